@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+# -*- Mode: python; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#
+# gen-rsvg-atoms.py: generate the perfect-hash atom tables used by the loader
+#
+# Usage: gen-rsvg-atoms.py <srcdir>
+#
+# Writes rsvg-atoms.h and rsvg-atoms.c into <srcdir>.  Both files are checked
+# into the tree; rerun this script whenever one of the name lists below
+# changes.  For every atom set we search for an FNV-1a seed that maps all
+# names to distinct slots of a power-of-two table, so a lookup is one hash,
+# one length compare and one memcmp.
+
+import os
+import re
+import sys
+
+ELEMENTS = [
+    "a", "circle", "clipPath", "conicalGradient", "defs", "desc", "ellipse",
+    "feBlend", "feColorMatrix", "feComponentTransfer", "feComposite",
+    "feConvolveMatrix", "feDiffuseLighting", "feDisplacementMap",
+    "feDistantLight", "feFlood", "feFuncA", "feFuncB", "feFuncG", "feFuncR",
+    "feGaussianBlur", "feImage", "feMerge", "feMergeNode", "feMorphology",
+    "feOffset", "fePointLight", "feSpecularLighting", "feSpotLight", "feTile",
+    "feTurbulence", "filter", "g", "image", "line", "linearGradient", "marker",
+    "mask", "metadata", "multiImage", "path", "pattern", "polygon", "polyline",
+    "radialGradient", "rect", "stop", "style", "subImage", "subImageRef",
+    "svg", "switch", "symbol", "text", "title", "tspan", "use",
+]
+
+# Every attribute the loader looks up by name, plus the presentation
+# attributes handled by rsvg_parse_style_pair()
+ATTRIBUTES = [
+    "alternate", "amplitude", "azimuth", "baseFrequency", "baseline-shift",
+    "bias", "class", "clip-path", "clip-rule", "clipPathUnits", "color",
+    "comp-op", "cx", "cy", "d", "diffuseConstant", "direction", "display",
+    "divisor", "dx", "dy", "edgeMode", "elevation", "enable-background",
+    "exponent", "fill", "fill-opacity", "fill-rule", "filter", "filterUnits",
+    "flood-color", "flood-opacity", "font-family", "font-size", "font-stretch",
+    "font-style", "font-variant", "font-weight", "fx", "fy",
+    "gradientTransform", "gradientUnits", "height", "href", "id", "in", "in2",
+    "intercept", "k1", "k2", "k3", "k4", "kernelMatrix", "kernelUnitLength",
+    "letter-spacing", "lighting-color", "limitingConeAngle", "marker-end",
+    "marker-mid", "marker-start", "markerHeight", "markerUnits", "markerWidth",
+    "mask", "maskContentUnits", "maskUnits", "mode", "numOctaves", "offset",
+    "opacity", "operator", "order", "orient", "overflow", "path",
+    "patternContentUnits", "patternTransform", "patternUnits", "points",
+    "pointsAtX", "pointsAtY", "pointsAtZ", "preserveAlpha",
+    "preserveAspectRatio", "primitiveUnits", "r", "radius", "refX", "refY",
+    "requiredExtensions", "requiredFeatures", "result", "rx", "ry", "scale",
+    "seed", "shape-rendering", "slope", "specularConstant", "specularExponent",
+    "spreadMethod", "stdDeviation", "stitchTiles", "stop-color", "stop-opacity",
+    "stroke", "stroke-dasharray", "stroke-dashoffset", "stroke-linecap",
+    "stroke-linejoin", "stroke-miterlimit", "stroke-opacity", "stroke-width",
+    "style", "surfaceScale", "systemLanguage", "tableValues", "targetX",
+    "targetY", "text-anchor", "text-decoration", "text-rendering", "transform",
+    "type", "unicode-bidi", "values", "verts", "viewBox", "visibility", "width",
+    "writing-mode", "x", "x1", "x2", "xChannelSelector", "xlink:href",
+    "xml:lang", "xml:space", "y", "y1", "y2", "yChannelSelector", "z",
+]
+
+# (set name, C type, enum prefix, names)
+ATOM_SETS = [
+    ("element", "RsvgElementAtom", "RSVG_ELEMENT_", ELEMENTS),
+    ("attribute", "RsvgAttributeAtom", "RSVG_ATTRIBUTE_", ATTRIBUTES),
+]
+
+FNV_PRIME = 16777619
+MASK32 = 0xffffffff
+
+
+def fnv1a(seed, name):
+    h = seed
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * FNV_PRIME) & MASK32
+    return h
+
+
+def find_seed(names, bits):
+    for seed in range(2166136261, 2166136261 + 10000000):
+        slots = set()
+        for name in names:
+            slot = fnv1a(seed, name) >> (32 - bits)
+            if slot in slots:
+                break
+            slots.add(slot)
+        else:
+            return seed
+    return None
+
+
+def enum_name(prefix, name):
+    name = re.sub(r"[^A-Za-z0-9]+", "_", name)
+    name = re.sub(r"([a-z0-9])([A-Z])", r"\1_\2", name)
+    return prefix + name.upper()
+
+
+def plan(names):
+    bits = max(4, (len(names) * 4 - 1).bit_length())
+    while True:
+        seed = find_seed(names, bits)
+        if seed is not None:
+            return bits, seed
+        bits += 1
+
+
+HEADER_PREAMBLE = """\
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   {file}: Perfect-hash atoms for element and attribute names
+
+   This file is generated by gen-rsvg-atoms.py; do not edit it by hand.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+"""
+
+
+def gen_header(sets):
+    out = [HEADER_PREAMBLE.format(file="rsvg-atoms.h")]
+    out.append("#ifndef RSVG_ATOMS_H\n#define RSVG_ATOMS_H\n\n#include <glib.h>\n\nG_BEGIN_DECLS\n")
+    for set_name, ctype, prefix, names, bits, seed in sets:
+        out.append("typedef enum {")
+        out.append("    %sUNKNOWN = 0," % prefix)
+        for name in names:
+            out.append("    %s," % enum_name(prefix, name))
+        out.append("    %sLAST" % prefix)
+        out.append("} %s;\n" % ctype)
+    for set_name, ctype, prefix, names, bits, seed in sets:
+        out.append("/* Returns %sUNKNOWN for names that are not in the table */" % prefix)
+        out.append("G_GNUC_INTERNAL")
+        out.append("%s rsvg_%s_atom_lookup(const char* name);" % (ctype, set_name))
+        out.append("G_GNUC_INTERNAL")
+        out.append("%s rsvg_%s_atom_lookup_len(const char* name, gsize len);" % (ctype, set_name))
+        out.append("/* Returns a static string, or NULL for %sUNKNOWN */" % prefix)
+        out.append("G_GNUC_INTERNAL")
+        out.append("const char* rsvg_%s_atom_to_string(%s atom);\n" % (set_name, ctype))
+    out.append("G_END_DECLS\n\n#endif /* RSVG_ATOMS_H */")
+    return "\n".join(out) + "\n"
+
+
+def wrap(items, width=116):
+    lines, line = [], "   "
+    for item in items:
+        if len(line) + len(item) + 2 > width:
+            lines.append(line)
+            line = "   "
+        line += " " + item + ","
+    lines.append(line)
+    return lines
+
+
+def gen_source(sets):
+    out = [HEADER_PREAMBLE.format(file="rsvg-atoms.c")]
+    out.append('#include "config.h"\n\n#include "rsvg-atoms.h"\n\n#include <string.h>\n')
+    out.append("static inline guint32 rsvg_atom_hash(guint32 seed, const char* name, gsize len) {")
+    out.append("    guint32 h = seed;")
+    out.append("    gsize i;\n")
+    out.append("    for (i = 0; i < len; i++)")
+    out.append("        h = (h ^ (guchar)name[i]) * %du;\n" % FNV_PRIME)
+    out.append("    return h;\n}\n")
+    for set_name, ctype, prefix, names, bits, seed in sets:
+        assert len(names) < 255
+        assert max(len(n) for n in names) < 256
+        slots = [None] * (1 << bits)
+        for name in names:
+            slots[fnv1a(seed, name) >> (32 - bits)] = name
+        upper = set_name.upper()
+        out.append("#define RSVG_%s_ATOM_SEED %du" % (upper, seed))
+        out.append("#define RSVG_%s_ATOM_SHIFT %d\n" % (upper, 32 - bits))
+        out.append("static const char* const rsvg_%s_atom_names[%sLAST] = {" % (set_name, prefix))
+        out.append("    NULL,")
+        for name in names:
+            out.append('    "%s",' % name)
+        out.append("};\n")
+        out.append("static const guint8 rsvg_%s_atom_lengths[%sLAST] = {" % (set_name, prefix))
+        out.extend(wrap(["0"] + [str(len(n)) for n in names]))
+        out.append("};\n")
+        out.append("/* hash slot -> atom, 0 for empty slots */")
+        out.append("static const guint8 rsvg_%s_atom_slots[%d] = {" % (set_name, 1 << bits))
+        out.extend(wrap([str(names.index(n) + 1) if n is not None else "0" for n in slots]))
+        out.append("};\n")
+        out.append("%s rsvg_%s_atom_lookup_len(const char* name, gsize len) {" % (ctype, set_name))
+        out.append("    guint atom;\n")
+        out.append("    atom = rsvg_%s_atom_slots[rsvg_atom_hash(RSVG_%s_ATOM_SEED, name, len) >> RSVG_%s_ATOM_SHIFT];"
+                   % (set_name, upper, upper))
+        out.append("    if (atom != 0 && rsvg_%s_atom_lengths[atom] == len &&" % set_name)
+        out.append("        memcmp(rsvg_%s_atom_names[atom], name, len) == 0)" % set_name)
+        out.append("        return (%s)atom;\n" % ctype)
+        out.append("    return %sUNKNOWN;\n}\n" % prefix)
+        out.append("%s rsvg_%s_atom_lookup(const char* name) {" % (ctype, set_name))
+        out.append("    return rsvg_%s_atom_lookup_len(name, strlen(name));\n}\n" % set_name)
+        out.append("const char* rsvg_%s_atom_to_string(%s atom) {" % (set_name, ctype))
+        out.append("    if ((guint)atom >= %sLAST)" % prefix)
+        out.append("        return NULL;\n")
+        out.append("    return rsvg_%s_atom_names[atom];\n}\n" % set_name)
+    return "\n".join(out).rstrip("\n") + "\n"
+
+
+def main():
+    srcdir = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(os.path.abspath(__file__))
+    sets = []
+    for set_name, ctype, prefix, names in ATOM_SETS:
+        names = sorted(set(names), key=lambda n: (n.lower(), n))
+        assert len(set(enum_name(prefix, n) for n in names)) == len(names)
+        bits, seed = plan(names)
+        sets.append((set_name, ctype, prefix, names, bits, seed))
+    with open(os.path.join(srcdir, "rsvg-atoms.h"), "w") as f:
+        f.write(gen_header(sets))
+    with open(os.path.join(srcdir, "rsvg-atoms.c"), "w") as f:
+        f.write(gen_source(sets))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-arena.c: Bump allocator for memory that lives as long as a handle
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include "config.h"
+#include "rsvg-arena.h"
+
+#include <string.h>
+
+/* Every allocation is rounded up to a multiple of the granule, which keeps
+ * everything suitably aligned for doubles and pointers
+ */
+#define RSVG_ARENA_GRANULE 16
+/* Blocks start small so that tiny documents stay tiny, and double up to
+ * the maximum so that huge ones only need a handful of blocks
+ */
+#define RSVG_ARENA_MIN_BLOCK_SIZE (16 * 1024)
+#define RSVG_ARENA_MAX_BLOCK_SIZE (4 * 1024 * 1024)
+/* Requests at least this big that do not fit in the current block get a
+ * block of their own instead of retiring the current one
+ */
+#define RSVG_ARENA_LARGE_SIZE (RSVG_ARENA_MIN_BLOCK_SIZE / 4)
+
+#define RSVG_ARENA_ROUND_UP(size) (((size) + RSVG_ARENA_GRANULE - 1) & ~(gsize)(RSVG_ARENA_GRANULE - 1))
+
+typedef struct _RsvgArenaBlock RsvgArenaBlock;
+
+struct _RsvgArenaBlock {
+    RsvgArenaBlock* next;
+};
+
+#define RSVG_ARENA_BLOCK_HEADER_SIZE RSVG_ARENA_ROUND_UP(sizeof(RsvgArenaBlock))
+#define RSVG_ARENA_BLOCK_DATA(block) ((guint8*)(block) + RSVG_ARENA_BLOCK_HEADER_SIZE)
+
+struct _RsvgArena {
+    RsvgArenaBlock* blocks;
+    guint8* next; /* free space in the block being bumped */
+    guint8* end;
+    gsize next_block_size;
+    gsize size;
+    gsize used;
+};
+
+RsvgArena* rsvg_arena_new(void) {
+    RsvgArena* arena = g_new(RsvgArena, 1);
+
+    arena->blocks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->next_block_size = RSVG_ARENA_MIN_BLOCK_SIZE;
+    arena->size = 0;
+    arena->used = 0;
+
+    return arena;
+}
+
+void rsvg_arena_free(RsvgArena* arena) {
+    RsvgArenaBlock* block;
+
+    if (arena == NULL)
+        return;
+
+    while ((block = arena->blocks) != NULL) {
+        arena->blocks = block->next;
+        g_free(block);
+    }
+
+    g_free(arena);
+}
+
+static guint8* rsvg_arena_add_block(RsvgArena* arena, gsize size) {
+    RsvgArenaBlock* block;
+
+    block = g_malloc(RSVG_ARENA_BLOCK_HEADER_SIZE + size);
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->size += RSVG_ARENA_BLOCK_HEADER_SIZE + size;
+
+    return RSVG_ARENA_BLOCK_DATA(block);
+}
+
+gpointer rsvg_arena_alloc(RsvgArena* arena, gsize size) {
+    guint8* mem;
+
+    if (G_UNLIKELY(size > G_MAXSIZE / 2))
+        g_error("%s: overflow allocating %" G_GSIZE_FORMAT " bytes", G_STRLOC, size);
+
+    size = size == 0 ? RSVG_ARENA_GRANULE : RSVG_ARENA_ROUND_UP(size);
+    arena->used += size;
+
+    if (size > (gsize)(arena->end - arena->next)) {
+        gsize block_size;
+
+        if (size >= RSVG_ARENA_LARGE_SIZE)
+            return rsvg_arena_add_block(arena, size);
+
+        block_size = arena->next_block_size;
+        arena->next_block_size = MIN(block_size * 2, RSVG_ARENA_MAX_BLOCK_SIZE);
+
+        arena->next = rsvg_arena_add_block(arena, block_size);
+        arena->end = arena->next + block_size;
+    }
+
+    mem = arena->next;
+    arena->next += size;
+
+    return mem;
+}
+
+gpointer rsvg_arena_alloc0(RsvgArena* arena, gsize size) {
+    gpointer mem = rsvg_arena_alloc(arena, size);
+
+    memset(mem, 0, size);
+    return mem;
+}
+
+gpointer rsvg_arena_memdup(RsvgArena* arena, gconstpointer mem, gsize size) {
+    gpointer copy;
+
+    if (mem == NULL)
+        return NULL;
+
+    copy = rsvg_arena_alloc(arena, size);
+    memcpy(copy, mem, size);
+    return copy;
+}
+
+char* rsvg_arena_strndup(RsvgArena* arena, const char* str, gsize len) {
+    char* copy;
+
+    if (str == NULL)
+        return NULL;
+
+    copy = rsvg_arena_alloc(arena, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+char* rsvg_arena_strdup(RsvgArena* arena, const char* str) {
+    if (str == NULL)
+        return NULL;
+
+    return rsvg_arena_strndup(arena, str, strlen(str));
+}
+
+void rsvg_arena_adopt(RsvgArena* arena, RsvgArena* other) {
+    RsvgArenaBlock* last;
+
+    /* only the list of blocks to free grows; bumping goes on in the current block */
+    if (other->blocks != NULL) {
+        for (last = other->blocks; last->next != NULL; last = last->next)
+            ;
+        last->next = arena->blocks;
+        arena->blocks = other->blocks;
+    }
+
+    arena->size += other->size;
+    arena->used += other->used;
+
+    g_free(other);
+}
+
+gsize rsvg_arena_get_size(const RsvgArena* arena) {
+    return arena->size;
+}
+
+gsize rsvg_arena_get_used(const RsvgArena* arena) {
+    return arena->used;
+}
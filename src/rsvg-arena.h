@@ -0,0 +1,70 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-arena.h: Bump allocator for memory that lives as long as a handle
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RSVG_ARENA_H
+#define RSVG_ARENA_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Nodes, their id/class/style strings and their path data are carved out of
+ * large blocks owned by the handle.  Nothing allocated from an arena is freed
+ * on its own; everything goes away at once in rsvg_arena_free().
+ */
+typedef struct _RsvgArena RsvgArena;
+
+G_GNUC_INTERNAL
+RsvgArena* rsvg_arena_new(void);
+G_GNUC_INTERNAL
+void rsvg_arena_free(RsvgArena* arena);
+
+G_GNUC_INTERNAL
+gpointer rsvg_arena_alloc(RsvgArena* arena, gsize size);
+G_GNUC_INTERNAL
+gpointer rsvg_arena_alloc0(RsvgArena* arena, gsize size);
+G_GNUC_INTERNAL
+gpointer rsvg_arena_memdup(RsvgArena* arena, gconstpointer mem, gsize size);
+G_GNUC_INTERNAL
+char* rsvg_arena_strdup(RsvgArena* arena, const char* str);
+G_GNUC_INTERNAL
+char* rsvg_arena_strndup(RsvgArena* arena, const char* str, gsize len);
+
+/* Moves all of @other's memory into @arena, which then frees it along with
+ * its own, and frees @other.  Lets each thread of a parallel pass allocate
+ * from an arena of its own.
+ */
+G_GNUC_INTERNAL
+void rsvg_arena_adopt(RsvgArena* arena, RsvgArena* other);
+
+/* Bytes reserved from the system, including the unused tails of blocks */
+G_GNUC_INTERNAL
+gsize rsvg_arena_get_size(const RsvgArena* arena);
+/* Bytes handed out, after rounding up to the allocation granule */
+G_GNUC_INTERNAL
+gsize rsvg_arena_get_used(const RsvgArena* arena);
+
+#define RSVG_ARENA_NEW(arena, struct_type) ((struct_type*)rsvg_arena_alloc((arena), sizeof(struct_type)))
+#define RSVG_ARENA_NEW0(arena, struct_type) ((struct_type*)rsvg_arena_alloc0((arena), sizeof(struct_type)))
+
+G_END_DECLS
+
+#endif /* RSVG_ARENA_H */
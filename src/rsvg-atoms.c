@@ -0,0 +1,354 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-atoms.c: Perfect-hash atoms for element and attribute names
+
+   This file is generated by gen-rsvg-atoms.py; do not edit it by hand.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include "config.h"
+
+#include "rsvg-atoms.h"
+
+#include <string.h>
+
+static inline guint32 rsvg_atom_hash(guint32 seed, const char* name, gsize len) {
+    guint32 h = seed;
+    gsize i;
+
+    for (i = 0; i < len; i++)
+        h = (h ^ (guchar)name[i]) * 16777619u;
+
+    return h;
+}
+
+#define RSVG_ELEMENT_ATOM_SEED 2166138337u
+#define RSVG_ELEMENT_ATOM_SHIFT 24
+
+static const char* const rsvg_element_atom_names[RSVG_ELEMENT_LAST] = {
+    NULL,
+    "a",
+    "circle",
+    "clipPath",
+    "conicalGradient",
+    "defs",
+    "desc",
+    "ellipse",
+    "feBlend",
+    "feColorMatrix",
+    "feComponentTransfer",
+    "feComposite",
+    "feConvolveMatrix",
+    "feDiffuseLighting",
+    "feDisplacementMap",
+    "feDistantLight",
+    "feFlood",
+    "feFuncA",
+    "feFuncB",
+    "feFuncG",
+    "feFuncR",
+    "feGaussianBlur",
+    "feImage",
+    "feMerge",
+    "feMergeNode",
+    "feMorphology",
+    "feOffset",
+    "fePointLight",
+    "feSpecularLighting",
+    "feSpotLight",
+    "feTile",
+    "feTurbulence",
+    "filter",
+    "g",
+    "image",
+    "line",
+    "linearGradient",
+    "marker",
+    "mask",
+    "metadata",
+    "multiImage",
+    "path",
+    "pattern",
+    "polygon",
+    "polyline",
+    "radialGradient",
+    "rect",
+    "stop",
+    "style",
+    "subImage",
+    "subImageRef",
+    "svg",
+    "switch",
+    "symbol",
+    "text",
+    "title",
+    "tspan",
+    "use",
+};
+
+static const guint8 rsvg_element_atom_lengths[RSVG_ELEMENT_LAST] = {
+    0, 1, 6, 8, 15, 4, 4, 7, 7, 13, 19, 11, 16, 17, 17, 14, 7, 7, 7, 7, 7, 14, 7, 7, 11, 12, 8, 12, 18, 11, 6, 12,
+    6, 1, 5, 4, 14, 6, 4, 8, 10, 4, 7, 7, 8, 14, 4, 4, 5, 8, 11, 3, 6, 6, 4, 5, 5, 3,
+};
+
+/* hash slot -> atom, 0 for empty slots */
+static const guint8 rsvg_element_atom_slots[256] = {
+    0, 7, 0, 0, 48, 0, 0, 52, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 45, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 13, 0, 0,
+    0, 0, 0, 0, 14, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 35, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    28, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0, 21, 0, 0, 50, 0, 0, 0, 19, 0, 6, 18, 0, 0, 17, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 40, 29, 0, 0, 5, 0, 0, 0, 39, 0, 0, 0, 0, 0, 2, 54, 0, 0, 0, 0, 0, 0, 22, 0, 0, 0,
+    0, 47, 3, 0, 0, 0, 0, 49, 0, 0, 0, 51, 9, 0, 0, 0, 0, 0, 0, 57, 0, 0, 0, 26, 0, 0, 0, 15, 0, 0, 53, 0, 0, 44, 0,
+    0, 0, 0, 10, 0, 0, 37, 0, 0, 0, 0, 0, 0, 0, 1, 34, 0, 43, 36, 0, 33, 0, 46, 0, 0, 0, 0, 11, 0, 24, 0, 0, 0, 0,
+    38, 0, 0, 32, 0, 0, 0, 0, 0, 55, 0, 0, 0, 0, 0, 25, 0, 0, 0, 56, 27, 0, 0, 0, 16, 0, 0, 12, 23, 0, 31, 8, 0, 0,
+    0, 30, 0, 41, 0, 0, 42, 0, 0, 0,
+};
+
+RsvgElementAtom rsvg_element_atom_lookup_len(const char* name, gsize len) {
+    guint atom;
+
+    atom = rsvg_element_atom_slots[rsvg_atom_hash(RSVG_ELEMENT_ATOM_SEED, name, len) >> RSVG_ELEMENT_ATOM_SHIFT];
+    if (atom != 0 && rsvg_element_atom_lengths[atom] == len &&
+        memcmp(rsvg_element_atom_names[atom], name, len) == 0)
+        return (RsvgElementAtom)atom;
+
+    return RSVG_ELEMENT_UNKNOWN;
+}
+
+RsvgElementAtom rsvg_element_atom_lookup(const char* name) {
+    return rsvg_element_atom_lookup_len(name, strlen(name));
+}
+
+const char* rsvg_element_atom_to_string(RsvgElementAtom atom) {
+    if ((guint)atom >= RSVG_ELEMENT_LAST)
+        return NULL;
+
+    return rsvg_element_atom_names[atom];
+}
+
+#define RSVG_ATTRIBUTE_ATOM_SEED 2166214612u
+#define RSVG_ATTRIBUTE_ATOM_SHIFT 22
+
+static const char* const rsvg_attribute_atom_names[RSVG_ATTRIBUTE_LAST] = {
+    NULL,
+    "alternate",
+    "amplitude",
+    "azimuth",
+    "baseFrequency",
+    "baseline-shift",
+    "bias",
+    "class",
+    "clip-path",
+    "clip-rule",
+    "clipPathUnits",
+    "color",
+    "comp-op",
+    "cx",
+    "cy",
+    "d",
+    "diffuseConstant",
+    "direction",
+    "display",
+    "divisor",
+    "dx",
+    "dy",
+    "edgeMode",
+    "elevation",
+    "enable-background",
+    "exponent",
+    "fill",
+    "fill-opacity",
+    "fill-rule",
+    "filter",
+    "filterUnits",
+    "flood-color",
+    "flood-opacity",
+    "font-family",
+    "font-size",
+    "font-stretch",
+    "font-style",
+    "font-variant",
+    "font-weight",
+    "fx",
+    "fy",
+    "gradientTransform",
+    "gradientUnits",
+    "height",
+    "href",
+    "id",
+    "in",
+    "in2",
+    "intercept",
+    "k1",
+    "k2",
+    "k3",
+    "k4",
+    "kernelMatrix",
+    "kernelUnitLength",
+    "letter-spacing",
+    "lighting-color",
+    "limitingConeAngle",
+    "marker-end",
+    "marker-mid",
+    "marker-start",
+    "markerHeight",
+    "markerUnits",
+    "markerWidth",
+    "mask",
+    "maskContentUnits",
+    "maskUnits",
+    "mode",
+    "numOctaves",
+    "offset",
+    "opacity",
+    "operator",
+    "order",
+    "orient",
+    "overflow",
+    "path",
+    "patternContentUnits",
+    "patternTransform",
+    "patternUnits",
+    "points",
+    "pointsAtX",
+    "pointsAtY",
+    "pointsAtZ",
+    "preserveAlpha",
+    "preserveAspectRatio",
+    "primitiveUnits",
+    "r",
+    "radius",
+    "refX",
+    "refY",
+    "requiredExtensions",
+    "requiredFeatures",
+    "result",
+    "rx",
+    "ry",
+    "scale",
+    "seed",
+    "shape-rendering",
+    "slope",
+    "specularConstant",
+    "specularExponent",
+    "spreadMethod",
+    "stdDeviation",
+    "stitchTiles",
+    "stop-color",
+    "stop-opacity",
+    "stroke",
+    "stroke-dasharray",
+    "stroke-dashoffset",
+    "stroke-linecap",
+    "stroke-linejoin",
+    "stroke-miterlimit",
+    "stroke-opacity",
+    "stroke-width",
+    "style",
+    "surfaceScale",
+    "systemLanguage",
+    "tableValues",
+    "targetX",
+    "targetY",
+    "text-anchor",
+    "text-decoration",
+    "text-rendering",
+    "transform",
+    "type",
+    "unicode-bidi",
+    "values",
+    "verts",
+    "viewBox",
+    "visibility",
+    "width",
+    "writing-mode",
+    "x",
+    "x1",
+    "x2",
+    "xChannelSelector",
+    "xlink:href",
+    "xml:lang",
+    "xml:space",
+    "y",
+    "y1",
+    "y2",
+    "yChannelSelector",
+    "z",
+};
+
+static const guint8 rsvg_attribute_atom_lengths[RSVG_ATTRIBUTE_LAST] = {
+    0, 9, 9, 7, 13, 14, 4, 5, 9, 9, 13, 5, 7, 2, 2, 1, 15, 9, 7, 7, 2, 2, 8, 9, 17, 8, 4, 12, 9, 6, 11, 11, 13, 11,
+    9, 12, 10, 12, 11, 2, 2, 17, 13, 6, 4, 2, 2, 3, 9, 2, 2, 2, 2, 12, 16, 14, 14, 17, 10, 10, 12, 12, 11, 11, 4,
+    16, 9, 4, 10, 6, 7, 8, 5, 6, 8, 4, 19, 16, 12, 6, 9, 9, 9, 13, 19, 14, 1, 6, 4, 4, 18, 16, 6, 2, 2, 5, 4, 15, 5,
+    16, 16, 12, 12, 11, 10, 12, 6, 16, 17, 14, 15, 17, 14, 12, 5, 12, 14, 11, 7, 7, 11, 15, 14, 9, 4, 12, 6, 5, 7,
+    10, 5, 12, 1, 2, 2, 16, 10, 8, 9, 1, 2, 2, 16, 1,
+};
+
+/* hash slot -> atom, 0 for empty slots */
+static const guint8 rsvg_attribute_atom_slots[1024] = {
+    0, 0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 57, 0, 0, 0, 0, 0, 0,
+    0, 60, 0, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0, 114, 0, 0, 0, 0, 0, 52, 0, 54, 0, 0, 0, 109, 0,
+    0, 0, 0, 0, 49, 30, 89, 0, 74, 0, 88, 0, 51, 0, 120, 0, 50, 0, 0, 0, 121, 0, 0, 0, 0, 0, 128, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 113, 0, 0, 68, 0, 0, 0, 0, 0, 67, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 41, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 124, 0, 48, 0, 0, 0, 0, 0, 0, 0, 97,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 106, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 56, 27, 0, 0, 0, 45, 0, 0, 0,
+    0, 0, 2, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 46, 0, 0, 35, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    53, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 21, 0, 55, 108, 0, 0, 0, 29, 0, 0, 0, 93, 0, 0, 0,
+    94, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 14, 0, 0, 0, 13, 0, 0, 0, 0, 0, 0, 0, 39, 0, 0, 0, 40, 0, 0,
+    0, 0, 0, 0, 0, 33, 0, 0, 0, 0, 0, 0, 0, 0, 18, 0, 0, 0, 0, 0, 0, 0, 0, 75, 0, 0, 0, 0, 0, 0, 61, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 59, 0, 0, 0, 0, 117, 0, 0, 0, 0, 0, 90, 0, 0, 0, 0, 0, 0, 99, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 12, 0, 102, 0, 101, 0, 0, 0, 0, 0, 0, 0, 116, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 85, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 73, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 127, 0, 0, 0, 0, 0, 69, 3, 0, 66, 0, 0, 0, 112, 0, 137, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 133, 0, 82, 0, 134, 0, 0, 0, 0,
+    0, 80, 0, 141, 0, 81, 0, 140, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 71, 0, 92, 0, 0,
+    11, 0, 77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 96, 0, 0, 0, 0, 1, 0, 0, 110, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 105, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 131, 0, 37, 0, 0, 0, 0, 0, 0, 19, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 138, 0, 0, 0, 0, 23, 0, 104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0, 0, 0, 0, 0, 0,
+    95, 0, 125, 0, 0, 0, 0, 0, 0, 64, 0, 103, 0, 0, 0, 0, 0, 0, 0, 0, 0, 142, 0, 0, 0, 0, 0, 36, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 70, 0, 0, 0, 0, 91, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 119, 0, 0, 0, 118, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0, 0, 58, 0, 0, 0, 0, 0, 0, 0, 0, 31, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 129, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 38, 0,
+    0, 0, 107, 0, 0, 0, 0, 0, 34, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 47, 98, 0, 115, 126, 0, 0, 0, 0, 0, 0, 28, 0, 0,
+    0, 122, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 63, 62, 0, 0, 0, 0, 0, 43, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 130, 0, 0, 0, 0, 0, 0, 135, 0, 0, 0, 0, 0, 0, 0, 0, 0, 79, 0, 0, 0,
+    0, 0, 42, 0, 0, 0, 0, 86, 0, 111, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 87, 0, 0, 0, 0, 76, 0, 0, 0, 132, 0, 0, 0,
+    139, 0, 0, 0, 143, 0, 0, 0, 0, 0, 44, 0, 15, 0, 0, 0, 0, 0, 26, 5, 0, 0, 0, 0, 0, 6, 0, 0, 78, 0, 0, 0, 0, 0,
+    32, 0, 0, 123, 0, 0, 0, 0, 0, 83, 84, 0, 24, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 136, 0, 0, 0, 0, 0,
+};
+
+RsvgAttributeAtom rsvg_attribute_atom_lookup_len(const char* name, gsize len) {
+    guint atom;
+
+    atom = rsvg_attribute_atom_slots[rsvg_atom_hash(RSVG_ATTRIBUTE_ATOM_SEED, name, len) >> RSVG_ATTRIBUTE_ATOM_SHIFT];
+    if (atom != 0 && rsvg_attribute_atom_lengths[atom] == len &&
+        memcmp(rsvg_attribute_atom_names[atom], name, len) == 0)
+        return (RsvgAttributeAtom)atom;
+
+    return RSVG_ATTRIBUTE_UNKNOWN;
+}
+
+RsvgAttributeAtom rsvg_attribute_atom_lookup(const char* name) {
+    return rsvg_attribute_atom_lookup_len(name, strlen(name));
+}
+
+const char* rsvg_attribute_atom_to_string(RsvgAttributeAtom atom) {
+    if ((guint)atom >= RSVG_ATTRIBUTE_LAST)
+        return NULL;
+
+    return rsvg_attribute_atom_names[atom];
+}
@@ -78,8 +78,7 @@ RsvgHandle* rsvg_handle_new_from_data(const guint8* data, gsize data_len, GError
  */
 RsvgHandle* rsvg_handle_new_from_file(const gchar* file_name, GError** error) {
     gchar* base_uri;
-    char* data;
-    gsize data_len;
+    GBytes* data;
     RsvgHandle* handle = NULL;
     GFile* file;
 
@@ -93,16 +92,20 @@ RsvgHandle* rsvg_handle_new_from_file(const gchar* file_name, GError** error) {
         return NULL;
     }
 
-    data = _rsvg_io_acquire_data(base_uri, base_uri, NULL, &data_len, NULL, error);
+    /* a local file is parsed straight out of its mapping */
+    data = _rsvg_io_acquire_data(base_uri, base_uri, NULL, NULL, error);
 
     if (data) {
+        gsize data_len;
+        const char* buf = g_bytes_get_data(data, &data_len);
+
         handle = rsvg_handle_new();
         rsvg_handle_set_base_uri(handle, base_uri);
-        if (!rsvg_handle_fill_with_data(handle, data, data_len, error)) {
+        if (!rsvg_handle_fill_with_data(handle, buf, data_len, error)) {
             g_object_unref(handle);
             handle = NULL;
         }
-        g_free(data);
+        g_bytes_unref(data);
     }
 
     g_free(base_uri);
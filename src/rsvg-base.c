@@ -37,6 +37,8 @@
 #include "rsvg-structure.h"
 #include "rsvg-image.h"
 #include "rsvg-io.h"
+#include "rsvg-gzip.h"
+#include "rsvg-extern-cache.h"
 #include "rsvg-text.h"
 #include "rsvg-filter.h"
 #include "rsvg-mask.h"
@@ -135,7 +137,7 @@ static void rsvg_start_style(RsvgHandle* ctx, RsvgPropertyBag* atts) {
     RsvgSaxHandlerStyle* handler = g_new0(RsvgSaxHandlerStyle, 1);
     const char* type;
 
-    type = rsvg_property_bag_lookup(atts, "type");
+    type = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TYPE);
 
     handler->super.free = rsvg_style_handler_free;
     handler->super.characters = rsvg_style_handler_characters;
@@ -163,144 +165,159 @@ static void rsvg_start_style(RsvgHandle* ctx, RsvgPropertyBag* atts) {
     ctx->priv->handler = &handler->super;
 }
 
-static void rsvg_standard_element_start(RsvgHandle* ctx, const char* name, RsvgPropertyBag* atts) {
-    /*replace this stuff with a hash for fast reading! */
-    RsvgNode* newnode = NULL;
-    if (!strcmp(name, "g"))
-        newnode = rsvg_new_group();
-    else if (!strcmp(name, "a")) /*treat anchors as groups for now */
-        newnode = rsvg_new_group();
-    else if (!strcmp(name, "switch"))
-        newnode = rsvg_new_switch();
-    else if (!strcmp(name, "defs"))
-        newnode = rsvg_new_defs();
-    else if (!strcmp(name, "use"))
-        newnode = rsvg_new_use();
-    else if (!strcmp(name, "path"))
-        newnode = rsvg_new_path();
-    else if (!strcmp(name, "line"))
-        newnode = rsvg_new_line();
-    else if (!strcmp(name, "rect"))
-        newnode = rsvg_new_rect();
-    else if (!strcmp(name, "ellipse"))
-        newnode = rsvg_new_ellipse();
-    else if (!strcmp(name, "circle"))
-        newnode = rsvg_new_circle();
-    else if (!strcmp(name, "polygon"))
-        newnode = rsvg_new_polygon();
-    else if (!strcmp(name, "polyline"))
-        newnode = rsvg_new_polyline();
-    else if (!strcmp(name, "symbol"))
-        newnode = rsvg_new_symbol();
-    else if (!strcmp(name, "svg"))
-        newnode = rsvg_new_svg();
-    else if (!strcmp(name, "mask"))
-        newnode = rsvg_new_mask();
-    else if (!strcmp(name, "clipPath"))
-        newnode = rsvg_new_clip_path();
-    else if (!strcmp(name, "image"))
-        newnode = rsvg_new_image();
-    else if (!strcmp(name, "marker"))
-        newnode = rsvg_new_marker();
-    else if (!strcmp(name, "stop"))
-        newnode = rsvg_new_stop();
-    else if (!strcmp(name, "pattern"))
-        newnode = rsvg_new_pattern();
-    else if (!strcmp(name, "linearGradient"))
-        newnode = rsvg_new_linear_gradient();
-    else if (!strcmp(name, "radialGradient"))
-        newnode = rsvg_new_radial_gradient();
-    else if (!strcmp(name, "conicalGradient"))
-        newnode = rsvg_new_radial_gradient();
-    else if (!strcmp(name, "filter"))
-        newnode = rsvg_new_filter();
-    else if (!strcmp(name, "feBlend"))
-        newnode = rsvg_new_filter_primitive_blend();
-    else if (!strcmp(name, "feColorMatrix"))
-        newnode = rsvg_new_filter_primitive_color_matrix();
-    else if (!strcmp(name, "feComponentTransfer"))
-        newnode = rsvg_new_filter_primitive_component_transfer();
-    else if (!strcmp(name, "feComposite"))
-        newnode = rsvg_new_filter_primitive_composite();
-    else if (!strcmp(name, "feConvolveMatrix"))
-        newnode = rsvg_new_filter_primitive_convolve_matrix();
-    else if (!strcmp(name, "feDiffuseLighting"))
-        newnode = rsvg_new_filter_primitive_diffuse_lighting();
-    else if (!strcmp(name, "feDisplacementMap"))
-        newnode = rsvg_new_filter_primitive_displacement_map();
-    else if (!strcmp(name, "feFlood"))
-        newnode = rsvg_new_filter_primitive_flood();
-    else if (!strcmp(name, "feGaussianBlur"))
-        newnode = rsvg_new_filter_primitive_gaussian_blur();
-    else if (!strcmp(name, "feImage"))
-        newnode = rsvg_new_filter_primitive_image();
-    else if (!strcmp(name, "feMerge"))
-        newnode = rsvg_new_filter_primitive_merge();
-    else if (!strcmp(name, "feMorphology"))
-        newnode = rsvg_new_filter_primitive_erode();
-    else if (!strcmp(name, "feOffset"))
-        newnode = rsvg_new_filter_primitive_offset();
-    else if (!strcmp(name, "feSpecularLighting"))
-        newnode = rsvg_new_filter_primitive_specular_lighting();
-    else if (!strcmp(name, "feTile"))
-        newnode = rsvg_new_filter_primitive_tile();
-    else if (!strcmp(name, "feTurbulence"))
-        newnode = rsvg_new_filter_primitive_turbulence();
-    else if (!strcmp(name, "feMergeNode"))
-        newnode = rsvg_new_filter_primitive_merge_node();
-    else if (!strcmp(name, "feFuncR"))
-        newnode = rsvg_new_node_component_transfer_function(
-            'r'); /* See rsvg_filter_primitive_component_transfer_render() for where these values are used */
-    else if (!strcmp(name, "feFuncG"))
-        newnode = rsvg_new_node_component_transfer_function('g');
-    else if (!strcmp(name, "feFuncB"))
-        newnode = rsvg_new_node_component_transfer_function('b');
-    else if (!strcmp(name, "feFuncA"))
-        newnode = rsvg_new_node_component_transfer_function('a');
-    else if (!strcmp(name, "feDistantLight"))
-        newnode = rsvg_new_node_light_source('d');
-    else if (!strcmp(name, "feSpotLight"))
-        newnode = rsvg_new_node_light_source('s');
-    else if (!strcmp(name, "fePointLight"))
-        newnode = rsvg_new_node_light_source('p');
-    /* hack to make multiImage sort-of work */
-    else if (!strcmp(name, "multiImage"))
-        newnode = rsvg_new_switch();
-    else if (!strcmp(name, "subImageRef"))
-        newnode = rsvg_new_image();
-    else if (!strcmp(name, "subImage"))
-        newnode = rsvg_new_group();
-    else if (!strcmp(name, "text"))
-        newnode = rsvg_new_text();
-    else if (!strcmp(name, "tspan"))
-        newnode = rsvg_new_tspan();
-    else {
-        /* Whenever we encounter a node we don't understand, represent it as a defs.
-         * This is like a group, but it doesn't do any rendering of children.  The
-         * effect is that we will ignore all children of unknown elements.
-         */
-        newnode = rsvg_new_defs();
+static RsvgNode* rsvg_new_node_for_element(RsvgArena* arena, RsvgElementAtom atom) {
+    switch (atom) {
+        case RSVG_ELEMENT_G:
+        case RSVG_ELEMENT_A: /*treat anchors as groups for now */
+            return rsvg_new_group(arena);
+        case RSVG_ELEMENT_SWITCH:
+            return rsvg_new_switch(arena);
+        case RSVG_ELEMENT_DEFS:
+            return rsvg_new_defs(arena);
+        case RSVG_ELEMENT_USE:
+            return rsvg_new_use(arena);
+        case RSVG_ELEMENT_PATH:
+            return rsvg_new_path(arena);
+        case RSVG_ELEMENT_LINE:
+            return rsvg_new_line(arena);
+        case RSVG_ELEMENT_RECT:
+            return rsvg_new_rect(arena);
+        case RSVG_ELEMENT_ELLIPSE:
+            return rsvg_new_ellipse(arena);
+        case RSVG_ELEMENT_CIRCLE:
+            return rsvg_new_circle(arena);
+        case RSVG_ELEMENT_POLYGON:
+            return rsvg_new_polygon(arena);
+        case RSVG_ELEMENT_POLYLINE:
+            return rsvg_new_polyline(arena);
+        case RSVG_ELEMENT_SYMBOL:
+            return rsvg_new_symbol(arena);
+        case RSVG_ELEMENT_SVG:
+            return rsvg_new_svg(arena);
+        case RSVG_ELEMENT_MASK:
+            return rsvg_new_mask(arena);
+        case RSVG_ELEMENT_CLIP_PATH:
+            return rsvg_new_clip_path(arena);
+        case RSVG_ELEMENT_IMAGE:
+            return rsvg_new_image(arena);
+        case RSVG_ELEMENT_MARKER:
+            return rsvg_new_marker(arena);
+        case RSVG_ELEMENT_STOP:
+            return rsvg_new_stop(arena);
+        case RSVG_ELEMENT_PATTERN:
+            return rsvg_new_pattern(arena);
+        case RSVG_ELEMENT_LINEAR_GRADIENT:
+            return rsvg_new_linear_gradient(arena);
+        case RSVG_ELEMENT_RADIAL_GRADIENT:
+        case RSVG_ELEMENT_CONICAL_GRADIENT:
+            return rsvg_new_radial_gradient(arena);
+        case RSVG_ELEMENT_FILTER:
+            return rsvg_new_filter(arena);
+        case RSVG_ELEMENT_FE_BLEND:
+            return rsvg_new_filter_primitive_blend(arena);
+        case RSVG_ELEMENT_FE_COLOR_MATRIX:
+            return rsvg_new_filter_primitive_color_matrix(arena);
+        case RSVG_ELEMENT_FE_COMPONENT_TRANSFER:
+            return rsvg_new_filter_primitive_component_transfer(arena);
+        case RSVG_ELEMENT_FE_COMPOSITE:
+            return rsvg_new_filter_primitive_composite(arena);
+        case RSVG_ELEMENT_FE_CONVOLVE_MATRIX:
+            return rsvg_new_filter_primitive_convolve_matrix(arena);
+        case RSVG_ELEMENT_FE_DIFFUSE_LIGHTING:
+            return rsvg_new_filter_primitive_diffuse_lighting(arena);
+        case RSVG_ELEMENT_FE_DISPLACEMENT_MAP:
+            return rsvg_new_filter_primitive_displacement_map(arena);
+        case RSVG_ELEMENT_FE_FLOOD:
+            return rsvg_new_filter_primitive_flood(arena);
+        case RSVG_ELEMENT_FE_GAUSSIAN_BLUR:
+            return rsvg_new_filter_primitive_gaussian_blur(arena);
+        case RSVG_ELEMENT_FE_IMAGE:
+            return rsvg_new_filter_primitive_image(arena);
+        case RSVG_ELEMENT_FE_MERGE:
+            return rsvg_new_filter_primitive_merge(arena);
+        case RSVG_ELEMENT_FE_MORPHOLOGY:
+            return rsvg_new_filter_primitive_erode(arena);
+        case RSVG_ELEMENT_FE_OFFSET:
+            return rsvg_new_filter_primitive_offset(arena);
+        case RSVG_ELEMENT_FE_SPECULAR_LIGHTING:
+            return rsvg_new_filter_primitive_specular_lighting(arena);
+        case RSVG_ELEMENT_FE_TILE:
+            return rsvg_new_filter_primitive_tile(arena);
+        case RSVG_ELEMENT_FE_TURBULENCE:
+            return rsvg_new_filter_primitive_turbulence(arena);
+        case RSVG_ELEMENT_FE_MERGE_NODE:
+            return rsvg_new_filter_primitive_merge_node(arena);
+        /* See rsvg_filter_primitive_component_transfer_render() for where these values are used */
+        case RSVG_ELEMENT_FE_FUNC_R:
+            return rsvg_new_node_component_transfer_function(arena, 'r');
+        case RSVG_ELEMENT_FE_FUNC_G:
+            return rsvg_new_node_component_transfer_function(arena, 'g');
+        case RSVG_ELEMENT_FE_FUNC_B:
+            return rsvg_new_node_component_transfer_function(arena, 'b');
+        case RSVG_ELEMENT_FE_FUNC_A:
+            return rsvg_new_node_component_transfer_function(arena, 'a');
+        case RSVG_ELEMENT_FE_DISTANT_LIGHT:
+            return rsvg_new_node_light_source(arena, 'd');
+        case RSVG_ELEMENT_FE_SPOT_LIGHT:
+            return rsvg_new_node_light_source(arena, 's');
+        case RSVG_ELEMENT_FE_POINT_LIGHT:
+            return rsvg_new_node_light_source(arena, 'p');
+        /* hack to make multiImage sort-of work */
+        case RSVG_ELEMENT_MULTI_IMAGE:
+            return rsvg_new_switch(arena);
+        case RSVG_ELEMENT_SUB_IMAGE_REF:
+            return rsvg_new_image(arena);
+        case RSVG_ELEMENT_SUB_IMAGE:
+            return rsvg_new_group(arena);
+        case RSVG_ELEMENT_TEXT:
+            return rsvg_new_text(arena);
+        case RSVG_ELEMENT_TSPAN:
+            return rsvg_new_tspan(arena);
+        default:
+            /* Whenever we encounter a node we don't understand, represent it as a defs.
+             * This is like a group, but it doesn't do any rendering of children.  The
+             * effect is that we will ignore all children of unknown elements.
+             */
+            return rsvg_new_defs(arena);
     }
+}
+
+static void rsvg_standard_element_start(RsvgHandle* ctx,
+                                        const char* name,
+                                        RsvgElementAtom atom,
+                                        RsvgPropertyBag* atts) {
+    RsvgNode* newnode;
+
+    newnode = rsvg_new_node_for_element(ctx->priv->arena, atom);
 
     if (newnode) {
         g_assert(RSVG_NODE_TYPE(newnode) != RSVG_NODE_TYPE_INVALID);
-        newnode->name = g_strdup(name);
+        newnode->atom = atom;
+        if (atom != RSVG_ELEMENT_UNKNOWN)
+            newnode->name = rsvg_element_atom_to_string(atom);
+        else
+            newnode->name = rsvg_arena_strdup(ctx->priv->arena, name);
         newnode->parent = ctx->priv->currentnode;
 
         if (atts) {
             const char* v;
-            if ((v = rsvg_property_bag_lookup(atts, "id")))
-                newnode->id = g_strdup(v);
-            if ((v = rsvg_property_bag_lookup(atts, "class")))
-                newnode->klass = g_strdup(v);
-            if ((v = rsvg_property_bag_lookup(atts, "style")))
-                newnode->style_attr = g_strdup(v);
+            if ((v = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
+                newnode->id = rsvg_interner_intern(ctx->priv->interner, v);
+            if ((v = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
+                newnode->klass = rsvg_interner_intern(ctx->priv->interner, v);
+            if ((v = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STYLE)))
+                newnode->style_attr = rsvg_interner_intern(ctx->priv->interner, v);
             newnode->has_style_info = 1;
         }
 
         rsvg_node_set_atts(newnode, ctx, atts);
         rsvg_defs_register_memory(ctx->priv->defs, newnode);
         if (ctx->priv->currentnode) {
+            /* text after a tspan starts a new chunk */
+            if (RSVG_NODE_TYPE(newnode) == RSVG_NODE_TYPE_TSPAN && ctx->priv->last_chars &&
+                ctx->priv->last_chars->super.parent == ctx->priv->currentnode)
+                ctx->priv->last_chars = NULL;
+
             rsvg_node_group_pack(ctx->priv->currentnode, newnode);
             ctx->priv->currentnode = newnode;
         }
@@ -340,15 +357,7 @@ static void rsvg_extra_handler_characters(RsvgSaxHandler* self, const char* ch,
     if (!ch || !len)
         return;
 
-    if (!g_utf8_validate((char*)ch, len, NULL)) {
-        char* utf8;
-        utf8 = rsvg_make_valid_utf8((char*)ch, len);
-        g_string_append(z->string, utf8);
-        g_free(utf8);
-    }
-    else {
-        g_string_append_len(z->string, (char*)ch, len);
-    }
+    rsvg_string_append_valid_utf8(z->string, ch, len);
 }
 
 static void rsvg_extra_handler_start(RsvgSaxHandler* self, const char* name, RsvgPropertyBag* atts) {
@@ -454,6 +463,51 @@ static void rsvg_start_metadata(RsvgHandle* ctx) {
 
 /* end metadata */
 
+/* skipped subtrees (RSVG_HANDLE_FLAG_RENDER_ONLY) */
+
+static void rsvg_skip_handler_free(RsvgSaxHandler* self) {
+    (void)self;
+}
+
+static void rsvg_skip_handler_characters(RsvgSaxHandler* self, const char* ch, int len) {
+    (void)self;
+    (void)ch;
+    (void)len;
+}
+
+/* Stateless, so a single instance serves every handle.  Nested elements
+ * only bump handler_nest; the handler is dropped again when the element it
+ * was started for ends.
+ */
+static RsvgSaxHandler rsvg_skip_handler = {
+    rsvg_skip_handler_free,
+    NULL,
+    NULL,
+    rsvg_skip_handler_characters,
+};
+
+static gboolean rsvg_element_is_skipped(RsvgHandle* ctx, RsvgElementAtom atom, gboolean prefixed) {
+    if ((ctx->priv->flags & RSVG_HANDLE_FLAG_RENDER_ONLY) == 0)
+        return FALSE;
+
+    switch (atom) {
+        case RSVG_ELEMENT_TITLE:
+        case RSVG_ELEMENT_DESC:
+        case RSVG_ELEMENT_METADATA:
+            return TRUE;
+        case RSVG_ELEMENT_UNKNOWN:
+            /* Editor and RDF elements come with a prefix.  Unprefixed unknown
+             * elements keep their node, since <switch> counts them and their
+             * children can still be referenced.
+             */
+            return prefixed;
+        default:
+            return FALSE;
+    }
+}
+
+/* end skipped subtrees */
+
 /* start xinclude */
 
 typedef struct _RsvgSaxHandlerXinclude {
@@ -488,7 +542,7 @@ static void rsvg_xinclude_handler_start(RsvgSaxHandler* self, const char* name,
             if (!strcmp(name, "xi:include"))
                 rsvg_start_xinclude(z->ctx, atts);
             else
-                rsvg_standard_element_start(z->ctx, (const char*)name, atts);
+                rsvg_standard_element_start(z->ctx, name, rsvg_element_atom_lookup(name), atts);
         }
         else if (!strcmp(name, "xi:fallback")) {
             z->in_fallback = TRUE;
@@ -573,9 +627,12 @@ static gboolean loading_limits_exceeded(RsvgHandle* handle) {
 }
 
 static void rsvg_start_element(void* data, const xmlChar* name, const xmlChar** atts) {
-    RsvgPropertyBag* bag;
+    RsvgPropertyBag bag;
     RsvgHandle* ctx = (RsvgHandle*)data;
 
+    if (ctx->priv->cache_writer)
+        rsvg_cache_writer_start_element(ctx->priv->cache_writer, (const char*)name, (const char**)atts);
+
     /* In a different way from librsvg 2.42, we do the following check here, not
      * in rsvg_standard_element_start() as it is done there.  This is because
      * librsvg 2.40 still creates nodes for <title> and <metadata> elements, and
@@ -590,37 +647,61 @@ static void rsvg_start_element(void* data, const xmlChar* name, const xmlChar**
 
     ctx->priv->num_loaded_elements += 1;
 
-    bag = rsvg_property_bag_new((const char**)atts);
-
     if (ctx->priv->handler) {
         ctx->priv->handler_nest++;
-        if (ctx->priv->handler->start_element != NULL)
-            ctx->priv->handler->start_element(ctx->priv->handler, (const char*)name, bag);
+        if (ctx->priv->handler->start_element != NULL) {
+            rsvg_property_bag_init(&bag, (const char**)atts);
+            ctx->priv->handler->start_element(ctx->priv->handler, (const char*)name, &bag);
+            rsvg_property_bag_clear(&bag);
+        }
     }
     else {
+        const xmlChar* qname = name;
         const char* tempname;
+        RsvgElementAtom atom;
+
         for (tempname = (const char*)name; *tempname != '\0'; tempname++)
             if (*tempname == ':')
                 name = (const xmlChar*)(tempname + 1);
 
-        if (!strcmp((const char*)name, "style"))
-            rsvg_start_style(ctx, bag);
-        else if (!strcmp((const char*)name, "title"))
-            rsvg_start_title(ctx);
-        else if (!strcmp((const char*)name, "desc"))
-            rsvg_start_desc(ctx);
-        else if (!strcmp((const char*)name, "metadata"))
-            rsvg_start_metadata(ctx);
-        else
-            rsvg_standard_element_start(ctx, (const char*)name, bag);
-    }
+        atom = rsvg_element_atom_lookup_len((const char*)name, tempname - (const char*)name);
 
-    rsvg_property_bag_free(bag);
+        /* skipped before even the attributes are looked at */
+        if (rsvg_element_is_skipped(ctx, atom, name != qname)) {
+            ctx->priv->handler = &rsvg_skip_handler;
+            return;
+        }
+
+        rsvg_property_bag_init(&bag, (const char**)atts);
+
+        switch (atom) {
+            case RSVG_ELEMENT_STYLE:
+                rsvg_start_style(ctx, &bag);
+                break;
+            case RSVG_ELEMENT_TITLE:
+                rsvg_start_title(ctx);
+                break;
+            case RSVG_ELEMENT_DESC:
+                rsvg_start_desc(ctx);
+                break;
+            case RSVG_ELEMENT_METADATA:
+                rsvg_start_metadata(ctx);
+                break;
+            default:
+                rsvg_standard_element_start(ctx, (const char*)name, atom, &bag);
+                break;
+        }
+
+        rsvg_property_bag_clear(&bag);
+    }
 }
 
 static void rsvg_end_element(void* data, const xmlChar* name) {
     RsvgHandle* ctx = (RsvgHandle*)data;
 
+    if (ctx->priv->cache_writer)
+        rsvg_cache_writer_end_element(ctx->priv->cache_writer, (const char*)name);
+
     if (ctx->priv->handler_nest > 0 && ctx->priv->handler != NULL) {
         if (ctx->priv->handler->end_element != NULL)
             ctx->priv->handler->end_element(ctx->priv->handler, (const char*)name);
@@ -628,20 +709,28 @@ static void rsvg_end_element(void* data, const xmlChar* name) {
     }
     else {
         const char* tempname;
+        RsvgNode* current;
+        RsvgElementAtom atom;
+
         for (tempname = (const char*)name; *tempname != '\0'; tempname++)
             if (*tempname == ':')
                 name = (const xmlChar*)(tempname + 1);
 
+        atom = rsvg_element_atom_lookup_len((const char*)name, tempname - (const char*)name);
+
         if (ctx->priv->handler != NULL) {
             ctx->priv->handler->free(ctx->priv->handler);
             ctx->priv->handler = NULL;
         }
 
-        if (ctx->priv->currentnode && !strcmp((const char*)name, ctx->priv->currentnode->name))
+        /* Known elements compare by atom; only unknown ones need their names compared */
+        current = ctx->priv->currentnode;
+        if (current && current->atom == atom &&
+            (atom != RSVG_ELEMENT_UNKNOWN || !strcmp((const char*)name, current->name)))
             rsvg_pop_def_group(ctx);
 
         /* FIXMEchpe: shouldn't this check that currentnode == treebase or sth like that? */
-        if (ctx->priv->treebase && !strcmp((const char*)name, "svg"))
+        if (ctx->priv->treebase && atom == RSVG_ELEMENT_SVG)
             _rsvg_node_svg_apply_atts((RsvgNodeSvg*)ctx->priv->treebase, ctx);
     }
 }
@@ -652,21 +741,14 @@ static void _rsvg_node_chars_free(RsvgNode* node) {
     _rsvg_node_free(node);
 }
 
-static RsvgNodeChars* rsvg_new_node_chars(const char* text, int len) {
+static RsvgNodeChars* rsvg_new_node_chars(RsvgArena* arena, const char* text, int len) {
     RsvgNodeChars* self;
 
-    self = g_new(RsvgNodeChars, 1);
+    self = RSVG_ARENA_NEW(arena, RsvgNodeChars);
     _rsvg_node_init(&self->super, RSVG_NODE_TYPE_CHARS);
 
-    if (!g_utf8_validate(text, len, NULL)) {
-        char* utf8;
-        utf8 = rsvg_make_valid_utf8(text, len);
-        self->contents = g_string_new(utf8);
-        g_free(utf8);
-    }
-    else {
-        self->contents = g_string_new_len(text, len);
-    }
+    self->contents = g_string_sized_new(len);
+    rsvg_string_append_valid_utf8(self->contents, text, len);
 
     self->super.free = _rsvg_node_chars_free;
     self->super.state->cond_true = FALSE;
@@ -674,56 +756,73 @@ static RsvgNodeChars* rsvg_new_node_chars(const char* text, int len) {
     return self;
 }
 
+/* Finds the last CHARS node in a text or tspan node that is not followed by a
+ * tspan.  Only needed when character data resumes in an element after one of
+ * its non-tspan children was closed; the handle remembers the common case.
+ */
+static RsvgNodeChars* rsvg_find_last_chars(RsvgNode* node) {
+    guint i;
+
+    for (i = node->children->len; i > 0; i--) {
+        RsvgNode* child = g_ptr_array_index(node->children, i - 1);
+
+        if (RSVG_NODE_TYPE(child) == RSVG_NODE_TYPE_CHARS)
+            return (RsvgNodeChars*)child;
+        else if (RSVG_NODE_TYPE(child) == RSVG_NODE_TYPE_TSPAN)
+            return NULL;
+    }
+
+    return NULL;
+}
+
 static void rsvg_characters_impl(RsvgHandle* ctx, const xmlChar* ch, int len) {
+    RsvgNode* current = ctx->priv->currentnode;
     RsvgNodeChars* self;
 
     if (!ch || !len)
         return;
 
-    if (ctx->priv->currentnode) {
-        RsvgNodeType type = RSVG_NODE_TYPE(ctx->priv->currentnode);
+    /* only text and tspan elements ever render their character data */
+    if ((ctx->priv->flags & RSVG_HANDLE_FLAG_RENDER_ONLY) != 0 &&
+        (current == NULL ||
+         (RSVG_NODE_TYPE(current) != RSVG_NODE_TYPE_TEXT && RSVG_NODE_TYPE(current) != RSVG_NODE_TYPE_TSPAN)))
+        return;
+
+    if (current) {
+        RsvgNodeType type = RSVG_NODE_TYPE(current);
         if (type == RSVG_NODE_TYPE_TSPAN || type == RSVG_NODE_TYPE_TEXT) {
-            guint i;
-
-            /* find the last CHARS node in the text or tspan node, so that we
-               can coalesce the text, and thus avoid screwing up the Pango layouts */
-            self = NULL;
-            for (i = 0; i < ctx->priv->currentnode->children->len; i++) {
-                RsvgNode* node = g_ptr_array_index(ctx->priv->currentnode->children, i);
-                if (RSVG_NODE_TYPE(node) == RSVG_NODE_TYPE_CHARS) {
-                    self = (RsvgNodeChars*)node;
-                }
-                else if (RSVG_NODE_TYPE(node) == RSVG_NODE_TYPE_TSPAN) {
-                    self = NULL;
-                }
-            }
+            /* coalesce with the last CHARS node in the text or tspan node,
+               and thus avoid screwing up the Pango layouts */
+            self = ctx->priv->last_chars;
+            if (self == NULL || self->super.parent != current)
+                self = rsvg_find_last_chars(current);
 
             if (self != NULL) {
-                if (!g_utf8_validate((char*)ch, len, NULL)) {
-                    char* utf8;
-                    utf8 = rsvg_make_valid_utf8((char*)ch, len);
-                    g_string_append(self->contents, utf8);
-                    g_free(utf8);
-                }
-                else {
-                    g_string_append_len(self->contents, (char*)ch, len);
-                }
-
+                rsvg_string_append_valid_utf8(self->contents, (const char*)ch, len);
+                ctx->priv->last_chars = self;
                 return;
             }
         }
     }
 
-    self = rsvg_new_node_chars((char*)ch, len);
+    self = rsvg_new_node_chars(ctx->priv->arena, (char*)ch, len);
 
     rsvg_defs_register_memory(ctx->priv->defs, (RsvgNode*)self);
-    if (ctx->priv->currentnode)
-        rsvg_node_group_pack(ctx->priv->currentnode, (RsvgNode*)self);
+    if (current) {
+        RsvgNodeType type = RSVG_NODE_TYPE(current);
+
+        rsvg_node_group_pack(current, (RsvgNode*)self);
+        if (type == RSVG_NODE_TYPE_TSPAN || type == RSVG_NODE_TYPE_TEXT)
+            ctx->priv->last_chars = self;
+    }
 }
 
 static void rsvg_characters(void* data, const xmlChar* ch, int len) {
     RsvgHandle* ctx = (RsvgHandle*)data;
 
+    if (ctx->priv->cache_writer)
+        rsvg_cache_writer_characters(ctx->priv->cache_writer, (const char*)ch, len);
+
     if (ctx->priv->handler && ctx->priv->handler->characters != NULL) {
         ctx->priv->handler->characters(ctx->priv->handler, (const char*)ch, len);
         return;
@@ -827,8 +926,11 @@ static void rsvg_processing_instruction(void* ctx, const xmlChar* target, const
     /* http://www.w3.org/TR/xml-stylesheet/ */
     RsvgHandle* handle = (RsvgHandle*)ctx;
 
+    if (handle->priv->cache_writer)
+        rsvg_cache_writer_processing_instruction(handle->priv->cache_writer, (const char*)target, (const char*)data);
+
     if (!strcmp((const char*)target, "xml-stylesheet")) {
-        RsvgPropertyBag* atts;
+        RsvgPropertyBag atts;
         char** xml_atts;
 
         xml_atts = rsvg_css_parse_xml_attribute_string((const char*)data);
@@ -836,29 +938,32 @@ static void rsvg_processing_instruction(void* ctx, const xmlChar* target, const
         if (xml_atts) {
             const char* value;
 
-            atts = rsvg_property_bag_new((const char**)xml_atts);
-            value = rsvg_property_bag_lookup(atts, "alternate");
+            rsvg_property_bag_init(&atts, (const char**)xml_atts);
+            value = rsvg_property_bag_lookup_atom(&atts, RSVG_ATTRIBUTE_ALTERNATE);
             if (!value || !value[0] || (strcmp(value, "no") != 0)) {
-                value = rsvg_property_bag_lookup(atts, "type");
+                value = rsvg_property_bag_lookup_atom(&atts, RSVG_ATTRIBUTE_TYPE);
                 if (value && strcmp(value, "text/css") == 0) {
-                    value = rsvg_property_bag_lookup(atts, "href");
+                    value = rsvg_property_bag_lookup_atom(&atts, RSVG_ATTRIBUTE_HREF);
                     if (value && value[0]) {
-                        char* style_data;
-                        gsize style_data_len;
+                        GBytes* style_data;
                         char* mime_type = NULL;
 
-                        style_data = _rsvg_handle_acquire_data(handle, value, &mime_type, &style_data_len, NULL);
+                        style_data = _rsvg_handle_acquire_data(handle, value, &mime_type, NULL);
                         if (style_data && mime_type && strcmp(mime_type, "text/css") == 0) {
-                            rsvg_parse_cssbuffer(handle, style_data, style_data_len);
+                            gsize style_data_len;
+                            const char* css = g_bytes_get_data(style_data, &style_data_len);
+
+                            rsvg_parse_cssbuffer(handle, css, style_data_len);
                         }
 
                         g_free(mime_type);
-                        g_free(style_data);
+                        if (style_data)
+                            g_bytes_unref(style_data);
                     }
                 }
             }
 
-            rsvg_property_bag_free(atts);
+            rsvg_property_bag_clear(&atts);
             g_strfreev(xml_atts);
         }
     }
@@ -952,51 +1057,118 @@ void rsvg_handle_set_base_uri(RsvgHandle* handle, const char* base_uri) {
     rsvg_handle_set_base_gfile(handle, file);
 }
 
-static void rsvg_node_snapshot_base_state_recursive(RsvgNode* node) {
+/* Trees with fewer nodes than this are restyled on the calling thread,
+ * unless rsvg_handle_set_style_threads() asks for more threads
+ */
+#define RSVG_RESTYLE_PARALLEL_NODES 4096
+#define RSVG_RESTYLE_MAX_THREADS 8
+/* Nodes are claimed this many at a time; consecutive nodes in document
+ * order mostly make up whole subtrees
+ */
+#define RSVG_RESTYLE_BATCH_SIZE 64
+
+typedef struct {
+    RsvgHandle* ctx;
+    GPtrArray* nodes; /* the whole tree, in document order */
+    gint next; /* first unclaimed node */
+} RsvgRestyleJob;
+
+static void rsvg_collect_nodes_recursive(RsvgNode* node, GPtrArray* nodes) {
     guint i;
 
     if (!node)
         return;
 
-    if (!node->base_state) {
-        node->base_state = g_new(RsvgState, 1);
-        rsvg_state_init(node->base_state);
-        rsvg_state_clone(node->base_state, node->state);
-    }
+    g_ptr_array_add(nodes, node);
 
     if (node->children) {
         for (i = 0; i < node->children->len; i++) {
             RsvgNode* child = g_ptr_array_index(node->children, i);
-            rsvg_node_snapshot_base_state_recursive(child);
+            rsvg_collect_nodes_recursive(child, nodes);
         }
     }
 }
 
+/* Restyling a node only reads the node itself and the stylesheet, so any
+ * number of nodes can be restyled at once.
+ */
 static void rsvg_apply_styles_to_node(RsvgHandle* ctx, RsvgNode* node) {
     if (!node->state)
         return;
 
-    if (node->base_state) {
-        rsvg_state_clone(node->state, node->base_state);
+    /* the state the node had before any stylesheet was set from outside */
+    if (!node->base_state) {
+        node->base_state = g_new(RsvgState, 1);
+        rsvg_state_init(node->base_state);
+        rsvg_state_clone(node->base_state, node->state);
     }
 
+    rsvg_state_clone(node->state, node->base_state);
+    rsvg_state_clear_computed(node);
+
     rsvg_css_engine_apply_styles(ctx->priv->css_engine, node, node->state, node->name, node->klass, node->id, NULL);
 }
 
-static void rsvg_apply_styles_recursive(RsvgHandle* ctx, RsvgNode* node) {
-    guint i;
+static gpointer rsvg_restyle_worker_run(gpointer data) {
+    RsvgRestyleJob* job = data;
+    guint n_nodes = job->nodes->len;
 
-    if (!node)
-        return;
+    for (;;) {
+        guint start = (guint)g_atomic_int_add(&job->next, RSVG_RESTYLE_BATCH_SIZE);
+        guint end, i;
 
-    rsvg_apply_styles_to_node(ctx, node);
+        if (start >= n_nodes)
+            break;
 
-    if (node->children) {
-        for (i = 0; i < node->children->len; i++) {
-            RsvgNode* child = g_ptr_array_index(node->children, i);
-            rsvg_apply_styles_recursive(ctx, child);
-        }
+        end = MIN(start + RSVG_RESTYLE_BATCH_SIZE, n_nodes);
+        for (i = start; i < end; i++)
+            rsvg_apply_styles_to_node(job->ctx, g_ptr_array_index(job->nodes, i));
     }
+
+    return NULL;
+}
+
+static guint rsvg_restyle_get_n_threads(RsvgHandle* ctx, guint n_nodes) {
+    guint n_threads = ctx->priv->style_threads;
+
+    if (n_threads == 0) {
+        if (n_nodes < RSVG_RESTYLE_PARALLEL_NODES)
+            return 1;
+        n_threads = g_get_num_processors();
+    }
+
+    return CLAMP(n_threads, 1, RSVG_RESTYLE_MAX_THREADS);
+}
+
+static void rsvg_apply_styles_to_tree(RsvgHandle* ctx, RsvgNode* treebase) {
+    GThread* threads[RSVG_RESTYLE_MAX_THREADS];
+    RsvgRestyleJob job;
+    guint n_threads, i;
+
+    job.ctx = ctx;
+    job.nodes = g_ptr_array_new();
+    job.next = 0;
+    rsvg_collect_nodes_recursive(treebase, job.nodes);
+
+    n_threads = rsvg_restyle_get_n_threads(ctx, job.nodes->len);
+    if (n_threads > 1)
+        rsvg_css_engine_set_concurrent(ctx->priv->css_engine, TRUE);
+
+    /* the calling thread is the first worker */
+    for (i = 1; i < n_threads; i++) {
+        threads[i] = g_thread_try_new("rsvg-restyle", rsvg_restyle_worker_run, &job, NULL);
+        if (threads[i] == NULL)
+            break;
+    }
+    n_threads = i;
+
+    rsvg_restyle_worker_run(&job);
+
+    for (i = 1; i < n_threads; i++)
+        g_thread_join(threads[i]);
+
+    rsvg_css_engine_set_concurrent(ctx->priv->css_engine, FALSE);
+    g_ptr_array_free(job.nodes, TRUE);
 }
 
 /**
@@ -1008,6 +1180,9 @@ static void rsvg_apply_styles_recursive(RsvgHandle* ctx, RsvgNode* node) {
  *
  * Sets a CSS stylesheet to use for an SVG document.
  *
+ * Large documents are restyled on several threads; see
+ * rsvg_handle_set_style_threads().
+ *
  * Returns: %TRUE on success, or %FALSE on error.
  *
  * Since: 2.48
@@ -1019,14 +1194,55 @@ gboolean rsvg_handle_set_stylesheet(RsvgHandle* handle, const guint8* css, gsize
 
     rsvg_parse_cssbuffer(handle, (const char*)css, (size_t)css_len);
 
-    if (handle->priv->treebase) {
-        rsvg_node_snapshot_base_state_recursive(handle->priv->treebase);
-        rsvg_apply_styles_recursive(handle, handle->priv->treebase);
-    }
+    if (handle->priv->treebase)
+        rsvg_apply_styles_to_tree(handle, handle->priv->treebase);
 
     return TRUE;
 }
 
+/**
+ * rsvg_handle_set_style_threads:
+ * @handle: A #RsvgHandle
+ * @n_threads: the number of threads, or 0 to pick them automatically
+ *
+ * Sets how many threads rsvg_handle_set_stylesheet() restyles the document
+ * with.  With 1, it is restyled on the calling thread.  With 0, the
+ * default, small documents are restyled on the calling thread and large
+ * ones on one thread per processor.  There are never more than 8.
+ *
+ * Since: 2.52
+ */
+void rsvg_handle_set_style_threads(RsvgHandle* handle, guint n_threads) {
+    g_return_if_fail(RSVG_IS_HANDLE(handle));
+
+    handle->priv->style_threads = MIN(n_threads, RSVG_RESTYLE_MAX_THREADS);
+}
+
+/**
+ * rsvg_handle_get_style_share_stats:
+ * @handle: A #RsvgHandle
+ * @hits: (out) (optional): where to store how many elements took their style from another one
+ * @misses: (out) (optional): where to store how many elements had their style computed
+ *
+ * Returns how often elements of @handle could share a style computed for
+ * an earlier element with the same tag, class and style attributes while
+ * the document loaded.  Elements that cannot share styles are not counted.
+ *
+ * Since: 2.52
+ */
+void rsvg_handle_get_style_share_stats(RsvgHandle* handle, guint64* hits, guint64* misses) {
+    guint n_hits, n_misses;
+
+    g_return_if_fail(RSVG_IS_HANDLE(handle));
+
+    rsvg_css_engine_get_share_stats(handle->priv->css_engine, &n_hits, &n_misses);
+
+    if (hits)
+        *hits = n_hits;
+    if (misses)
+        *misses = n_misses;
+}
+
 /**
  * rsvg_handle_set_base_gfile:
  * @handle: a #RsvgHandle
@@ -1124,6 +1340,7 @@ static gboolean rsvg_handle_close_impl(RsvgHandle* handle, GError** error) {
         int result;
 
         result = xmlParseChunk(handle->priv->ctxt, "", 0, TRUE);
+        rsvg_handle_finish_prefetch(handle);
         if (result != 0) {
             if (real_error != NULL)
                 g_propagate_error(error, real_error);
@@ -1143,6 +1360,8 @@ static gboolean rsvg_handle_close_impl(RsvgHandle* handle, GError** error) {
         return FALSE;
     }
 
+    rsvg_geometry_queue_compile(handle->priv->geometry, handle->priv->arena);
+
     return TRUE;
 }
 
@@ -1152,7 +1371,7 @@ void rsvg_drawing_ctx_free(RsvgDrawingCtx* handle) {
 
     rsvg_render_free(handle->render);
 
-    rsvg_state_free_all(handle->state);
+    rsvg_state_free_all(handle);
 
     /* the drawsub stack's nodes are owned by the ->defs */
     g_slist_free(handle->drawsub_stack);
@@ -1229,6 +1448,17 @@ const char* rsvg_handle_get_desc(RsvgHandle* handle) {
         return NULL;
 }
 
+/* The rsvg_handle_get_dimensions() calls in progress on a thread, innermost
+ * first.  Keeping them on the thread rather than flagging the handle lets
+ * several threads ask for the size of one handle at once.
+ */
+typedef struct _RsvgDimensionsCall {
+    RsvgHandle* handle;
+    struct _RsvgDimensionsCall* outer;
+} RsvgDimensionsCall;
+
+static GPrivate rsvg_dimensions_calls;
+
 /**
  * rsvg_handle_get_dimensions:
  * @handle: A #RsvgHandle
@@ -1239,19 +1469,26 @@ const char* rsvg_handle_get_desc(RsvgHandle* handle) {
  * Since: 2.14
  */
 void rsvg_handle_get_dimensions(RsvgHandle* handle, RsvgDimensionData* dimension_data) {
+    RsvgDimensionsCall call, *outer, *c;
+
     /* This function is probably called from the cairo_render functions.
-     * To prevent an infinite loop we are saving the state.
+     * To prevent an infinite loop we remember which handles are being sized.
      */
-    if (!handle->priv->in_loop) {
-        handle->priv->in_loop = TRUE;
-        rsvg_handle_get_dimensions_sub(handle, dimension_data, NULL);
-        handle->priv->in_loop = FALSE;
-    }
-    else {
-        /* Called within the size function, so return a standard size */
-        dimension_data->em = dimension_data->width = 1;
-        dimension_data->ex = dimension_data->height = 1;
+    outer = g_private_get(&rsvg_dimensions_calls);
+    for (c = outer; c != NULL; c = c->outer) {
+        if (c->handle == handle) {
+            /* Called within the size function, so return a standard size */
+            dimension_data->em = dimension_data->width = 1;
+            dimension_data->ex = dimension_data->height = 1;
+            return;
+        }
     }
+
+    call.handle = handle;
+    call.outer = outer;
+    g_private_set(&rsvg_dimensions_calls, &call);
+    rsvg_handle_get_dimensions_sub(handle, dimension_data, NULL);
+    g_private_set(&rsvg_dimensions_calls, outer);
 }
 
 /**
@@ -1742,22 +1979,122 @@ void rsvg_handle_set_size_callback(RsvgHandle* handle,
     handle->priv->user_data_destroy = user_data_destroy;
 }
 
-#define GZ_MAGIC_0 ((guchar)0x1f)
-#define GZ_MAGIC_1 ((guchar)0x8b)
-
-/* Creates handle->priv->compressed_input_stream and adds the gzip header data
+/* Creates handle->priv->compressed_data and adds the gzip header data
  * to it.  We implicitly consume the header data from the caller in
  * rsvg_handle_write(); that's why we add it back here.
  */
-static void create_compressed_input_stream(RsvgHandle* handle) {
+static void create_compressed_buffer(RsvgHandle* handle) {
+    RsvgHandlePrivate* priv = handle->priv;
+
+    static const guchar gz_magic[2] = {RSVG_GZIP_MAGIC_0, RSVG_GZIP_MAGIC_1};
+
+    g_assert(priv->compressed_data == NULL);
+
+    priv->compressed_data = g_byte_array_new();
+    g_byte_array_append(priv->compressed_data, gz_magic, 2);
+}
+
+/* Parses svgz data that was written to the handle and is all in memory.
+ * Unless the document is huge it is inflated in one go into a buffer sized
+ * from the gzip trailer and handed to the parser like uncompressed data;
+ * otherwise it is parsed as a stream.
+ */
+static gboolean rsvg_handle_close_compressed(RsvgHandle* handle, GError** error) {
     RsvgHandlePrivate* priv = handle->priv;
+    GByteArray* compressed = priv->compressed_data;
+    GError* inflate_error = NULL;
+    GBytes* inflated;
+    gboolean ret;
+
+    priv->compressed_data = NULL;
+
+    inflated = rsvg_gzip_inflate(compressed->data, compressed->len, RSVG_GZIP_MAX_INFLATE_SIZE, &inflate_error);
+    if (inflated == NULL && inflate_error == NULL) {
+        g_autoptr(GBytes) bytes = g_byte_array_free_to_bytes(compressed);
+        g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(bytes);
+
+        priv->state = RSVG_HANDLE_STATE_START;
+        return rsvg_handle_read_stream_sync(handle, stream, NULL, error);
+    }
+
+    g_byte_array_free(compressed, TRUE);
+
+    if (inflated == NULL) {
+        priv->state = RSVG_HANDLE_STATE_CLOSED_ERROR;
+        g_propagate_error(error, inflate_error);
+        return FALSE;
+    }
+
+    priv->state = RSVG_HANDLE_STATE_READING;
+    ret = rsvg_handle_write_impl(handle, g_bytes_get_data(inflated, NULL), g_bytes_get_size(inflated), error);
+    g_bytes_unref(inflated);
+
+    if (!ret) {
+        /* the state is already CLOSED_ERROR; this only frees the parser */
+        (void)rsvg_handle_close_impl(handle, NULL);
+        return FALSE;
+    }
+
+    ret = rsvg_handle_close_impl(handle, error);
+    priv->state = ret ? RSVG_HANDLE_STATE_CLOSED_OK : RSVG_HANDLE_STATE_CLOSED_ERROR;
 
-    static const guchar gz_magic[2] = {GZ_MAGIC_0, GZ_MAGIC_1};
+    return ret;
+}
+
+/* Wraps @buffered_stream, which starts with the gzip magic, in a stream that
+ * decompresses it.  A small compressed stream is read whole and inflated in
+ * one go; a larger one is decompressed on a helper thread while the parser
+ * consumes it.
+ */
+static GInputStream* create_decompressing_stream(GInputStream* buffered_stream,
+                                                 GCancellable* cancellable,
+                                                 GError** error) {
+    GBufferedInputStream* buffered = G_BUFFERED_INPUT_STREAM(buffered_stream);
+    gboolean at_eof = FALSE;
+    gsize available;
+
+    g_buffered_input_stream_set_buffer_size(buffered, RSVG_GZIP_PEEK_SIZE);
+    while ((available = g_buffered_input_stream_get_available(buffered)) < RSVG_GZIP_PEEK_SIZE) {
+        gssize num_read = g_buffered_input_stream_fill(buffered, -1, cancellable, error);
+
+        if (num_read < 0)
+            return NULL;
+        if (num_read == 0) {
+            at_eof = TRUE;
+            break;
+        }
+    }
+
+    if (at_eof) {
+        const guint8* data = g_buffered_input_stream_peek_buffer(buffered, &available);
+        GError* inflate_error = NULL;
+        g_autoptr(GBytes) inflated = rsvg_gzip_inflate(data, available, RSVG_GZIP_MAX_INFLATE_SIZE, &inflate_error);
 
-    g_assert(priv->compressed_input_stream == NULL);
+        if (inflated != NULL)
+            return g_memory_input_stream_new_from_bytes(inflated);
 
-    priv->compressed_input_stream = g_memory_input_stream_new();
-    g_memory_input_stream_add_data(G_MEMORY_INPUT_STREAM(priv->compressed_input_stream), gz_magic, 2, NULL);
+        if (inflate_error != NULL) {
+            g_propagate_error(error, inflate_error);
+            return NULL;
+        }
+    }
+
+    return rsvg_gzip_input_stream_new(buffered_stream, cancellable);
+}
+
+/* Starts recording what rsvg_handle_save_cache() needs, if asked to.
+ * Returns whether recording started just now.
+ */
+static gboolean rsvg_handle_begin_cache(RsvgHandle* handle) {
+    RsvgHandlePrivate* priv = handle->priv;
+
+    if ((priv->flags & RSVG_HANDLE_FLAG_CACHEABLE) == 0 || priv->cache_writer != NULL)
+        return FALSE;
+
+    priv->cache_writer = rsvg_cache_writer_new();
+    rsvg_geometry_queue_record(priv->geometry);
+
+    return TRUE;
 }
 
 /**
@@ -1786,10 +2123,15 @@ gboolean rsvg_handle_write(RsvgHandle* handle, const guchar* buf, gsize count, G
                                 priv->state == RSVG_HANDLE_STATE_READING,
                             FALSE, error);
 
+    if (priv->state == RSVG_HANDLE_STATE_START)
+        (void)rsvg_handle_begin_cache(handle);
+    if (priv->cache_writer)
+        rsvg_cache_writer_add_source(priv->cache_writer, buf, count);
+
     while (count > 0) {
         switch (priv->state) {
             case RSVG_HANDLE_STATE_START:
-                if (buf[0] == GZ_MAGIC_0) {
+                if (buf[0] == RSVG_GZIP_MAGIC_0) {
                     priv->state = RSVG_HANDLE_STATE_EXPECTING_GZ_1;
                     buf++;
                     count--;
@@ -1802,9 +2144,9 @@ gboolean rsvg_handle_write(RsvgHandle* handle, const guchar* buf, gsize count, G
                 break;
 
             case RSVG_HANDLE_STATE_EXPECTING_GZ_1:
-                if (buf[0] == GZ_MAGIC_1) {
+                if (buf[0] == RSVG_GZIP_MAGIC_1) {
                     priv->state = RSVG_HANDLE_STATE_READING_COMPRESSED;
-                    create_compressed_input_stream(handle);
+                    create_compressed_buffer(handle);
                     buf++;
                     count--;
                 }
@@ -1816,8 +2158,7 @@ gboolean rsvg_handle_write(RsvgHandle* handle, const guchar* buf, gsize count, G
                 break;
 
             case RSVG_HANDLE_STATE_READING_COMPRESSED:
-                g_memory_input_stream_add_data(G_MEMORY_INPUT_STREAM(priv->compressed_input_stream),
-                                               g_memdup2(buf, count), count, (GDestroyNotify)g_free);
+                g_byte_array_append(priv->compressed_data, buf, count);
                 return TRUE;
 
             case RSVG_HANDLE_STATE_READING:
@@ -1840,6 +2181,9 @@ gboolean rsvg_handle_write(RsvgHandle* handle, const guchar* buf, gsize count, G
  * return %TRUE if the loader closed successfully.  Note that @handle isn't
  * freed until @g_object_unref is called.
  *
+ * After a successful close the document is frozen and may be rendered from
+ * several threads at once; see the description of #RsvgHandle.
+ *
  * Returns: %TRUE on success, or %FALSE on error
  **/
 gboolean rsvg_handle_close(RsvgHandle* handle, GError** error) {
@@ -1860,20 +2204,11 @@ gboolean rsvg_handle_close(RsvgHandle* handle, GError** error) {
     }
 
     if (priv->state == RSVG_HANDLE_STATE_READING_COMPRESSED) {
-        gboolean ret;
-
-        /* FIXME: when using rsvg_handle_write()/rsvg_handle_close(), as opposed to using the
+        /* when using rsvg_handle_write()/rsvg_handle_close(), as opposed to using the
          * stream functions, for compressed SVGs we buffer the whole compressed file in memory
          * and *then* uncompress/parse it here.
-         *
-         * We should make it so that the incoming data is decompressed and parsed on the fly.
          */
-        priv->state = RSVG_HANDLE_STATE_START;
-        ret = rsvg_handle_read_stream_sync(handle, priv->compressed_input_stream, NULL, error);
-        g_object_unref(priv->compressed_input_stream);
-        priv->compressed_input_stream = NULL;
-
-        return ret;
+        return rsvg_handle_close_compressed(handle, error);
     }
 
     result = rsvg_handle_close_impl(handle, error);
@@ -1918,6 +2253,7 @@ gboolean rsvg_handle_read_stream_sync(RsvgHandle* handle,
     const guchar* buf;
     gssize num_read;
     g_autoptr(GInputStream) buffered_stream = NULL;
+    g_autoptr(GInputStream) source_stream = NULL;
 
     g_return_val_if_fail(RSVG_IS_HANDLE(handle), FALSE);
     g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
@@ -1928,6 +2264,18 @@ gboolean rsvg_handle_read_stream_sync(RsvgHandle* handle,
 
     g_return_val_if_fail(priv->state == RSVG_HANDLE_STATE_START, FALSE);
 
+    /* the whole source is hashed before anything is parsed; big svgz data
+     * from rsvg_handle_write() comes through here too, already hashed
+     */
+    if (rsvg_handle_begin_cache(handle)) {
+        source_stream = rsvg_cache_writer_read_stream(priv->cache_writer, stream, cancellable, error);
+        if (source_stream == NULL) {
+            priv->state = RSVG_HANDLE_STATE_CLOSED_ERROR;
+            return FALSE;
+        }
+        stream = source_stream;
+    }
+
     /* detect zipped streams */
     buffered_stream = g_buffered_input_stream_new(stream);
     num_read = g_buffered_input_stream_fill(G_BUFFERED_INPUT_STREAM(buffered_stream), 2, cancellable, error);
@@ -1941,9 +2289,13 @@ gboolean rsvg_handle_read_stream_sync(RsvgHandle* handle,
     }
 
     buf = g_buffered_input_stream_peek_buffer(G_BUFFERED_INPUT_STREAM(buffered_stream), NULL);
-    if ((buf[0] == GZ_MAGIC_0) && (buf[1] == GZ_MAGIC_1)) {
-        g_autoptr(GConverter) converter = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP));
-        GInputStream* conv_stream = g_converter_input_stream_new(buffered_stream, converter);
+    if ((buf[0] == RSVG_GZIP_MAGIC_0) && (buf[1] == RSVG_GZIP_MAGIC_1)) {
+        GInputStream* conv_stream = create_decompressing_stream(buffered_stream, cancellable, error);
+
+        if (conv_stream == NULL) {
+            priv->state = RSVG_HANDLE_STATE_CLOSED_ERROR;
+            return FALSE;
+        }
         g_clear_object(&buffered_stream);
         buffered_stream = conv_stream;
     }
@@ -1977,10 +2329,15 @@ gboolean rsvg_handle_read_stream_sync(RsvgHandle* handle,
         goto out;
     }
 
+    rsvg_geometry_queue_compile(priv->geometry, priv->arena);
+
     res = TRUE;
 
 out:
 
+    /* before the cancellable goes, since the fetches use it */
+    rsvg_handle_finish_prefetch(handle);
+
     priv->ctxt = rsvg_free_xml_parser_and_doc(priv->ctxt);
 
     priv->error = NULL;
@@ -2078,6 +2435,163 @@ RsvgHandle* rsvg_handle_new_from_stream_sync(GInputStream* input_stream,
     return handle;
 }
 
+static void rsvg_handle_read_stream_thread(GTask* task,
+                                           gpointer source_object,
+                                           gpointer task_data,
+                                           GCancellable* cancellable) {
+    GError* error = NULL;
+
+    if (rsvg_handle_read_stream_sync(source_object, task_data, cancellable, &error))
+        g_task_return_boolean(task, TRUE);
+    else
+        g_task_return_error(task, error);
+}
+
+/**
+ * rsvg_handle_read_stream_async:
+ * @handle: a #RsvgHandle
+ * @stream: a #GInputStream
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the document is loaded
+ * @user_data: the data to pass to @callback
+ *
+ * Reads @stream and writes the data from it to @handle, like
+ * rsvg_handle_read_stream_sync(), but without blocking: reading,
+ * decompressing and parsing happen on one of the threads GIO keeps for
+ * such work, a limited number shared by the whole process.  @callback is
+ * called in the thread-default main context of the caller, and should call
+ * rsvg_handle_read_stream_finish() to get the result.
+ *
+ * @handle must not be used until then.  If the operation is cancelled
+ * through @cancellable, it finishes with %G_IO_ERROR_CANCELLED.
+ *
+ * Since: 2.52
+ */
+void rsvg_handle_read_stream_async(RsvgHandle* handle,
+                                   GInputStream* stream,
+                                   GCancellable* cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data) {
+    GTask* task;
+
+    g_return_if_fail(RSVG_IS_HANDLE(handle));
+    g_return_if_fail(G_IS_INPUT_STREAM(stream));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+    g_return_if_fail(handle->priv->state == RSVG_HANDLE_STATE_START);
+
+    task = g_task_new(handle, cancellable, callback, user_data);
+    g_task_set_source_tag(task, rsvg_handle_read_stream_async);
+    g_task_set_task_data(task, g_object_ref(stream), g_object_unref);
+    g_task_run_in_thread(task, rsvg_handle_read_stream_thread);
+    g_object_unref(task);
+}
+
+/**
+ * rsvg_handle_read_stream_finish:
+ * @handle: a #RsvgHandle
+ * @result: the #GAsyncResult passed to the callback of rsvg_handle_read_stream_async()
+ * @error: (allow-none): a location to store a #GError, or %NULL
+ *
+ * Finishes loading a document with rsvg_handle_read_stream_async().
+ *
+ * Returns: %TRUE if reading the stream succeeded, or %FALSE otherwise
+ *   with @error filled in
+ *
+ * Since: 2.52
+ */
+gboolean rsvg_handle_read_stream_finish(RsvgHandle* handle, GAsyncResult* result, GError** error) {
+    g_return_val_if_fail(RSVG_IS_HANDLE(handle), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, handle), FALSE);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == rsvg_handle_read_stream_async, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+typedef struct {
+    GFile* file;
+    RsvgHandleFlags flags;
+} RsvgGFileLoad;
+
+static void rsvg_gfile_load_free(RsvgGFileLoad* load) {
+    g_object_unref(load->file);
+    g_free(load);
+}
+
+static void rsvg_handle_new_from_gfile_thread(GTask* task,
+                                              gpointer source_object,
+                                              gpointer task_data,
+                                              GCancellable* cancellable) {
+    RsvgGFileLoad* load = task_data;
+    RsvgHandle* handle;
+    GError* error = NULL;
+
+    (void)source_object;
+
+    handle = rsvg_handle_new_from_gfile_sync(load->file, load->flags, cancellable, &error);
+    if (handle != NULL)
+        g_task_return_pointer(task, handle, g_object_unref);
+    else
+        g_task_return_error(task, error);
+}
+
+/**
+ * rsvg_handle_new_from_gfile_async:
+ * @file: a #GFile
+ * @flags: flags from #RsvgHandleFlags
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the document is loaded
+ * @user_data: the data to pass to @callback
+ *
+ * Creates a new #RsvgHandle for @file, like rsvg_handle_new_from_gfile_sync(),
+ * but without blocking; see rsvg_handle_read_stream_async() for where the
+ * work happens.  @callback is called in the thread-default main context of
+ * the caller, and should call rsvg_handle_new_from_gfile_finish() to get
+ * the handle.
+ *
+ * Since: 2.52
+ */
+void rsvg_handle_new_from_gfile_async(GFile* file,
+                                      RsvgHandleFlags flags,
+                                      GCancellable* cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data) {
+    RsvgGFileLoad* load;
+    GTask* task;
+
+    g_return_if_fail(G_IS_FILE(file));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    load = g_new(RsvgGFileLoad, 1);
+    load->file = g_object_ref(file);
+    load->flags = flags;
+
+    task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, rsvg_handle_new_from_gfile_async);
+    g_task_set_task_data(task, load, (GDestroyNotify)rsvg_gfile_load_free);
+    g_task_run_in_thread(task, rsvg_handle_new_from_gfile_thread);
+    g_object_unref(task);
+}
+
+/**
+ * rsvg_handle_new_from_gfile_finish:
+ * @result: the #GAsyncResult passed to the callback of rsvg_handle_new_from_gfile_async()
+ * @error: (allow-none): a location to store a #GError, or %NULL
+ *
+ * Finishes loading a document with rsvg_handle_new_from_gfile_async().
+ *
+ * Returns: (transfer full): a new #RsvgHandle on success, or %NULL with @error filled in
+ *
+ * Since: 2.52
+ */
+RsvgHandle* rsvg_handle_new_from_gfile_finish(GAsyncResult* result, GError** error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == rsvg_handle_new_from_gfile_async, NULL);
+    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
 /**
  * _rsvg_handle_internal_set_testing:
  * @handle: a #RsvgHandle
@@ -2117,11 +2631,13 @@ void rsvg_term(void) {}
  * rsvg_cleanup:
  *
  * This function should not be called from normal programs.
- * See xmlCleanupParser() for more information.
+ * See xmlCleanupParser() for more information.  It also drops the
+ * documents in the cache set up with rsvg_set_extern_cache_size().
  *
  * Since: 2.36
  **/
 void rsvg_cleanup(void) {
+    rsvg_extern_cache_clear();
     xmlCleanupParser();
 }
 
@@ -2490,16 +3006,16 @@ char* rsvg_handle_resolve_uri(RsvgHandle* handle, const char* uri) {
     return resolved_uri;
 }
 
-char* _rsvg_handle_acquire_data(RsvgHandle* handle, const char* url, char** content_type, gsize* len, GError** error) {
+GBytes* _rsvg_handle_acquire_data(RsvgHandle* handle, const char* url, char** content_type, GError** error) {
     RsvgHandlePrivate* priv = handle->priv;
     char* uri;
-    char* data;
+    GBytes* data;
 
     uri = rsvg_handle_resolve_uri(handle, url);
 
     if (rsvg_allow_load(priv->base_gfile, uri, error)) {
-        data = _rsvg_io_acquire_data(uri, rsvg_handle_get_base_uri(handle), content_type, len,
-                                     handle->priv->cancellable, error);
+        data = _rsvg_io_acquire_data(uri, rsvg_handle_get_base_uri(handle), content_type, handle->priv->cancellable,
+                                     error);
     }
     else {
         data = NULL;
@@ -2528,6 +3044,97 @@ GInputStream* _rsvg_handle_acquire_stream(RsvgHandle* handle, const char* url, c
     return stream;
 }
 
+/* Most of what a prefetch waits for is I/O, so it may use more threads
+ * than there are processors.  The threads are shared by every handle in
+ * the process, and made the first time anything is prefetched.
+ */
+#define RSVG_PREFETCH_MAX_THREADS 8
+
+typedef struct {
+    RsvgHandle* handle;
+    RsvgPrefetchFunc func;
+    gpointer data;
+} RsvgPrefetchJob;
+
+static GMutex prefetch_pool_lock;
+static GThreadPool* prefetch_pool;
+/* set on the pool's threads */
+static GPrivate prefetch_pool_thread;
+
+static void rsvg_prefetch_job_done(RsvgHandlePrivate* priv) {
+    g_mutex_lock(&priv->prefetch_lock);
+    if (--priv->prefetch_pending == 0)
+        g_cond_broadcast(&priv->prefetch_done);
+    g_mutex_unlock(&priv->prefetch_lock);
+}
+
+static void rsvg_prefetch_run(gpointer data, gpointer user_data) {
+    RsvgPrefetchJob* job = data;
+
+    (void)user_data;
+
+    g_private_set(&prefetch_pool_thread, GINT_TO_POINTER(TRUE));
+    job->func(job->handle, job->data);
+    rsvg_prefetch_job_done(job->handle->priv);
+    g_free(job);
+}
+
+static GThreadPool* rsvg_prefetch_get_pool(void) {
+    GThreadPool* pool;
+
+    g_mutex_lock(&prefetch_pool_lock);
+    if (prefetch_pool == NULL)
+        prefetch_pool = g_thread_pool_new(rsvg_prefetch_run, NULL, RSVG_PREFETCH_MAX_THREADS, FALSE, NULL);
+    pool = prefetch_pool;
+    g_mutex_unlock(&prefetch_pool_lock);
+
+    return pool;
+}
+
+void rsvg_handle_prefetch(RsvgHandle* handle, RsvgPrefetchFunc func, gpointer data) {
+    RsvgHandlePrivate* priv = handle->priv;
+    GThreadPool* pool;
+    RsvgPrefetchJob* job;
+
+    /* a job that prefetches, like an external document loading its images,
+     * would wait on the threads it is taking up, so it fetches right away
+     */
+    if (g_private_get(&prefetch_pool_thread) != NULL || (pool = rsvg_prefetch_get_pool()) == NULL) {
+        func(handle, data);
+        return;
+    }
+
+    job = g_new(RsvgPrefetchJob, 1);
+    job->handle = handle;
+    job->func = func;
+    job->data = data;
+
+    g_mutex_lock(&priv->prefetch_lock);
+    priv->prefetch_pending++;
+    g_mutex_unlock(&priv->prefetch_lock);
+
+    if (!g_thread_pool_push(pool, job, NULL)) {
+        g_free(job);
+        func(handle, data);
+        rsvg_prefetch_job_done(priv);
+    }
+}
+
+void rsvg_handle_finish_prefetch(RsvgHandle* handle) {
+    RsvgHandlePrivate* priv = handle->priv;
+
+    /* only this handle's jobs, queued or running */
+    g_mutex_lock(&priv->prefetch_lock);
+    while (priv->prefetch_pending > 0)
+        g_cond_wait(&priv->prefetch_done, &priv->prefetch_lock);
+    g_mutex_unlock(&priv->prefetch_lock);
+}
+
+/* For diagnostics: how much memory the document tree holds in the arena */
+gsize _rsvg_handle_get_arena_size(RsvgHandle* handle) {
+    return rsvg_arena_get_size(handle->priv->arena);
+}
+
 /* Frees the ctxt and its ctxt->myDoc - libxml2 doesn't free them together
  * http://xmlsoft.org/html/libxml-parser.html#xmlFreeParserCtxt
  *
@@ -0,0 +1,716 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-cache.c: Precompiled document caches
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#include "config.h"
+#include "rsvg-cache.h"
+#include "rsvg-private.h"
+#include "rsvg-styles.h"
+#include "rsvg-xml.h"
+
+#include <string.h>
+
+/* Caches are only valid for the exact library that wrote them, and are
+ * laid out in the byte order and double format of the machine, so the
+ * header carries everything needed to reject a cache from elsewhere.
+ */
+#define RSVG_CACHE_MAGIC "RSVGPCH"
+#define RSVG_CACHE_FORMAT_VERSION 2
+#define RSVG_CACHE_BYTE_ORDER 0x01020304
+#define RSVG_CACHE_VERSION_SIZE 16
+#define RSVG_CACHE_HASH_TYPE G_CHECKSUM_SHA256
+#define RSVG_CACHE_HASH_SIZE 32
+#define RSVG_CACHE_NO_STRING G_MAXUINT32
+/* The only flags a cache passes on to the handle loaded from it.  The
+ * loading limits are not among them, so an edited cache cannot lift them.
+ */
+#define RSVG_CACHE_FLAGS (RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA | RSVG_HANDLE_FLAG_RENDER_ONLY)
+
+/* The events are a stream of 32-bit words: the event type, then the offsets
+ * of its strings in the string table.  Every string is NUL-terminated.
+ *
+ *   START name n_atts (key value)*n_atts
+ *   END name
+ *   CHARS offset length
+ *   PI target data
+ *
+ * The states are what each call to rsvg_parse_style_attrs() left, in the
+ * order of the calls, as written by rsvg_state_write_flat().
+ */
+typedef enum {
+    RSVG_CACHE_EVENT_START = 1,
+    RSVG_CACHE_EVENT_END,
+    RSVG_CACHE_EVENT_CHARS,
+    RSVG_CACHE_EVENT_PI
+} RsvgCacheEvent;
+
+typedef struct {
+    char magic[8];
+    guint32 format_version;
+    guint32 byte_order;
+    guint32 path_data_size; /* sizeof (cairo_path_data_t) */
+    guint32 flags; /* of RSVG_CACHE_FLAGS, that the document was loaded with */
+    char library_version[RSVG_CACHE_VERSION_SIZE];
+    guint8 source_hash[RSVG_CACHE_HASH_SIZE];
+    guint32 base_uri; /* string offset, or RSVG_CACHE_NO_STRING */
+    guint32 state_size; /* sizeof (RsvgState) */
+
+    /* all offsets are from the start of the file */
+    guint64 events_offset;
+    guint64 n_events; /* in words */
+    guint64 strings_offset;
+    guint64 strings_size;
+    guint64 paths_offset; /* of an array of RsvgCachePath */
+    guint64 n_paths;
+    guint64 states_offset;
+    guint64 states_size;
+} RsvgCacheHeader;
+
+typedef struct {
+    guint64 offset; /* of the cairo_path_data_t array */
+    gint64 num_data; /* -1 for a path that did not compile */
+} RsvgCachePath;
+
+struct _RsvgCacheWriter {
+    GChecksum* checksum;
+    GArray* events;
+    GString* strings;
+    GHashTable* string_offsets; /* string -> offset in strings */
+    GByteArray* states;
+    gboolean overflow; /* the strings outgrew 32-bit offsets */
+};
+
+struct _RsvgCache {
+    GBytes* bytes;
+    const RsvgCacheHeader* header;
+    const guint32* events;
+    const char* strings;
+    cairo_path_t* paths;
+    cairo_path_t** path_pointers;
+    gboolean replaying;
+    guint64 states_pos; /* of the next state, in the states */
+    gboolean states_damaged;
+};
+
+RsvgCacheWriter* rsvg_cache_writer_new(void) {
+    RsvgCacheWriter* writer = g_new(RsvgCacheWriter, 1);
+
+    writer->checksum = g_checksum_new(RSVG_CACHE_HASH_TYPE);
+    writer->events = g_array_new(FALSE, FALSE, sizeof(guint32));
+    writer->strings = g_string_new(NULL);
+    writer->string_offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    writer->states = g_byte_array_new();
+    writer->overflow = FALSE;
+
+    return writer;
+}
+
+void rsvg_cache_writer_free(RsvgCacheWriter* writer) {
+    if (writer == NULL)
+        return;
+
+    g_checksum_free(writer->checksum);
+    g_array_free(writer->events, TRUE);
+    g_string_free(writer->strings, TRUE);
+    g_hash_table_destroy(writer->string_offsets);
+    g_byte_array_free(writer->states, TRUE);
+    g_free(writer);
+}
+
+static void rsvg_cache_checksum_update(GChecksum* checksum, const guint8* data, gsize len) {
+    /* g_checksum_update() takes a gssize */
+    while (len > 0) {
+        gsize n = MIN(len, (gsize)G_MAXSSIZE);
+
+        g_checksum_update(checksum, data, n);
+        data += n;
+        len -= n;
+    }
+}
+
+void rsvg_cache_writer_add_source(RsvgCacheWriter* writer, const guint8* data, gsize len) {
+    rsvg_cache_checksum_update(writer->checksum, data, len);
+}
+
+GInputStream* rsvg_cache_writer_read_stream(RsvgCacheWriter* writer,
+                                            GInputStream* stream,
+                                            GCancellable* cancellable,
+                                            GError** error) {
+    GOutputStream* memory = g_memory_output_stream_new_resizable();
+    GBytes* bytes;
+    GInputStream* contents;
+
+    if (g_output_stream_splice(memory, stream, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, cancellable, error) < 0) {
+        g_object_unref(memory);
+        return NULL;
+    }
+
+    bytes = g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(memory));
+    g_object_unref(memory);
+
+    rsvg_cache_writer_add_source(writer, g_bytes_get_data(bytes, NULL), g_bytes_get_size(bytes));
+    contents = g_memory_input_stream_new_from_bytes(bytes);
+    g_bytes_unref(bytes);
+
+    return contents;
+}
+
+static void rsvg_cache_writer_append(RsvgCacheWriter* writer, guint32 word) {
+    g_array_append_val(writer->events, word);
+}
+
+/* Element and attribute names and most attribute values repeat, so each
+ * distinct string is only stored once
+ */
+static guint32 rsvg_cache_writer_add_string(RsvgCacheWriter* writer, const char* str) {
+    gpointer offset;
+    gsize len = strlen(str);
+
+    if (g_hash_table_lookup_extended(writer->string_offsets, str, NULL, &offset))
+        return GPOINTER_TO_UINT(offset);
+
+    if (len >= RSVG_CACHE_NO_STRING - writer->strings->len) {
+        writer->overflow = TRUE;
+        return 0;
+    }
+
+    offset = GUINT_TO_POINTER(writer->strings->len);
+    g_hash_table_insert(writer->string_offsets, g_strdup(str), offset);
+    g_string_append_len(writer->strings, str, len + 1);
+
+    return GPOINTER_TO_UINT(offset);
+}
+
+void rsvg_cache_writer_start_element(RsvgCacheWriter* writer, const char* name, const char** atts) {
+    guint32 n_atts = 0;
+    guint i;
+
+    if (atts != NULL)
+        while (atts[2 * n_atts] != NULL)
+            n_atts++;
+
+    rsvg_cache_writer_append(writer, RSVG_CACHE_EVENT_START);
+    rsvg_cache_writer_append(writer, rsvg_cache_writer_add_string(writer, name));
+    rsvg_cache_writer_append(writer, n_atts);
+    for (i = 0; i < 2 * n_atts; i++)
+        rsvg_cache_writer_append(writer, rsvg_cache_writer_add_string(writer, atts[i] ? atts[i] : ""));
+}
+
+void rsvg_cache_writer_end_element(RsvgCacheWriter* writer, const char* name) {
+    rsvg_cache_writer_append(writer, RSVG_CACHE_EVENT_END);
+    rsvg_cache_writer_append(writer, rsvg_cache_writer_add_string(writer, name));
+}
+
+void rsvg_cache_writer_characters(RsvgCacheWriter* writer, const char* ch, int len) {
+    if (ch == NULL || len <= 0)
+        return;
+
+    /* character data hardly ever repeats, and is not looked up */
+    if ((gsize)len >= RSVG_CACHE_NO_STRING - writer->strings->len) {
+        writer->overflow = TRUE;
+        return;
+    }
+
+    rsvg_cache_writer_append(writer, RSVG_CACHE_EVENT_CHARS);
+    rsvg_cache_writer_append(writer, writer->strings->len);
+    rsvg_cache_writer_append(writer, len);
+    g_string_append_len(writer->strings, ch, len);
+    g_string_append_c(writer->strings, '\0');
+}
+
+void rsvg_cache_writer_processing_instruction(RsvgCacheWriter* writer, const char* target, const char* data) {
+    rsvg_cache_writer_append(writer, RSVG_CACHE_EVENT_PI);
+    rsvg_cache_writer_append(writer, rsvg_cache_writer_add_string(writer, target));
+    rsvg_cache_writer_append(writer, rsvg_cache_writer_add_string(writer, data ? data : ""));
+}
+
+static guint32 rsvg_cache_writer_add_state_string(const char* str, gpointer user_data) {
+    return rsvg_cache_writer_add_string(user_data, str);
+}
+
+void rsvg_cache_writer_add_state(RsvgCacheWriter* writer, const RsvgState* state) {
+    rsvg_state_write_flat(state, writer->states, rsvg_cache_writer_add_state_string, writer);
+}
+
+static void rsvg_cache_pad(GByteArray* buf) {
+    static const guint8 zeros[8] = {0};
+
+    g_byte_array_append(buf, zeros, (8 - buf->len % 8) % 8);
+}
+
+/**
+ * rsvg_handle_save_cache:
+ * @handle: a #RsvgHandle
+ * @filename: the file to write the cache to
+ * @error: (allow-none): a location to store a #GError, or %NULL
+ *
+ * Writes a precompiled cache of the document in @handle, for
+ * rsvg_handle_new_from_cache() to load without parsing the document again.
+ * The cache holds the document's structure and attributes, the style
+ * every element was given and all of its path data, compiled.  The styles
+ * are the ones the document's own stylesheets gave it; the stylesheets are
+ * not applied again when the cache is loaded.  It is only valid for this version of librsvg on
+ * this kind of machine, and for the exact source it was made from.
+ *
+ * @handle must have been created with %RSVG_HANDLE_FLAG_CACHEABLE and
+ * loaded completely.  The file is replaced atomically.
+ *
+ * Returns: %TRUE on success, or %FALSE with @error filled in
+ *
+ * Since: 2.52
+ */
+gboolean rsvg_handle_save_cache(RsvgHandle* handle, const char* filename, GError** error) {
+    RsvgCacheWriter* writer;
+    RsvgCacheHeader header;
+    GByteArray* buf;
+    cairo_path_t** const* results;
+    guint n_results, i;
+    gsize hash_size = RSVG_CACHE_HASH_SIZE;
+    const char* base_uri;
+    RsvgCachePath* table;
+    gboolean success;
+
+    g_return_val_if_fail(RSVG_IS_HANDLE(handle), FALSE);
+    g_return_val_if_fail(filename != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    writer = handle->priv->cache_writer;
+    if (writer == NULL || handle->priv->state != RSVG_HANDLE_STATE_CLOSED_OK) {
+        g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED,
+                    "Only a handle loaded completely with RSVG_HANDLE_FLAG_CACHEABLE can be cached");
+        return FALSE;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RSVG_CACHE_MAGIC, sizeof(header.magic));
+    header.format_version = RSVG_CACHE_FORMAT_VERSION;
+    header.byte_order = RSVG_CACHE_BYTE_ORDER;
+    header.path_data_size = sizeof(cairo_path_data_t);
+    header.state_size = sizeof(RsvgState);
+    header.flags = handle->priv->flags & RSVG_CACHE_FLAGS;
+    g_strlcpy(header.library_version, VERSION, sizeof(header.library_version));
+
+    /* a copy, since the writer's checksum cannot be updated once read */
+    {
+        GChecksum* checksum = g_checksum_copy(writer->checksum);
+
+        g_checksum_get_digest(checksum, header.source_hash, &hash_size);
+        g_checksum_free(checksum);
+    }
+
+    base_uri = rsvg_handle_get_base_uri(handle);
+    header.base_uri = base_uri ? rsvg_cache_writer_add_string(writer, base_uri) : RSVG_CACHE_NO_STRING;
+
+    if (writer->overflow) {
+        g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED, "The document is too big to be cached");
+        return FALSE;
+    }
+
+    buf = g_byte_array_new();
+    g_byte_array_append(buf, (const guint8*)&header, sizeof(header));
+
+    header.events_offset = buf->len;
+    header.n_events = writer->events->len;
+    g_byte_array_append(buf, (const guint8*)writer->events->data, writer->events->len * sizeof(guint32));
+    rsvg_cache_pad(buf);
+
+    header.strings_offset = buf->len;
+    header.strings_size = writer->strings->len;
+    g_byte_array_append(buf, (const guint8*)writer->strings->str, writer->strings->len);
+    rsvg_cache_pad(buf);
+
+    results = rsvg_geometry_queue_get_recorded(handle->priv->geometry, &n_results);
+    header.paths_offset = buf->len;
+    header.n_paths = n_results;
+    table = g_new0(RsvgCachePath, MAX(n_results, 1));
+    g_byte_array_set_size(buf, buf->len + n_results * sizeof(RsvgCachePath));
+
+    /* cairo_path_data_t holds doubles, and the cache is mapped at a page
+     * boundary, so keeping every offset 8-aligned keeps the data aligned
+     */
+    for (i = 0; i < n_results; i++) {
+        const cairo_path_t* path = *results[i];
+
+        if (path == NULL) {
+            table[i].num_data = -1;
+            continue;
+        }
+
+        table[i].offset = buf->len;
+        table[i].num_data = path->num_data;
+        g_byte_array_append(buf, (const guint8*)path->data, path->num_data * sizeof(cairo_path_data_t));
+    }
+
+    header.states_offset = buf->len;
+    header.states_size = writer->states->len;
+    g_byte_array_append(buf, writer->states->data, writer->states->len);
+
+    memcpy(buf->data + header.paths_offset, table, n_results * sizeof(RsvgCachePath));
+    memcpy(buf->data, &header, sizeof(header));
+    g_free(table);
+
+    success = g_file_set_contents(filename, (const char*)buf->data, buf->len, error);
+    g_byte_array_free(buf, TRUE);
+
+    return success;
+}
+
+static gboolean rsvg_cache_check_range(gsize size, guint64 offset, guint64 count, gsize elem_size) {
+    return offset <= size && count <= (size - offset) / elem_size;
+}
+
+/* Walks a path like a renderer would, so that a damaged cache cannot make
+ * one read past its data
+ */
+static gboolean rsvg_cache_check_path(const cairo_path_data_t* data, gint64 num_data) {
+    gint64 i;
+
+    for (i = 0; i < num_data; i += data[i].header.length) {
+        int length;
+
+        switch (data[i].header.type) {
+            case CAIRO_PATH_MOVE_TO:
+            case CAIRO_PATH_LINE_TO:
+                length = 2;
+                break;
+            case CAIRO_PATH_CURVE_TO:
+                length = 4;
+                break;
+            case CAIRO_PATH_CLOSE_PATH:
+                length = 1;
+                break;
+            default:
+                return FALSE;
+        }
+
+        if (data[i].header.length != length || length > num_data - i)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void rsvg_cache_set_corrupt_error(GError** error) {
+    g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED, "The cache file is damaged");
+}
+
+static RsvgCache* rsvg_cache_new(GBytes* bytes, const guint8* source, gsize source_len, GError** error) {
+    const guint8* base;
+    gsize size;
+    const RsvgCacheHeader* header;
+    RsvgCache* cache;
+    GChecksum* checksum;
+    guint8 hash[RSVG_CACHE_HASH_SIZE];
+    gsize hash_size = sizeof(hash);
+    const RsvgCachePath* table;
+    guint64 i;
+
+    base = g_bytes_get_data(bytes, &size);
+    header = (const RsvgCacheHeader*)base;
+
+    if (size < sizeof(RsvgCacheHeader) || memcmp(header->magic, RSVG_CACHE_MAGIC, sizeof(header->magic)) != 0) {
+        g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED, "Not a librsvg cache file");
+        return NULL;
+    }
+
+    if (header->format_version != RSVG_CACHE_FORMAT_VERSION || header->byte_order != RSVG_CACHE_BYTE_ORDER ||
+        header->path_data_size != sizeof(cairo_path_data_t) || header->state_size != sizeof(RsvgState) ||
+        strncmp(header->library_version, VERSION, sizeof(header->library_version)) != 0) {
+        g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED, "The cache file was written by another version of librsvg");
+        return NULL;
+    }
+
+    checksum = g_checksum_new(RSVG_CACHE_HASH_TYPE);
+    rsvg_cache_checksum_update(checksum, source, source_len);
+    g_checksum_get_digest(checksum, hash, &hash_size);
+    g_checksum_free(checksum);
+
+    if (memcmp(hash, header->source_hash, sizeof(hash)) != 0) {
+        g_set_error(error, RSVG_ERROR, RSVG_ERROR_FAILED, "The cache file was made from a different document");
+        return NULL;
+    }
+
+    /* strings must end in the table, so a NUL has to close it */
+    if (header->events_offset % sizeof(guint32) != 0 ||
+        !rsvg_cache_check_range(size, header->events_offset, header->n_events, sizeof(guint32)) ||
+        !rsvg_cache_check_range(size, header->strings_offset, header->strings_size, 1) ||
+        header->strings_size > RSVG_CACHE_NO_STRING ||
+        (header->strings_size > 0 && base[header->strings_offset + header->strings_size - 1] != '\0') ||
+        (header->base_uri != RSVG_CACHE_NO_STRING && header->base_uri >= header->strings_size) ||
+        header->n_events > G_MAXUINT || header->n_paths > G_MAXUINT || header->paths_offset % 8 != 0 ||
+        !rsvg_cache_check_range(size, header->paths_offset, header->n_paths, sizeof(RsvgCachePath)) ||
+        header->states_offset % 8 != 0 ||
+        !rsvg_cache_check_range(size, header->states_offset, header->states_size, 1)) {
+        rsvg_cache_set_corrupt_error(error);
+        return NULL;
+    }
+
+    cache = g_new0(RsvgCache, 1);
+    cache->bytes = g_bytes_ref(bytes);
+    cache->header = header;
+    cache->events = (const guint32*)(base + header->events_offset);
+    cache->strings = (const char*)(base + header->strings_offset);
+    cache->paths = g_new(cairo_path_t, MAX(header->n_paths, 1));
+    cache->path_pointers = g_new(cairo_path_t*, MAX(header->n_paths, 1));
+
+    /* the paths point straight into the mapping */
+    table = (const RsvgCachePath*)(base + header->paths_offset);
+    for (i = 0; i < header->n_paths; i++) {
+        cairo_path_t* path = &cache->paths[i];
+
+        if (table[i].num_data < 0) {
+            cache->path_pointers[i] = NULL;
+            continue;
+        }
+
+        if (table[i].offset % 8 != 0 || table[i].num_data > G_MAXINT ||
+            !rsvg_cache_check_range(size, table[i].offset, table[i].num_data, sizeof(cairo_path_data_t)) ||
+            !rsvg_cache_check_path((const cairo_path_data_t*)(base + table[i].offset), table[i].num_data)) {
+            rsvg_cache_free(cache);
+            rsvg_cache_set_corrupt_error(error);
+            return NULL;
+        }
+
+        path->status = CAIRO_STATUS_SUCCESS;
+        path->num_data = (int)table[i].num_data;
+        path->data = path->num_data > 0 ? (cairo_path_data_t*)(base + table[i].offset) : NULL;
+        cache->path_pointers[i] = path;
+    }
+
+    return cache;
+}
+
+void rsvg_cache_free(RsvgCache* cache) {
+    if (cache == NULL)
+        return;
+
+    g_free(cache->paths);
+    g_free(cache->path_pointers);
+    g_bytes_unref(cache->bytes);
+    g_free(cache);
+}
+
+/* Returns the string at the word at @pos, or NULL if it is out of range */
+static const char* rsvg_cache_get_string(RsvgCache* cache, guint64 pos) {
+    guint32 offset = cache->events[pos];
+
+    return offset < cache->header->strings_size ? cache->strings + offset : NULL;
+}
+
+static const char* rsvg_cache_get_state_string(guint32 offset, gpointer user_data) {
+    RsvgCache* cache = user_data;
+
+    return offset < cache->header->strings_size ? cache->strings + offset : NULL;
+}
+
+gboolean rsvg_cache_replay_state(RsvgCache* cache, RsvgState* state) {
+    const guint8* states;
+    gsize len;
+
+    if (!cache->replaying)
+        return FALSE;
+    if (cache->states_damaged)
+        return TRUE;
+
+    states = (const guint8*)g_bytes_get_data(cache->bytes, NULL) + cache->header->states_offset;
+    len = rsvg_state_read_flat(state, states + cache->states_pos, cache->header->states_size - cache->states_pos,
+                               rsvg_cache_get_state_string, cache);
+    if (len == 0)
+        cache->states_damaged = TRUE;
+    cache->states_pos += len;
+
+    return TRUE;
+}
+
+static gboolean rsvg_cache_replay(RsvgCache* cache, RsvgHandle* handle, GError** error) {
+    const RsvgSaxCallbacks* sax = rsvg_get_sax_callbacks();
+    const guint32* events = cache->events;
+    guint64 n_events = cache->header->n_events, pos = 0;
+    GPtrArray* atts = g_ptr_array_new();
+    GError* real_error = NULL;
+    gboolean corrupt = FALSE;
+
+    handle->priv->error = &real_error;
+    cache->replaying = TRUE;
+
+    while (pos < n_events && real_error == NULL && !corrupt && !cache->states_damaged) {
+        guint64 left = n_events - pos - 1;
+        const char* name;
+
+        switch (events[pos++]) {
+            case RSVG_CACHE_EVENT_START: {
+                guint32 n_atts, i;
+
+                if (left < 2 || (n_atts = events[pos + 1]) > (left - 2) / 2 ||
+                    (name = rsvg_cache_get_string(cache, pos)) == NULL) {
+                    corrupt = TRUE;
+                    break;
+                }
+                pos += 2;
+
+                g_ptr_array_set_size(atts, 0);
+                for (i = 0; i < 2 * n_atts && !corrupt; i++) {
+                    const char* str = rsvg_cache_get_string(cache, pos++);
+
+                    corrupt = str == NULL;
+                    g_ptr_array_add(atts, (gpointer)str);
+                }
+                g_ptr_array_add(atts, NULL);
+
+                if (!corrupt)
+                    sax->start_element(handle, (const xmlChar*)name, (const xmlChar**)atts->pdata);
+                break;
+            }
+
+            case RSVG_CACHE_EVENT_END:
+                if (left < 1 || (name = rsvg_cache_get_string(cache, pos)) == NULL) {
+                    corrupt = TRUE;
+                    break;
+                }
+                pos += 1;
+
+                sax->end_element(handle, (const xmlChar*)name);
+                break;
+
+            case RSVG_CACHE_EVENT_CHARS:
+                if (left < 2 || events[pos] >= cache->header->strings_size ||
+                    events[pos + 1] > cache->header->strings_size - events[pos] || events[pos + 1] > G_MAXINT) {
+                    corrupt = TRUE;
+                    break;
+                }
+
+                sax->characters(handle, (const xmlChar*)(cache->strings + events[pos]), (int)events[pos + 1]);
+                pos += 2;
+                break;
+
+            case RSVG_CACHE_EVENT_PI: {
+                const char* data;
+
+                if (left < 2 || (name = rsvg_cache_get_string(cache, pos)) == NULL ||
+                    (data = rsvg_cache_get_string(cache, pos + 1)) == NULL) {
+                    corrupt = TRUE;
+                    break;
+                }
+                pos += 2;
+
+                sax->processing_instruction(handle, (const xmlChar*)name, (const xmlChar*)data);
+                break;
+            }
+
+            default:
+                corrupt = TRUE;
+                break;
+        }
+    }
+
+    rsvg_handle_finish_prefetch(handle);
+
+    cache->replaying = FALSE;
+    handle->priv->error = NULL;
+    g_ptr_array_free(atts, TRUE);
+
+    /* every state has to have been used up, or the events and the states
+     * are from different caches
+     */
+    corrupt = corrupt || cache->states_damaged || cache->states_pos != cache->header->states_size;
+
+    if (real_error != NULL) {
+        g_propagate_error(error, real_error);
+        return FALSE;
+    }
+
+    if (corrupt) {
+        rsvg_cache_set_corrupt_error(error);
+        return FALSE;
+    }
+
+    /* anything the cache did not have a compiled path for */
+    rsvg_geometry_queue_compile(handle->priv->geometry, handle->priv->arena);
+
+    return TRUE;
+}
+
+/**
+ * rsvg_handle_new_from_cache:
+ * @cache_filename: a file written by rsvg_handle_save_cache()
+ * @data: (array length=data_len): the source document the cache was made from
+ * @data_len: the length of @data, in bytes
+ * @error: (allow-none): a location to store a #GError, or %NULL
+ *
+ * Loads a document from a cache written by rsvg_handle_save_cache().  The
+ * cache file is mapped, and the document is built from it without parsing
+ * its XML, its styles or any of its path data again.  External resources,
+ * like images and referenced documents, are still loaded as usual.
+ *
+ * @data must be the source document, exactly as it was loaded when the
+ * cache was written; the cache is rejected if it was made from anything
+ * else, or by another version of librsvg.  The resulting handle has the
+ * base URI of the handle the cache was written from, and its
+ * %RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA and %RSVG_HANDLE_FLAG_RENDER_ONLY
+ * flags.  %RSVG_HANDLE_FLAG_UNLIMITED is never taken from a cache, so an
+ * edited cache cannot lift the loading limits.
+ *
+ * Returns: a new #RsvgHandle, or %NULL with @error filled in
+ *
+ * Since: 2.52
+ */
+RsvgHandle* rsvg_handle_new_from_cache(const char* cache_filename,
+                                       const guint8* data,
+                                       gsize data_len,
+                                       GError** error) {
+    GMappedFile* mapped;
+    GBytes* bytes;
+    RsvgCache* cache;
+    RsvgHandle* handle;
+
+    g_return_val_if_fail(cache_filename != NULL, NULL);
+    g_return_val_if_fail(data != NULL || data_len == 0, NULL);
+    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+    mapped = g_mapped_file_new(cache_filename, FALSE, error);
+    if (mapped == NULL)
+        return NULL;
+
+    bytes = g_mapped_file_get_bytes(mapped);
+    g_mapped_file_unref(mapped);
+
+    cache = rsvg_cache_new(bytes, data, data_len, error);
+    g_bytes_unref(bytes);
+    if (cache == NULL)
+        return NULL;
+
+    handle = rsvg_handle_new_with_flags((RsvgHandleFlags)(cache->header->flags & RSVG_CACHE_FLAGS));
+    if (cache->header->base_uri != RSVG_CACHE_NO_STRING)
+        rsvg_handle_set_base_uri(handle, cache->strings + cache->header->base_uri);
+
+    handle->priv->cache = cache;
+    rsvg_geometry_queue_set_precompiled(handle->priv->geometry, cache->path_pointers, (guint)cache->header->n_paths);
+    handle->priv->state = RSVG_HANDLE_STATE_READING;
+
+    if (!rsvg_cache_replay(cache, handle, error)) {
+        g_object_unref(handle);
+        return NULL;
+    }
+
+    handle->priv->state = RSVG_HANDLE_STATE_CLOSED_OK;
+
+    return handle;
+}
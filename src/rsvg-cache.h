@@ -0,0 +1,90 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-cache.h: Precompiled document caches
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RSVG_CACHE_H
+#define RSVG_CACHE_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* A document cache holds what the XML parser reported while loading a
+ * document, with the strings laid out once, the state the styles gave each
+ * element, and the compiled path data of every path and point list.
+ * Loading from it replays the parser's events straight out of a mapping of
+ * the file, takes the states instead of applying the styles again and
+ * points the paths into it, so neither the XML, the styles nor any geometry
+ * is parsed again.
+ */
+
+/* Records what a cache needs while a handle loads */
+typedef struct _RsvgCacheWriter RsvgCacheWriter;
+/* A mapped cache file, which a handle loaded from it keeps alive */
+typedef struct _RsvgCache RsvgCache;
+
+struct _RsvgState;
+
+G_GNUC_INTERNAL
+RsvgCacheWriter* rsvg_cache_writer_new(void);
+G_GNUC_INTERNAL
+void rsvg_cache_writer_free(RsvgCacheWriter* writer);
+
+/* Adds bytes of the source document, exactly as they were handed in, to
+ * the hash that a cache is keyed by
+ */
+G_GNUC_INTERNAL
+void rsvg_cache_writer_add_source(RsvgCacheWriter* writer, const guint8* data, gsize len);
+
+/* Reads all of @stream, adding it to the hash, and returns a stream with
+ * the same contents
+ */
+G_GNUC_INTERNAL
+GInputStream* rsvg_cache_writer_read_stream(RsvgCacheWriter* writer,
+                                            GInputStream* stream,
+                                            GCancellable* cancellable,
+                                            GError** error);
+
+G_GNUC_INTERNAL
+void rsvg_cache_writer_start_element(RsvgCacheWriter* writer, const char* name, const char** atts);
+G_GNUC_INTERNAL
+void rsvg_cache_writer_end_element(RsvgCacheWriter* writer, const char* name);
+G_GNUC_INTERNAL
+void rsvg_cache_writer_characters(RsvgCacheWriter* writer, const char* ch, int len);
+G_GNUC_INTERNAL
+void rsvg_cache_writer_processing_instruction(RsvgCacheWriter* writer, const char* target, const char* data);
+
+/* Records the state rsvg_parse_style_attrs() left */
+G_GNUC_INTERNAL
+void rsvg_cache_writer_add_state(RsvgCacheWriter* writer, const struct _RsvgState* state);
+
+/* While @cache is replayed, replaces @state with the next state in it and
+ * returns %TRUE; if there is none, or it is damaged, the replay fails.
+ * Returns %FALSE at any other time, for the styles to be applied as usual.
+ */
+G_GNUC_INTERNAL
+gboolean rsvg_cache_replay_state(RsvgCache* cache, struct _RsvgState* state);
+
+G_GNUC_INTERNAL
+void rsvg_cache_free(RsvgCache* cache);
+
+G_END_DECLS
+
+#endif /* RSVG_CACHE_H */
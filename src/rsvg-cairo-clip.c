@@ -170,27 +170,31 @@ void rsvg_cairo_clip(RsvgDrawingCtx* ctx, RsvgClipPath* clip, RsvgBbox* bbox) {
     RsvgCairoClipRender* clip_render;
     RsvgCairoRender* save = RSVG_CAIRO_RENDER(ctx->render);
     cairo_t* cr;
-    cairo_matrix_t affinesave;
 
     cr = save->cr;
     clip_render = RSVG_CAIRO_CLIP_RENDER(rsvg_cairo_clip_render_new(cr, save));
     ctx->render = &clip_render->super.super;
 
-    /* Horribly dirty hack to have the bbox premultiplied to everything */
+    rsvg_state_push(ctx);
+    rsvg_state_reinherit_top(ctx, &clip->super, 0);
+
+    /* Have the bbox premultiplied to everything.  This goes into the
+     * drawing context's copy of the state, never the node's, so that
+     * several threads can render the same clip path at once.
+     */
     if (clip->units == objectBoundingBox) {
+        RsvgState* current = rsvg_current_state(ctx);
         cairo_matrix_t bbtransform;
+
         cairo_matrix_init(&bbtransform, bbox->rect.width, 0, 0, bbox->rect.height, bbox->rect.x, bbox->rect.y);
-        affinesave = clip->super.state->affine;
-        cairo_matrix_multiply(&clip->super.state->affine, &bbtransform, &clip->super.state->affine);
+        cairo_matrix_multiply(&current->affine, &bbtransform, &current->affine);
     }
 
-    rsvg_state_push(ctx);
-    _rsvg_node_draw_children((RsvgNode*)clip, ctx, 0);
+    rsvg_push_discrete_layer(ctx);
+    _rsvg_node_draw_children((RsvgNode*)clip, ctx, -1);
+    rsvg_pop_discrete_layer(ctx);
     rsvg_state_pop(ctx);
 
-    if (clip->units == objectBoundingBox)
-        clip->super.state->affine = affinesave;
-
     g_assert(clip_render->super.cr_stack == NULL);
     g_assert(clip_render->super.bb_stack == NULL);
     g_assert(clip_render->super.surfaces_stack == NULL);
@@ -680,7 +680,6 @@ static void rsvg_cairo_generate_mask(cairo_t* cr, RsvgMask* self, RsvgDrawingCtx
     guint8* pixels;
     guint32 width = render->width, height = render->height;
     guint32 rowstride = width * 4, row, i;
-    cairo_matrix_t affinesave;
     double sx, sy, sw, sh;
     gboolean nest = cr != render->initial_cr;
 
@@ -714,23 +713,29 @@ static void rsvg_cairo_generate_mask(cairo_t* cr, RsvgMask* self, RsvgDrawingCtx
     else
         rsvg_cairo_add_clipping_rect(ctx, sx, sy, sw, sh);
 
-    /* Horribly dirty hack to have the bbox premultiplied to everything */
+    rsvg_state_push(ctx);
+    rsvg_state_reinherit_top(ctx, &self->super, 0);
+
+    /* Have the bbox premultiplied to everything, in the drawing context's
+     * copy of the state so that the mask node itself is left untouched
+     */
     if (self->contentunits == objectBoundingBox) {
+        RsvgState* current = rsvg_current_state(ctx);
         cairo_matrix_t bbtransform;
+
         cairo_matrix_init(&bbtransform, bbox->rect.width, 0, 0, bbox->rect.height, bbox->rect.x, bbox->rect.y);
-        affinesave = self->super.state->affine;
-        cairo_matrix_multiply(&self->super.state->affine, &bbtransform, &self->super.state->affine);
+        cairo_matrix_multiply(&current->affine, &bbtransform, &current->affine);
         _rsvg_push_view_box(ctx, 1, 1);
     }
 
-    rsvg_state_push(ctx);
-    _rsvg_node_draw_children(&self->super, ctx, 0);
-    rsvg_state_pop(ctx);
+    rsvg_push_discrete_layer(ctx);
+    _rsvg_node_draw_children(&self->super, ctx, -1);
+    rsvg_pop_discrete_layer(ctx);
 
-    if (self->contentunits == objectBoundingBox) {
+    if (self->contentunits == objectBoundingBox)
         _rsvg_pop_view_box(ctx);
-        self->super.state->affine = affinesave;
-    }
+
+    rsvg_state_pop(ctx);
 
     render->cr = save_cr;
 
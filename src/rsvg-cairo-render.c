@@ -176,6 +176,8 @@ RsvgDrawingCtx* rsvg_cairo_new_drawing_ctx(cairo_t* cr, RsvgHandle* handle) {
     render->offset_y = bby0;
 
     draw->state = NULL;
+    draw->state_chunks = NULL;
+    draw->n_states = 0;
 
     draw->defs = handle->priv->defs;
     draw->dpi_x = handle->priv->dpi_x;
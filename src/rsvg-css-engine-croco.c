@@ -13,17 +13,104 @@
 #include <string.h>
 #include <libcroco.h>
 
+/* A rule of the stylesheet, filed in the engine's index under the class
+ * its selector asks for if there is one, else under the id, else under
+ * the tag.  The other parts of the selector are kept here for matching.
+ */
+typedef struct _RsvgCssRule RsvgCssRule;
+
+struct _RsvgCssRule {
+    const char* tag; /* interned, or NULL */
+    const char* id; /* interned, or NULL */
+    GHashTable* styles; /* property name -> StyleValueData */
+    RsvgCssRule* next; /* the next rule in the same bucket */
+};
+
 typedef struct {
     RsvgCssEngine parent;
-    GHashTable* css_props;
+    /* the rules, by what their selectors ask for; keys are interned */
+    RsvgCssRule* universal_rule; /* * */
+    GHashTable* tag_rules; /* tag -> tag */
+    GHashTable* class_rules; /* ".class" -> .class, tag.class, .class#id and tag.class#id */
+    GHashTable* id_rules; /* id -> #id and tag#id */
+    guint n_rules;
+    GHashTable* rule_ids; /* every id a rule names */
+    GHashTable* shared_styles; /* RsvgStyleShareKey -> RsvgStyleShareEntry */
+    guint share_hits;
+    guint share_misses;
+    GHashTable* class_lists; /* interned class attribute -> NULL-terminated interned ".class" selectors */
+    gboolean concurrent; /* apply_styles may be running on several threads */
     RsvgHandle* ctx; /* Reference to handle for data acquisition */
 } RsvgCssEngineCroco;
 
+static void rsvg_css_rule_free_list(RsvgCssRule* rule) {
+    while (rule != NULL) {
+        RsvgCssRule* next = rule->next;
+
+        g_hash_table_destroy(rule->styles);
+        g_free(rule);
+        rule = next;
+    }
+}
+
+static GHashTable* rsvg_css_rule_table_new(void) {
+    /* keys are interned in the handle, so they are compared by address */
+    return g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)rsvg_css_rule_free_list);
+}
+
+/* Elements without presentation attributes start from the same initial
+ * state, so the styles of one are those of every other with the same tag,
+ * class attribute and style attribute, and with the same id if a rule
+ * names it.  The state of the first such element is kept to be copied for
+ * the others, up to this many different ones.
+ */
+#define RSVG_STYLE_SHARE_MAX_ENTRIES 1024
+
+typedef struct {
+    const char* tag;
+    const char* klass;
+    const char* id;
+    const char* style;
+} RsvgStyleShareKey;
+
+typedef struct {
+    RsvgStyleShareKey key;
+    RsvgState state;
+} RsvgStyleShareEntry;
+
+/* the strings in keys are interned */
+static guint rsvg_style_share_key_hash(gconstpointer data) {
+    const RsvgStyleShareKey* key = data;
+    guint hash = g_direct_hash(key->tag);
+
+    hash = hash * 31 + g_direct_hash(key->klass);
+    hash = hash * 31 + g_direct_hash(key->id);
+    return hash * 31 + g_direct_hash(key->style);
+}
+
+static gboolean rsvg_style_share_key_equal(gconstpointer a, gconstpointer b) {
+    const RsvgStyleShareKey* key_a = a;
+    const RsvgStyleShareKey* key_b = b;
+
+    return key_a->tag == key_b->tag && key_a->klass == key_b->klass && key_a->id == key_b->id &&
+           key_a->style == key_b->style;
+}
+
+static void rsvg_style_share_entry_free(RsvgStyleShareEntry* entry) {
+    rsvg_state_finalize(&entry->state);
+    g_free(entry);
+}
+
 static void rsvg_css_engine_croco_free(RsvgCssEngine* engine) {
     RsvgCssEngineCroco* self = (RsvgCssEngineCroco*)engine;
-    if (self->css_props) {
-        g_hash_table_destroy(self->css_props);
-    }
+
+    rsvg_css_rule_free_list(self->universal_rule);
+    g_hash_table_destroy(self->tag_rules);
+    g_hash_table_destroy(self->class_rules);
+    g_hash_table_destroy(self->id_rules);
+    g_hash_table_destroy(self->rule_ids);
+    g_hash_table_destroy(self->shared_styles);
+    g_hash_table_destroy(self->class_lists);
     g_free(self);
 }
 
@@ -34,29 +121,150 @@ static void rsvg_css_engine_croco_free(RsvgCssEngine* engine) {
 #define RSVG_MAX_CSS_DECLARATIONS 50000
 #define RSVG_MAX_CSS_SELECTOR_LENGTH 512
 
+/* The parts of a simple selector that rules are matched on, interned */
+typedef struct {
+    gboolean universal;
+    const char* tag;
+    const char* klass; /* with its leading '.' */
+    const char* id;
+} RsvgCssSelector;
+
+static const char* rsvg_css_engine_croco_intern(RsvgCssEngineCroco* self, const char* prefix, const CRString* str) {
+    char* tmp = g_strdup_printf("%s%.*s", prefix, (int)cr_string_peek_raw_str_len(str), cr_string_peek_raw_str(str));
+    const char* interned = rsvg_interner_intern(self->ctx->priv->interner, tmp);
+
+    g_free(tmp);
+    return interned;
+}
+
+/* Reads @sel into @out.  Returns FALSE for what cannot be matched on a
+ * single element (combinators, pseudo-classes, attribute selectors, more
+ * than one class or id) and for overly long selectors.
+ */
+static gboolean rsvg_css_engine_croco_compile_selector(RsvgCssEngineCroco* self,
+                                                       const CRSimpleSel* sel,
+                                                       RsvgCssSelector* out) {
+    const CRString* tag = NULL;
+    const CRString* klass = NULL;
+    const CRString* id = NULL;
+    const CRAdditionalSel* add;
+    gsize len = 2;
+
+    if (sel->next != NULL)
+        return FALSE;
+
+    for (add = sel->add_sel; add != NULL; add = add->next) {
+        if (add->type == CLASS_ADD_SELECTOR && klass == NULL && add->content.class_name != NULL)
+            klass = add->content.class_name;
+        else if (add->type == ID_ADD_SELECTOR && id == NULL && add->content.id_name != NULL)
+            id = add->content.id_name;
+        else
+            return FALSE;
+    }
+
+    if ((sel->type_mask & TYPE_SELECTOR) && sel->name != NULL)
+        tag = sel->name;
+    else if (!(sel->type_mask & UNIVERSAL_SELECTOR) && klass == NULL && id == NULL)
+        return FALSE;
+
+    if (tag != NULL)
+        len += cr_string_peek_raw_str_len(tag);
+    if (klass != NULL)
+        len += cr_string_peek_raw_str_len(klass);
+    if (id != NULL)
+        len += cr_string_peek_raw_str_len(id);
+    if (len > RSVG_MAX_CSS_SELECTOR_LENGTH)
+        return FALSE;
+
+    out->universal = tag == NULL && klass == NULL && id == NULL;
+    out->tag = tag != NULL ? rsvg_css_engine_croco_intern(self, "", tag) : NULL;
+    out->klass = klass != NULL ? rsvg_css_engine_croco_intern(self, ".", klass) : NULL;
+    out->id = id != NULL ? rsvg_css_engine_croco_intern(self, "", id) : NULL;
+
+    return TRUE;
+}
+
+/* Returns the rule in the list @rule for exactly @tag and @id, or NULL */
+static RsvgCssRule* rsvg_css_rule_find(RsvgCssRule* rule, const char* tag, const char* id) {
+    for (; rule != NULL; rule = rule->next) {
+        if (rule->tag == tag && rule->id == id)
+            return rule;
+    }
+    return NULL;
+}
+
+/* Returns the rule for @selector, adding it to the index if needed */
+static RsvgCssRule* rsvg_css_engine_croco_get_rule(RsvgCssEngineCroco* self, const RsvgCssSelector* selector) {
+    RsvgCssRule** link;
+    GHashTable* buckets;
+    const char* key;
+    RsvgCssRule* head;
+    RsvgCssRule* rule;
+
+    if (selector->universal) {
+        link = &self->universal_rule;
+        buckets = NULL;
+        key = NULL;
+        head = self->universal_rule;
+    }
+    else {
+        if (selector->klass != NULL) {
+            buckets = self->class_rules;
+            key = selector->klass;
+        }
+        else if (selector->id != NULL) {
+            buckets = self->id_rules;
+            key = selector->id;
+        }
+        else {
+            buckets = self->tag_rules;
+            key = selector->tag;
+        }
+        head = g_hash_table_lookup(buckets, key);
+        link = NULL;
+    }
+
+    rule = rsvg_css_rule_find(head, selector->tag, selector->id);
+    if (rule != NULL)
+        return rule;
+
+    rule = g_new(RsvgCssRule, 1);
+    rule->tag = selector->tag;
+    rule->id = selector->id;
+    rule->styles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)rsvg_style_value_data_free);
+    rule->next = NULL;
+    self->n_rules++;
+    if (rule->id != NULL)
+        g_hash_table_add(self->rule_ids, (gpointer)rule->id);
+
+    /* appended, so that the bucket's head never changes */
+    if (head != NULL) {
+        while (head->next != NULL)
+            head = head->next;
+        head->next = rule;
+    }
+    else if (link != NULL) {
+        *link = rule;
+    }
+    else {
+        g_hash_table_insert(buckets, (gpointer)key, rule);
+    }
+
+    return rule;
+}
+
 static void rsvg_css_define_style(RsvgCssEngineCroco* self,
-                                  const gchar* selector,
+                                  const RsvgCssSelector* selector,
                                   const gchar* style_name,
                                   const gchar* style_value,
                                   gboolean important) {
-    GHashTable* styles;
-    gboolean need_insert = FALSE;
+    RsvgCssRule* rule = rsvg_css_engine_croco_get_rule(self, selector);
+    StyleValueData* current_value;
 
     /* push name/style pair into HT */
-    styles = g_hash_table_lookup(self->css_props, selector);
-    if (styles == NULL) {
-        styles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)rsvg_style_value_data_free);
-        g_hash_table_insert(self->css_props, (gpointer)g_strdup(selector), styles);
-        need_insert = TRUE;
-    }
-    else {
-        StyleValueData* current_value;
-        current_value = g_hash_table_lookup(styles, style_name);
-        if (current_value == NULL || !current_value->important)
-            need_insert = TRUE;
-    }
-    if (need_insert) {
-        g_hash_table_insert(styles, (gpointer)g_strdup(style_name),
+    current_value = g_hash_table_lookup(rule->styles, style_name);
+    if (current_value == NULL || !current_value->important) {
+        g_hash_table_insert(rule->styles, (gpointer)g_strdup(style_name),
                             (gpointer)rsvg_style_value_data_new(style_value, important));
     }
 }
@@ -123,24 +331,20 @@ static void ccss_property(CRDocHandler* a_handler, CRString* a_name, CRTerm* a_e
     if (a_name && a_expr && user_data->selector) {
         CRSelector* cur;
         for (cur = user_data->selector; cur; cur = cur->next) {
-            if (cur->simple_sel) {
-                gchar* selector = (gchar*)cr_simple_sel_to_string(cur->simple_sel);
-                if (selector) {
-                    if (strlen(selector) > RSVG_MAX_CSS_SELECTOR_LENGTH) {
-                        g_free(selector);
-                        continue;
-                    }
-                    gchar *style_name, *style_value;
-                    name = (gchar*)cr_string_peek_raw_str(a_name);
-                    len = cr_string_peek_raw_str_len(a_name);
-                    style_name = g_strndup(name, len);
-                    style_value = (gchar*)cr_term_to_string(a_expr);
-                    rsvg_css_define_style(user_data->engine, selector, style_name, style_value, a_important);
-                    g_free(selector);
-                    g_free(style_name);
-                    g_free(style_value);
-                }
-            }
+            RsvgCssSelector selector;
+            gchar *style_name, *style_value;
+
+            if (cur->simple_sel == NULL ||
+                !rsvg_css_engine_croco_compile_selector(user_data->engine, cur->simple_sel, &selector))
+                continue;
+
+            name = (gchar*)cr_string_peek_raw_str(a_name);
+            len = cr_string_peek_raw_str_len(a_name);
+            style_name = g_strndup(name, len);
+            style_value = (gchar*)cr_term_to_string(a_expr);
+            rsvg_css_define_style(user_data->engine, &selector, style_name, style_value, a_important);
+            g_free(style_name);
+            g_free(style_value);
         }
     }
 }
@@ -195,6 +399,9 @@ static gboolean rsvg_css_engine_croco_parse_stylesheet(RsvgCssEngine* engine, co
         return FALSE;
     }
 
+    /* the rules are about to change */
+    g_hash_table_remove_all(self->shared_styles);
+
     css_handler = cr_doc_handler_new();
     init_sac_handler(css_handler);
 
@@ -224,8 +431,9 @@ static void ccss_import_style(CRDocHandler* a_this,
                               CRString* a_uri_default_ns,
                               CRParsingLocation* a_location) {
     CSSUserData* user_data = (CSSUserData*)a_this->app_data;
-    char* stylesheet_data;
+    GBytes* stylesheet_data;
     gsize stylesheet_data_len;
+    const char* stylesheet;
     char* mime_type = NULL;
 
     (void)a_media_list;
@@ -236,16 +444,18 @@ static void ccss_import_style(CRDocHandler* a_this,
         return;
 
     /* Accessing ctx from engine */
-    stylesheet_data = _rsvg_handle_acquire_data(user_data->engine->ctx, cr_string_peek_raw_str(a_uri), &mime_type,
-                                                &stylesheet_data_len, NULL);
+    stylesheet_data =
+        _rsvg_handle_acquire_data(user_data->engine->ctx, cr_string_peek_raw_str(a_uri), &mime_type, NULL);
     if (stylesheet_data == NULL || mime_type == NULL || strcmp(mime_type, "text/css") != 0) {
-        g_free(stylesheet_data);
+        if (stylesheet_data)
+            g_bytes_unref(stylesheet_data);
         g_free(mime_type);
         return;
     }
 
-    rsvg_css_engine_croco_parse_stylesheet((RsvgCssEngine*)user_data->engine, stylesheet_data, stylesheet_data_len);
-    g_free(stylesheet_data);
+    stylesheet = g_bytes_get_data(stylesheet_data, &stylesheet_data_len);
+    rsvg_css_engine_croco_parse_stylesheet((RsvgCssEngine*)user_data->engine, stylesheet, stylesheet_data_len);
+    g_bytes_unref(stylesheet_data);
     g_free(mime_type);
 }
 
@@ -277,126 +487,249 @@ static void apply_style(const gchar* key, StyleValueData* value, gpointer user_d
     rsvg_parse_style_pair(data->ctx, data->state, key, value->value, value->important);
 }
 
-static gboolean rsvg_lookup_apply_css_style(RsvgCssEngineCroco* self,
-                                            RsvgHandle* ctx,
-                                            const char* target,
-                                            RsvgState* state) {
-    GHashTable* styles;
+static void rsvg_css_rule_apply(const RsvgCssRule* rule, RsvgHandle* ctx, RsvgState* state) {
+    StylesData data;
 
-    styles = g_hash_table_lookup(self->css_props, target);
+    if (rule == NULL)
+        return;
 
-    if (styles != NULL) {
-        StylesData* data = g_new(StylesData, 1);
-        data->ctx = ctx;
-        data->state = state;
-        g_hash_table_foreach(styles, (GHFunc)apply_style, data);
-        g_free(data);
-        return TRUE;
-    }
-    return FALSE;
+    data.ctx = ctx;
+    data.state = state;
+    g_hash_table_foreach(rule->styles, (GHFunc)apply_style, &data);
 }
 
-static void rsvg_css_engine_croco_apply_styles(RsvgCssEngine* engine,
-                                               RsvgNode* node,
-                                               RsvgState* state,
-                                               const char* tag,
-                                               const char* klass,
-                                               const char* id,
-                                               RsvgPropertyBag* atts) {
-    RsvgCssEngineCroco* self = (RsvgCssEngineCroco*)engine;
-    RsvgHandle* ctx = self->ctx;
+/* Returns the most specific of the rules in the class bucket @rule that
+ * match an element with @tag and @id: tag.class#id, then .class#id, then
+ * tag.class, then .class.  Only that one applies.
+ */
+static const RsvgCssRule* rsvg_css_rule_find_for_class(const RsvgCssRule* rule, const char* tag, const char* id) {
+    const RsvgCssRule* best = NULL;
+    int best_rank = -1;
 
-    int i = 0, j = 0;
-    char* target = NULL;
-    gboolean found = FALSE;
-    GString* klazz_list = NULL;
+    for (; rule != NULL; rule = rule->next) {
+        int rank;
 
-    if (atts != NULL && rsvg_property_bag_size(atts) > 0)
-        rsvg_parse_style_pairs(ctx, state, atts);
+        if ((rule->tag != NULL && rule->tag != tag) || (rule->id != NULL && rule->id != id))
+            continue;
 
-    /* * */
-    rsvg_lookup_apply_css_style(self, ctx, "*", state);
+        rank = (rule->id != NULL ? 2 : 0) + (rule->tag != NULL ? 1 : 0);
+        if (rank > best_rank) {
+            best = rule;
+            best_rank = rank;
+        }
+    }
+
+    return best;
+}
 
-    /* tag */
-    if (tag != NULL) {
-        rsvg_lookup_apply_css_style(self, ctx, tag, state);
+/* Splits a class attribute into ".class" selectors, appended to @classes.
+ * They are interned if @interner is given and copied with g_strdup() if not.
+ */
+static void rsvg_css_engine_croco_split_classes(const char* klass, RsvgInterner* interner, GPtrArray* classes) {
+    GString* selector = g_string_new(NULL);
+    const char* p;
+
+    for (p = klass; *p != '\0';) {
+        while (g_ascii_isspace(*p))
+            p++;
+        if (*p == '\0')
+            break;
+
+        g_string_assign(selector, ".");
+        while (*p != '\0' && !g_ascii_isspace(*p))
+            g_string_append_c(selector, *p++);
+        if (interner != NULL)
+            g_ptr_array_add(classes, (gpointer)rsvg_interner_intern(interner, selector->str));
+        else
+            g_ptr_array_add(classes, g_strdup(selector->str));
     }
+    g_string_free(selector, TRUE);
+    g_ptr_array_add(classes, NULL);
+}
 
-    if (klass != NULL) {
-        i = strlen(klass);
-        while (j < i) {
-            found = FALSE;
-            klazz_list = g_string_new(".");
+/* Splits a class attribute into interned ".class" selectors.  Documents
+ * repeat the same few class attributes over and over, so the split is kept
+ * per interned attribute.
+ *
+ * While the engine is concurrent nothing may be added to the interner or
+ * the cache, so a class attribute that is not in the cache yet is split
+ * into *@scratch instead, with selectors that are not interned.
+ */
+static const char* const* rsvg_css_engine_croco_get_class_list(RsvgCssEngineCroco* self,
+                                                               const char* klass,
+                                                               GPtrArray** scratch) {
+    RsvgInterner* interner = self->ctx->priv->interner;
+    const char** list;
+    GPtrArray* classes;
+
+    if (self->concurrent) {
+        const char* interned = rsvg_interner_lookup(interner, klass);
+
+        list = interned != NULL ? g_hash_table_lookup(self->class_lists, interned) : NULL;
+        if (list != NULL)
+            return list;
+
+        *scratch = g_ptr_array_new_with_free_func(g_free);
+        rsvg_css_engine_croco_split_classes(klass, NULL, *scratch);
+        return (const char* const*)(*scratch)->pdata;
+    }
 
-            while (j < i && g_ascii_isspace(klass[j]))
-                j++;
+    klass = rsvg_interner_intern(interner, klass);
+    list = g_hash_table_lookup(self->class_lists, klass);
+    if (list != NULL)
+        return list;
 
-            while (j < i && !g_ascii_isspace(klass[j]))
-                g_string_append_c(klazz_list, klass[j++]);
+    classes = g_ptr_array_new();
+    rsvg_css_engine_croco_split_classes(klass, interner, classes);
 
-            /* tag.class#id */
-            if (tag != NULL && klazz_list->len != 1 && id != NULL) {
-                target = g_strdup_printf("%s%s#%s", tag, klazz_list->str, id);
-                found = found || rsvg_lookup_apply_css_style(self, ctx, target, state);
-                g_free(target);
-            }
+    list = rsvg_arena_memdup(self->ctx->priv->arena, classes->pdata, classes->len * sizeof(gpointer));
+    g_ptr_array_free(classes, TRUE);
+    g_hash_table_insert(self->class_lists, (gpointer)klass, list);
 
-            /* class#id */
-            if (klazz_list->len != 1 && id != NULL) {
-                target = g_strdup_printf("%s#%s", klazz_list->str, id);
-                found = found || rsvg_lookup_apply_css_style(self, ctx, target, state);
-                g_free(target);
-            }
+    return list;
+}
 
-            /* tag.class */
-            if (tag != NULL && klazz_list->len != 1) {
-                target = g_strdup_printf("%s%s", tag, klazz_list->str);
-                found = found || rsvg_lookup_apply_css_style(self, ctx, target, state);
-                g_free(target);
+/* Applies the stylesheet and then the style attribute @style to @state */
+static void rsvg_css_engine_croco_cascade(RsvgCssEngineCroco* self,
+                                          RsvgState* state,
+                                          const char* tag,
+                                          const char* klass,
+                                          const char* id,
+                                          const char* style) {
+    /* Rules apply in the order *, tag, one per class, #id, tag#id; every
+     * one of them is found through the index without building a selector.
+     */
+    if (self->n_rules > 0) {
+        RsvgInterner* interner = self->ctx->priv->interner;
+        const char* tag_key = tag != NULL ? rsvg_interner_lookup(interner, tag) : NULL;
+        const char* id_key = id != NULL ? rsvg_interner_lookup(interner, id) : NULL;
+        RsvgCssRule* id_bucket = id_key != NULL ? g_hash_table_lookup(self->id_rules, id_key) : NULL;
+
+        rsvg_css_rule_apply(self->universal_rule, self->ctx, state);
+
+        if (tag_key != NULL)
+            rsvg_css_rule_apply(g_hash_table_lookup(self->tag_rules, tag_key), self->ctx, state);
+
+        if (klass != NULL && g_hash_table_size(self->class_rules) > 0) {
+            GPtrArray* scratch = NULL;
+            const char* const* classes = rsvg_css_engine_croco_get_class_list(self, klass, &scratch);
+
+            for (; *classes != NULL; classes++) {
+                const char* key = scratch != NULL ? rsvg_interner_lookup(interner, *classes) : *classes;
+
+                if (key != NULL)
+                    rsvg_css_rule_apply(
+                        rsvg_css_rule_find_for_class(g_hash_table_lookup(self->class_rules, key), tag_key, id_key),
+                        self->ctx, state);
             }
 
-            /* didn't find anything more specific, just apply the class style */
-            if (!found) {
-                found = found || rsvg_lookup_apply_css_style(self, ctx, klazz_list->str, state);
-            }
-            g_string_free(klazz_list, TRUE);
+            if (scratch != NULL)
+                g_ptr_array_free(scratch, TRUE);
+        }
+
+        if (id_bucket != NULL) {
+            rsvg_css_rule_apply(rsvg_css_rule_find(id_bucket, NULL, id_key), self->ctx, state);
+            if (tag_key != NULL)
+                rsvg_css_rule_apply(rsvg_css_rule_find(id_bucket, tag_key, id_key), self->ctx, state);
         }
     }
 
-    /* #id */
-    if (id != NULL) {
-        target = g_strdup_printf("#%s", id);
-        rsvg_lookup_apply_css_style(self, ctx, target, state);
-        g_free(target);
+    if (style != NULL)
+        rsvg_parse_style(self->ctx, state, style);
+}
+
+/* Like rsvg_css_engine_croco_cascade(), for a @state that is as
+ * rsvg_state_init() left it; see RSVG_STYLE_SHARE_MAX_ENTRIES
+ */
+static void rsvg_css_engine_croco_cascade_shared(RsvgCssEngineCroco* self,
+                                                 RsvgState* state,
+                                                 const char* tag,
+                                                 const char* klass,
+                                                 const char* id,
+                                                 const char* style) {
+    RsvgInterner* interner = self->ctx->priv->interner;
+    RsvgStyleShareKey key;
+    RsvgStyleShareEntry* entry;
+
+    key.tag = tag != NULL ? rsvg_interner_intern(interner, tag) : NULL;
+    key.klass = klass != NULL ? rsvg_interner_intern(interner, klass) : NULL;
+    key.style = style != NULL ? rsvg_interner_intern(interner, style) : NULL;
+    key.id = id != NULL ? rsvg_interner_lookup(interner, id) : NULL;
+    if (key.id != NULL && !g_hash_table_contains(self->rule_ids, key.id))
+        key.id = NULL;
+
+    entry = g_hash_table_lookup(self->shared_styles, &key);
+    if (entry != NULL) {
+        self->share_hits++;
+        rsvg_state_clone(state, &entry->state);
+        return;
     }
 
-    /* tag#id */
-    if (tag != NULL && id != NULL) {
-        target = g_strdup_printf("%s#%s", tag, id);
-        rsvg_lookup_apply_css_style(self, ctx, target, state);
-        g_free(target);
+    self->share_misses++;
+    rsvg_css_engine_croco_cascade(self, state, tag, klass, id, style);
+
+    if (g_hash_table_size(self->shared_styles) < RSVG_STYLE_SHARE_MAX_ENTRIES) {
+        entry = g_new(RsvgStyleShareEntry, 1);
+        entry->key = key;
+        rsvg_state_init(&entry->state);
+        rsvg_state_clone(&entry->state, state);
+        g_hash_table_insert(self->shared_styles, &entry->key, entry);
     }
+}
+
+static void rsvg_css_engine_croco_apply_styles(RsvgCssEngine* engine,
+                                               RsvgNode* node,
+                                               RsvgState* state,
+                                               const char* tag,
+                                               const char* klass,
+                                               const char* id,
+                                               RsvgPropertyBag* atts) {
+    RsvgCssEngineCroco* self = (RsvgCssEngineCroco*)engine;
 
     if (atts != NULL && rsvg_property_bag_size(atts) > 0) {
-        const char* value;
+        const char* style = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STYLE);
+        const char* transform = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TRANSFORM);
 
-        if ((value = rsvg_property_bag_lookup(atts, "style")) != NULL)
-            rsvg_parse_style(ctx, state, value);
-        if ((value = rsvg_property_bag_lookup(atts, "transform")) != NULL)
-            rsvg_parse_transform_attr(ctx, state, value);
+        gboolean presentational = rsvg_parse_style_pairs(self->ctx, state, atts);
+
+        if (presentational || self->concurrent || (self->n_rules == 0 && style == NULL))
+            rsvg_css_engine_croco_cascade(self, state, tag, klass, id, style);
+        else
+            rsvg_css_engine_croco_cascade_shared(self, state, tag, klass, id, style);
+
+        if (transform != NULL)
+            rsvg_parse_transform_attr(self->ctx, state, transform);
     }
-    else if (node != NULL && node->style_attr != NULL) {
-        rsvg_parse_style(ctx, state, node->style_attr);
+    else {
+        rsvg_css_engine_croco_cascade(self, state, tag, klass, id, node != NULL ? node->style_attr : NULL);
     }
 }
 
+static void rsvg_css_engine_croco_set_concurrent(RsvgCssEngine* engine, gboolean concurrent) {
+    ((RsvgCssEngineCroco*)engine)->concurrent = concurrent;
+}
+
+static void rsvg_css_engine_croco_get_share_stats(RsvgCssEngine* engine, guint* hits, guint* misses) {
+    RsvgCssEngineCroco* self = (RsvgCssEngineCroco*)engine;
+
+    *hits = self->share_hits;
+    *misses = self->share_misses;
+}
+
 static const RsvgCssEngineVtable rsvg_css_engine_croco_vtable = {
-    rsvg_css_engine_croco_free, rsvg_css_engine_croco_parse_stylesheet, rsvg_css_engine_croco_apply_styles};
+    rsvg_css_engine_croco_free, rsvg_css_engine_croco_parse_stylesheet, rsvg_css_engine_croco_apply_styles,
+    rsvg_css_engine_croco_set_concurrent, rsvg_css_engine_croco_get_share_stats};
 
 RsvgCssEngine* rsvg_css_engine_croco_new(RsvgHandle* ctx) {
     RsvgCssEngineCroco* self = g_new0(RsvgCssEngineCroco, 1);
     self->parent.vtable = &rsvg_css_engine_croco_vtable;
-    self->css_props = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_hash_table_destroy);
+    self->tag_rules = rsvg_css_rule_table_new();
+    self->class_rules = rsvg_css_rule_table_new();
+    self->id_rules = rsvg_css_rule_table_new();
+    self->rule_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->shared_styles = g_hash_table_new_full(rsvg_style_share_key_hash, rsvg_style_share_key_equal, NULL,
+                                                (GDestroyNotify)rsvg_style_share_entry_free);
+    self->class_lists = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->ctx = ctx;
     return (RsvgCssEngine*)self;
 }
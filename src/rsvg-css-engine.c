@@ -31,3 +31,16 @@ void rsvg_css_engine_apply_styles(RsvgCssEngine* engine,
         engine->vtable->apply_styles(engine, node, state, tag, klass, id, atts);
     }
 }
+
+void rsvg_css_engine_set_concurrent(RsvgCssEngine* engine, gboolean concurrent) {
+    if (engine && engine->vtable && engine->vtable->set_concurrent) {
+        engine->vtable->set_concurrent(engine, concurrent);
+    }
+}
+
+void rsvg_css_engine_get_share_stats(RsvgCssEngine* engine, guint* hits, guint* misses) {
+    *hits = *misses = 0;
+    if (engine && engine->vtable && engine->vtable->get_share_stats) {
+        engine->vtable->get_share_stats(engine, hits, misses);
+    }
+}
@@ -25,6 +25,8 @@ struct _RsvgCssEngineVtable {
                          const char* klass,
                          const char* id,
                          RsvgPropertyBag* atts);
+    void (*set_concurrent)(RsvgCssEngine* engine, gboolean concurrent);
+    void (*get_share_stats)(RsvgCssEngine* engine, guint* hits, guint* misses);
 };
 
 struct _RsvgCssEngine {
@@ -37,6 +39,10 @@ void rsvg_css_engine_free(RsvgCssEngine* engine);
 G_GNUC_INTERNAL
 gboolean rsvg_css_engine_parse_stylesheet(RsvgCssEngine* engine, const char* data, size_t len);
 
+/* With @atts, @state is a newly initialized state, which the presentation
+ * attributes in @atts are applied to first.  Without, it is a copy of the
+ * node's state from before any stylesheet was set from outside.
+ */
 G_GNUC_INTERNAL
 void rsvg_css_engine_apply_styles(RsvgCssEngine* engine,
                                   RsvgNode* node,
@@ -46,6 +52,19 @@ void rsvg_css_engine_apply_styles(RsvgCssEngine* engine,
                                   const char* id,
                                   RsvgPropertyBag* atts);
 
+/* While concurrent, apply_styles may run on several threads at once, each
+ * with its own state, and leaves the engine and the handle untouched.  No
+ * stylesheet may be parsed in the meantime.
+ */
+G_GNUC_INTERNAL
+void rsvg_css_engine_set_concurrent(RsvgCssEngine* engine, gboolean concurrent);
+
+/* How many elements took their styles from an earlier element with the same
+ * tag, classes and style attribute, and how many had to be matched
+ */
+G_GNUC_INTERNAL
+void rsvg_css_engine_get_share_stats(RsvgCssEngine* engine, guint* hits, guint* misses);
+
 /* Factory for default (Libcroco) engine */
 G_GNUC_INTERNAL
 RsvgCssEngine* rsvg_css_engine_croco_new(RsvgHandle* ctx);
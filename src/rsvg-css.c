@@ -27,6 +27,7 @@
 #include "config.h"
 #define _GNU_SOURCE 1
 #include "rsvg-css.h"
+#include "rsvg-number.h"
 #include "rsvg-private.h"
 #include "rsvg-styles.h"
 #include "rsvg-xml.h"
@@ -76,31 +77,31 @@
  */
 RsvgViewBox rsvg_css_parse_vbox(const char* vbox) {
     RsvgViewBox vb;
-    gdouble* list;
-    guint list_len;
+    double list[4];
+    const char* token;
+    gsize token_len;
+    guint i;
+
     vb.active = FALSE;
 
     vb.rect.x = vb.rect.y = 0;
     vb.rect.width = vb.rect.height = 0;
 
-    list = rsvg_css_parse_number_list(vbox, &list_len);
+    for (i = 0; i < G_N_ELEMENTS(list); i++)
+        if (!rsvg_scan_list_number(&vbox, &list[i]))
+            return vb;
 
-    if (!(list && list_len))
-        return vb;
-    else if (list_len != 4) {
-        g_free(list);
+    /* exactly four numbers */
+    if (rsvg_scan_list_token(&vbox, &token, &token_len))
         return vb;
-    }
-    else {
-        vb.rect.x = list[0];
-        vb.rect.y = list[1];
-        vb.rect.width = list[2];
-        vb.rect.height = list[3];
-        vb.active = TRUE;
 
-        g_free(list);
-        return vb;
-    }
+    vb.rect.x = list[0];
+    vb.rect.y = list[1];
+    vb.rect.width = list[2];
+    vb.rect.height = list[3];
+    vb.active = TRUE;
+
+    return vb;
 }
 
 typedef enum _RelativeSize { RELATIVE_SIZE_NORMAL, RELATIVE_SIZE_SMALLER, RELATIVE_SIZE_LARGER } RelativeSize;
@@ -112,7 +113,7 @@ static double rsvg_css_parse_raw_length(const char* str,
                                         gboolean* ex,
                                         RelativeSize* relative_size) {
     double length = 0.0;
-    char* p = NULL;
+    const char* p;
 
     /*
      *  The supported CSS length unit specifiers are:
@@ -123,15 +124,21 @@ static double rsvg_css_parse_raw_length(const char* str,
     *ex = FALSE;
     *relative_size = RELATIVE_SIZE_NORMAL;
 
-    length = g_ascii_strtod(str, &p);
+    p = str;
+    while (g_ascii_isspace(*p))
+        p++;
+
+    /* without a number the whole string is taken as the unit */
+    if (!rsvg_scan_number(&p, &length))
+        p = str;
 
-    if ((length == -HUGE_VAL || length == HUGE_VAL) && (ERANGE == errno)) {
+    if (isinf(length)) {
         /* todo: error condition - figure out how to best represent it */
         return 0.0;
     }
 
     /* test for either pixels or no unit, which is assumed to be pixels */
-    if (p && *p && (strcmp(p, "px") != 0)) {
+    if (*p && (strcmp(p, "px") != 0)) {
         if (!strcmp(p, "pt")) {
             length /= POINTS_PER_INCH;
             *in = TRUE;
@@ -226,27 +233,9 @@ RsvgLength _rsvg_css_parse_length(const char* str) {
     return out;
 }
 
-/* Recursive evaluation of all parent elements regarding absolute font size */
-double _rsvg_css_normalize_font_size(RsvgState* state, RsvgDrawingCtx* ctx) {
-    RsvgState* parent;
-
-    switch (state->font_size.factor) {
-        case 'p':
-        case 'm':
-        case 'x':
-            parent = rsvg_state_parent(state);
-            if (parent) {
-                double parent_size;
-                parent_size = _rsvg_css_normalize_font_size(parent, ctx);
-                return state->font_size.length * parent_size;
-            }
-            break;
-        default:
-            return _rsvg_css_normalize_length(&state->font_size, ctx, 'v');
-            break;
-    }
-
-    return 12.;
+/* The absolute font size, resolved when @state was pushed */
+double _rsvg_css_normalize_font_size(RsvgState* state) {
+    return rsvg_state_font_size(state);
 }
 
 double _rsvg_css_normalize_length(const RsvgLength* in, RsvgDrawingCtx* ctx, char dir) {
@@ -261,7 +250,7 @@ double _rsvg_css_normalize_length(const RsvgLength* in, RsvgDrawingCtx* ctx, cha
             return in->length * rsvg_viewport_percentage(ctx->vb.rect.width, ctx->vb.rect.height);
     }
     else if (in->factor == 'm' || in->factor == 'x') {
-        double font = _rsvg_css_normalize_font_size(rsvg_current_state(ctx), ctx);
+        double font = _rsvg_css_normalize_font_size(rsvg_current_state(ctx));
         if (in->factor == 'm')
             return in->length * font;
         else
@@ -285,22 +274,11 @@ double _rsvg_css_normalize_length(const RsvgLength* in, RsvgDrawingCtx* ctx, cha
     return 0;
 }
 
-/* Recursive evaluation of all parent elements regarding basline-shift */
-double _rsvg_css_accumulate_baseline_shift(RsvgState* state, RsvgDrawingCtx* ctx) {
-    RsvgState* parent;
-    double shift = 0.;
-
-    parent = rsvg_state_parent(state);
-    if (parent) {
-        if (state->has_baseline_shift) {
-            double parent_font_size;
-            parent_font_size = _rsvg_css_normalize_font_size(parent, ctx); /* font size from here */
-            shift = parent_font_size * state->baseline_shift;
-        }
-        shift += _rsvg_css_accumulate_baseline_shift(parent, ctx); /* baseline-shift for parent element */
-    }
-
-    return shift;
+/* The baseline shift of @state and all its parents, resolved when @state
+ * was pushed
+ */
+double _rsvg_css_accumulate_baseline_shift(RsvgState* state) {
+    return rsvg_state_baseline_shift(state);
 }
 
 double _rsvg_css_hand_normalize_length(const RsvgLength* in,
@@ -651,106 +629,49 @@ const char* rsvg_css_parse_font_family(const char* str, gboolean* inherit) {
         return str;
 }
 
-#if !defined(HAVE_STRTOK_R)
-
-static char* strtok_r(char* s, const char* delim, char** last) {
-    char* p;
-
-    if (s == NULL)
-        s = *last;
-
-    if (s == NULL)
-        return NULL;
-
-    while (*s && strchr(delim, *s))
-        s++;
-
-    if (*s == '\0') {
-        *last = NULL;
-        return NULL;
-    }
-
-    p = s;
-    while (*p && !strchr(delim, *p))
-        p++;
-
-    if (*p == '\0')
-        *last = NULL;
-    else {
-        *p = '\0';
-        p++;
-        *last = p;
-    }
-
-    return s;
-}
-
-#endif /* !HAVE_STRTOK_R */
-
 gchar** rsvg_css_parse_list(const char* in_str, guint* out_list_len) {
-    char *ptr, *tok;
-    char* str;
-
-    guint n = 0;
-    GSList* string_list = NULL;
-    gchar** string_array = NULL;
-
-    str = g_strdup(in_str);
-    tok = strtok_r(str, ", \t", &ptr);
-    if (tok != NULL) {
-        if (strcmp(tok, " ") != 0) {
-            string_list = g_slist_prepend(string_list, g_strdup(tok));
-            n++;
-        }
+    const char* p;
+    const char* token;
+    gsize token_len;
+    guint n, i;
+    gchar** string_array;
 
-        while ((tok = strtok_r(NULL, ", \t", &ptr)) != NULL) {
-            if (strcmp(tok, " ") != 0) {
-                string_list = g_slist_prepend(string_list, g_strdup(tok));
-                n++;
-            }
-        }
-    }
-    g_free(str);
+    n = rsvg_scan_list_count(in_str);
 
     if (out_list_len)
         *out_list_len = n;
 
-    if (string_list) {
-        GSList* slist;
-        guint i = n;
-
-        string_array = g_new(gchar*, n + 1);
+    if (n == 0)
+        return NULL;
 
-        string_array[i--] = NULL;
-        for (slist = string_list; slist; slist = slist->next)
-            string_array[i--] = (gchar*)slist->data;
+    string_array = g_new(gchar*, n + 1);
 
-        g_slist_free(string_list);
-    }
+    p = in_str;
+    for (i = 0; i < n && rsvg_scan_list_token(&p, &token, &token_len); i++)
+        string_array[i] = g_strndup(token, token_len);
+    string_array[i] = NULL;
 
     return string_array;
 }
 
 gdouble* rsvg_css_parse_number_list(const char* in_str, guint* out_list_len) {
-    gchar** string_array;
+    const char* p;
     gdouble* output;
     guint len, i;
 
     if (out_list_len)
         *out_list_len = 0;
 
-    string_array = rsvg_css_parse_list(in_str, &len);
-
-    if (!(string_array && len))
+    len = rsvg_scan_list_count(in_str);
+    if (len == 0)
         return NULL;
 
     output = g_new(gdouble, len);
 
     /* TODO: some error checking */
-    for (i = 0; i < len; i++)
-        output[i] = g_ascii_strtod(string_array[i], NULL);
-
-    g_strfreev(string_array);
+    p = in_str;
+    for (i = 0; i < len && rsvg_scan_list_number(&p, &output[i]); i++)
+        ;
 
     if (out_list_len != NULL)
         *out_list_len = len;
@@ -759,57 +680,66 @@ gdouble* rsvg_css_parse_number_list(const char* in_str, guint* out_list_len) {
 }
 
 void rsvg_css_parse_number_optional_number(const char* str, double* x, double* y) {
-    char* endptr;
+    const char* p = str;
 
     /* TODO: some error checking */
 
-    *x = g_ascii_strtod(str, &endptr);
+    while (g_ascii_isspace(*p))
+        p++;
 
-    if (endptr && *endptr != '\0')
-        while (g_ascii_isspace(*endptr) && *endptr)
-            endptr++;
+    if (!rsvg_scan_number(&p, x))
+        *x = 0.0;
+
+    while (g_ascii_isspace(*p))
+        p++;
+    if (*p == ',') {
+        p++;
+        while (g_ascii_isspace(*p))
+            p++;
+    }
 
-    if (endptr && *endptr)
-        *y = g_ascii_strtod(endptr, NULL);
+    if (*p) {
+        if (!rsvg_scan_number(&p, y))
+            *y = 0.0;
+    }
     else
         *y = *x;
 }
 
+static const struct {
+    const char* name;
+    int ratio;
+} aspect_ratio_keywords[] = {
+    {"xMinYMin", RSVG_ASPECT_RATIO_XMIN_YMIN}, {"xMidYMin", RSVG_ASPECT_RATIO_XMID_YMIN},
+    {"xMaxYMin", RSVG_ASPECT_RATIO_XMAX_YMIN}, {"xMinYMid", RSVG_ASPECT_RATIO_XMIN_YMID},
+    {"xMidYMid", RSVG_ASPECT_RATIO_XMID_YMID}, {"xMaxYMid", RSVG_ASPECT_RATIO_XMAX_YMID},
+    {"xMinYMax", RSVG_ASPECT_RATIO_XMIN_YMAX}, {"xMidYMax", RSVG_ASPECT_RATIO_XMID_YMAX},
+    {"xMaxYMax", RSVG_ASPECT_RATIO_XMAX_YMAX},
+};
+
 int rsvg_css_parse_aspect_ratio(const char* str) {
-    char** elems;
-    guint nb_elems;
+    const char* token;
+    gsize token_len;
+    guint i;
 
     int ratio = RSVG_ASPECT_RATIO_NONE;
 
-    elems = rsvg_css_parse_list(str, &nb_elems);
-
-    if (elems && nb_elems) {
-        guint i;
-
-        for (i = 0; i < nb_elems; i++) {
-            if (!strcmp(elems[i], "xMinYMin"))
-                ratio = RSVG_ASPECT_RATIO_XMIN_YMIN;
-            else if (!strcmp(elems[i], "xMidYMin"))
-                ratio = RSVG_ASPECT_RATIO_XMID_YMIN;
-            else if (!strcmp(elems[i], "xMaxYMin"))
-                ratio = RSVG_ASPECT_RATIO_XMAX_YMIN;
-            else if (!strcmp(elems[i], "xMinYMid"))
-                ratio = RSVG_ASPECT_RATIO_XMIN_YMID;
-            else if (!strcmp(elems[i], "xMidYMid"))
-                ratio = RSVG_ASPECT_RATIO_XMID_YMID;
-            else if (!strcmp(elems[i], "xMaxYMid"))
-                ratio = RSVG_ASPECT_RATIO_XMAX_YMID;
-            else if (!strcmp(elems[i], "xMinYMax"))
-                ratio = RSVG_ASPECT_RATIO_XMIN_YMAX;
-            else if (!strcmp(elems[i], "xMidYMax"))
-                ratio = RSVG_ASPECT_RATIO_XMID_YMAX;
-            else if (!strcmp(elems[i], "xMaxYMax"))
-                ratio = RSVG_ASPECT_RATIO_XMAX_YMAX;
-            else if (!strcmp(elems[i], "slice"))
-                ratio |= RSVG_ASPECT_RATIO_SLICE;
+    while (rsvg_scan_list_token(&str, &token, &token_len)) {
+        if (token_len == 5 && !memcmp(token, "slice", 5)) {
+            ratio |= RSVG_ASPECT_RATIO_SLICE;
+            continue;
         }
 
-        g_strfreev(elems);
+        /* every alignment keyword is eight characters long */
+        if (token_len != 8)
+            continue;
+
+        for (i = 0; i < G_N_ELEMENTS(aspect_ratio_keywords); i++) {
+            if (!memcmp(token, aspect_ratio_keywords[i].name, 8)) {
+                ratio = aspect_ratio_keywords[i].ratio;
+                break;
+            }
+        }
     }
 
     return ratio;
@@ -26,6 +26,7 @@
 #include "config.h"
 #include "rsvg-private.h"
 #include "rsvg-defs.h"
+#include "rsvg-extern-cache.h"
 #include "rsvg-styles.h"
 #include "rsvg-io.h"
 
@@ -35,41 +36,110 @@ struct _RsvgDefs {
     GHashTable* hash;
     GPtrArray* unnamed;
     GHashTable* externs;
+    GMutex externs_lock; /* externs are loaded on demand, possibly while several threads render */
     RsvgHandle* ctx;
 };
 
 RsvgDefs* rsvg_defs_new(RsvgHandle* handle) {
     RsvgDefs* result = g_new(RsvgDefs, 1);
 
-    result->hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    /* keyed by the names interned in the handle */
+    result->hash = g_hash_table_new(g_direct_hash, g_direct_equal);
     result->externs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
     result->unnamed = g_ptr_array_new();
+    g_mutex_init(&result->externs_lock);
     result->ctx = handle; /* no need to take a ref here */
 
     return result;
 }
 
+static RsvgNode* rsvg_defs_lookup_name(const RsvgDefs* defs, const char* name) {
+    const char* interned;
+
+    /* a name the document never interned cannot belong to any element */
+    interned = rsvg_interner_lookup(defs->ctx->priv->interner, name);
+    if (interned == NULL)
+        return NULL;
+
+    return g_hash_table_lookup(defs->hash, interned);
+}
+
 static RsvgHandle* rsvg_defs_load_extern(const RsvgDefs* defs, const char* uri) {
     RsvgHandle* handle = NULL;
-    char* data;
-    gsize data_len;
+    GBytes* data;
+    char* key;
 
-    data = _rsvg_handle_acquire_data(defs->ctx, uri, NULL, &data_len, NULL);
+    key = rsvg_extern_cache_make_key(uri);
+
+    /* only share a document with a handle that would be allowed to load it */
+    if (key != NULL && rsvg_allow_load(defs->ctx->priv->base_gfile, uri, NULL)) {
+        handle = rsvg_extern_cache_lookup(key);
+        if (handle != NULL) {
+            g_free(key);
+            return handle;
+        }
+    }
+
+    data = _rsvg_handle_acquire_data(defs->ctx, uri, NULL, NULL);
 
     if (data) {
+        gsize data_len;
+        const guchar* buf = g_bytes_get_data(data, &data_len);
+
         handle = rsvg_handle_new();
+        handle->priv->is_extern = TRUE;
         rsvg_handle_set_base_uri(handle, uri);
 
-        if (rsvg_handle_write(handle, (guchar*)data, data_len, NULL) && rsvg_handle_close(handle, NULL)) {
-            g_hash_table_insert(defs->externs, g_strdup(uri), handle);
+        if (rsvg_handle_write(handle, buf, data_len, NULL) && rsvg_handle_close(handle, NULL)) {
+            if (key != NULL)
+                rsvg_extern_cache_insert(key, handle);
         }
         else {
             g_object_unref(handle);
             handle = NULL;
         }
 
-        g_free(data);
+        g_bytes_unref(data);
+    }
+
+    g_free(key);
+
+    return handle;
+}
+
+/* Returns the document at @uri, loading it if need be.  The loading happens
+ * outside the lock, so that prefetch threads can load several documents at
+ * once; if two of them load the same one, the first to finish wins.
+ */
+static RsvgHandle* rsvg_defs_get_extern(const RsvgDefs* defs, const char* uri) {
+    GMutex* lock = (GMutex*)&defs->externs_lock;
+    RsvgHandle* handle;
+    RsvgHandle* loaded;
+
+    g_mutex_lock(lock);
+    handle = (RsvgHandle*)g_hash_table_lookup(defs->externs, uri);
+    g_mutex_unlock(lock);
+
+    if (handle != NULL)
+        return handle;
+
+    loaded = rsvg_defs_load_extern(defs, uri);
+    if (loaded == NULL)
+        return NULL;
+
+    /* the loaded documents are never modified again, so only the table
+     * itself needs the lock
+     */
+    g_mutex_lock(lock);
+    handle = (RsvgHandle*)g_hash_table_lookup(defs->externs, uri);
+    if (handle == NULL) {
+        g_hash_table_insert(defs->externs, g_strdup(uri), loaded);
+        handle = g_steal_pointer(&loaded);
     }
+    g_mutex_unlock(lock);
+
+    if (loaded != NULL)
+        g_object_unref(loaded);
 
     return handle;
 }
@@ -82,17 +152,34 @@ static RsvgNode* rsvg_defs_extern_lookup(const RsvgDefs* defs, const char* possi
     if (!uri)
         return NULL;
 
-    handle = (RsvgHandle*)g_hash_table_lookup(defs->externs, uri);
-    if (handle == NULL) {
-        handle = rsvg_defs_load_extern(defs, uri);
-    }
+    handle = rsvg_defs_get_extern(defs, uri);
+    g_free(uri);
 
     if (handle != NULL)
-        return g_hash_table_lookup(handle->priv->defs->hash, name);
+        return rsvg_defs_lookup_name(handle->priv->defs, name);
     else
         return NULL;
 }
 
+void rsvg_defs_prefetch(const RsvgDefs* defs, const char* name) {
+    const char* hashpos;
+    char* possibly_relative_uri;
+    char* uri;
+
+    /* the same split as rsvg_defs_lookup() */
+    hashpos = g_strrstr(name, "#");
+    if (hashpos == NULL || hashpos == name)
+        return;
+
+    possibly_relative_uri = g_strndup(name, hashpos - name);
+    uri = rsvg_handle_resolve_uri(defs->ctx, possibly_relative_uri);
+    g_free(possibly_relative_uri);
+
+    if (uri != NULL)
+        rsvg_defs_get_extern(defs, uri);
+    g_free(uri);
+}
+
 RsvgNode* rsvg_defs_lookup(const RsvgDefs* defs, const char* name) {
     char* hashpos;
     hashpos = g_strrstr(name, "#");
@@ -100,7 +187,7 @@ RsvgNode* rsvg_defs_lookup(const RsvgDefs* defs, const char* name) {
         return NULL;
     }
     if (hashpos == name) {
-        return g_hash_table_lookup(defs->hash, name + 1);
+        return rsvg_defs_lookup_name(defs, name + 1);
     }
     else {
         gchar** splitbits;
@@ -123,10 +210,12 @@ void rsvg_defs_set(RsvgDefs* defs, const char* name, RsvgNode* val) {
 }
 
 void rsvg_defs_register_name(RsvgDefs* defs, const char* name, RsvgNode* val) {
-    if (g_hash_table_lookup(defs->hash, name))
+    const char* interned = rsvg_interner_intern(defs->ctx->priv->interner, name);
+
+    if (g_hash_table_lookup(defs->hash, interned))
         return;
 
-    g_hash_table_insert(defs->hash, g_strdup(name), val);
+    g_hash_table_insert(defs->hash, (gpointer)interned, val);
 }
 
 void rsvg_defs_register_memory(RsvgDefs* defs, RsvgNode* val) {
@@ -143,6 +232,7 @@ void rsvg_defs_free(RsvgDefs* defs) {
     g_ptr_array_free(defs->unnamed, TRUE);
 
     g_hash_table_destroy(defs->externs);
+    g_mutex_clear(&defs->externs_lock);
 
     g_free(defs);
 }
@@ -39,6 +39,12 @@ G_GNUC_INTERNAL
 RsvgDefs* rsvg_defs_new(RsvgHandle* handle);
 /* for some reason this one's public... */
 RsvgNode* rsvg_defs_lookup(const RsvgDefs* defs, const char* name);
+/* Loads the other document that @name, a reference like "other.svg#id",
+ * points into, so that looking it up later finds it loaded.  Safe to call
+ * from a prefetch thread.
+ */
+G_GNUC_INTERNAL
+void rsvg_defs_prefetch(const RsvgDefs* defs, const char* name);
 G_GNUC_INTERNAL
 void rsvg_defs_set(RsvgDefs* defs, const char* name, RsvgNode* val);
 G_GNUC_INTERNAL
@@ -0,0 +1,202 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-extern-cache.c: Process-wide cache of external documents
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#include "config.h"
+#include "rsvg-extern-cache.h"
+
+#include <gio/gio.h>
+
+/* Documents referred to from other documents, shared by every handle in
+ * the process.  A document here was loaded with the default flags and its
+ * own base URI, so it looks the same from every handle that refers to it,
+ * and is never modified once loaded, so that handles on any thread can
+ * render from it at once.
+ */
+
+/* what tells one version of a file from the next */
+#define EXTERN_CACHE_ATTRIBUTES \
+    G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC "," G_FILE_ATTRIBUTE_STANDARD_SIZE
+
+typedef struct {
+    char* key;
+    RsvgHandle* handle;
+} RsvgExternCacheEntry;
+
+static GMutex extern_cache_lock;
+static GHashTable* extern_cache_table; /* key -> link in extern_cache_lru */
+static GQueue extern_cache_lru = G_QUEUE_INIT; /* most recently used first */
+static guint extern_cache_max_size;
+static guint64 extern_cache_hits;
+static guint64 extern_cache_misses;
+
+static void rsvg_extern_cache_entry_free(RsvgExternCacheEntry* entry) {
+    g_free(entry->key);
+    g_object_unref(entry->handle);
+    g_free(entry);
+}
+
+/* Called with the lock held */
+static void rsvg_extern_cache_trim(guint max_size) {
+    while (extern_cache_lru.length > max_size) {
+        RsvgExternCacheEntry* entry = g_queue_pop_tail(&extern_cache_lru);
+
+        g_hash_table_remove(extern_cache_table, entry->key);
+        rsvg_extern_cache_entry_free(entry);
+    }
+}
+
+char* rsvg_extern_cache_make_key(const char* uri) {
+    GFile* file;
+    GFileInfo* info;
+    char* key = NULL;
+    gboolean enabled;
+
+    g_mutex_lock(&extern_cache_lock);
+    enabled = extern_cache_max_size > 0;
+    g_mutex_unlock(&extern_cache_lock);
+
+    if (!enabled)
+        return NULL;
+
+    file = g_file_new_for_uri(uri);
+    if (!g_file_is_native(file)) {
+        g_object_unref(file);
+        return NULL;
+    }
+
+    info = g_file_query_info(file, EXTERN_CACHE_ATTRIBUTES, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+    if (info != NULL) {
+        /* a URI has no spaces, so these cannot run into each other */
+        key = g_strdup_printf("%s %" G_GUINT64_FORMAT ".%06u %" G_GOFFSET_FORMAT, uri,
+                              g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                              g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+                              g_file_info_get_size(info));
+        g_object_unref(info);
+    }
+
+    g_object_unref(file);
+
+    return key;
+}
+
+RsvgHandle* rsvg_extern_cache_lookup(const char* key) {
+    RsvgHandle* handle = NULL;
+    GList* link = NULL;
+
+    g_mutex_lock(&extern_cache_lock);
+
+    if (extern_cache_table != NULL)
+        link = g_hash_table_lookup(extern_cache_table, key);
+
+    if (link != NULL) {
+        g_queue_unlink(&extern_cache_lru, link);
+        g_queue_push_head_link(&extern_cache_lru, link);
+
+        handle = g_object_ref(((RsvgExternCacheEntry*)link->data)->handle);
+        extern_cache_hits++;
+    }
+    else {
+        extern_cache_misses++;
+    }
+
+    g_mutex_unlock(&extern_cache_lock);
+
+    return handle;
+}
+
+void rsvg_extern_cache_insert(const char* key, RsvgHandle* handle) {
+    RsvgExternCacheEntry* entry;
+
+    g_mutex_lock(&extern_cache_lock);
+
+    /* another handle may have loaded the same document meanwhile */
+    if (extern_cache_max_size == 0 || g_hash_table_contains(extern_cache_table, key)) {
+        g_mutex_unlock(&extern_cache_lock);
+        return;
+    }
+
+    entry = g_new(RsvgExternCacheEntry, 1);
+    entry->key = g_strdup(key);
+    entry->handle = g_object_ref(handle);
+
+    g_queue_push_head(&extern_cache_lru, entry);
+    g_hash_table_insert(extern_cache_table, entry->key, extern_cache_lru.head);
+    rsvg_extern_cache_trim(extern_cache_max_size);
+
+    g_mutex_unlock(&extern_cache_lock);
+}
+
+void rsvg_extern_cache_clear(void) {
+    g_mutex_lock(&extern_cache_lock);
+    rsvg_extern_cache_trim(0);
+    g_mutex_unlock(&extern_cache_lock);
+}
+
+/**
+ * rsvg_set_extern_cache_size:
+ * @max_documents: how many documents to keep, or 0 to disable the cache
+ *
+ * Sets up a cache of external documents that is shared by every handle in
+ * the process.  When an element refers to an element in another file, as
+ * in &lt;use xlink:href="sprites.svg#icon"/&gt;, that file is normally
+ * loaded again for each handle that refers to it.  With the cache, it is
+ * loaded once and shared by all of them for as long as the file keeps its
+ * modification time and size.  At most @max_documents are kept, and the
+ * least recently used one is dropped first.
+ *
+ * Only local files are cached.  The cache is disabled by default; setting
+ * the size to 0 disables it again and drops everything in it.
+ *
+ * Since: 2.52
+ */
+void rsvg_set_extern_cache_size(guint max_documents) {
+    g_mutex_lock(&extern_cache_lock);
+
+    if (extern_cache_table == NULL)
+        extern_cache_table = g_hash_table_new(g_str_hash, g_str_equal);
+
+    extern_cache_max_size = max_documents;
+    rsvg_extern_cache_trim(max_documents);
+
+    g_mutex_unlock(&extern_cache_lock);
+}
+
+/**
+ * rsvg_get_extern_cache_stats:
+ * @hits: (out) (optional): where to store how many times a cached document was used
+ * @misses: (out) (optional): where to store how many times a document had to be loaded
+ *
+ * Returns how well the cache set up with rsvg_set_extern_cache_size() has
+ * done so far.  Only documents that could be cached are counted.
+ *
+ * Since: 2.52
+ */
+void rsvg_get_extern_cache_stats(guint64* hits, guint64* misses) {
+    g_mutex_lock(&extern_cache_lock);
+
+    if (hits)
+        *hits = extern_cache_hits;
+    if (misses)
+        *misses = extern_cache_misses;
+
+    g_mutex_unlock(&extern_cache_lock);
+}
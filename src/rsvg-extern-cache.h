@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-extern-cache.h: Process-wide cache of external documents
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#ifndef RSVG_EXTERN_CACHE_H
+#define RSVG_EXTERN_CACHE_H
+
+#include "rsvg.h"
+
+G_BEGIN_DECLS
+
+/* Returns the key under which the document at @uri would be cached: the URI
+ * together with the modification time and size of the file.  Returns NULL
+ * if the cache is disabled or @uri is not a local file that can be checked.
+ */
+G_GNUC_INTERNAL
+char* rsvg_extern_cache_make_key(const char* uri);
+
+/* Returns a new reference to the document cached under @key, or NULL */
+G_GNUC_INTERNAL
+RsvgHandle* rsvg_extern_cache_lookup(const char* key);
+
+/* Caches @handle, which must be closed and is never modified again, under
+ * @key.  The least recently used document is dropped if the cache is full.
+ */
+G_GNUC_INTERNAL
+void rsvg_extern_cache_insert(const char* key, RsvgHandle* handle);
+
+/* Drops every cached document, without disabling the cache */
+G_GNUC_INTERNAL
+void rsvg_extern_cache_clear(void);
+
+G_END_DECLS
+
+#endif /* RSVG_EXTERN_CACHE_H */
@@ -120,15 +120,17 @@ static GdkPixbuf* rsvg_pixbuf_from_file_with_size_data(const gchar* file_name,
                                                        struct RsvgSizeCallbackData* cb_data,
                                                        GError** error) {
     GdkPixbuf* pixbuf;
-    char* data;
-    gsize data_len;
+    GBytes* data;
     GString* base_uri = g_string_new(file_name);
 
-    data = _rsvg_io_acquire_data(file_name, base_uri->str, NULL, &data_len, NULL, error);
+    data = _rsvg_io_acquire_data(file_name, base_uri->str, NULL, NULL, error);
 
     if (data) {
-        pixbuf = rsvg_pixbuf_from_stdio_file_with_size_data(data, data_len, cb_data, base_uri->str, error);
-        g_free(data);
+        gsize data_len;
+        const char* buf = g_bytes_get_data(data, &data_len);
+
+        pixbuf = rsvg_pixbuf_from_stdio_file_with_size_data(buf, data_len, cb_data, base_uri->str, error);
+        g_bytes_unref(data);
     }
     else {
         pixbuf = NULL;
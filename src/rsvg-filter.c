@@ -89,7 +89,7 @@ typedef struct _RsvgFilterPrimitive RsvgFilterPrimitive;
  *    }
  *
  * That last call to rsvg_filter_primitive_free() will free the base RsvgFilterPrimitive's own fields,
- * and your whole structure itself, via _rsvg_node_free().
+ * and the node's, via _rsvg_node_free().  The structure itself lives in the handle's arena.
  */
 struct _RsvgFilterPrimitive {
     RsvgNode super;
@@ -698,27 +698,27 @@ static void rsvg_filter_set_args(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBa
     filter = (RsvgFilter*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "filterUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_FILTER_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 filter->filterunits = userSpaceOnUse;
             else
                 filter->filterunits = objectBoundingBox;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "primitiveUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRIMITIVE_UNITS))) {
             if (!strcmp(value, "objectBoundingBox"))
                 filter->primitiveunits = objectBoundingBox;
             else
                 filter->primitiveunits = userSpaceOnUse;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super);
     }
 }
@@ -728,10 +728,10 @@ static void rsvg_filter_set_args(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBa
  *
  * Creates a blank filter and assigns default values to everything
  **/
-RsvgNode* rsvg_new_filter(void) {
+RsvgNode* rsvg_new_filter(RsvgArena* arena) {
     RsvgFilter* filter;
 
-    filter = g_new(RsvgFilter, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilter);
     _rsvg_node_init(&filter->super, RSVG_NODE_TYPE_FILTER);
     filter->filterunits = objectBoundingBox;
     filter->primitiveunits = userSpaceOnUse;
@@ -936,7 +936,7 @@ static void rsvg_filter_primitive_blend_set_atts(RsvgNode* node, RsvgHandle* ctx
     filter = (RsvgFilterPrimitiveBlend*)node;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "mode"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MODE))) {
             if (!strcmp(value, "multiply"))
                 filter->mode = multiply;
             else if (!strcmp(value, "screen"))
@@ -948,28 +948,28 @@ static void rsvg_filter_primitive_blend_set_atts(RsvgNode* node, RsvgHandle* ctx
             else
                 filter->mode = normal;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "in2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN2)))
             g_string_assign(filter->in2, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_blend(void) {
+RsvgNode* rsvg_new_filter_primitive_blend(RsvgArena* arena) {
     RsvgFilterPrimitiveBlend* filter;
-    filter = g_new(RsvgFilterPrimitiveBlend, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveBlend);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_BLEND);
     filter->mode = normal;
     filter->super.in = g_string_new("none");
@@ -1149,49 +1149,49 @@ static void rsvg_filter_primitive_convolve_matrix_set_atts(RsvgNode* self, RsvgH
     has_target_y = 0;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "targetX"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TARGET_X))) {
             has_target_x = 1;
             filter->targetx = atoi(value);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "targetY"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TARGET_Y))) {
             has_target_y = 1;
             filter->targety = atoi(value);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "bias")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_BIAS)))
             filter->bias = atof(value);
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAlpha"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ALPHA))) {
             if (!strcmp(value, "true"))
                 filter->preservealpha = TRUE;
             else
                 filter->preservealpha = FALSE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "divisor")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DIVISOR)))
             filter->divisor = atof(value);
-        if ((value = rsvg_property_bag_lookup(atts, "order"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ORDER))) {
             double tempx, tempy;
             rsvg_css_parse_number_optional_number(value, &tempx, &tempy);
             filter->orderx = MAX(tempx, G_MAXINT);
             filter->ordery = MAX(tempy, G_MAXINT);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "kernelUnitLength")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_KERNEL_UNIT_LENGTH)))
             rsvg_css_parse_number_optional_number(value, &filter->dx, &filter->dy);
 
-        if ((value = rsvg_property_bag_lookup(atts, "kernelMatrix")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_KERNEL_MATRIX)))
             filter->KernelMatrix = rsvg_css_parse_number_list(value, &listlen);
 
-        if ((value = rsvg_property_bag_lookup(atts, "edgeMode"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_EDGE_MODE))) {
             if (!strcmp(value, "wrap"))
                 filter->edgemode = 1;
             else if (!strcmp(value, "none"))
@@ -1199,7 +1199,7 @@ static void rsvg_filter_primitive_convolve_matrix_set_atts(RsvgNode* self, RsvgH
             else
                 filter->edgemode = 0;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 
@@ -1223,9 +1223,9 @@ static void rsvg_filter_primitive_convolve_matrix_set_atts(RsvgNode* self, RsvgH
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_convolve_matrix(void) {
+RsvgNode* rsvg_new_filter_primitive_convolve_matrix(RsvgArena* arena) {
     RsvgFilterPrimitiveConvolveMatrix* filter;
-    filter = g_new(RsvgFilterPrimitiveConvolveMatrix, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveConvolveMatrix);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_CONVOLVE_MATRIX);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -1839,28 +1839,28 @@ static void rsvg_filter_primitive_gaussian_blur_set_atts(RsvgNode* self, RsvgHan
     filter = (RsvgFilterPrimitiveGaussianBlur*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "stdDeviation")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STD_DEVIATION)))
             rsvg_css_parse_number_optional_number(value, &filter->sdx, &filter->sdy);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_gaussian_blur(void) {
+RsvgNode* rsvg_new_filter_primitive_gaussian_blur(RsvgArena* arena) {
     RsvgFilterPrimitiveGaussianBlur* filter;
-    filter = g_new(RsvgFilterPrimitiveGaussianBlur, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveGaussianBlur);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_GAUSSIAN_BLUR);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -1960,30 +1960,30 @@ static void rsvg_filter_primitive_offset_set_atts(RsvgNode* self, RsvgHandle* ct
     filter = (RsvgFilterPrimitiveOffset*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DX)))
             filter->dx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dy")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DY)))
             filter->dy = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_offset(void) {
+RsvgNode* rsvg_new_filter_primitive_offset(RsvgArena* arena) {
     RsvgFilterPrimitiveOffset* filter;
-    filter = g_new(RsvgFilterPrimitiveOffset, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveOffset);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_OFFSET);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -2056,24 +2056,24 @@ static void rsvg_filter_primitive_merge_set_atts(RsvgNode* self, RsvgHandle* ctx
     filter = (RsvgFilterPrimitiveMerge*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_merge(void) {
+RsvgNode* rsvg_new_filter_primitive_merge(RsvgArena* arena) {
     RsvgFilterPrimitiveMerge* filter;
-    filter = g_new(RsvgFilterPrimitiveMerge, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveMerge);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_MERGE);
     filter->super.result = g_string_new("none");
     filter->super.x.factor = filter->super.y.factor = filter->super.width.factor = filter->super.height.factor = 'n';
@@ -2091,7 +2091,7 @@ static void rsvg_filter_primitive_merge_node_set_atts(RsvgNode* self, RsvgHandle
 
     if (rsvg_property_bag_size(atts)) {
         /* see bug 145149 - sodipodi generates bad SVG... */
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(((RsvgFilterPrimitive*)self)->in, value);
     }
 }
@@ -2111,9 +2111,9 @@ static void rsvg_filter_primitive_merge_node_render(RsvgFilterPrimitive* self, R
     /* todo */
 }
 
-RsvgNode* rsvg_new_filter_primitive_merge_node(void) {
+RsvgNode* rsvg_new_filter_primitive_merge_node(RsvgArena* arena) {
     RsvgFilterPrimitive* filter;
-    filter = g_new(RsvgFilterPrimitive, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitive);
     _rsvg_node_init(&filter->super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_MERGE_NODE);
     filter->in = g_string_new("none");
     filter->super.free = rsvg_filter_primitive_merge_node_free;
@@ -2242,19 +2242,19 @@ static void rsvg_filter_primitive_color_matrix_set_atts(RsvgNode* self, RsvgHand
     type = 0;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "values"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VALUES))) {
             unsigned int i;
             double* temp = rsvg_css_parse_number_list(value, &listlen);
             filter->KernelMatrix = g_new(int, listlen);
@@ -2262,7 +2262,7 @@ static void rsvg_filter_primitive_color_matrix_set_atts(RsvgNode* self, RsvgHand
                 filter->KernelMatrix[i] = temp[i] * 255.;
             g_free(temp);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "type"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TYPE))) {
             if (!strcmp(value, "matrix"))
                 type = 0;
             else if (!strcmp(value, "saturate"))
@@ -2274,7 +2274,7 @@ static void rsvg_filter_primitive_color_matrix_set_atts(RsvgNode* self, RsvgHand
             else
                 type = 0;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 
@@ -2347,9 +2347,9 @@ static void rsvg_filter_primitive_color_matrix_set_atts(RsvgNode* self, RsvgHand
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_color_matrix(void) {
+RsvgNode* rsvg_new_filter_primitive_color_matrix(RsvgArena* arena) {
     RsvgFilterPrimitiveColorMatrix* filter;
-    filter = g_new(RsvgFilterPrimitiveColorMatrix, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveColorMatrix);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_COLOR_MATRIX);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -2542,27 +2542,27 @@ static void rsvg_filter_primitive_component_transfer_set_atts(RsvgNode* self, Rs
     filter = (RsvgFilterPrimitiveComponentTransfer*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_component_transfer(void) {
+RsvgNode* rsvg_new_filter_primitive_component_transfer(RsvgArena* arena) {
     RsvgFilterPrimitiveComponentTransfer* filter;
 
-    filter = g_new(RsvgFilterPrimitiveComponentTransfer, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveComponentTransfer);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_COMPONENT_TRANSFER);
     filter->super.result = g_string_new("none");
     filter->super.in = g_string_new("none");
@@ -2580,7 +2580,7 @@ static void rsvg_node_component_transfer_function_set_atts(RsvgNode* self, RsvgH
     (void)ctx;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "type"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TYPE))) {
             if (!strcmp(value, "identity"))
                 data->function = identity_component_transfer_func;
             else if (!strcmp(value, "table"))
@@ -2592,7 +2592,7 @@ static void rsvg_node_component_transfer_function_set_atts(RsvgNode* self, RsvgH
             else if (!strcmp(value, "gamma"))
                 data->function = gamma_component_transfer_func;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "tableValues"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TABLE_VALUES))) {
             unsigned int i;
             double* temp = rsvg_css_parse_number_list(value, &data->nbTableValues);
             data->tableValues = g_new(gint, data->nbTableValues);
@@ -2600,19 +2600,19 @@ static void rsvg_node_component_transfer_function_set_atts(RsvgNode* self, RsvgH
                 data->tableValues[i] = temp[i] * 255.;
             g_free(temp);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "slope"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SLOPE))) {
             data->slope = g_ascii_strtod(value, NULL) * 255.;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "intercept"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_INTERCEPT))) {
             data->intercept = g_ascii_strtod(value, NULL) * 255.;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "amplitude"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_AMPLITUDE))) {
             data->amplitude = g_ascii_strtod(value, NULL) * 255.;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "exponent"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_EXPONENT))) {
             data->exponent = g_ascii_strtod(value, NULL);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "offset"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_OFFSET))) {
             data->offset = g_ascii_strtod(value, NULL) * 255.;
         }
     }
@@ -2625,10 +2625,10 @@ static void rsvg_component_transfer_function_free(RsvgNode* self) {
     _rsvg_node_free(self);
 }
 
-RsvgNode* rsvg_new_node_component_transfer_function(char channel) {
+RsvgNode* rsvg_new_node_component_transfer_function(RsvgArena* arena, char channel) {
     RsvgNodeComponentTransferFunc* filter;
 
-    filter = g_new0(RsvgNodeComponentTransferFunc, 1);
+    filter = RSVG_ARENA_NEW0(arena, RsvgNodeComponentTransferFunc);
     _rsvg_node_init(&filter->super, RSVG_NODE_TYPE_COMPONENT_TRANFER_FUNCTION);
     filter->super.free = rsvg_component_transfer_function_free;
     filter->super.set_atts = rsvg_node_component_transfer_function_set_atts;
@@ -2735,35 +2735,35 @@ static void rsvg_filter_primitive_erode_set_atts(RsvgNode* self, RsvgHandle* ctx
     filter = (RsvgFilterPrimitiveErode*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "radius"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RADIUS))) {
             rsvg_css_parse_number_optional_number(value, &filter->rx, &filter->ry);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "operator"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_OPERATOR))) {
             if (!strcmp(value, "erode"))
                 filter->mode = 0;
             else if (!strcmp(value, "dilate"))
                 filter->mode = 1;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_erode(void) {
+RsvgNode* rsvg_new_filter_primitive_erode(RsvgArena* arena) {
     RsvgFilterPrimitiveErode* filter;
-    filter = g_new(RsvgFilterPrimitiveErode, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveErode);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_ERODE);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -2956,7 +2956,7 @@ static void rsvg_filter_primitive_composite_set_atts(RsvgNode* self, RsvgHandle*
     filter = (RsvgFilterPrimitiveComposite*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "operator"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_OPERATOR))) {
             if (!strcmp(value, "in"))
                 filter->mode = COMPOSITE_MODE_IN;
             else if (!strcmp(value, "out"))
@@ -2970,36 +2970,36 @@ static void rsvg_filter_primitive_composite_set_atts(RsvgNode* self, RsvgHandle*
             else
                 filter->mode = COMPOSITE_MODE_OVER;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "in2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN2)))
             g_string_assign(filter->in2, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "k1")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_K1)))
             filter->k1 = g_ascii_strtod(value, NULL) * 255.;
-        if ((value = rsvg_property_bag_lookup(atts, "k2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_K2)))
             filter->k2 = g_ascii_strtod(value, NULL) * 255.;
-        if ((value = rsvg_property_bag_lookup(atts, "k3")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_K3)))
             filter->k3 = g_ascii_strtod(value, NULL) * 255.;
-        if ((value = rsvg_property_bag_lookup(atts, "k4")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_K4)))
             filter->k4 = g_ascii_strtod(value, NULL) * 255.;
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_composite(void) {
+RsvgNode* rsvg_new_filter_primitive_composite(RsvgArena* arena) {
     RsvgFilterPrimitiveComposite* filter;
-    filter = g_new(RsvgFilterPrimitiveComposite, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveComposite);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_COMPOSITE);
     filter->mode = COMPOSITE_MODE_OVER;
     filter->super.in = g_string_new("none");
@@ -3068,25 +3068,25 @@ static void rsvg_filter_primitive_flood_set_atts(RsvgNode* self, RsvgHandle* ctx
     RsvgFilterPrimitive* filter = (RsvgFilterPrimitive*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, id = value, &filter->super);
         rsvg_parse_style_attrs(ctx, self->state, "feFlood", NULL, id, atts);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_flood(void) {
+RsvgNode* rsvg_new_filter_primitive_flood(RsvgArena* arena) {
     RsvgFilterPrimitive* filter;
-    filter = g_new(RsvgFilterPrimitive, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitive);
     _rsvg_node_init(&filter->super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_FLOOD);
     filter->in = g_string_new("none");
     filter->result = g_string_new("none");
@@ -3245,34 +3245,34 @@ static void rsvg_filter_primitive_displacement_map_set_atts(RsvgNode* self, Rsvg
     filter = (RsvgFilterPrimitiveDisplacementMap*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "in2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN2)))
             g_string_assign(filter->in2, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "xChannelSelector")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X_CHANNEL_SELECTOR)))
             filter->xChannelSelector = (value)[0];
-        if ((value = rsvg_property_bag_lookup(atts, "yChannelSelector")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y_CHANNEL_SELECTOR)))
             filter->yChannelSelector = (value)[0];
-        if ((value = rsvg_property_bag_lookup(atts, "scale")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SCALE)))
             filter->scale = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_displacement_map(void) {
+RsvgNode* rsvg_new_filter_primitive_displacement_map(RsvgArena* arena) {
     RsvgFilterPrimitiveDisplacementMap* filter;
-    filter = g_new(RsvgFilterPrimitiveDisplacementMap, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveDisplacementMap);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_DISPLACEMENT_MAP);
     filter->super.in = g_string_new("none");
     filter->in2 = g_string_new("none");
@@ -3593,36 +3593,36 @@ static void rsvg_filter_primitive_turbulence_set_atts(RsvgNode* self, RsvgHandle
     filter = (RsvgFilterPrimitiveTurbulence*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "baseFrequency")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_BASE_FREQUENCY)))
             rsvg_css_parse_number_optional_number(value, &filter->fBaseFreqX, &filter->fBaseFreqY);
-        if ((value = rsvg_property_bag_lookup(atts, "numOctaves")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_NUM_OCTAVES)))
             filter->nNumOctaves = atoi(value);
-        if ((value = rsvg_property_bag_lookup(atts, "seed")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SEED)))
             filter->seed = atoi(value);
-        if ((value = rsvg_property_bag_lookup(atts, "stitchTiles")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STITCH_TILES)))
             filter->bDoStitching = (!strcmp(value, "stitch"));
-        if ((value = rsvg_property_bag_lookup(atts, "type")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_TYPE)))
             filter->bFractalSum = (!strcmp(value, "fractalNoise"));
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_turbulence(void) {
+RsvgNode* rsvg_new_filter_primitive_turbulence(RsvgArena* arena) {
     RsvgFilterPrimitiveTurbulence* filter;
-    filter = g_new(RsvgFilterPrimitiveTurbulence, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveTurbulence);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_TURBULENCE);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -3649,6 +3649,7 @@ struct _RsvgFilterPrimitiveImage {
     RsvgFilterPrimitive super;
     RsvgHandle* ctx;
     GString* href;
+    cairo_surface_t* surface; /* the image at href, if it was fetched while loading */
 };
 
 static cairo_surface_t* rsvg_filter_primitive_image_render_in(RsvgFilterPrimitive* self, RsvgFilterContext* context) {
@@ -3699,7 +3700,10 @@ static cairo_surface_t* rsvg_filter_primitive_image_render_ext(RsvgFilterPrimiti
     if (width == 0 || height == 0)
         return NULL;
 
-    img = rsvg_cairo_surface_new_from_href(upself->ctx, upself->href->str, NULL);
+    if (upself->surface)
+        img = cairo_surface_reference(upself->surface);
+    else
+        img = rsvg_cairo_surface_new_from_href(upself->ctx, upself->href->str, NULL);
     if (!img)
         return NULL;
 
@@ -3796,10 +3800,19 @@ static void rsvg_filter_primitive_image_free(RsvgNode* self) {
 
     if (image->href)
         g_string_free(image->href, TRUE);
+    if (image->surface)
+        cairo_surface_destroy(image->surface);
 
     rsvg_filter_primitive_free(self);
 }
 
+/* Runs on a prefetch thread, while the document loads */
+static void rsvg_filter_primitive_image_fetch(RsvgHandle* handle, gpointer data) {
+    RsvgFilterPrimitiveImage* image = data;
+
+    image->surface = rsvg_cairo_surface_new_from_href(handle, image->href->str, NULL);
+}
+
 static void rsvg_filter_primitive_image_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag* atts) {
     const char* value;
     RsvgFilterPrimitiveImage* filter;
@@ -3808,30 +3821,34 @@ static void rsvg_filter_primitive_image_set_atts(RsvgNode* self, RsvgHandle* ctx
     filter->ctx = ctx;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "xlink:href"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF))) {
             filter->href = g_string_new(NULL);
             g_string_assign(filter->href, value);
+
+            /* anything but a reference to an element is an image file */
+            if (strchr(value, '#') == NULL)
+                rsvg_handle_prefetch(ctx, rsvg_filter_primitive_image_fetch, filter);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_image(void) {
+RsvgNode* rsvg_new_filter_primitive_image(RsvgArena* arena) {
     RsvgFilterPrimitiveImage* filter;
-    filter = g_new(RsvgFilterPrimitiveImage, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveImage);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_IMAGE);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -3840,6 +3857,7 @@ RsvgNode* rsvg_new_filter_primitive_image(void) {
     filter->super.super.free = rsvg_filter_primitive_image_free;
     filter->super.super.set_atts = rsvg_filter_primitive_image_set_atts;
     filter->href = NULL;
+    filter->surface = NULL;
     return (RsvgNode*)filter;
 }
 
@@ -4085,32 +4103,32 @@ static void rsvg_node_light_source_set_atts(RsvgNode* self, RsvgHandle* ctx, Rsv
     data = (RsvgNodeLightSource*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "azimuth")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_AZIMUTH)))
             data->azimuth = rsvg_css_parse_angle(value) / 180.0 * M_PI;
-        if ((value = rsvg_property_bag_lookup(atts, "elevation")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ELEVATION)))
             data->elevation = rsvg_css_parse_angle(value) / 180.0 * M_PI;
-        if ((value = rsvg_property_bag_lookup(atts, "limitingConeAngle")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_LIMITING_CONE_ANGLE)))
             data->limitingconeAngle = rsvg_css_parse_angle(value) / 180.0 * M_PI;
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             data->x = data->pointsAtX = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             data->y = data->pointsAtX = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "z")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Z)))
             data->z = data->pointsAtX = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "pointsAtX")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_POINTS_AT_X)))
             data->pointsAtX = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "pointsAtY")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_POINTS_AT_Y)))
             data->pointsAtY = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "pointsAtZ")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_POINTS_AT_Z)))
             data->pointsAtZ = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "specularExponent")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SPECULAR_EXPONENT)))
             data->specularExponent = g_ascii_strtod(value, NULL);
     }
 }
 
-RsvgNode* rsvg_new_node_light_source(char type) {
+RsvgNode* rsvg_new_node_light_source(RsvgArena* arena, char type) {
     RsvgNodeLightSource* data;
-    data = g_new(RsvgNodeLightSource, 1);
+    data = RSVG_ARENA_NEW(arena, RsvgNodeLightSource);
     _rsvg_node_init(&data->super, RSVG_NODE_TYPE_LIGHT_SOURCE);
     data->super.free = _rsvg_node_free;
     data->super.set_atts = rsvg_node_light_source_set_atts;
@@ -4250,34 +4268,34 @@ static void rsvg_filter_primitive_diffuse_lighting_set_atts(RsvgNode* self, Rsvg
     filter = (RsvgFilterPrimitiveDiffuseLighting*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "kernelUnitLength")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_KERNEL_UNIT_LENGTH)))
             rsvg_css_parse_number_optional_number(value, &filter->dx, &filter->dy);
-        if ((value = rsvg_property_bag_lookup(atts, "lighting-color")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_LIGHTING_COLOR)))
             filter->lightingcolor = rsvg_css_parse_color(value, 0);
-        if ((value = rsvg_property_bag_lookup(atts, "diffuseConstant")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DIFFUSE_CONSTANT)))
             filter->diffuseConstant = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "surfaceScale")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SURFACE_SCALE)))
             filter->surfaceScale = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_diffuse_lighting(void) {
+RsvgNode* rsvg_new_filter_primitive_diffuse_lighting(RsvgArena* arena) {
     RsvgFilterPrimitiveDiffuseLighting* filter;
-    filter = g_new(RsvgFilterPrimitiveDiffuseLighting, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveDiffuseLighting);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_DIFFUSE_LIGHTING);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -4420,34 +4438,34 @@ static void rsvg_filter_primitive_specular_lighting_set_atts(RsvgNode* self, Rsv
     filter = (RsvgFilterPrimitiveSpecularLighting*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "lighting-color")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_LIGHTING_COLOR)))
             filter->lightingcolor = rsvg_css_parse_color(value, 0);
-        if ((value = rsvg_property_bag_lookup(atts, "specularConstant")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SPECULAR_CONSTANT)))
             filter->specularConstant = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "specularExponent")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SPECULAR_EXPONENT)))
             filter->specularExponent = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "surfaceScale")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SURFACE_SCALE)))
             filter->surfaceScale = g_ascii_strtod(value, NULL);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_specular_lighting(void) {
+RsvgNode* rsvg_new_filter_primitive_specular_lighting(RsvgArena* arena) {
     RsvgFilterPrimitiveSpecularLighting* filter;
-    filter = g_new(RsvgFilterPrimitiveSpecularLighting, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveSpecularLighting);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_SPECULAR_LIGHTING);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -4541,26 +4559,26 @@ static void rsvg_filter_primitive_tile_set_atts(RsvgNode* self, RsvgHandle* ctx,
     filter = (RsvgFilterPrimitiveTile*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "in")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_IN)))
             g_string_assign(filter->super.in, value);
-        if ((value = rsvg_property_bag_lookup(atts, "result")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RESULT)))
             g_string_assign(filter->super.result, value);
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             filter->super.x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             filter->super.y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             filter->super.width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             filter->super.height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, &filter->super.super);
     }
 }
 
-RsvgNode* rsvg_new_filter_primitive_tile(void) {
+RsvgNode* rsvg_new_filter_primitive_tile(RsvgArena* arena) {
     RsvgFilterPrimitiveTile* filter;
-    filter = g_new(RsvgFilterPrimitiveTile, 1);
+    filter = RSVG_ARENA_NEW(arena, RsvgFilterPrimitiveTile);
     _rsvg_node_init(&filter->super.super, RSVG_NODE_TYPE_FILTER_PRIMITIVE_TILE);
     filter->super.in = g_string_new("none");
     filter->super.result = g_string_new("none");
@@ -52,45 +52,45 @@ cairo_surface_t* rsvg_filter_render(RsvgFilter* self,
                                     char* channelmap);
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter(void);
+RsvgNode* rsvg_new_filter(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_blend(void);
+RsvgNode* rsvg_new_filter_primitive_blend(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_convolve_matrix(void);
+RsvgNode* rsvg_new_filter_primitive_convolve_matrix(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_gaussian_blur(void);
+RsvgNode* rsvg_new_filter_primitive_gaussian_blur(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_offset(void);
+RsvgNode* rsvg_new_filter_primitive_offset(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_merge(void);
+RsvgNode* rsvg_new_filter_primitive_merge(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_merge_node(void);
+RsvgNode* rsvg_new_filter_primitive_merge_node(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_color_matrix(void);
+RsvgNode* rsvg_new_filter_primitive_color_matrix(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_component_transfer(void);
+RsvgNode* rsvg_new_filter_primitive_component_transfer(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_node_component_transfer_function(char channel);
+RsvgNode* rsvg_new_node_component_transfer_function(RsvgArena* arena, char channel);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_erode(void);
+RsvgNode* rsvg_new_filter_primitive_erode(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_composite(void);
+RsvgNode* rsvg_new_filter_primitive_composite(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_flood(void);
+RsvgNode* rsvg_new_filter_primitive_flood(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_displacement_map(void);
+RsvgNode* rsvg_new_filter_primitive_displacement_map(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_turbulence(void);
+RsvgNode* rsvg_new_filter_primitive_turbulence(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_image(void);
+RsvgNode* rsvg_new_filter_primitive_image(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_diffuse_lighting(void);
+RsvgNode* rsvg_new_filter_primitive_diffuse_lighting(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_node_light_source(char type);
+RsvgNode* rsvg_new_node_light_source(RsvgArena* arena, char type);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_specular_lighting(void);
+RsvgNode* rsvg_new_filter_primitive_specular_lighting(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_filter_primitive_tile(void);
+RsvgNode* rsvg_new_filter_primitive_tile(RsvgArena* arena);
 
 G_END_DECLS
 
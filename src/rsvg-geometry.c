@@ -0,0 +1,199 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-geometry.c: Deferred compilation of path data and point lists
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#include "config.h"
+#include "rsvg-geometry.h"
+
+#include <string.h>
+
+/* Less text than this is compiled on the calling thread alone, since
+ * starting threads would cost more than it saves
+ */
+#define RSVG_GEOMETRY_PARALLEL_SIZE (256 * 1024)
+#define RSVG_GEOMETRY_MAX_THREADS 8
+/* Items are claimed this many at a time, to keep the workers off each
+ * other's cache lines without leaving one of them with all the big ones
+ */
+#define RSVG_GEOMETRY_BATCH_SIZE 16
+
+typedef struct {
+    RsvgGeometryFunc func;
+    cairo_path_t** result;
+    gsize offset; /* of the NUL-terminated value in the queue's text */
+} RsvgGeometryItem;
+
+struct _RsvgGeometryQueue {
+    GArray* items;
+    GString* text;
+
+    GPtrArray* recorded; /* cairo_path_t** of every push, or NULL */
+    cairo_path_t* const* precompiled;
+    guint n_precompiled;
+    guint next_precompiled;
+};
+
+typedef struct {
+    RsvgGeometryQueue* queue;
+    gint next; /* first unclaimed item */
+} RsvgGeometryJob;
+
+typedef struct {
+    RsvgGeometryJob* job;
+    RsvgArena* arena;
+    GThread* thread;
+} RsvgGeometryWorker;
+
+RsvgGeometryQueue* rsvg_geometry_queue_new(void) {
+    RsvgGeometryQueue* queue = g_new(RsvgGeometryQueue, 1);
+
+    queue->items = g_array_new(FALSE, FALSE, sizeof(RsvgGeometryItem));
+    queue->text = g_string_new(NULL);
+    queue->recorded = NULL;
+    queue->precompiled = NULL;
+    queue->n_precompiled = 0;
+    queue->next_precompiled = 0;
+
+    return queue;
+}
+
+void rsvg_geometry_queue_free(RsvgGeometryQueue* queue) {
+    if (queue == NULL)
+        return;
+
+    g_array_free(queue->items, TRUE);
+    g_string_free(queue->text, TRUE);
+    if (queue->recorded)
+        g_ptr_array_free(queue->recorded, TRUE);
+    g_free(queue);
+}
+
+void rsvg_geometry_queue_push(RsvgGeometryQueue* queue,
+                              RsvgGeometryFunc func,
+                              const char* value,
+                              cairo_path_t** result) {
+    RsvgGeometryItem item;
+
+    if (queue->recorded)
+        g_ptr_array_add(queue->recorded, result);
+
+    if (queue->next_precompiled < queue->n_precompiled) {
+        *result = queue->precompiled[queue->next_precompiled++];
+        return;
+    }
+
+    item.func = func;
+    item.result = result;
+    item.offset = queue->text->len;
+
+    /* the terminating NUL of each value is kept */
+    g_string_append_len(queue->text, value, strlen(value) + 1);
+    g_array_append_val(queue->items, item);
+}
+
+static gpointer rsvg_geometry_worker_run(gpointer data) {
+    RsvgGeometryWorker* worker = data;
+    RsvgGeometryQueue* queue = worker->job->queue;
+    guint n_items = queue->items->len;
+
+    for (;;) {
+        guint start = (guint)g_atomic_int_add(&worker->job->next, RSVG_GEOMETRY_BATCH_SIZE);
+        guint end, i;
+
+        if (start >= n_items)
+            break;
+
+        end = MIN(start + RSVG_GEOMETRY_BATCH_SIZE, n_items);
+        for (i = start; i < end; i++) {
+            RsvgGeometryItem* item = &g_array_index(queue->items, RsvgGeometryItem, i);
+
+            *item->result = item->func(queue->text->str + item->offset, worker->arena);
+        }
+    }
+
+    return NULL;
+}
+
+void rsvg_geometry_queue_compile(RsvgGeometryQueue* queue, RsvgArena* arena) {
+    RsvgGeometryWorker workers[RSVG_GEOMETRY_MAX_THREADS];
+    RsvgGeometryJob job;
+    guint n_workers = 1, i;
+
+    if (queue->text->len >= RSVG_GEOMETRY_PARALLEL_SIZE)
+        n_workers = CLAMP(g_get_num_processors(), 1, RSVG_GEOMETRY_MAX_THREADS);
+
+    job.queue = queue;
+    job.next = 0;
+
+    /* The calling thread is the first worker and allocates from the handle's
+     * arena; the others get arenas of their own, since arenas are not
+     * thread-safe, and hand their blocks over when they are done.
+     */
+    workers[0].job = &job;
+    workers[0].arena = arena;
+    workers[0].thread = NULL;
+
+    for (i = 1; i < n_workers; i++) {
+        workers[i].job = &job;
+        workers[i].arena = rsvg_arena_new();
+        workers[i].thread = g_thread_try_new("rsvg-geometry", rsvg_geometry_worker_run, &workers[i], NULL);
+
+        if (workers[i].thread == NULL) {
+            rsvg_arena_free(workers[i].arena);
+            break;
+        }
+    }
+    n_workers = i;
+
+    rsvg_geometry_worker_run(&workers[0]);
+
+    for (i = 1; i < n_workers; i++) {
+        g_thread_join(workers[i].thread);
+        rsvg_arena_adopt(arena, workers[i].arena);
+    }
+
+    /* the text is not needed any more, and can be as big as the document */
+    g_array_free(queue->items, TRUE);
+    g_string_free(queue->text, TRUE);
+    queue->items = g_array_new(FALSE, FALSE, sizeof(RsvgGeometryItem));
+    queue->text = g_string_new(NULL);
+}
+
+void rsvg_geometry_queue_record(RsvgGeometryQueue* queue) {
+    if (queue->recorded == NULL)
+        queue->recorded = g_ptr_array_new();
+}
+
+cairo_path_t** const* rsvg_geometry_queue_get_recorded(RsvgGeometryQueue* queue, guint* n_results) {
+    if (queue->recorded == NULL) {
+        *n_results = 0;
+        return NULL;
+    }
+
+    *n_results = queue->recorded->len;
+    return (cairo_path_t** const*)queue->recorded->pdata;
+}
+
+void rsvg_geometry_queue_set_precompiled(RsvgGeometryQueue* queue, cairo_path_t* const* paths, guint n_paths) {
+    queue->precompiled = paths;
+    queue->n_precompiled = n_paths;
+    queue->next_precompiled = 0;
+}
@@ -0,0 +1,76 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-geometry.h: Deferred compilation of path data and point lists
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+
+#ifndef RSVG_GEOMETRY_H
+#define RSVG_GEOMETRY_H
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "rsvg-arena.h"
+
+G_BEGIN_DECLS
+
+/* Path data and point lists are the most expensive attributes to parse.
+ * While loading, they are only copied into a queue; when the document is
+ * complete they are all compiled at once, on several threads if there is
+ * enough of them.  Each result is exactly what parsing in place would have
+ * produced.
+ */
+typedef struct _RsvgGeometryQueue RsvgGeometryQueue;
+
+/* Compiles @value into a path allocated from @arena; must be thread-safe */
+typedef cairo_path_t* (*RsvgGeometryFunc)(const char* value, RsvgArena* arena);
+
+G_GNUC_INTERNAL
+RsvgGeometryQueue* rsvg_geometry_queue_new(void);
+G_GNUC_INTERNAL
+void rsvg_geometry_queue_free(RsvgGeometryQueue* queue);
+
+/* Arranges for *@result to be set to @func (@value) on compilation */
+G_GNUC_INTERNAL
+void rsvg_geometry_queue_push(RsvgGeometryQueue* queue,
+                              RsvgGeometryFunc func,
+                              const char* value,
+                              cairo_path_t** result);
+
+/* Compiles everything queued so far into @arena and empties the queue */
+G_GNUC_INTERNAL
+void rsvg_geometry_queue_compile(RsvgGeometryQueue* queue, RsvgArena* arena);
+
+/* Keeps the result location of every push from now on, in order, so that
+ * the compiled paths can be written to a document cache
+ */
+G_GNUC_INTERNAL
+void rsvg_geometry_queue_record(RsvgGeometryQueue* queue);
+G_GNUC_INTERNAL
+cairo_path_t** const* rsvg_geometry_queue_get_recorded(RsvgGeometryQueue* queue, guint* n_results);
+
+/* Makes the next @n_paths pushes take their results from @paths, which
+ * must outlive them, instead of compiling anything
+ */
+G_GNUC_INTERNAL
+void rsvg_geometry_queue_set_precompiled(RsvgGeometryQueue* queue, cairo_path_t* const* paths, guint n_paths);
+
+G_END_DECLS
+
+#endif /* RSVG_GEOMETRY_H */
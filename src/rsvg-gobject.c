@@ -33,6 +33,18 @@
  *
  * Many software developers use the librsvg library to render
  * SVG graphics. It is lightweight and portable.
+ *
+ * Once rsvg_handle_close() has succeeded, or the handle was created
+ * complete with one of the rsvg_handle_new_from_*() functions, the
+ * document is frozen: rendering never modifies it, and everything that
+ * a render needs to keep track of lives in that render alone.  A frozen
+ * handle can therefore be rendered, and have its dimensions, positions
+ * and elements queried, from several threads at the same time, each with
+ * its own cairo context.  Functions that change the handle, such as
+ * rsvg_handle_set_stylesheet(), rsvg_handle_set_dpi() or
+ * rsvg_handle_set_size_callback(), must not run concurrently with
+ * anything else on it, and a size callback that is set must itself be
+ * safe to call from those threads.
  */
 
 #include "config.h"
@@ -70,6 +82,9 @@ static void rsvg_handle_init(RsvgHandle* self) {
     self->priv->flags = RSVG_HANDLE_FLAGS_NONE;
     self->priv->state = RSVG_HANDLE_STATE_START;
     self->priv->load_policy = RSVG_LOAD_POLICY_DEFAULT;
+    self->priv->arena = rsvg_arena_new();
+    self->priv->interner = rsvg_interner_new(self->priv->arena);
+    self->priv->geometry = rsvg_geometry_queue_new();
     self->priv->defs = rsvg_defs_new(self);
     self->priv->handler_nest = 0;
     self->priv->entities = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)xmlFreeNode);
@@ -81,13 +96,19 @@ static void rsvg_handle_init(RsvgHandle* self) {
     self->priv->ctxt = NULL;
     self->priv->currentnode = NULL;
     self->priv->treebase = NULL;
-
-    self->priv->compressed_input_stream = NULL;
+    self->priv->last_chars = NULL;
+
+    self->priv->compressed_data = NULL;
+    self->priv->prefetch_pending = 0;
+    g_mutex_init(&self->priv->prefetch_lock);
+    g_cond_init(&self->priv->prefetch_done);
+    self->priv->is_extern = FALSE;
+    self->priv->style_threads = 0;
+    self->priv->cache_writer = NULL;
+    self->priv->cache = NULL;
     self->priv->cancellable = NULL;
 
     self->priv->is_disposed = FALSE;
-    self->priv->in_loop = FALSE;
-
     self->priv->is_testing = FALSE;
 }
 
@@ -99,9 +120,18 @@ static void rsvg_handle_dispose(GObject* instance) {
 
     self->priv->is_disposed = TRUE;
 
+    /* a load that never finished may still be fetching into the tree */
+    rsvg_handle_finish_prefetch(self);
+
     rsvg_defs_free(self->priv->defs);
-    g_hash_table_destroy(self->priv->entities);
     rsvg_css_engine_free(self->priv->css_engine);
+    rsvg_interner_free(self->priv->interner);
+    rsvg_geometry_queue_free(self->priv->geometry);
+    /* after everything that points into it */
+    rsvg_arena_free(self->priv->arena);
+    rsvg_cache_free(self->priv->cache);
+    rsvg_cache_writer_free(self->priv->cache_writer);
+    g_hash_table_destroy(self->priv->entities);
 
     self->priv->ctxt = rsvg_free_xml_parser_and_doc(self->priv->ctxt);
 
@@ -121,9 +151,9 @@ static void rsvg_handle_dispose(GObject* instance) {
         g_object_unref(self->priv->base_gfile);
         self->priv->base_gfile = NULL;
     }
-    if (self->priv->compressed_input_stream) {
-        g_object_unref(self->priv->compressed_input_stream);
-        self->priv->compressed_input_stream = NULL;
+    if (self->priv->compressed_data) {
+        g_byte_array_free(self->priv->compressed_data, TRUE);
+        self->priv->compressed_data = NULL;
     }
 
     g_clear_object(&self->priv->cancellable);
@@ -132,6 +162,15 @@ chain:
     G_OBJECT_CLASS(rsvg_handle_parent_class)->dispose(instance);
 }
 
+static void rsvg_handle_finalize(GObject* instance) {
+    RsvgHandle* self = (RsvgHandle*)instance;
+
+    g_mutex_clear(&self->priv->prefetch_lock);
+    g_cond_clear(&self->priv->prefetch_done);
+
+    G_OBJECT_CLASS(rsvg_handle_parent_class)->finalize(instance);
+}
+
 static void rsvg_handle_set_property(GObject* instance, guint prop_id, GValue const* value, GParamSpec* pspec) {
     RsvgHandle* self = RSVG_HANDLE(instance);
 
@@ -204,6 +243,7 @@ static void rsvg_handle_class_init(RsvgHandleClass* klass) {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
 
     gobject_class->dispose = rsvg_handle_dispose;
+    gobject_class->finalize = rsvg_handle_finalize;
     gobject_class->set_property = rsvg_handle_set_property;
     gobject_class->get_property = rsvg_handle_get_property;
 
@@ -0,0 +1,324 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-gzip.c: Decompression of svgz data
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include "config.h"
+#include "rsvg-gzip.h"
+
+#include <string.h>
+
+/* A gzip member is at least a 10 byte header and an 8 byte trailer */
+#define GZIP_MIN_SIZE 18
+/* Deflate cannot do better than about 1032:1, so a trailer claiming more
+ * than that is lying and only used as a hint up to this point
+ */
+#define GZIP_MAX_RATIO 1032
+
+/* Size of the ring buffer between the decompression thread and the reader,
+ * and of the chunks the thread decompresses at a time
+ */
+#define GZIP_RING_SIZE (256 * 1024)
+#define GZIP_CHUNK_SIZE (32 * 1024)
+
+static gsize rsvg_gzip_guess_size(const guint8* data, gsize len) {
+    guint32 isize;
+
+    if (len < GZIP_MIN_SIZE)
+        return 4096;
+
+    /* ISIZE: the uncompressed length modulo 2^32, little-endian */
+    isize = (guint32)data[len - 4] | (guint32)data[len - 3] << 8 | (guint32)data[len - 2] << 16 |
+            (guint32)data[len - 1] << 24;
+
+    if (isize / GZIP_MAX_RATIO > len)
+        return len * 4;
+
+    /* one spare byte, so that the end of the stream is seen without growing */
+    return (gsize)isize + 1;
+}
+
+GBytes* rsvg_gzip_inflate(const guint8* data, gsize len, gsize max_size, GError** error) {
+    GConverter* converter;
+    guint8* out;
+    gsize out_size, in_pos = 0, out_pos = 0;
+    GConverterResult result;
+
+    out_size = rsvg_gzip_guess_size(data, len);
+    if (out_size > max_size + 1)
+        return NULL;
+
+    converter = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+    out = g_malloc(out_size);
+
+    do {
+        gsize bytes_read, bytes_written;
+
+        /* zlib always makes progress while there is room for output */
+        if (out_pos == out_size) {
+            if (out_size > max_size) {
+                g_free(out);
+                g_object_unref(converter);
+                return NULL;
+            }
+
+            out_size = MIN(out_size * 2, max_size + 1);
+            out = g_realloc(out, out_size);
+        }
+
+        result = g_converter_convert(converter, data + in_pos, len - in_pos, out + out_pos, out_size - out_pos,
+                                     G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, error);
+        if (result == G_CONVERTER_ERROR) {
+            g_free(out);
+            g_object_unref(converter);
+            return NULL;
+        }
+
+        in_pos += bytes_read;
+        out_pos += bytes_written;
+    } while (result != G_CONVERTER_FINISHED);
+
+    g_object_unref(converter);
+
+    if (out_pos > max_size) {
+        g_free(out);
+        return NULL;
+    }
+
+    return g_bytes_new_take(out, out_pos);
+}
+
+/* RsvgGzipInputStream: the reading end of a ring buffer that a helper
+ * thread fills with decompressed data, so that inflating and parsing run
+ * side by side.
+ */
+
+typedef struct {
+    GInputStream parent;
+
+    GInputStream* source; /* the decompressing stream, only touched by the thread */
+    GCancellable* cancellable; /* for the thread's reads, cancelled to stop it */
+    GCancellable* load_cancellable; /* the whole load's, forwarded to the thread's */
+    gulong load_cancelled_id;
+    GThread* thread;
+
+    GMutex lock;
+    GCond cond;
+    guint8* ring;
+    gsize head; /* first unread byte */
+    gsize fill; /* number of unread bytes */
+    gboolean eof;
+    gboolean closed;
+    GError* error;
+} RsvgGzipInputStream;
+
+typedef struct {
+    GInputStreamClass parent_class;
+} RsvgGzipInputStreamClass;
+
+static GType rsvg_gzip_input_stream_get_type(void);
+
+G_DEFINE_TYPE(RsvgGzipInputStream, rsvg_gzip_input_stream, G_TYPE_INPUT_STREAM)
+
+static gpointer rsvg_gzip_input_stream_thread(gpointer data) {
+    RsvgGzipInputStream* self = data;
+
+    g_mutex_lock(&self->lock);
+    while (!self->closed) {
+        gsize tail, len;
+        gssize n_read;
+        GError* error = NULL;
+
+        if (self->fill == GZIP_RING_SIZE) {
+            g_cond_wait(&self->cond, &self->lock);
+            continue;
+        }
+
+        /* the free space after the tail, which the reader does not touch */
+        tail = (self->head + self->fill) % GZIP_RING_SIZE;
+        len = MIN(GZIP_RING_SIZE - self->fill, GZIP_RING_SIZE - tail);
+        len = MIN(len, GZIP_CHUNK_SIZE);
+
+        g_mutex_unlock(&self->lock);
+        n_read = g_input_stream_read(self->source, self->ring + tail, len, self->cancellable, &error);
+        g_mutex_lock(&self->lock);
+
+        if (n_read > 0) {
+            self->fill += n_read;
+        }
+        else {
+            if (n_read == 0)
+                self->eof = TRUE;
+            else
+                self->error = error;
+            g_cond_broadcast(&self->cond);
+            break;
+        }
+        g_cond_broadcast(&self->cond);
+    }
+    g_mutex_unlock(&self->lock);
+
+    return NULL;
+}
+
+static void rsvg_gzip_input_stream_forward_cancel(GCancellable* cancellable, gpointer data) {
+    (void)cancellable;
+    g_cancellable_cancel(G_CANCELLABLE(data));
+}
+
+/* Wakes up a reader waiting for the thread, so that it sees it was cancelled */
+static void rsvg_gzip_input_stream_wake(GCancellable* cancellable, gpointer data) {
+    RsvgGzipInputStream* self = data;
+
+    (void)cancellable;
+
+    g_mutex_lock(&self->lock);
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->lock);
+}
+
+static gssize rsvg_gzip_input_stream_read(GInputStream* stream,
+                                          void* buffer,
+                                          gsize count,
+                                          GCancellable* cancellable,
+                                          GError** error) {
+    RsvgGzipInputStream* self = (RsvgGzipInputStream*)stream;
+    gulong cancelled_id = 0;
+    gsize n, first;
+
+    /* connected outside the lock, which the handler takes */
+    if (cancellable != NULL)
+        cancelled_id = g_cancellable_connect(cancellable, G_CALLBACK(rsvg_gzip_input_stream_wake), self, NULL);
+
+    g_mutex_lock(&self->lock);
+    while (self->fill == 0 && !self->eof && self->error == NULL && !g_cancellable_is_cancelled(cancellable))
+        g_cond_wait(&self->cond, &self->lock);
+    g_mutex_unlock(&self->lock);
+
+    if (cancelled_id != 0)
+        g_cancellable_disconnect(cancellable, cancelled_id);
+    if (g_cancellable_set_error_if_cancelled(cancellable, error))
+        return -1;
+
+    g_mutex_lock(&self->lock);
+    if (self->fill == 0) {
+        gboolean failed = self->error != NULL;
+
+        if (failed)
+            g_propagate_error(error, g_error_copy(self->error));
+        g_mutex_unlock(&self->lock);
+        return failed ? -1 : 0;
+    }
+
+    n = MIN(count, self->fill);
+    first = MIN(n, GZIP_RING_SIZE - self->head);
+    memcpy(buffer, self->ring + self->head, first);
+    memcpy((guint8*)buffer + first, self->ring, n - first);
+
+    self->head = (self->head + n) % GZIP_RING_SIZE;
+    self->fill -= n;
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->lock);
+
+    return n;
+}
+
+static void rsvg_gzip_input_stream_stop(RsvgGzipInputStream* self) {
+    if (self->thread == NULL)
+        return;
+
+    g_mutex_lock(&self->lock);
+    self->closed = TRUE;
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->lock);
+
+    /* a read that is still waiting on a slow source would hold up the join */
+    g_cancellable_cancel(self->cancellable);
+    g_thread_join(self->thread);
+    self->thread = NULL;
+}
+
+static gboolean rsvg_gzip_input_stream_close(GInputStream* stream, GCancellable* cancellable, GError** error) {
+    RsvgGzipInputStream* self = (RsvgGzipInputStream*)stream;
+
+    rsvg_gzip_input_stream_stop(self);
+
+    return self->source == NULL || g_input_stream_close(self->source, cancellable, error);
+}
+
+static void rsvg_gzip_input_stream_finalize(GObject* object) {
+    RsvgGzipInputStream* self = (RsvgGzipInputStream*)object;
+
+    rsvg_gzip_input_stream_stop(self);
+
+    if (self->load_cancellable != NULL) {
+        g_cancellable_disconnect(self->load_cancellable, self->load_cancelled_id);
+        g_clear_object(&self->load_cancellable);
+    }
+
+    g_clear_object(&self->source);
+    g_clear_object(&self->cancellable);
+    g_clear_error(&self->error);
+    g_free(self->ring);
+    g_mutex_clear(&self->lock);
+    g_cond_clear(&self->cond);
+
+    G_OBJECT_CLASS(rsvg_gzip_input_stream_parent_class)->finalize(object);
+}
+
+static void rsvg_gzip_input_stream_init(RsvgGzipInputStream* self) {
+    g_mutex_init(&self->lock);
+    g_cond_init(&self->cond);
+}
+
+static void rsvg_gzip_input_stream_class_init(RsvgGzipInputStreamClass* klass) {
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    GInputStreamClass* stream_class = G_INPUT_STREAM_CLASS(klass);
+
+    gobject_class->finalize = rsvg_gzip_input_stream_finalize;
+    stream_class->read_fn = rsvg_gzip_input_stream_read;
+    stream_class->close_fn = rsvg_gzip_input_stream_close;
+}
+
+GInputStream* rsvg_gzip_input_stream_new(GInputStream* compressed, GCancellable* cancellable) {
+    g_autoptr(GConverter) converter = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+    RsvgGzipInputStream* self;
+    GInputStream* source;
+
+    self = g_object_new(rsvg_gzip_input_stream_get_type(), NULL);
+    self->source = g_converter_input_stream_new(compressed, converter);
+    self->cancellable = g_cancellable_new();
+    self->ring = g_malloc(GZIP_RING_SIZE);
+
+    if (cancellable != NULL) {
+        self->load_cancellable = g_object_ref(cancellable);
+        self->load_cancelled_id = g_cancellable_connect(
+            cancellable, G_CALLBACK(rsvg_gzip_input_stream_forward_cancel), self->cancellable, NULL);
+    }
+
+    self->thread = g_thread_try_new("rsvg-gzip", rsvg_gzip_input_stream_thread, self, NULL);
+    if (self->thread == NULL) {
+        /* no thread to spare; decompress in the reader's thread instead */
+        source = g_steal_pointer(&self->source);
+        g_object_unref(self);
+        return source;
+    }
+
+    return G_INPUT_STREAM(self);
+}
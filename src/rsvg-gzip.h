@@ -0,0 +1,58 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-gzip.h: Decompression of svgz data
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RSVG_GZIP_H
+#define RSVG_GZIP_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define RSVG_GZIP_MAGIC_0 ((guchar)0x1f)
+#define RSVG_GZIP_MAGIC_1 ((guchar)0x8b)
+
+/* Compressed data that fits in memory is only inflated in one go if the
+ * result is at most this big; anything larger is decompressed as a stream
+ * so that the whole document never has to be held at once.
+ */
+#define RSVG_GZIP_MAX_INFLATE_SIZE (16 * 1024 * 1024)
+/* A stream whose compressed data ends within this many bytes counts as
+ * fitting in memory
+ */
+#define RSVG_GZIP_PEEK_SIZE (64 * 1024)
+
+/* Inflates the whole gzip member in @data into a buffer sized from its
+ * trailer.  Returns NULL with @error set if the data is corrupt, and NULL
+ * without an error if the output would be bigger than @max_size.
+ */
+G_GNUC_INTERNAL
+GBytes* rsvg_gzip_inflate(const guint8* data, gsize len, gsize max_size, GError** error);
+
+/* Returns a stream with the decompressed contents of @compressed.  The
+ * decompression runs on a helper thread that stays a bounded amount of
+ * data ahead of the reader.
+ */
+G_GNUC_INTERNAL
+GInputStream* rsvg_gzip_input_stream_new(GInputStream* compressed, GCancellable* cancellable);
+
+G_END_DECLS
+
+#endif /* RSVG_GZIP_H */
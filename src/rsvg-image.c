@@ -36,37 +36,78 @@
 #include "rsvg-css.h"
 #include "rsvg-io.h"
 
+typedef struct {
+    char* mime_type;
+    GdkPixbufLoader* loader;
+    GByteArray* kept; /* a copy of the data for RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA */
+} RsvgImageLoad;
+
+static gboolean rsvg_image_load_write(const guint8* data, gsize len, gpointer user_data, GError** error) {
+    RsvgImageLoad* load = user_data;
+
+    /* created on the first write, once the mime type of a data: URI is known */
+    if (load->loader == NULL) {
+        if (load->mime_type)
+            load->loader = gdk_pixbuf_loader_new_with_mime_type(load->mime_type, error);
+        else
+            load->loader = gdk_pixbuf_loader_new();
+
+        if (load->loader == NULL)
+            return FALSE;
+    }
+
+    if (load->kept)
+        g_byte_array_append(load->kept, data, len);
+
+    return gdk_pixbuf_loader_write(load->loader, data, len, error);
+}
+
 cairo_surface_t* rsvg_cairo_surface_new_from_href(RsvgHandle* handle, const char* href, GError** error) {
-    char* data;
-    gsize data_len;
-    char* mime_type = NULL;
-    GdkPixbufLoader* loader = NULL;
+    RsvgImageLoad load = {NULL, NULL, NULL};
+    GBytes* bytes = NULL;
     GdkPixbuf* pixbuf = NULL;
     cairo_surface_t* surface = NULL;
+    gboolean keep_data = (handle->priv->flags & RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA) != 0;
+    gboolean written;
+
+    if (strncmp(href, "data:", 5) == 0) {
+        /* Embedded images are decoded straight from the attribute into the
+         * loader, a chunk at a time, instead of into a copy of the whole
+         * image first.  data: URIs need no resolving and are always allowed.
+         */
+        if (keep_data)
+            load.kept = g_byte_array_new();
 
-    data = _rsvg_handle_acquire_data(handle, href, &mime_type, &data_len, error);
-    if (data == NULL)
-        return NULL;
+        written = _rsvg_io_decode_data_uri(href, &load.mime_type, rsvg_image_load_write, &load, error);
 
-    if (mime_type) {
-        loader = gdk_pixbuf_loader_new_with_mime_type(mime_type, error);
+        if (load.kept)
+            bytes = g_byte_array_free_to_bytes(g_steal_pointer(&load.kept));
     }
     else {
-        loader = gdk_pixbuf_loader_new();
+        const guchar* data;
+        gsize data_len;
+
+        bytes = _rsvg_handle_acquire_data(handle, href, &load.mime_type, error);
+        if (bytes == NULL)
+            goto out;
+
+        data = g_bytes_get_data(bytes, &data_len);
+        written = rsvg_image_load_write(data, data_len, &load, error);
     }
 
-    if (loader == NULL)
+    /* an empty data: URI never gets as far as a loader */
+    if (load.loader == NULL)
         goto out;
 
-    if (!gdk_pixbuf_loader_write(loader, (guchar*)data, data_len, error)) {
-        gdk_pixbuf_loader_close(loader, NULL);
+    if (!written) {
+        gdk_pixbuf_loader_close(load.loader, NULL);
         goto out;
     }
 
-    if (!gdk_pixbuf_loader_close(loader, error))
+    if (!gdk_pixbuf_loader_close(load.loader, error))
         goto out;
 
-    pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+    pixbuf = gdk_pixbuf_loader_get_pixbuf(load.loader);
 
     if (!pixbuf) {
         g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED,
@@ -76,31 +117,32 @@ cairo_surface_t* rsvg_cairo_surface_new_from_href(RsvgHandle* handle, const char
 
     surface = rsvg_cairo_surface_from_pixbuf(pixbuf);
 
-    if (mime_type == NULL) {
+    if (load.mime_type == NULL) {
         /* Try to get the information from the loader */
         GdkPixbufFormat* format;
         char** mime_types;
 
-        if ((format = gdk_pixbuf_loader_get_format(loader)) != NULL) {
+        if ((format = gdk_pixbuf_loader_get_format(load.loader)) != NULL) {
             mime_types = gdk_pixbuf_format_get_mime_types(format);
 
             if (mime_types != NULL)
-                mime_type = g_strdup(mime_types[0]);
+                load.mime_type = g_strdup(mime_types[0]);
             g_strfreev(mime_types);
         }
     }
 
-    if ((handle->priv->flags & RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA) != 0 && mime_type != NULL &&
-        cairo_surface_set_mime_data(surface, mime_type, (guchar*)data, data_len, g_free, data) ==
-            CAIRO_STATUS_SUCCESS) {
-        data = NULL; /* transferred to the surface */
+    if (keep_data && bytes != NULL && load.mime_type != NULL &&
+        cairo_surface_set_mime_data(surface, load.mime_type, g_bytes_get_data(bytes, NULL), g_bytes_get_size(bytes),
+                                    (cairo_destroy_func_t)g_bytes_unref, bytes) == CAIRO_STATUS_SUCCESS) {
+        bytes = NULL; /* transferred to the surface */
     }
 
 out:
-    if (loader)
-        g_object_unref(loader);
-    g_free(mime_type);
-    g_free(data);
+    if (load.loader)
+        g_object_unref(load.loader);
+    g_free(load.mime_type);
+    if (bytes)
+        g_bytes_unref(bytes);
 
     return surface;
 }
@@ -170,7 +212,7 @@ static void rsvg_node_image_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
     w = _rsvg_css_normalize_length(&z->w, ctx, 'h');
     h = _rsvg_css_normalize_length(&z->h, ctx, 'v');
 
-    rsvg_state_reinherit_top(ctx, z->super.state, dominate);
+    rsvg_state_reinherit_top(ctx, &z->super, dominate);
 
     rsvg_push_discrete_layer(ctx);
 
@@ -186,46 +228,70 @@ static void rsvg_node_image_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
     rsvg_pop_discrete_layer(ctx);
 }
 
+typedef struct {
+    RsvgNodeImage* image;
+    char* href;
+} RsvgImageFetch;
+
+/* Runs on a prefetch thread; nothing else looks at the surface until the
+ * document has finished loading
+ */
+static void rsvg_node_image_fetch(RsvgHandle* handle, gpointer data) {
+    RsvgImageFetch* fetch = data;
+    cairo_surface_t* surface;
+
+    surface = rsvg_cairo_surface_new_from_href(handle, fetch->href, NULL);
+
+    if (!surface) {
+#ifdef G_ENABLE_DEBUG
+        g_warning("Couldn't load image: %s\n", fetch->href);
+#endif
+    }
+
+    fetch->image->surface = surface;
+
+    g_free(fetch->href);
+    g_free(fetch);
+}
+
 static void rsvg_node_image_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag* atts) {
     const char *klazz = NULL, *id = NULL, *value;
     RsvgNodeImage* image = (RsvgNodeImage*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             image->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             image->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             image->w = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             image->h = _rsvg_css_parse_length(value);
         /* path is used by some older adobe illustrator versions */
-        if ((value = rsvg_property_bag_lookup(atts, "path")) ||
-            (value = rsvg_property_bag_lookup(atts, "xlink:href"))) {
-            image->surface = rsvg_cairo_surface_new_from_href(ctx, value, NULL);
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PATH)) ||
+            (value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF))) {
+            RsvgImageFetch* fetch = g_new(RsvgImageFetch, 1);
 
-            if (!image->surface) {
-#ifdef G_ENABLE_DEBUG
-                g_warning("Couldn't load image: %s\n", value);
-#endif
-            }
+            fetch->image = image;
+            fetch->href = g_strdup(value);
+            rsvg_handle_prefetch(ctx, rsvg_node_image_fetch, fetch);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, id, &image->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAspectRatio")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ASPECT_RATIO)))
             image->preserve_aspect_ratio = rsvg_css_parse_aspect_ratio(value);
 
         rsvg_parse_style_attrs(ctx, image->super.state, "image", klazz, id, atts);
     }
 }
 
-RsvgNode* rsvg_new_image(void) {
+RsvgNode* rsvg_new_image(RsvgArena* arena) {
     RsvgNodeImage* image;
-    image = g_new(RsvgNodeImage, 1);
+    image = RSVG_ARENA_NEW(arena, RsvgNodeImage);
     _rsvg_node_init(&image->super, RSVG_NODE_TYPE_IMAGE);
     g_assert(image->super.state);
     image->surface = NULL;
@@ -0,0 +1,67 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-intern.c: Per-document string interning
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include "config.h"
+#include "rsvg-intern.h"
+
+struct _RsvgInterner {
+    GHashTable* strings; /* set of arena strings, each its own key and value */
+    RsvgArena* arena;
+};
+
+RsvgInterner* rsvg_interner_new(RsvgArena* arena) {
+    RsvgInterner* interner = g_new(RsvgInterner, 1);
+
+    interner->strings = g_hash_table_new(g_str_hash, g_str_equal);
+    interner->arena = arena;
+
+    return interner;
+}
+
+void rsvg_interner_free(RsvgInterner* interner) {
+    if (interner == NULL)
+        return;
+
+    g_hash_table_destroy(interner->strings);
+    g_free(interner);
+}
+
+const char* rsvg_interner_intern(RsvgInterner* interner, const char* str) {
+    char* interned;
+
+    if (str == NULL)
+        return NULL;
+
+    interned = g_hash_table_lookup(interner->strings, str);
+    if (interned == NULL) {
+        interned = rsvg_arena_strdup(interner->arena, str);
+        g_hash_table_add(interner->strings, interned);
+    }
+
+    return interned;
+}
+
+const char* rsvg_interner_lookup(const RsvgInterner* interner, const char* str) {
+    if (str == NULL)
+        return NULL;
+
+    return g_hash_table_lookup(interner->strings, str);
+}
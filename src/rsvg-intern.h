@@ -0,0 +1,52 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-intern.h: Per-document string interning
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RSVG_INTERN_H
+#define RSVG_INTERN_H
+
+#include <glib.h>
+
+#include "rsvg-arena.h"
+
+G_BEGIN_DECLS
+
+/* Ids, class lists, style attributes and CSS selectors are interned once per
+ * document, so two equal strings from the same handle are the same pointer
+ * and can be compared and hashed by address.  The strings live in the
+ * handle's arena.
+ */
+typedef struct _RsvgInterner RsvgInterner;
+
+G_GNUC_INTERNAL
+RsvgInterner* rsvg_interner_new(RsvgArena* arena);
+G_GNUC_INTERNAL
+void rsvg_interner_free(RsvgInterner* interner);
+
+/* Returns the canonical copy of @str, adding it if needed */
+G_GNUC_INTERNAL
+const char* rsvg_interner_intern(RsvgInterner* interner, const char* str);
+/* Returns the canonical copy of @str, or NULL if it was never interned */
+G_GNUC_INTERNAL
+const char* rsvg_interner_lookup(const RsvgInterner* interner, const char* str);
+
+G_END_DECLS
+
+#endif /* RSVG_INTERN_H */
@@ -63,16 +63,140 @@ static char* uri_decoded_copy(const char* part, gsize length) {
 #define BASE64_INDICATOR ";base64"
 #define BASE64_INDICATOR_LEN (sizeof(";base64") - 1)
 
-static char* rsvg_decode_data_uri(const char* uri, char** out_mime_type, gsize* out_len, GError** error) {
+/* data: payloads are decoded this much at a time, so that even a huge
+ * embedded image only ever needs a small buffer on top of the URI itself
+ */
+#define DATA_URI_CHUNK_SIZE (64 * 1024)
+
+#define BASE64_SKIP 0x80 /* whitespace and anything else outside the alphabet */
+#define BASE64_PAD 0x81
+
+static const guint8 base64_table[256] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3e, 0x80, 0x80, 0x80, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x80, 0x80, 0x80, 0x81, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+typedef struct {
+    guint32 acc;
+    guint n; /* sextets in acc */
+    guint pad; /* one bit per sextet in acc, set for padding */
+} Base64State;
+
+/* Decodes as much of @in as it can into @out, which must have room for
+ * (@len + 3) / 4 * 3 bytes.  This gives exactly what g_base64_decode()
+ * does: characters outside the alphabet are skipped, padding counts as a
+ * zero sextet that drops the bytes it stands for from its quad, decoding
+ * carries on after it, and the bytes of a trailing partial quad are never
+ * output.
+ */
+static gsize base64_decode_step(const guchar* in, gsize len, guint8* out, Base64State* state) {
+    const guchar* end = in + len;
+    guint8* o = out;
+    guint32 acc = state->acc;
+    guint n = state->n;
+    guint pad = state->pad;
+
+    while (in < end) {
+        guint8 c;
+
+        /* whole quads of clean characters take the fast path, which is all
+         * of the data in the usual case of a payload without line breaks
+         */
+        if (n == 0) {
+            while (end - in >= 4) {
+                guint32 v0 = base64_table[in[0]], v1 = base64_table[in[1]];
+                guint32 v2 = base64_table[in[2]], v3 = base64_table[in[3]];
+                guint32 v;
+
+                if ((v0 | v1 | v2 | v3) & 0x80)
+                    break;
+
+                v = v0 << 18 | v1 << 12 | v2 << 6 | v3;
+                o[0] = v >> 16;
+                o[1] = v >> 8;
+                o[2] = v;
+                o += 3;
+                in += 4;
+            }
+
+            if (in == end)
+                break;
+        }
+
+        c = base64_table[*in++];
+        if (c == BASE64_SKIP)
+            continue;
+
+        pad = pad << 1 | (c == BASE64_PAD);
+        acc = acc << 6 | (c == BASE64_PAD ? 0 : c);
+        if (++n == 4) {
+            /* like GLib, only padding in the last two places counts */
+            *o++ = acc >> 16;
+            if ((pad & 2) == 0)
+                *o++ = acc >> 8;
+            if ((pad & 1) == 0)
+                *o++ = acc;
+            acc = 0;
+            n = 0;
+            pad = 0;
+        }
+    }
+
+    state->acc = acc;
+    state->n = n;
+    state->pad = pad;
+
+    return o - out;
+}
+
+/* Percent-decodes from *@in into @out until @out is full or @end is
+ * reached.  Escapes are never split, since the whole payload is at hand.
+ */
+static gsize uri_decode_chunk(const char** in, const char* end, guint8* out, gsize out_len) {
+    const guchar* s = (const guchar*)*in;
+    guint8* d = out;
+
+    while ((const char*)s < end && d < out + out_len) {
+        if (*s == '%' && end - (const char*)s >= 3 && g_ascii_isxdigit(s[1]) && g_ascii_isxdigit(s[2])) {
+            *d++ = HEXCHAR(s);
+            s += 3;
+        }
+        else {
+            *d++ = *s++;
+        }
+    }
+
+    *in = (const char*)s;
+    return d - out;
+}
+
+gboolean _rsvg_io_decode_data_uri(const char* uri,
+                                  char** out_mime_type,
+                                  RsvgIoDataFunc func,
+                                  gpointer user_data,
+                                  GError** error) {
     const char *comma, *start, *end;
     char* mime_type;
-    char* data;
-    gsize data_len;
     gboolean base64 = FALSE;
+    gboolean escaped;
+    Base64State state = {0, 0, 0};
+    guint8* buf;
+    gsize n;
 
-    (void)error;
-
-    g_assert(out_len != NULL);
     g_assert(strncmp(uri, "data:", 5) == 0);
 
     mime_type = NULL;
@@ -95,45 +219,98 @@ static char* rsvg_decode_data_uri(const char* uri, char** out_mime_type, gsize*
         }
     }
 
+    if (out_mime_type)
+        *out_mime_type = mime_type;
+    else
+        g_free(mime_type);
+
     if (comma)
         start = comma + 1;
 
-    if (*start) {
-        data = uri_decoded_copy(start, strlen(start));
+    end = start + strlen(start);
+    if (start == end)
+        return TRUE;
 
-        if (base64)
-            data = (char*)g_base64_decode_inplace(data, &data_len);
-        else
-            data_len = strlen(data);
-    }
-    else {
-        data = NULL;
-        data_len = 0;
+    /* the percent-decoding pass is only needed if there is anything to decode */
+    escaped = memchr(start, '%', end - start) != NULL;
+
+    if (!base64 && !escaped)
+        return func((const guint8*)start, end - start, user_data, error);
+
+    /* percent-decoded input in the first half, base64 output in the second */
+    buf = g_malloc(2 * DATA_URI_CHUNK_SIZE);
+
+    while (start < end) {
+        const guint8* in;
+        gsize in_len;
+
+        if (escaped) {
+            in_len = uri_decode_chunk(&start, end, buf, DATA_URI_CHUNK_SIZE);
+            in = buf;
+        }
+        else {
+            in_len = MIN((gsize)(end - start), DATA_URI_CHUNK_SIZE);
+            in = (const guint8*)start;
+            start += in_len;
+        }
+
+        if (!base64) {
+            if (!func(in, in_len, user_data, error))
+                goto fail;
+            continue;
+        }
+
+        n = base64_decode_step(in, in_len, buf + DATA_URI_CHUNK_SIZE, &state);
+        if (n > 0 && !func(buf + DATA_URI_CHUNK_SIZE, n, user_data, error))
+            goto fail;
     }
 
-    if (out_mime_type)
-        *out_mime_type = mime_type;
-    else
-        g_free(mime_type);
+    g_free(buf);
+    return TRUE;
+
+fail:
+    g_free(buf);
+    return FALSE;
+}
+
+static gboolean append_to_byte_array(const guint8* data, gsize len, gpointer user_data, GError** error) {
+    (void)error;
+
+    g_byte_array_append(user_data, data, len);
+    return TRUE;
+}
+
+static GBytes* rsvg_decode_data_uri(const char* uri, char** out_mime_type, GError** error) {
+    /* enough for a base64 payload, and at most one resize otherwise */
+    GByteArray* array = g_byte_array_sized_new(strlen(uri) / 4 * 3 + 3);
+
+    _rsvg_io_decode_data_uri(uri, out_mime_type, append_to_byte_array, array, error);
 
-    *out_len = data_len;
-    return data;
+    if (array->len == 0) {
+        g_byte_array_free(array, TRUE);
+        return NULL;
+    }
+
+    return g_byte_array_free_to_bytes(array);
 }
 
-static char* rsvg_acquire_file_data(const char* uri,
-                                    char** out_mime_type,
-                                    gsize* out_len,
-                                    GCancellable* cancellable,
-                                    GError** error) {
+/* Local files are mapped rather than read, so that a large document is
+ * handed to the parser straight from the page cache instead of through a
+ * heap copy of the whole file.  Anything that cannot be mapped, such as a
+ * pipe, is read as before.
+ */
+static GBytes* rsvg_acquire_file_data(const char* uri,
+                                      char** out_mime_type,
+                                      GCancellable* cancellable,
+                                      GError** error) {
     g_autoptr(GFile) file = NULL;
     g_autofree gchar* path = NULL;
-    gchar* data;
-    gsize len;
+    GMappedFile* mapped;
+    GBytes* bytes;
 
     (void)cancellable;
 
     rsvg_return_val_if_fail(uri != NULL, NULL, error);
-    g_assert(out_len != NULL);
 
     fprintf(stderr, "SECURITY_AUDIT: Attempting to acquire: %s\n", uri);
 
@@ -144,19 +321,30 @@ static char* rsvg_acquire_file_data(const char* uri,
         return NULL;
     }
 
-    if (!g_file_get_contents(path, &data, &len, error)) {
-        return NULL;
+    if ((mapped = g_mapped_file_new(path, FALSE, NULL)) != NULL) {
+        bytes = g_mapped_file_get_bytes(mapped);
+        g_mapped_file_unref(mapped);
+    }
+    else {
+        gchar* data;
+        gsize len;
+
+        if (!g_file_get_contents(path, &data, &len, error)) {
+            return NULL;
+        }
+        bytes = g_bytes_new_take(data, len);
     }
 
     if (out_mime_type) {
-        g_autofree char* content_type = g_content_type_guess(path, (guchar*)data, len, NULL);
+        gsize len;
+        gconstpointer data = g_bytes_get_data(bytes, &len);
+        g_autofree char* content_type = g_content_type_guess(path, data, len, NULL);
         if (content_type) {
             *out_mime_type = g_content_type_get_mime_type(content_type);
         }
     }
 
-    *out_len = len;
-    return data;
+    return bytes;
 }
 
 static GInputStream* rsvg_acquire_gvfs_stream(const char* uri,
@@ -200,12 +388,11 @@ static GInputStream* rsvg_acquire_gvfs_stream(const char* uri,
     return stream;
 }
 
-static char* rsvg_acquire_gvfs_data(const char* uri,
-                                    const char* base_uri,
-                                    char** out_mime_type,
-                                    gsize* out_len,
-                                    GCancellable* cancellable,
-                                    GError** error) {
+static GBytes* rsvg_acquire_gvfs_data(const char* uri,
+                                      const char* base_uri,
+                                      char** out_mime_type,
+                                      GCancellable* cancellable,
+                                      GError** error) {
     g_autoptr(GFile) file = g_file_new_for_uri(uri);
     g_autoptr(GError) err = NULL;
     char* data = NULL;
@@ -236,35 +423,29 @@ static char* rsvg_acquire_gvfs_data(const char* uri,
         }
     }
 
-    *out_len = len;
-    return data;
+    return g_bytes_new_take(data, len);
 }
 
-char* _rsvg_io_acquire_data(const char* href,
-                            const char* base_uri,
-                            char** mime_type,
-                            gsize* len,
-                            GCancellable* cancellable,
-                            GError** error) {
-    char* data;
-    gsize llen;
+GBytes* _rsvg_io_acquire_data(const char* href,
+                              const char* base_uri,
+                              char** mime_type,
+                              GCancellable* cancellable,
+                              GError** error) {
+    GBytes* bytes;
 
     if (!(href && *href)) {
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid URI");
         return NULL;
     }
 
-    if (!len)
-        len = &llen;
-
     if (strncmp(href, "data:", 5) == 0)
-        return rsvg_decode_data_uri(href, mime_type, len, error);
+        return rsvg_decode_data_uri(href, mime_type, error);
 
-    if ((data = rsvg_acquire_file_data(href, mime_type, len, cancellable, NULL)))
-        return data;
+    if ((bytes = rsvg_acquire_file_data(href, mime_type, cancellable, NULL)))
+        return bytes;
 
-    if ((data = rsvg_acquire_gvfs_data(href, base_uri, mime_type, len, cancellable, error)))
-        return data;
+    if ((bytes = rsvg_acquire_gvfs_data(href, base_uri, mime_type, cancellable, error)))
+        return bytes;
 
     return NULL;
 }
@@ -275,8 +456,7 @@ GInputStream* _rsvg_io_acquire_stream(const char* href,
                                       GCancellable* cancellable,
                                       GError** error) {
     GInputStream* stream;
-    char* data;
-    gsize len;
+    g_autoptr(GBytes) bytes = NULL;
 
     if (!(href && *href)) {
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid URI");
@@ -284,14 +464,14 @@ GInputStream* _rsvg_io_acquire_stream(const char* href,
     }
 
     if (strncmp(href, "data:", 5) == 0) {
-        if (!(data = rsvg_decode_data_uri(href, mime_type, &len, error)))
+        if (!(bytes = rsvg_decode_data_uri(href, mime_type, error)))
             return NULL;
 
-        return g_memory_input_stream_new_from_data(data, len, (GDestroyNotify)g_free);
+        return g_memory_input_stream_new_from_bytes(bytes);
     }
 
-    if ((data = rsvg_acquire_file_data(href, mime_type, &len, cancellable, NULL)))
-        return g_memory_input_stream_new_from_data(data, len, (GDestroyNotify)g_free);
+    if ((bytes = rsvg_acquire_file_data(href, mime_type, cancellable, NULL)))
+        return g_memory_input_stream_new_from_bytes(bytes);
 
     if ((stream = rsvg_acquire_gvfs_stream(href, base_uri, mime_type, cancellable, error)))
         return stream;
@@ -26,12 +26,25 @@
 #include <glib.h>
 #include <gio/gio.h>
 
-char* _rsvg_io_acquire_data(const char* uri,
-                            const char* base_uri,
-                            char** mime_type,
-                            gsize* len,
-                            GCancellable* cancellable,
-                            GError** error);
+/* Local files come back as a read-only mapping */
+GBytes* _rsvg_io_acquire_data(const char* uri,
+                              const char* base_uri,
+                              char** mime_type,
+                              GCancellable* cancellable,
+                              GError** error);
+
+/* Receives the decoded payload of a data: URI a chunk at a time */
+typedef gboolean (*RsvgIoDataFunc)(const guint8* data, gsize len, gpointer user_data, GError** error);
+
+/* Decodes the payload of a data: URI straight out of @uri, a chunk at a
+ * time, and hands it to @func; *@mime_type is set before @func sees any
+ * data.  Returns FALSE if @func fails.
+ */
+gboolean _rsvg_io_decode_data_uri(const char* uri,
+                                  char** mime_type,
+                                  RsvgIoDataFunc func,
+                                  gpointer user_data,
+                                  GError** error);
 
 GInputStream* _rsvg_io_acquire_stream(const char* uri,
                                       const char* base_uri,
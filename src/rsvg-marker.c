@@ -46,43 +46,43 @@ static void rsvg_node_marker_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPrope
     marker = (RsvgMarker*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, id, &marker->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "viewBox")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VIEW_BOX)))
             marker->vbox = rsvg_css_parse_vbox(value);
-        if ((value = rsvg_property_bag_lookup(atts, "refX")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_REF_X)))
             marker->refX = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "refY")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_REF_Y)))
             marker->refY = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "markerWidth")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MARKER_WIDTH)))
             marker->width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "markerHeight")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MARKER_HEIGHT)))
             marker->height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "orient"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ORIENT))) {
             if (!strcmp(value, "auto"))
                 marker->orientAuto = TRUE;
             else
                 marker->orient = rsvg_css_parse_angle(value);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "markerUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MARKER_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 marker->bbox = FALSE;
             if (!strcmp(value, "strokeWidth"))
                 marker->bbox = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAspectRatio")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ASPECT_RATIO)))
             marker->preserve_aspect_ratio = rsvg_css_parse_aspect_ratio(value);
         rsvg_parse_style_attrs(ctx, self->state, "marker", klazz, id, atts);
     }
 }
 
-RsvgNode* rsvg_new_marker(void) {
+RsvgNode* rsvg_new_marker(RsvgArena* arena) {
     RsvgMarker* marker;
-    marker = g_new(RsvgMarker, 1);
+    marker = RSVG_ARENA_NEW(arena, RsvgMarker);
     _rsvg_node_init(&marker->super, RSVG_NODE_TYPE_MARKER);
     marker->orient = 0;
     marker->orientAuto = FALSE;
@@ -153,12 +153,9 @@ static void rsvg_marker_render(const char* marker_name,
     cairo_matrix_multiply(&affine, &taffine, &affine);
 
     rsvg_state_push(ctx);
-    state = rsvg_current_state(ctx);
-
-    rsvg_state_reinit(state);
-
-    rsvg_state_reconstruct(state, &self->super);
+    rsvg_state_reconstruct_top(ctx, &self->super);
 
+    state = rsvg_current_state(ctx);
     state->affine = affine;
 
     rsvg_push_discrete_layer(ctx);
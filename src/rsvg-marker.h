@@ -43,7 +43,7 @@ struct _RsvgMarker {
 };
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_marker(void);
+RsvgNode* rsvg_new_marker(RsvgArena* arena);
 G_GNUC_INTERNAL
 void rsvg_render_markers(RsvgDrawingCtx* ctx, const cairo_path_t* path);
 
@@ -35,41 +35,41 @@ static void rsvg_mask_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag*
     mask = (RsvgMask*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "maskUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MASK_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 mask->maskunits = userSpaceOnUse;
             else
                 mask->maskunits = objectBoundingBox;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "maskContentUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_MASK_CONTENT_UNITS))) {
             if (!strcmp(value, "objectBoundingBox"))
                 mask->contentunits = objectBoundingBox;
             else
                 mask->contentunits = userSpaceOnUse;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             mask->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             mask->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             mask->width = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             mask->height = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, id, &mask->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
     }
 
     rsvg_parse_style_attrs(ctx, mask->super.state, "mask", klazz, id, atts);
 }
 
-RsvgNode* rsvg_new_mask(void) {
+RsvgNode* rsvg_new_mask(RsvgArena* arena) {
     RsvgMask* mask;
 
-    mask = g_new(RsvgMask, 1);
+    mask = RSVG_ARENA_NEW(arena, RsvgMask);
     _rsvg_node_init(&mask->super, RSVG_NODE_TYPE_MASK);
     mask->maskunits = objectBoundingBox;
     mask->contentunits = userSpaceOnUse;
@@ -103,27 +103,27 @@ static void rsvg_clip_path_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropert
     clip_path = (RsvgClipPath*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "clipPathUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLIP_PATH_UNITS))) {
             if (!strcmp(value, "objectBoundingBox"))
                 clip_path->units = objectBoundingBox;
             else
                 clip_path->units = userSpaceOnUse;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, id, &clip_path->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
     }
 
     rsvg_parse_style_attrs(ctx, clip_path->super.state, "clipPath", klazz, id, atts);
 }
 
-RsvgNode* rsvg_new_clip_path(void) {
+RsvgNode* rsvg_new_clip_path(RsvgArena* arena) {
     RsvgClipPath* clip_path;
 
-    clip_path = g_new(RsvgClipPath, 1);
+    clip_path = RSVG_ARENA_NEW(arena, RsvgClipPath);
     _rsvg_node_init(&clip_path->super, RSVG_NODE_TYPE_CLIP_PATH);
     clip_path->units = userSpaceOnUse;
     clip_path->super.set_atts = rsvg_clip_path_set_atts;
@@ -46,7 +46,7 @@ struct _RsvgMask {
 };
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_mask(void);
+RsvgNode* rsvg_new_mask(RsvgArena* arena);
 
 typedef struct _RsvgClipPath RsvgClipPath;
 
@@ -56,7 +56,7 @@ struct _RsvgClipPath {
 };
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_clip_path(void);
+RsvgNode* rsvg_new_clip_path(RsvgArena* arena);
 
 G_END_DECLS
 #endif
@@ -0,0 +1,169 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-number.c: Locale-independent number scanning for attribute values
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#include "config.h"
+#include "rsvg-number.h"
+
+#include <string.h>
+
+/* Every power of ten that is exactly representable as a double */
+static const double rsvg_exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/* The result is correctly rounded: when the significand and the power of
+ * ten are both exact doubles a single multiplication or division rounds
+ * once (Clinger's fast path); everything else goes through g_ascii_strtod().
+ */
+double rsvg_decimal_to_double(const RsvgDecimal* decimal) {
+    char stack_buf[64];
+    char* buf;
+    gsize len;
+    double value;
+    int scale;
+
+    if (decimal->significand == 0)
+        return 0.0;
+
+    scale = decimal->exponent - decimal->fraction_digits;
+    if (decimal->n_digits <= RSVG_DECIMAL_MAX_FAST_DIGITS && decimal->significand <= (G_GUINT64_CONSTANT(1) << 53)) {
+        if (scale >= 0 && scale < (int)G_N_ELEMENTS(rsvg_exact_powers_of_ten))
+            return (double)decimal->significand * rsvg_exact_powers_of_ten[scale];
+        else if (scale < 0 && -scale < (int)G_N_ELEMENTS(rsvg_exact_powers_of_ten))
+            return (double)decimal->significand / rsvg_exact_powers_of_ten[-scale];
+    }
+
+    len = decimal->mantissa_end - decimal->mantissa;
+    buf = len + 16 <= sizeof(stack_buf) ? stack_buf : g_malloc(len + 16);
+    memcpy(buf, decimal->mantissa, len);
+    g_snprintf(buf + len, 16, "e%d", decimal->exponent);
+    value = g_ascii_strtod(buf, NULL);
+    if (buf != stack_buf)
+        g_free(buf);
+
+    return value;
+}
+
+gboolean rsvg_scan_number(const char** str, double* value) {
+    const char* p = *str;
+    RsvgDecimal decimal;
+    gboolean negative = FALSE;
+    gboolean has_digits = FALSE;
+    double result;
+
+    memset(&decimal, 0, sizeof(decimal));
+
+    if (*p == '+' || *p == '-')
+        negative = *p++ == '-';
+
+    decimal.mantissa = p;
+    for (; RSVG_IS_DIGIT(*p); p++) {
+        rsvg_decimal_push_digit(&decimal, *p, FALSE);
+        has_digits = TRUE;
+    }
+
+    /* "1." and ".5" are numbers, a lone "." is not */
+    if (*p == '.' && (has_digits || RSVG_IS_DIGIT(p[1]))) {
+        for (p++; RSVG_IS_DIGIT(*p); p++) {
+            rsvg_decimal_push_digit(&decimal, *p, TRUE);
+            has_digits = TRUE;
+        }
+    }
+
+    if (!has_digits)
+        return FALSE;
+
+    decimal.mantissa_end = p;
+
+    /* The exponent only counts if it has digits, so "1em" is 1 followed by "em" */
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        int exponent_sign = +1;
+        int exponent = 0;
+
+        if (*q == '+' || *q == '-')
+            exponent_sign = *q++ == '-' ? -1 : +1;
+
+        if (RSVG_IS_DIGIT(*q)) {
+            for (; RSVG_IS_DIGIT(*q); q++) {
+                if (exponent < RSVG_DECIMAL_MAX_EXPONENT)
+                    exponent = exponent * 10 + (*q - '0');
+            }
+            decimal.exponent = exponent_sign * exponent;
+            p = q;
+        }
+    }
+
+    result = rsvg_decimal_to_double(&decimal);
+    *value = negative ? -result : result;
+    *str = p;
+
+    return TRUE;
+}
+
+gboolean rsvg_scan_list_token(const char** str, const char** token, gsize* token_len) {
+    const char* p = *str;
+    const char* start;
+
+    while (rsvg_is_list_separator(*p))
+        p++;
+
+    if (*p == '\0') {
+        *str = p;
+        return FALSE;
+    }
+
+    start = p;
+    while (*p != '\0' && !rsvg_is_list_separator(*p))
+        p++;
+
+    *token = start;
+    *token_len = p - start;
+    *str = p;
+
+    return TRUE;
+}
+
+gboolean rsvg_scan_list_number(const char** str, double* value) {
+    const char* token;
+    gsize token_len;
+
+    if (!rsvg_scan_list_token(str, &token, &token_len))
+        return FALSE;
+
+    /* A number never spans a separator, so scanning cannot leave the item */
+    if (!rsvg_scan_number(&token, value))
+        *value = 0.0;
+
+    return TRUE;
+}
+
+guint rsvg_scan_list_count(const char* str) {
+    const char* token;
+    gsize token_len;
+    guint n = 0;
+
+    while (rsvg_scan_list_token(&str, &token, &token_len))
+        n++;
+
+    return n;
+}
@@ -0,0 +1,89 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+/*
+   rsvg-number.h: Locale-independent number scanning for attribute values
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RSVG_NUMBER_H
+#define RSVG_NUMBER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Significands with at most this many digits fit in a guint64 */
+#define RSVG_DECIMAL_MAX_FAST_DIGITS 19
+/* Exponents stop growing here, far beyond anything a significand of any
+ * plausible length could bring back into range, and well clear of overflow
+ */
+#define RSVG_DECIMAL_MAX_EXPONENT (G_MAXINT / 100)
+
+#define RSVG_IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+/* A decimal number as it was spelled in the source, before conversion */
+typedef struct {
+    const char* mantissa;     /* The digits and at most one '.' of the significand */
+    const char* mantissa_end;
+    guint64 significand;      /* The first RSVG_DECIMAL_MAX_FAST_DIGITS significant digits */
+    int n_digits;             /* Digits from the first non-zero one on */
+    int fraction_digits;      /* Digits after the '.' that went into the significand */
+    int exponent;
+} RsvgDecimal;
+
+static inline void rsvg_decimal_push_digit(RsvgDecimal* decimal, char c, gboolean fraction) {
+    if (decimal->n_digits < RSVG_DECIMAL_MAX_FAST_DIGITS) {
+        decimal->significand = decimal->significand * 10 + (c - '0');
+        if (fraction)
+            decimal->fraction_digits++;
+    }
+    if (decimal->n_digits > 0 || c != '0')
+        decimal->n_digits++;
+}
+
+G_GNUC_INTERNAL
+double rsvg_decimal_to_double(const RsvgDecimal* decimal);
+
+/* Scans an SVG number, [+-](digits[.digits]|.digits)[(e|E)[+-]digits], at
+ * *str.  Leading whitespace is not skipped.  On success stores the value,
+ * advances *str past the number and returns TRUE; otherwise leaves *str
+ * alone.
+ */
+G_GNUC_INTERNAL
+gboolean rsvg_scan_number(const char** str, double* value);
+
+/* Items in attribute lists are separated by any mix of whitespace and commas */
+static inline gboolean rsvg_is_list_separator(char c) {
+    return c == ',' || g_ascii_isspace(c);
+}
+
+/* Finds the next list item at or after *str and advances *str past it.
+ * Returns FALSE at the end of the string.
+ */
+G_GNUC_INTERNAL
+gboolean rsvg_scan_list_token(const char** str, const char** token, gsize* token_len);
+/* Like rsvg_scan_list_token(), but converts the number the item starts
+ * with; items that do not start with a number read as 0.
+ */
+G_GNUC_INTERNAL
+gboolean rsvg_scan_list_number(const char** str, double* value);
+G_GNUC_INTERNAL
+guint rsvg_scan_list_count(const char* str);
+
+G_END_DECLS
+
+#endif /* RSVG_NUMBER_H */
@@ -69,6 +69,14 @@ static RsvgPaintServer* rsvg_paint_server_iri(char* iri) {
     return result;
 }
 
+RsvgPaintServer* rsvg_paint_server_new_color(guint32 argb, gboolean current_color) {
+    return current_color ? rsvg_paint_server_solid_current_color() : rsvg_paint_server_solid(argb);
+}
+
+RsvgPaintServer* rsvg_paint_server_new_iri(const char* iri) {
+    return rsvg_paint_server_iri(g_strdup(iri));
+}
+
 /**
  * rsvg_paint_server_parse:
  * @str: The SVG paint specification string to parse.
@@ -116,7 +124,7 @@ RsvgPaintServer* rsvg_paint_server_parse(gboolean* inherit, const char* str) {
 void rsvg_paint_server_ref(RsvgPaintServer* ps) {
     if (ps == NULL)
         return;
-    ps->refcnt++;
+    g_atomic_int_inc(&ps->refcnt);
 }
 
 /**
@@ -128,7 +136,7 @@ void rsvg_paint_server_ref(RsvgPaintServer* ps) {
 void rsvg_paint_server_unref(RsvgPaintServer* ps) {
     if (ps == NULL)
         return;
-    if (--ps->refcnt == 0) {
+    if (g_atomic_int_dec_and_test(&ps->refcnt)) {
         if (ps->type == RSVG_PAINT_SERVER_SOLID)
             g_free(ps->core.color);
         else if (ps->type == RSVG_PAINT_SERVER_IRI)
@@ -147,7 +155,7 @@ static void rsvg_stop_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag*
     stop = (RsvgGradientStop*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "offset"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_OFFSET))) {
             /* either a number [0,1] or a percentage */
             RsvgLength length = _rsvg_css_parse_length(value);
             offset = _rsvg_css_hand_normalize_length(&length, rsvg_dpi_percentage(ctx), 1., 0.);
@@ -158,10 +166,10 @@ static void rsvg_stop_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag*
                 offset = 1.;
             stop->offset = offset;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "style")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STYLE)))
             rsvg_parse_style(ctx, self->state, value);
 
-        if ((value = rsvg_property_bag_lookup(atts, "stop-color")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_STOP_COLOR)))
             if (!strcmp(value, "currentColor"))
                 is_current_color = TRUE;
 
@@ -176,8 +184,8 @@ static void rsvg_stop_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag*
     rsvg_state_finalize(&state);
 }
 
-RsvgNode* rsvg_new_stop(void) {
-    RsvgGradientStop* stop = g_new(RsvgGradientStop, 1);
+RsvgNode* rsvg_new_stop(RsvgArena* arena) {
+    RsvgGradientStop* stop = RSVG_ARENA_NEW(arena, RsvgGradientStop);
     _rsvg_node_init(&stop->super, RSVG_NODE_TYPE_STOP);
     stop->super.set_atts = rsvg_stop_set_atts;
     stop->offset = 0;
@@ -190,25 +198,25 @@ static void rsvg_linear_gradient_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgP
     const char* value;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, self);
-        if ((value = rsvg_property_bag_lookup(atts, "x1"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X1))) {
             grad->x1 = _rsvg_css_parse_length(value);
             grad->hasx1 = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "y1"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y1))) {
             grad->y1 = _rsvg_css_parse_length(value);
             grad->hasy1 = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "x2"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X2))) {
             grad->x2 = _rsvg_css_parse_length(value);
             grad->hasx2 = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "y2"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y2))) {
             grad->y2 = _rsvg_css_parse_length(value);
             grad->hasy2 = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "spreadMethod"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SPREAD_METHOD))) {
             if (!strcmp(value, "pad")) {
                 grad->spread = CAIRO_EXTEND_PAD;
             }
@@ -221,14 +229,14 @@ static void rsvg_linear_gradient_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgP
             grad->hasspread = TRUE;
         }
         g_free(grad->fallback);
-        grad->fallback = g_strdup(rsvg_property_bag_lookup(atts, "xlink:href"));
-        if ((value = rsvg_property_bag_lookup(atts, "gradientTransform"))) {
+        grad->fallback = g_strdup(rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF));
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_GRADIENT_TRANSFORM))) {
             rsvg_parse_transform(&grad->affine, value);
             grad->hastransform = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "color")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_COLOR)))
             grad->current_color = rsvg_css_parse_color(value, 0);
-        if ((value = rsvg_property_bag_lookup(atts, "gradientUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_GRADIENT_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 grad->obj_bbox = FALSE;
             else if (!strcmp(value, "objectBoundingBox"))
@@ -245,9 +253,9 @@ static void rsvg_linear_gradient_free(RsvgNode* node) {
     _rsvg_node_free(node);
 }
 
-RsvgNode* rsvg_new_linear_gradient(void) {
+RsvgNode* rsvg_new_linear_gradient(RsvgArena* arena) {
     RsvgLinearGradient* grad = NULL;
-    grad = g_new(RsvgLinearGradient, 1);
+    grad = RSVG_ARENA_NEW(arena, RsvgLinearGradient);
     _rsvg_node_init(&grad->super, RSVG_NODE_TYPE_LINEAR_GRADIENT);
     cairo_matrix_init_identity(&grad->affine);
     grad->has_current_color = FALSE;
@@ -268,42 +276,42 @@ static void rsvg_radial_gradient_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgP
     const char* value;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, self);
-        if ((value = rsvg_property_bag_lookup(atts, "cx"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CX))) {
             grad->cx = _rsvg_css_parse_length(value);
             grad->hascx = TRUE;
             if (!grad->hasfx)
                 grad->fx = grad->cx;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "cy"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CY))) {
             grad->cy = _rsvg_css_parse_length(value);
             grad->hascy = TRUE;
             if (!grad->hasfy)
                 grad->fy = grad->cy;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "r"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_R))) {
             grad->r = _rsvg_css_parse_length(value);
             grad->hasr = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "fx"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_FX))) {
             grad->fx = _rsvg_css_parse_length(value);
             grad->hasfx = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "fy"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_FY))) {
             grad->fy = _rsvg_css_parse_length(value);
             grad->hasfy = TRUE;
         }
         g_free(grad->fallback);
-        grad->fallback = g_strdup(rsvg_property_bag_lookup(atts, "xlink:href"));
-        if ((value = rsvg_property_bag_lookup(atts, "gradientTransform"))) {
+        grad->fallback = g_strdup(rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF));
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_GRADIENT_TRANSFORM))) {
             rsvg_parse_transform(&grad->affine, value);
             grad->hastransform = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "color"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_COLOR))) {
             grad->current_color = rsvg_css_parse_color(value, 0);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "spreadMethod"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_SPREAD_METHOD))) {
             if (!strcmp(value, "pad"))
                 grad->spread = CAIRO_EXTEND_PAD;
             else if (!strcmp(value, "reflect"))
@@ -312,7 +320,7 @@ static void rsvg_radial_gradient_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgP
                 grad->spread = CAIRO_EXTEND_REPEAT;
             grad->hasspread = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "gradientUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_GRADIENT_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 grad->obj_bbox = FALSE;
             else if (!strcmp(value, "objectBoundingBox"))
@@ -329,8 +337,8 @@ static void rsvg_radial_gradient_free(RsvgNode* node) {
     _rsvg_node_free(node);
 }
 
-RsvgNode* rsvg_new_radial_gradient(void) {
-    RsvgRadialGradient* grad = g_new(RsvgRadialGradient, 1);
+RsvgNode* rsvg_new_radial_gradient(RsvgArena* arena) {
+    RsvgRadialGradient* grad = RSVG_ARENA_NEW(arena, RsvgRadialGradient);
     _rsvg_node_init(&grad->super, RSVG_NODE_TYPE_RADIAL_GRADIENT);
     cairo_matrix_init_identity(&grad->affine);
     grad->has_current_color = FALSE;
@@ -350,49 +358,49 @@ static void rsvg_pattern_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyB
     const char* value;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID)))
             rsvg_defs_register_name(ctx->priv->defs, value, self);
-        if ((value = rsvg_property_bag_lookup(atts, "viewBox"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VIEW_BOX))) {
             pattern->vbox = rsvg_css_parse_vbox(value);
             pattern->hasvbox = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "x"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X))) {
             pattern->x = _rsvg_css_parse_length(value);
             pattern->hasx = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "y"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y))) {
             pattern->y = _rsvg_css_parse_length(value);
             pattern->hasy = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "width"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH))) {
             pattern->width = _rsvg_css_parse_length(value);
             pattern->haswidth = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "height"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT))) {
             pattern->height = _rsvg_css_parse_length(value);
             pattern->hasheight = TRUE;
         }
         g_free(pattern->fallback);
-        pattern->fallback = g_strdup(rsvg_property_bag_lookup(atts, "xlink:href"));
-        if ((value = rsvg_property_bag_lookup(atts, "patternTransform"))) {
+        pattern->fallback = g_strdup(rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF));
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PATTERN_TRANSFORM))) {
             rsvg_parse_transform(&pattern->affine, value);
             pattern->hastransform = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "patternUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PATTERN_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 pattern->obj_bbox = FALSE;
             else if (!strcmp(value, "objectBoundingBox"))
                 pattern->obj_bbox = TRUE;
             pattern->hasbbox = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "patternContentUnits"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PATTERN_CONTENT_UNITS))) {
             if (!strcmp(value, "userSpaceOnUse"))
                 pattern->obj_cbbox = FALSE;
             else if (!strcmp(value, "objectBoundingBox"))
                 pattern->obj_cbbox = TRUE;
             pattern->hascbox = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAspectRatio"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ASPECT_RATIO))) {
             pattern->preserve_aspect_ratio = rsvg_css_parse_aspect_ratio(value);
             pattern->hasaspect = TRUE;
         }
@@ -405,8 +413,8 @@ static void rsvg_pattern_free(RsvgNode* node) {
     _rsvg_node_free(node);
 }
 
-RsvgNode* rsvg_new_pattern(void) {
-    RsvgPattern* pattern = g_new(RsvgPattern, 1);
+RsvgNode* rsvg_new_pattern(RsvgArena* arena) {
+    RsvgPattern* pattern = RSVG_ARENA_NEW(arena, RsvgPattern);
     _rsvg_node_init(&pattern->super, RSVG_NODE_TYPE_PATTERN);
     cairo_matrix_init_identity(&pattern->affine);
     pattern->obj_bbox = TRUE;
@@ -131,19 +131,24 @@ struct _RsvgPaintServer {
 /* Create a new paint server based on a specification string. */
 G_GNUC_INTERNAL
 RsvgPaintServer* rsvg_paint_server_parse(gboolean* inherit, const char* str);
+/* The paint servers rsvg_paint_server_parse() makes, from their parts */
+G_GNUC_INTERNAL
+RsvgPaintServer* rsvg_paint_server_new_color(guint32 argb, gboolean current_color);
+G_GNUC_INTERNAL
+RsvgPaintServer* rsvg_paint_server_new_iri(const char* iri);
 G_GNUC_INTERNAL
 void rsvg_paint_server_ref(RsvgPaintServer* ps);
 G_GNUC_INTERNAL
 void rsvg_paint_server_unref(RsvgPaintServer* ps);
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_linear_gradient(void);
+RsvgNode* rsvg_new_linear_gradient(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_radial_gradient(void);
+RsvgNode* rsvg_new_radial_gradient(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_stop(void);
+RsvgNode* rsvg_new_stop(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_pattern(void);
+RsvgNode* rsvg_new_pattern(RsvgArena* arena);
 G_GNUC_INTERNAL
 void rsvg_pattern_fix_fallback(RsvgDrawingCtx* ctx, RsvgPattern* pattern);
 G_GNUC_INTERNAL
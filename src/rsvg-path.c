@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "rsvg-number.h"
 #include "rsvg-private.h"
 
 /* This module parses an SVG path element into an cairo_path_t.
@@ -60,16 +61,21 @@ struct _RSVGParsePathCtx {
 };
 
 static inline void rsvg_path_builder_ensure_capacity(RsvgPathBuilder* builder, int additional_capacity) {
-    (void)builder;
-    (void)additional_capacity;
+    if (G_UNLIKELY(builder->n_data + additional_capacity > builder->capacity)) {
+        builder->capacity = MAX(builder->capacity * 2, builder->n_data + additional_capacity);
+        builder->data = g_renew(cairo_path_data_t, builder->data, builder->capacity);
+    }
 }
 
+/* Callers reserve room with rsvg_path_builder_ensure_capacity() first */
 static inline void rsvg_path_builder_add_element(RsvgPathBuilder* builder, cairo_path_data_t* data) {
-    g_array_append_val(builder->path_data, *data);
+    builder->data[builder->n_data++] = *data;
 }
 
 void rsvg_path_builder_init(RsvgPathBuilder* builder, int n_elements) {
-    builder->path_data = g_array_sized_new(FALSE, FALSE, sizeof(cairo_path_data_t), n_elements);
+    builder->capacity = MAX(n_elements, 1);
+    builder->data = g_new(cairo_path_data_t, builder->capacity);
+    builder->n_data = 0;
     builder->last_move_to_index = -1;
 }
 
@@ -81,7 +87,7 @@ void rsvg_path_builder_move_to(RsvgPathBuilder* builder, double x, double y) {
     data.header.type = CAIRO_PATH_MOVE_TO;
     data.header.length = 2;
     rsvg_path_builder_add_element(builder, &data);
-    builder->last_move_to_index = builder->path_data->len - 1;
+    builder->last_move_to_index = builder->n_data - 1;
 
     data.point.x = x;
     data.point.y = y;
@@ -131,13 +137,17 @@ void rsvg_path_builder_close_path(RsvgPathBuilder* builder) {
 
     rsvg_path_builder_ensure_capacity(builder, 1);
 
+    /* Without a preceding move-to the parser takes this element as the
+     * current point, so don't leave half of it uninitialized.
+     */
+    memset(&data, 0, sizeof(data));
     data.header.type = CAIRO_PATH_CLOSE_PATH;
     data.header.length = 1;
     rsvg_path_builder_add_element(builder, &data);
 
     /* Add a 'move-to' element */
     if (builder->last_move_to_index >= 0) {
-        cairo_path_data_t* moveto = &g_array_index(builder->path_data, cairo_path_data_t, builder->last_move_to_index);
+        cairo_path_data_t* moveto = &builder->data[builder->last_move_to_index];
 
         rsvg_path_builder_move_to(builder, moveto[1].point.x, moveto[1].point.y);
     }
@@ -146,11 +156,35 @@ void rsvg_path_builder_close_path(RsvgPathBuilder* builder) {
 cairo_path_t* rsvg_path_builder_finish(RsvgPathBuilder* builder) {
     cairo_path_t* path;
 
+    /* Give back what a generous initial estimate left unused */
+    if (builder->n_data > 0 && builder->capacity - builder->n_data > builder->n_data / 4)
+        builder->data = g_renew(cairo_path_data_t, builder->data, builder->n_data);
+
     path = g_new(cairo_path_t, 1);
     path->status = CAIRO_STATUS_SUCCESS;
-    path->data = (cairo_path_data_t*)builder->path_data->data; /* adopt array segment */
-    path->num_data = builder->path_data->len;
-    g_array_free(builder->path_data, FALSE);
+    path->data = builder->data; /* adopt the buffer */
+    path->num_data = builder->n_data;
+
+    builder->data = NULL;
+    builder->n_data = builder->capacity = 0;
+
+    return path;
+}
+
+/* Like rsvg_path_builder_finish(), but the path is copied into @arena and
+ * must not be passed to rsvg_cairo_path_destroy()
+ */
+cairo_path_t* rsvg_path_builder_finish_in_arena(RsvgPathBuilder* builder, RsvgArena* arena) {
+    cairo_path_t* path;
+
+    path = RSVG_ARENA_NEW(arena, cairo_path_t);
+    path->status = CAIRO_STATUS_SUCCESS;
+    path->data = rsvg_arena_memdup(arena, builder->data, builder->n_data * sizeof(cairo_path_data_t));
+    path->num_data = builder->n_data;
+
+    g_free(builder->data);
+    builder->data = NULL;
+    builder->n_data = builder->capacity = 0;
 
     return path;
 }
@@ -520,8 +554,7 @@ static void rsvg_parse_path_do_cmd(RSVGParsePathCtx* ctx, gboolean final) {
     }
 }
 
-static void rsvg_path_end_of_number(RSVGParsePathCtx* ctx, double val, int sign, int exp_sign, int exp) {
-    val *= sign * pow(10, exp_sign * exp);
+static void rsvg_path_end_of_number(RSVGParsePathCtx* ctx, double val) {
     if (ctx->rel) {
         /* Handle relative coordinates. This switch statement attempts
            to determine _what_ the coords are relative to. This is
@@ -562,114 +595,86 @@ static void rsvg_path_end_of_number(RSVGParsePathCtx* ctx, double val, int sign,
     rsvg_parse_path_do_cmd(ctx, FALSE);
 }
 
-#define RSVGN_IN_PREINTEGER 0
-#define RSVGN_IN_INTEGER 1
-#define RSVGN_IN_FRACTION 2
-#define RSVGN_IN_PREEXPONENT 3
-#define RSVGN_IN_EXPONENT 4
-
-#define RSVGN_GOT_SIGN 0x1
-#define RSVGN_GOT_EXPONENT_SIGN 0x2
-
 /* Returns the length of the number parsed, so it can be skipped
  * in rsvg_parse_path_data. Calls rsvg_path_end_number to have the number
  * processed in its command.
+ *
+ * This accepts exactly what the old character-at-a-time state machine
+ * did, quirks included: characters other than signs, '.' and digits are
+ * skipped before the first digit and right after an 'e', and a second
+ * sign in either place ends the number just after it.  Runs of digits
+ * are folded into the significand as they are scanned; the conversion is
+ * shared with rsvg_scan_number().
  */
 static int rsvg_parse_number(RSVGParsePathCtx* ctx, const char* data) {
-    int length = 0;
-    int in = RSVGN_IN_PREINTEGER; /* Current location within the number */
-    int got = 0x0;                /* [bitfield] Having 2 of each of these is an error */
-    gboolean end = FALSE;         /* Set to true if the number should end after a char */
-    gboolean error = FALSE;       /* Set to true if the number ended due to an error */
-
-    double value = 0.0;
-    double fraction = 1.0;
-    int sign = +1; /* Presume the INTEGER is positive if it has no sign */
+    const char* p = data;
+    RsvgDecimal decimal;
+    gboolean got_sign = FALSE;
+    gboolean error = FALSE; /* Set to true if the number ended due to an error */
+    int sign = +1;          /* Presume the INTEGER is positive if it has no sign */
     int exponent = 0;
     int exponent_sign = +1; /* Presume the EXPONENT is positive if it has no sign */
+    double value;
 
-    while (data[length] != '\0' && !end && !error) {
-        char c = data[length];
-        switch (in) {
-            case RSVGN_IN_PREINTEGER: /* No numbers yet, we're just starting out */
-                /* LEGAL: + - .->FRACTION DIGIT->INTEGER */
-                if (c == '+' || c == '-') {
-                    if (got & RSVGN_GOT_SIGN) {
-                        error = TRUE; /* Two signs: not allowed */
-                    }
-                    else {
-                        sign = c == '+' ? +1 : -1;
-                        got |= RSVGN_GOT_SIGN;
-                    }
-                }
-                else if (c == '.') {
-                    in = RSVGN_IN_FRACTION;
-                }
-                else if (c >= '0' && c <= '9') {
-                    value = c - '0';
-                    in = RSVGN_IN_INTEGER;
-                }
-                break;
-            case RSVGN_IN_INTEGER: /* Previous character(s) was/were digit(s) */
-                /* LEGAL: DIGIT .->FRACTION E->PREEXPONENT */
-                if (c >= '0' && c <= '9') {
-                    value = value * 10 + (c - '0');
-                }
-                else if (c == '.') {
-                    in = RSVGN_IN_FRACTION;
-                }
-                else if (c == 'e' || c == 'E') {
-                    in = RSVGN_IN_PREEXPONENT;
-                }
-                else {
-                    end = TRUE;
-                }
-                break;
-            case RSVGN_IN_FRACTION: /* Previously, digit(s) in the fractional part */
-                /* LEGAL: DIGIT E->PREEXPONENT */
-                if (c >= '0' && c <= '9') {
-                    fraction *= 0.1;
-                    value += fraction * (c - '0');
-                }
-                else if (c == 'e' || c == 'E') {
-                    in = RSVGN_IN_PREEXPONENT;
-                }
-                else {
-                    end = TRUE;
-                }
+    memset(&decimal, 0, sizeof(decimal));
+
+    /* No numbers yet, we're just starting out */
+    for (; *p != '\0'; p++) {
+        if (*p == '+' || *p == '-') {
+            if (got_sign) {
+                error = TRUE; /* Two signs: not allowed */
                 break;
-            case RSVGN_IN_PREEXPONENT: /* Right after E */
-                /* LEGAL: + - DIGIT->EXPONENT */
-                if (c == '+' || c == '-') {
-                    if (got & RSVGN_GOT_EXPONENT_SIGN) {
+            }
+            sign = *p == '+' ? +1 : -1;
+            got_sign = TRUE;
+        }
+        else if (*p == '.' || RSVG_IS_DIGIT(*p)) {
+            decimal.mantissa = p;
+            break;
+        }
+    }
+
+    if (decimal.mantissa) {
+        for (; RSVG_IS_DIGIT(*p); p++)
+            rsvg_decimal_push_digit(&decimal, *p, FALSE);
+
+        if (*p == '.') {
+            for (p++; RSVG_IS_DIGIT(*p); p++)
+                rsvg_decimal_push_digit(&decimal, *p, TRUE);
+        }
+
+        decimal.mantissa_end = p;
+
+        if (*p == 'e' || *p == 'E') {
+            gboolean got_exponent_sign = FALSE;
+
+            for (p++; *p != '\0' && !RSVG_IS_DIGIT(*p); p++) {
+                if (*p == '+' || *p == '-') {
+                    if (got_exponent_sign) {
                         error = TRUE; /* Two signs: not allowed */
+                        break;
                     }
-                    else {
-                        exponent_sign = c == '+' ? +1 : -1;
-                        got |= RSVGN_GOT_EXPONENT_SIGN;
-                    }
-                }
-                else if (c >= '0' && c <= '9') {
-                    exponent = c - '0';
-                    in = RSVGN_IN_EXPONENT;
-                }
-                break;
-            case RSVGN_IN_EXPONENT: /* After E and the sign, if applicable */
-                /* LEGAL: DIGIT */
-                if (c >= '0' && c <= '9') {
-                    exponent = exponent * 10 + (c - '0');
+                    exponent_sign = *p == '+' ? +1 : -1;
+                    got_exponent_sign = TRUE;
                 }
-                else {
-                    end = TRUE;
+            }
+
+            if (!error) {
+                for (; RSVG_IS_DIGIT(*p); p++) {
+                    if (exponent < RSVG_DECIMAL_MAX_EXPONENT)
+                        exponent = exponent * 10 + (*p - '0');
                 }
-                break;
+            }
         }
-        length++;
     }
 
     /* TODO? if (error) report_the_error_somehow(); */
-    rsvg_path_end_of_number(ctx, value, sign, exponent_sign, exponent);
-    return end /* && !error */ ? length - 1 : length;
+    decimal.exponent = exponent_sign * exponent;
+    value = rsvg_decimal_to_double(&decimal);
+    rsvg_path_end_of_number(ctx, sign < 0 ? -value : value);
+
+    /* The offending sign is consumed along with the number */
+    return p - data + (error ? 1 : 0);
 }
 
 static void rsvg_parse_path_data(RSVGParsePathCtx* ctx, const char* data) {
@@ -687,8 +692,7 @@ static void rsvg_parse_path_data(RSVGParsePathCtx* ctx, const char* data) {
                 rsvg_parse_path_do_cmd(ctx, TRUE);
             rsvg_path_builder_close_path(&ctx->builder);
 
-            ctx->cp = ctx->rp =
-                g_array_index(ctx->builder.path_data, cairo_path_data_t, ctx->builder.path_data->len - 1);
+            ctx->cp = ctx->rp = ctx->builder.data[ctx->builder.n_data - 1];
         }
         else if (c >= 'A' && c < 'Z' && c != 'E') {
             if (ctx->param)
@@ -706,26 +710,44 @@ static void rsvg_parse_path_data(RSVGParsePathCtx* ctx, const char* data) {
     }
 }
 
-cairo_path_t* rsvg_parse_path(const char* path_str) {
-    RSVGParsePathCtx ctx;
+static void rsvg_parse_path_into_builder(RSVGParsePathCtx* ctx, const char* path_str) {
+    gsize len = strlen(path_str);
 
-    rsvg_path_builder_init(&ctx.builder, 32);
+    /* A coordinate pair takes at least four characters ("1 2 ") and yields
+     * at most two elements; real-world data is sparser, and the builder
+     * trims what is left over when it finishes.
+     */
+    rsvg_path_builder_init(&ctx->builder, (int)MIN(len / 4 + 16, G_MAXINT / 2));
 
-    ctx.cp.point.x = 0.0;
-    ctx.cp.point.y = 0.0;
-    ctx.rp.point.x = 0.0;
-    ctx.rp.point.y = 0.0;
-    ctx.cmd = 0;
-    ctx.param = 0;
+    ctx->cp.point.x = 0.0;
+    ctx->cp.point.y = 0.0;
+    ctx->rp.point.x = 0.0;
+    ctx->rp.point.y = 0.0;
+    ctx->cmd = 0;
+    ctx->param = 0;
+    /* An arc cut short reads all seven parameters */
+    memset(ctx->params, 0, sizeof(ctx->params));
 
-    rsvg_parse_path_data(&ctx, path_str);
+    rsvg_parse_path_data(ctx, path_str);
 
-    if (ctx.param)
-        rsvg_parse_path_do_cmd(&ctx, TRUE);
+    if (ctx->param)
+        rsvg_parse_path_do_cmd(ctx, TRUE);
+}
+
+cairo_path_t* rsvg_parse_path(const char* path_str) {
+    RSVGParsePathCtx ctx;
 
+    rsvg_parse_path_into_builder(&ctx, path_str);
     return rsvg_path_builder_finish(&ctx.builder);
 }
 
+cairo_path_t* rsvg_parse_path_in_arena(const char* path_str, RsvgArena* arena) {
+    RSVGParsePathCtx ctx;
+
+    rsvg_parse_path_into_builder(&ctx, path_str);
+    return rsvg_path_builder_finish_in_arena(&ctx.builder, arena);
+}
+
 void rsvg_cairo_path_destroy(cairo_path_t* path) {
     if (path == NULL)
         return;
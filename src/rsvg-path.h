@@ -30,10 +30,14 @@
 #include <glib.h>
 #include <cairo.h>
 
+#include "rsvg-arena.h"
+
 G_BEGIN_DECLS
 
 typedef struct {
-    GArray* path_data;
+    cairo_path_data_t* data;
+    int n_data;
+    int capacity;
     int last_move_to_index;
 } RsvgPathBuilder;
 
@@ -69,8 +73,12 @@ void rsvg_path_builder_close_path(RsvgPathBuilder* builder);
 G_GNUC_INTERNAL
 cairo_path_t* rsvg_path_builder_finish(RsvgPathBuilder* builder);
 G_GNUC_INTERNAL
+cairo_path_t* rsvg_path_builder_finish_in_arena(RsvgPathBuilder* builder, RsvgArena* arena);
+G_GNUC_INTERNAL
 cairo_path_t* rsvg_parse_path(const char* path_str);
 G_GNUC_INTERNAL
+cairo_path_t* rsvg_parse_path_in_arena(const char* path_str, RsvgArena* arena);
+G_GNUC_INTERNAL
 void rsvg_cairo_path_destroy(cairo_path_t* path);
 
 G_END_DECLS
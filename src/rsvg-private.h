@@ -30,6 +30,11 @@
 #include <cairo.h>
 
 #include "rsvg.h"
+#include "rsvg-arena.h"
+#include "rsvg-intern.h"
+#include "rsvg-geometry.h"
+#include "rsvg-cache.h"
+#include "rsvg-atoms.h"
 
 #include <libxml/parser.h>
 #include <libxml/xmlmemory.h>
@@ -53,8 +58,9 @@ G_BEGIN_DECLS
 typedef struct RsvgSaxHandler RsvgSaxHandler;
 typedef struct RsvgDrawingCtx RsvgDrawingCtx;
 typedef struct RsvgRender RsvgRender;
-typedef GHashTable RsvgPropertyBag;
+typedef struct _RsvgPropertyBag RsvgPropertyBag;
 typedef struct _RsvgState RsvgState;
+typedef struct _RsvgComputedStyle RsvgComputedStyle;
 typedef struct _RsvgDefs RsvgDefs;
 typedef struct _RsvgNode RsvgNode;
 typedef struct _RsvgFilter RsvgFilter;
@@ -158,11 +164,20 @@ struct RsvgHandlePrivate {
     /* stack; there is a state for each element */
 
     RsvgDefs* defs;
+    /* nodes, their id/class/style strings and path data; outlives defs */
+    RsvgArena* arena;
+    /* ids, class lists, style attributes and selectors, in the arena */
+    RsvgInterner* interner;
+    /* path data and point lists waiting to be compiled into the arena */
+    RsvgGeometryQueue* geometry;
     guint nest_level;
     RsvgNode* currentnode;
     /* this is the root level of the displayable tree, essentially what the
        file is converted into at the end */
     RsvgNode* treebase;
+    /* the CHARS node in a text or tspan that further character data in the
+       same element is appended to; NULL once a tspan follows it */
+    RsvgNodeChars* last_chars;
 
     RsvgCssEngine* css_engine;
 
@@ -189,9 +204,20 @@ struct RsvgHandlePrivate {
     gchar* base_uri;
     GFile* base_gfile;
 
-    gboolean in_loop; /* see get_dimension() */
+    GByteArray* compressed_data; /* for rsvg_handle_write of svgz data */
 
-    GInputStream* compressed_input_stream; /* for rsvg_handle_write of svgz data */
+    /* external resources being fetched while the document loads */
+    guint prefetch_pending;
+    GMutex prefetch_lock;
+    GCond prefetch_done;
+    gboolean is_extern; /* loaded as the target of another document's <use> */
+
+    guint style_threads; /* for restyling; 0 picks them by the size of the tree */
+
+    /* with RSVG_HANDLE_FLAG_CACHEABLE, what rsvg_handle_save_cache() needs */
+    RsvgCacheWriter* cache_writer;
+    /* the cache the document was loaded from, which its paths point into */
+    RsvgCache* cache;
 
     gboolean is_testing; /* Are we being run from the test suite? */
 };
@@ -206,6 +232,8 @@ typedef struct {
 struct RsvgDrawingCtx {
     RsvgRender* render;
     RsvgState* state;
+    GPtrArray* state_chunks; /* storage for the state stack, see rsvg_state_push() */
+    guint n_states;
     GError** error;
     RsvgDefs* defs;
     gsize num_elements_acquired;
@@ -316,13 +344,15 @@ typedef enum {
 struct _RsvgNode {
     RsvgState* state;
     RsvgState* base_state;
+    RsvgComputedStyle* computed; /* styles computed for drawing, see rsvg_state_reinherit_top() */
     RsvgNode* parent;
     GPtrArray* children;
     RsvgNodeType type;
-    char* name; /* owned */
-    char* id;
-    char* klass;
-    char* style_attr;
+    RsvgElementAtom atom;
+    const char* name; /* static for known elements, in the arena for RSVG_ELEMENT_UNKNOWN */
+    const char* id; /* interned, like klass and style_attr */
+    const char* klass;
+    const char* style_attr;
     RsvgPropertyBag* atts;
     guint has_style_info : 1;
     void (*free)(RsvgNode* self);
@@ -340,6 +370,32 @@ struct _RsvgNodeChars {
 
 typedef void (*RsvgPropertyBagEnumFunc)(const char* key, const char* value, gpointer user_data);
 
+typedef struct {
+    RsvgAttributeAtom atom;
+    const char* name;
+    const char* value;
+} RsvgAttribute;
+
+/* Elements with more attributes than this spill over to the heap */
+#define RSVG_PROPERTY_BAG_PREALLOC 16
+
+/* A flat view over libxml2's NULL-terminated name/value array.  The SAX
+ * loader keeps one on the stack for each element; only bags made by
+ * rsvg_property_bag_new() or rsvg_property_bag_dup() live on the heap, and
+ * only duplicated bags own their strings.
+ */
+struct _RsvgPropertyBag {
+    guint n_attributes;
+    guint is_heap : 1;
+    guint owns_strings : 1;
+    RsvgAttribute* attributes;
+    RsvgAttribute prealloc[RSVG_PROPERTY_BAG_PREALLOC];
+};
+
+G_GNUC_INTERNAL
+void rsvg_property_bag_init(RsvgPropertyBag* bag, const char** atts);
+G_GNUC_INTERNAL
+void rsvg_property_bag_clear(RsvgPropertyBag* bag);
 G_GNUC_INTERNAL
 RsvgPropertyBag* rsvg_property_bag_new(const char** atts);
 G_GNUC_INTERNAL
@@ -350,6 +406,16 @@ G_GNUC_INTERNAL
 const char* rsvg_property_bag_lookup(RsvgPropertyBag* bag, const char* key);
 G_GNUC_INTERNAL
 guint rsvg_property_bag_size(RsvgPropertyBag* bag);
+
+static inline const char* rsvg_property_bag_lookup_atom(RsvgPropertyBag* bag, RsvgAttributeAtom atom) {
+    guint i;
+
+    for (i = 0; i < bag->n_attributes; i++)
+        if (bag->attributes[i].atom == atom)
+            return bag->attributes[i].value;
+
+    return NULL;
+}
 G_GNUC_INTERNAL
 void rsvg_property_bag_enumerate(RsvgPropertyBag* bag, RsvgPropertyBagEnumFunc func, gpointer user_data);
 /* for some reason this one's public... */
@@ -404,9 +470,9 @@ double _rsvg_css_hand_normalize_length(const RsvgLength* in,
                                        gdouble pixels_per_inch,
                                        gdouble width_or_height,
                                        gdouble font_size);
-double _rsvg_css_normalize_font_size(RsvgState* state, RsvgDrawingCtx* ctx);
+double _rsvg_css_normalize_font_size(RsvgState* state);
 G_GNUC_INTERNAL
-double _rsvg_css_accumulate_baseline_shift(RsvgState* state, RsvgDrawingCtx* ctx);
+double _rsvg_css_accumulate_baseline_shift(RsvgState* state);
 G_GNUC_INTERNAL
 RsvgLength _rsvg_css_parse_length(const char* str);
 G_GNUC_INTERNAL
@@ -427,10 +493,25 @@ G_GNUC_INTERNAL
 gboolean rsvg_allow_load(GFile* base_gfile, const char* uri, GError** error);
 
 G_GNUC_INTERNAL
-char* _rsvg_handle_acquire_data(RsvgHandle* handle, const char* uri, char** content_type, gsize* len, GError** error);
+GBytes* _rsvg_handle_acquire_data(RsvgHandle* handle, const char* uri, char** content_type, GError** error);
 G_GNUC_INTERNAL
 GInputStream* _rsvg_handle_acquire_stream(RsvgHandle* handle, const char* uri, char** content_type, GError** error);
 
+typedef void (*RsvgPrefetchFunc)(RsvgHandle* handle, gpointer data);
+
+/* Runs @func on a worker thread while the document goes on loading.  It is
+ * for fetching and decoding external resources, and may store its result
+ * in the node it came from; rsvg_handle_finish_prefetch() waits for every
+ * such job of @handle, and the end of the load calls it before anything
+ * looks at the results.
+ */
+G_GNUC_INTERNAL
+void rsvg_handle_prefetch(RsvgHandle* handle, RsvgPrefetchFunc func, gpointer data);
+G_GNUC_INTERNAL
+void rsvg_handle_finish_prefetch(RsvgHandle* handle);
+G_GNUC_INTERNAL
+gsize _rsvg_handle_get_arena_size(RsvgHandle* handle);
+
 G_GNUC_INTERNAL
 xmlParserCtxtPtr rsvg_free_xml_parser_and_doc(xmlParserCtxtPtr ctxt) G_GNUC_WARN_UNUSED_RESULT;
 
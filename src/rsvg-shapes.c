@@ -35,26 +35,19 @@
 #include "rsvg-shapes.h"
 #include "rsvg-css.h"
 #include "rsvg-defs.h"
+#include "rsvg-number.h"
 #include "rsvg-path.h"
 
 /* 4/3 * (1-cos 45)/sin 45 = 4/3 * sqrt(2) - 1 */
 #define RSVG_ARC_MAGIC ((double)0.5522847498)
 
-static void rsvg_node_path_free(RsvgNode* self) {
-    RsvgNodePath* path = (RsvgNodePath*)self;
-    if (path->path)
-        rsvg_cairo_path_destroy(path->path);
-    _rsvg_node_finalize(&path->super);
-    g_free(path);
-}
-
 static void rsvg_node_path_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate) {
     RsvgNodePath* path = (RsvgNodePath*)self;
 
     if (!path->path)
         return;
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     rsvg_render_path(ctx, path->path);
 }
@@ -64,14 +57,11 @@ static void rsvg_node_path_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropert
     RsvgNodePath* path = (RsvgNodePath*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "d"))) {
-            if (path->path)
-                rsvg_cairo_path_destroy(path->path);
-            path->path = rsvg_parse_path(value);
-        }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_D)))
+            rsvg_geometry_queue_push(ctx->priv->geometry, rsvg_parse_path_in_arena, value, &path->path);
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -80,12 +70,11 @@ static void rsvg_node_path_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropert
     }
 }
 
-RsvgNode* rsvg_new_path(void) {
+RsvgNode* rsvg_new_path(RsvgArena* arena) {
     RsvgNodePath* path;
-    path = g_new(RsvgNodePath, 1);
+    path = RSVG_ARENA_NEW(arena, RsvgNodePath);
     _rsvg_node_init(&path->super, RSVG_NODE_TYPE_PATH);
     path->path = NULL;
-    path->super.free = rsvg_node_path_free;
     path->super.draw = rsvg_node_path_draw;
     path->super.set_atts = rsvg_node_path_set_atts;
 
@@ -99,7 +88,15 @@ struct _RsvgNodePoly {
 
 typedef struct _RsvgNodePoly RsvgNodePoly;
 
-static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean close_path);
+static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean close_path, RsvgArena* arena);
+
+static cairo_path_t* _rsvg_node_polyline_build_path(const char* value, RsvgArena* arena) {
+    return _rsvg_node_poly_build_path(value, FALSE, arena);
+}
+
+static cairo_path_t* _rsvg_node_polygon_build_path(const char* value, RsvgArena* arena) {
+    return _rsvg_node_poly_build_path(value, TRUE, arena);
+}
 
 static void _rsvg_node_poly_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag* atts) {
     RsvgNodePoly* poly = (RsvgNodePoly*)self;
@@ -107,14 +104,15 @@ static void _rsvg_node_poly_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
 
     if (rsvg_property_bag_size(atts)) {
         /* support for svg < 1.0 which used verts */
-        if ((value = rsvg_property_bag_lookup(atts, "verts")) || (value = rsvg_property_bag_lookup(atts, "points"))) {
-            if (poly->path)
-                rsvg_cairo_path_destroy(poly->path);
-            poly->path = _rsvg_node_poly_build_path(value, RSVG_NODE_TYPE(self) == RSVG_NODE_TYPE_POLYGON);
-        }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VERTS)) ||
+            (value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_POINTS)))
+            rsvg_geometry_queue_push(ctx->priv->geometry,
+                                     RSVG_NODE_TYPE(self) == RSVG_NODE_TYPE_POLYGON ? _rsvg_node_polygon_build_path
+                                                                                    : _rsvg_node_polyline_build_path,
+                                     value, &poly->path);
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -125,21 +123,15 @@ static void _rsvg_node_poly_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
     }
 }
 
-static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean close_path) {
-    double* pointlist;
+static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean close_path, RsvgArena* arena) {
     guint pointlist_len, i;
+    double x, y;
     RsvgPathBuilder builder;
-    cairo_path_t* path;
 
-    pointlist = rsvg_css_parse_number_list(value, &pointlist_len);
-    if (pointlist == NULL)
+    pointlist_len = rsvg_scan_list_count(value);
+    if (pointlist_len < 2)
         return NULL;
 
-    if (pointlist_len < 2) {
-        g_free(pointlist);
-        return NULL;
-    }
-
     /* Calculate the number of cairo_path_data_t we'll need:
      *
      *     pointlist_len / 2 -> number of commands
@@ -150,21 +142,19 @@ static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean clos
      */
     rsvg_path_builder_init(&builder, pointlist_len + 1);
 
-    rsvg_path_builder_move_to(&builder, pointlist[0], pointlist[1]);
+    rsvg_scan_list_number(&value, &x);
+    rsvg_scan_list_number(&value, &y);
+    rsvg_path_builder_move_to(&builder, x, y);
 
     for (i = 2; i < pointlist_len; i += 2) {
-        double x, y;
-
-        x = pointlist[i];
+        rsvg_scan_list_number(&value, &x);
 
         /* We expect points to come in coordinate pairs.  But if there is a
          * missing part of one pair in a corrupt SVG, we'll have an incomplete
          * list.  In that case, we reuse the last-known Y coordinate.
          */
         if (i + 1 < pointlist_len)
-            y = pointlist[i + 1];
-        else
-            y = pointlist[i - 1];
+            rsvg_scan_list_number(&value, &y);
 
         rsvg_path_builder_line_to(&builder, x, y);
     }
@@ -172,10 +162,7 @@ static cairo_path_t* _rsvg_node_poly_build_path(const char* value, gboolean clos
     if (close_path)
         rsvg_path_builder_close_path(&builder);
 
-    path = rsvg_path_builder_finish(&builder);
-    g_free(pointlist);
-
-    return path;
+    return rsvg_path_builder_finish_in_arena(&builder, arena);
 }
 
 static void _rsvg_node_poly_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate) {
@@ -184,36 +171,27 @@ static void _rsvg_node_poly_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
     if (poly->path == NULL)
         return;
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     rsvg_render_path(ctx, poly->path);
 }
 
-static void _rsvg_node_poly_free(RsvgNode* self) {
-    RsvgNodePoly* poly = (RsvgNodePoly*)self;
-    if (poly->path)
-        rsvg_cairo_path_destroy(poly->path);
-    _rsvg_node_finalize(&poly->super);
-    g_free(poly);
-}
-
-static RsvgNode* rsvg_new_any_poly(RsvgNodeType type) {
+static RsvgNode* rsvg_new_any_poly(RsvgArena* arena, RsvgNodeType type) {
     RsvgNodePoly* poly;
-    poly = g_new(RsvgNodePoly, 1);
+    poly = RSVG_ARENA_NEW(arena, RsvgNodePoly);
     _rsvg_node_init(&poly->super, type);
-    poly->super.free = _rsvg_node_poly_free;
     poly->super.draw = _rsvg_node_poly_draw;
     poly->super.set_atts = _rsvg_node_poly_set_atts;
     poly->path = NULL;
     return &poly->super;
 }
 
-RsvgNode* rsvg_new_polygon(void) {
-    return rsvg_new_any_poly(RSVG_NODE_TYPE_POLYGON);
+RsvgNode* rsvg_new_polygon(RsvgArena* arena) {
+    return rsvg_new_any_poly(arena, RSVG_NODE_TYPE_POLYGON);
 }
 
-RsvgNode* rsvg_new_polyline(void) {
-    return rsvg_new_any_poly(RSVG_NODE_TYPE_POLYLINE);
+RsvgNode* rsvg_new_polyline(RsvgArena* arena) {
+    return rsvg_new_any_poly(arena, RSVG_NODE_TYPE_POLYLINE);
 }
 
 struct _RsvgNodeLine {
@@ -228,17 +206,17 @@ static void _rsvg_node_line_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
     RsvgNodeLine* line = (RsvgNodeLine*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x1")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X1)))
             line->x1 = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y1")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y1)))
             line->y1 = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "x2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X2)))
             line->x2 = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y2")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y2)))
             line->y2 = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -265,15 +243,15 @@ static void _rsvg_node_line_draw(RsvgNode* overself, RsvgDrawingCtx* ctx, int do
 
     path = rsvg_path_builder_finish(&builder);
 
-    rsvg_state_reinherit_top(ctx, overself->state, dominate);
+    rsvg_state_reinherit_top(ctx, overself, dominate);
 
     rsvg_render_path(ctx, path);
     rsvg_cairo_path_destroy(path);
 }
 
-RsvgNode* rsvg_new_line(void) {
+RsvgNode* rsvg_new_line(RsvgArena* arena) {
     RsvgNodeLine* line;
-    line = g_new(RsvgNodeLine, 1);
+    line = RSVG_ARENA_NEW(arena, RsvgNodeLine);
     _rsvg_node_init(&line->super, RSVG_NODE_TYPE_LINE);
     line->super.draw = _rsvg_node_line_draw;
     line->super.set_atts = _rsvg_node_line_set_atts;
@@ -295,25 +273,25 @@ static void _rsvg_node_rect_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
 
     /* FIXME: negative w/h/rx/ry is an error, per http://www.w3.org/TR/SVG11/shapes.html#RectElement */
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             rect->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             rect->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             rect->w = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             rect->h = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "rx"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RX))) {
             rect->rx = _rsvg_css_parse_length(value);
             rect->got_rx = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "ry"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RY))) {
             rect->ry = _rsvg_css_parse_length(value);
             rect->got_ry = TRUE;
         }
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -442,14 +420,14 @@ static void _rsvg_node_rect_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
 
     path = rsvg_path_builder_finish(&builder);
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
     rsvg_render_path(ctx, path);
     rsvg_cairo_path_destroy(path);
 }
 
-RsvgNode* rsvg_new_rect(void) {
+RsvgNode* rsvg_new_rect(RsvgArena* arena) {
     RsvgNodeRect* rect;
-    rect = g_new(RsvgNodeRect, 1);
+    rect = RSVG_ARENA_NEW(arena, RsvgNodeRect);
     _rsvg_node_init(&rect->super, RSVG_NODE_TYPE_RECT);
     rect->super.draw = _rsvg_node_rect_draw;
     rect->super.set_atts = _rsvg_node_rect_set_atts;
@@ -470,15 +448,15 @@ static void _rsvg_node_circle_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProp
     RsvgNodeCircle* circle = (RsvgNodeCircle*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "cx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CX)))
             circle->cx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "cy")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CY)))
             circle->cy = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "r")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_R)))
             circle->r = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -518,14 +496,14 @@ static void _rsvg_node_circle_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domi
 
     path = rsvg_path_builder_finish(&builder);
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
     rsvg_render_path(ctx, path);
     rsvg_cairo_path_destroy(path);
 }
 
-RsvgNode* rsvg_new_circle(void) {
+RsvgNode* rsvg_new_circle(RsvgArena* arena) {
     RsvgNodeCircle* circle;
-    circle = g_new(RsvgNodeCircle, 1);
+    circle = RSVG_ARENA_NEW(arena, RsvgNodeCircle);
     _rsvg_node_init(&circle->super, RSVG_NODE_TYPE_CIRCLE);
     circle->super.draw = _rsvg_node_circle_draw;
     circle->super.set_atts = _rsvg_node_circle_set_atts;
@@ -545,17 +523,17 @@ static void _rsvg_node_ellipse_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPro
     RsvgNodeEllipse* ellipse = (RsvgNodeEllipse*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "cx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CX)))
             ellipse->cx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "cy")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CY)))
             ellipse->cy = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "rx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RX)))
             ellipse->rx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "ry")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_RY)))
             ellipse->ry = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -600,14 +578,14 @@ static void _rsvg_node_ellipse_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dom
 
     path = rsvg_path_builder_finish(&builder);
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
     rsvg_render_path(ctx, path);
     rsvg_cairo_path_destroy(path);
 }
 
-RsvgNode* rsvg_new_ellipse(void) {
+RsvgNode* rsvg_new_ellipse(RsvgArena* arena) {
     RsvgNodeEllipse* ellipse;
-    ellipse = g_new(RsvgNodeEllipse, 1);
+    ellipse = RSVG_ARENA_NEW(arena, RsvgNodeEllipse);
     _rsvg_node_init(&ellipse->super, RSVG_NODE_TYPE_ELLIPSE);
     ellipse->super.draw = _rsvg_node_ellipse_draw;
     ellipse->super.set_atts = _rsvg_node_ellipse_set_atts;
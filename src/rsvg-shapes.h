@@ -37,19 +37,19 @@
 G_BEGIN_DECLS
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_path(void);
+RsvgNode* rsvg_new_path(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_polygon(void);
+RsvgNode* rsvg_new_polygon(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_polyline(void);
+RsvgNode* rsvg_new_polyline(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_line(void);
+RsvgNode* rsvg_new_line(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_rect(void);
+RsvgNode* rsvg_new_rect(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_circle(void);
+RsvgNode* rsvg_new_circle(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_ellipse(void);
+RsvgNode* rsvg_new_ellipse(RsvgArena* arena);
 
 typedef struct _RsvgNodePath RsvgNodePath;
 
@@ -60,7 +60,7 @@ void rsvg_node_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate) {
 void _rsvg_node_draw_children(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate) {
     guint i;
     if (dominate != -1) {
-        rsvg_state_reinherit_top(ctx, self->state, dominate);
+        rsvg_state_reinherit_top(ctx, self, dominate);
 
         rsvg_push_discrete_layer(ctx);
     }
@@ -88,10 +88,12 @@ static void _rsvg_node_dont_set_atts(RsvgNode* node, RsvgHandle* ctx, RsvgProper
 
 void _rsvg_node_init(RsvgNode* self, RsvgNodeType type) {
     self->type = type;
+    self->atom = RSVG_ELEMENT_UNKNOWN;
     self->parent = NULL;
     self->children = g_ptr_array_new();
     self->state = g_new(RsvgState, 1);
     self->base_state = NULL;
+    self->computed = NULL;
     self->name = NULL;
     self->id = NULL;
     self->klass = NULL;
@@ -104,7 +106,10 @@ void _rsvg_node_init(RsvgNode* self, RsvgNodeType type) {
     self->set_atts = _rsvg_node_dont_set_atts;
 }
 
+/* Releases what the node owns outside the handle's arena; the node itself,
+ * its name and its id/class/style strings live in the arena */
 void _rsvg_node_finalize(RsvgNode* self) {
+    rsvg_state_clear_computed(self);
     if (self->state != NULL) {
         rsvg_state_finalize(self->state);
         g_free(self->state);
@@ -115,26 +120,21 @@ void _rsvg_node_finalize(RsvgNode* self) {
     }
     if (self->children != NULL)
         g_ptr_array_free(self->children, TRUE);
-    g_free(self->name);
-    g_free(self->id);
-    g_free(self->klass);
-    g_free(self->style_attr);
     if (self->atts)
         rsvg_property_bag_free(self->atts);
 }
 
 void _rsvg_node_free(RsvgNode* self) {
     _rsvg_node_finalize(self);
-    g_free(self);
 }
 
 static void rsvg_node_group_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag* atts) {
     const char *klazz = NULL, *id = NULL, *value;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -143,9 +143,9 @@ static void rsvg_node_group_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
     }
 }
 
-RsvgNode* rsvg_new_group(void) {
+RsvgNode* rsvg_new_group(RsvgArena* arena) {
     RsvgNodeGroup* group;
-    group = g_new(RsvgNodeGroup, 1);
+    group = RSVG_ARENA_NEW(arena, RsvgNodeGroup);
     _rsvg_node_init(&group->super, RSVG_NODE_TYPE_GROUP);
     group->super.draw = _rsvg_node_draw_children;
     group->super.set_atts = rsvg_node_group_set_atts;
@@ -174,7 +174,7 @@ static void rsvg_node_use_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate
     w = _rsvg_css_normalize_length(&use->w, ctx, 'h');
     h = _rsvg_css_normalize_length(&use->h, ctx, 'v');
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     /* <use> is an element that is used directly, unlike
      * <pattern>, which is used through a fill="url(#...)"
@@ -269,7 +269,7 @@ static void rsvg_node_svg_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate
     nw = _rsvg_css_normalize_length(&sself->w, ctx, 'h');
     nh = _rsvg_css_normalize_length(&sself->h, ctx, 'v');
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     state = rsvg_current_state(ctx);
 
@@ -318,24 +318,24 @@ static void rsvg_node_svg_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProperty
     RsvgNodeSvg* svg = (RsvgNodeSvg*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "viewBox")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VIEW_BOX)))
             svg->vbox = rsvg_css_parse_vbox(value);
 
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAspectRatio")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ASPECT_RATIO)))
             svg->preserve_aspect_ratio = rsvg_css_parse_aspect_ratio(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             svg->w = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             svg->h = _rsvg_css_parse_length(value);
         /*
          * x & y attributes have no effect on outermost svg
          * http://www.w3.org/TR/SVG/struct.html#SVGElement
          */
-        if (self->parent && (value = rsvg_property_bag_lookup(atts, "x")))
+        if (self->parent && (value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             svg->x = _rsvg_css_parse_length(value);
-        if (self->parent && (value = rsvg_property_bag_lookup(atts, "y")))
+        if (self->parent && (value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             svg->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             rsvg_defs_register_name(ctx->priv->defs, value, &svg->super);
         }
         /*
@@ -349,9 +349,9 @@ static void rsvg_node_svg_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProperty
 void _rsvg_node_svg_apply_atts(RsvgNodeSvg* self, RsvgHandle* ctx) {
     const char *id = NULL, *klazz = NULL, *value;
     if (((RsvgNode*)self)->atts && rsvg_property_bag_size(((RsvgNode*)self)->atts)) {
-        if ((value = rsvg_property_bag_lookup(((RsvgNode*)self)->atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(((RsvgNode*)self)->atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(((RsvgNode*)self)->atts, "id")))
+        if ((value = rsvg_property_bag_lookup_atom(((RsvgNode*)self)->atts, RSVG_ATTRIBUTE_ID)))
             id = value;
         rsvg_parse_style_attrs(ctx, ((RsvgNode*)self)->state, "svg", klazz, id, ((RsvgNode*)self)->atts);
     }
@@ -361,9 +361,9 @@ static void _rsvg_svg_free(RsvgNode* self) {
     _rsvg_node_free(self);
 }
 
-RsvgNode* rsvg_new_svg(void) {
+RsvgNode* rsvg_new_svg(RsvgArena* arena) {
     RsvgNodeSvg* svg;
-    svg = g_new(RsvgNodeSvg, 1);
+    svg = RSVG_ARENA_NEW(arena, RsvgNodeSvg);
     _rsvg_node_init(&svg->super, RSVG_NODE_TYPE_SVG);
     svg->vbox.active = FALSE;
     svg->preserve_aspect_ratio = RSVG_ASPECT_RATIO_XMID_YMID;
@@ -383,37 +383,50 @@ static void rsvg_node_use_free(RsvgNode* node) {
     _rsvg_node_free(node);
 }
 
+static void rsvg_node_use_fetch(RsvgHandle* handle, gpointer data) {
+    rsvg_defs_prefetch(handle->priv->defs, data);
+    g_free(data);
+}
+
 static void rsvg_node_use_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPropertyBag* atts) {
     const char *value = NULL, *klazz = NULL, *id = NULL;
     RsvgNodeUse* use;
 
     use = (RsvgNodeUse*)self;
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             use->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             use->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "width")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_WIDTH)))
             use->w = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "height")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_HEIGHT)))
             use->h = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, &use->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "xlink:href"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_XLINK_HREF))) {
             g_free(use->link);
             use->link = g_strdup(value);
+
+            /* a reference into another document: start loading it now,
+             * unless this document is itself such a target, whose own
+             * references are left for rendering to resolve, so that
+             * documents referring to each other are not loaded forever
+             */
+            if (!ctx->priv->is_extern && value[0] != '#' && strchr(value, '#') != NULL)
+                rsvg_handle_prefetch(ctx, rsvg_node_use_fetch, g_strdup(value));
         }
         rsvg_parse_style_attrs(ctx, self->state, "use", klazz, id, atts);
     }
 }
 
-RsvgNode* rsvg_new_use(void) {
+RsvgNode* rsvg_new_use(RsvgArena* arena) {
     RsvgNodeUse* use;
-    use = g_new(RsvgNodeUse, 1);
+    use = RSVG_ARENA_NEW(arena, RsvgNodeUse);
     _rsvg_node_init(&use->super, RSVG_NODE_TYPE_USE);
     use->super.draw = rsvg_node_use_draw;
     use->super.free = rsvg_node_use_free;
@@ -432,24 +445,24 @@ static void rsvg_node_symbol_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPrope
     const char *klazz = NULL, *value, *id = NULL;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, &symbol->super);
         }
-        if ((value = rsvg_property_bag_lookup(atts, "viewBox")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_VIEW_BOX)))
             symbol->vbox = rsvg_css_parse_vbox(value);
-        if ((value = rsvg_property_bag_lookup(atts, "preserveAspectRatio")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_PRESERVE_ASPECT_RATIO)))
             symbol->preserve_aspect_ratio = rsvg_css_parse_aspect_ratio(value);
 
         rsvg_parse_style_attrs(ctx, self->state, "symbol", klazz, id, atts);
     }
 }
 
-RsvgNode* rsvg_new_symbol(void) {
+RsvgNode* rsvg_new_symbol(RsvgArena* arena) {
     RsvgNodeSymbol* symbol;
-    symbol = g_new(RsvgNodeSymbol, 1);
+    symbol = RSVG_ARENA_NEW(arena, RsvgNodeSymbol);
     _rsvg_node_init(&symbol->super, RSVG_NODE_TYPE_SYMBOL);
     symbol->vbox.active = FALSE;
     symbol->preserve_aspect_ratio = RSVG_ASPECT_RATIO_XMID_YMID;
@@ -458,9 +471,9 @@ RsvgNode* rsvg_new_symbol(void) {
     return &symbol->super;
 }
 
-RsvgNode* rsvg_new_defs(void) {
+RsvgNode* rsvg_new_defs(RsvgArena* arena) {
     RsvgNodeGroup* group;
-    group = g_new(RsvgNodeGroup, 1);
+    group = RSVG_ARENA_NEW(arena, RsvgNodeGroup);
     _rsvg_node_init(&group->super, RSVG_NODE_TYPE_DEFS);
     group->super.draw = _rsvg_node_draw_nothing;
     group->super.set_atts = rsvg_node_group_set_atts;
@@ -470,7 +483,7 @@ RsvgNode* rsvg_new_defs(void) {
 static void _rsvg_node_switch_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int dominate) {
     guint i;
 
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     rsvg_push_discrete_layer(ctx);
 
@@ -489,9 +502,9 @@ static void _rsvg_node_switch_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domi
     rsvg_pop_discrete_layer(ctx);
 }
 
-RsvgNode* rsvg_new_switch(void) {
+RsvgNode* rsvg_new_switch(RsvgArena* arena) {
     RsvgNodeGroup* group;
-    group = g_new(RsvgNodeGroup, 1);
+    group = RSVG_ARENA_NEW(arena, RsvgNodeGroup);
     _rsvg_node_init(&group->super, RSVG_NODE_TYPE_SWITCH);
     group->super.draw = _rsvg_node_switch_draw;
     group->super.set_atts = rsvg_node_group_set_atts;
@@ -37,17 +37,17 @@
 G_BEGIN_DECLS
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_use(void);
+RsvgNode* rsvg_new_use(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_symbol(void);
+RsvgNode* rsvg_new_symbol(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_svg(void);
+RsvgNode* rsvg_new_svg(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_defs(void);
+RsvgNode* rsvg_new_defs(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_group(void);
+RsvgNode* rsvg_new_group(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_switch(void);
+RsvgNode* rsvg_new_switch(RsvgArena* arena);
 
 typedef struct _RsvgNodeGroup RsvgNodeGroup;
 typedef struct _RsvgNodeUse RsvgNodeUse;
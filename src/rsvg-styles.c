@@ -37,6 +37,7 @@
 #include "rsvg-shapes.h"
 #include "rsvg-mask.h"
 #include "rsvg-marker.h"
+#include "rsvg-number.h"
 
 #define RSVG_DEFAULT_FONT "Times New Roman"
 
@@ -80,6 +81,168 @@ void rsvg_style_value_data_free(StyleValueData* value) {
     g_free(value);
 }
 
+/* Values that states share (strings, dash arrays and the list of important
+ * properties) are immutable blocks that start with a reference count.
+ * States are cloned and finalized on several threads at once, by the
+ * parallel restyle and by concurrent renders, so the count is atomic.
+ */
+typedef union {
+    gint ref_count;
+    double align;
+} RsvgSharedHeader;
+
+#define RSVG_SHARED_HEADER(data) ((RsvgSharedHeader*)(data)-1)
+
+static gpointer rsvg_shared_alloc(gsize size) {
+    RsvgSharedHeader* header = g_malloc(sizeof(RsvgSharedHeader) + size);
+
+    header->ref_count = 1;
+    return header + 1;
+}
+
+static gconstpointer rsvg_shared_ref(gconstpointer data) {
+    if (data != NULL)
+        g_atomic_int_inc(&RSVG_SHARED_HEADER(data)->ref_count);
+    return data;
+}
+
+static void rsvg_shared_unref(gconstpointer data) {
+    if (data != NULL && g_atomic_int_dec_and_test(&RSVG_SHARED_HEADER(data)->ref_count))
+        g_free(RSVG_SHARED_HEADER(data));
+}
+
+/* Strings are interned as well, so that a document where every element
+ * names the same font or marker holds that string once.  Only interning and
+ * dropping the last reference take the lock; since lookups happen under it
+ * too, a string cannot be handed out again once its count reaches zero.
+ */
+static GMutex state_strings_lock;
+static GHashTable* state_strings;
+
+static const char* rsvg_state_string_new(const char* str) {
+    char* shared;
+
+    if (str == NULL)
+        return NULL;
+
+    g_mutex_lock(&state_strings_lock);
+    if (state_strings == NULL)
+        state_strings = g_hash_table_new(g_str_hash, g_str_equal);
+
+    shared = g_hash_table_lookup(state_strings, str);
+    if (shared != NULL) {
+        rsvg_shared_ref(shared);
+    }
+    else {
+        gsize len = strlen(str);
+
+        shared = rsvg_shared_alloc(len + 1);
+        memcpy(shared, str, len + 1);
+        g_hash_table_add(state_strings, shared);
+    }
+    g_mutex_unlock(&state_strings_lock);
+
+    return shared;
+}
+
+static void rsvg_state_string_unref(const char* str) {
+    RsvgSharedHeader* header;
+
+    if (str == NULL)
+        return;
+
+    header = RSVG_SHARED_HEADER(str);
+    for (;;) {
+        gint count = g_atomic_int_get(&header->ref_count);
+
+        if (count == 1)
+            break;
+        if (g_atomic_int_compare_and_exchange(&header->ref_count, count, count - 1))
+            return;
+    }
+
+    g_mutex_lock(&state_strings_lock);
+    if (g_atomic_int_dec_and_test(&header->ref_count)) {
+        g_hash_table_remove(state_strings, str);
+        g_free(header);
+    }
+    g_mutex_unlock(&state_strings_lock);
+}
+
+/* Makes *@dst another reference to @src, a string held by some other state */
+static void rsvg_state_string_assign(const char** dst, const char* src) {
+    rsvg_shared_ref(src);
+    rsvg_state_string_unref(*dst);
+    *dst = src;
+}
+
+static const char* rsvg_state_url_new(const char* value) {
+    char* url = rsvg_get_url_string(value);
+    const char* shared = rsvg_state_string_new(url);
+
+    g_free(url);
+    return shared;
+}
+
+/* Every state starts out with the default font, so one reference to it is
+ * kept for good and each state only adds to its count.
+ */
+static const char* rsvg_state_default_font_family(void) {
+    static gsize family = 0;
+
+    if (g_once_init_enter(&family))
+        g_once_init_leave(&family, (gsize)rsvg_state_string_new(RSVG_DEFAULT_FONT));
+
+    return rsvg_shared_ref((const char*)family);
+}
+
+struct _RsvgImportantProperties {
+    guint n_atoms;
+    guint16 atoms[]; /* sorted */
+};
+
+static gboolean rsvg_important_properties_contain(const RsvgImportantProperties* important, RsvgAttributeAtom atom) {
+    guint lo = 0, hi;
+
+    if (important == NULL)
+        return FALSE;
+
+    hi = important->n_atoms;
+    while (lo < hi) {
+        guint mid = (lo + hi) / 2;
+
+        if (important->atoms[mid] < atom)
+            lo = mid + 1;
+        else if (important->atoms[mid] > atom)
+            hi = mid;
+        else
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Returns a new list with the atoms of @important, which may be shared and
+ * is left alone, and @atom
+ */
+static const RsvgImportantProperties* rsvg_important_properties_add(const RsvgImportantProperties* important,
+                                                                    RsvgAttributeAtom atom) {
+    guint n = important != NULL ? important->n_atoms : 0;
+    RsvgImportantProperties* added;
+    guint i;
+
+    added = rsvg_shared_alloc(G_STRUCT_OFFSET(RsvgImportantProperties, atoms) + (n + 1) * sizeof(guint16));
+    added->n_atoms = n + 1;
+
+    for (i = 0; i < n && important->atoms[i] < atom; i++)
+        added->atoms[i] = important->atoms[i];
+    added->atoms[i] = atom;
+    for (; i < n; i++)
+        added->atoms[i + 1] = important->atoms[i];
+
+    return added;
+}
+
 gdouble rsvg_viewport_percentage(gdouble width, gdouble height) {
     return sqrt(width * height);
 }
@@ -117,7 +280,7 @@ void rsvg_state_init(RsvgState* state) {
     state->flood_color = 0;
     state->flood_opacity = 255;
 
-    state->font_family = g_strdup(RSVG_DEFAULT_FONT);
+    state->font_family = rsvg_state_default_font_family();
     state->font_size = _rsvg_css_parse_length("12.0");
     state->font_style = PANGO_STYLE_NORMAL;
     state->font_variant = PANGO_VARIANT_NORMAL;
@@ -179,54 +342,33 @@ void rsvg_state_init(RsvgState* state) {
     state->text_rendering_type = TEXT_RENDERING_AUTO;
     state->has_text_rendering_type = FALSE;
 
-    state->styles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)rsvg_style_value_data_free);
-}
-
-void rsvg_state_reinit(RsvgState* state) {
-    RsvgState* parent = state->parent;
-    rsvg_state_finalize(state);
-    rsvg_state_init(state);
-    state->parent = parent;
+    state->important = NULL;
 }
 
 typedef int (*InheritanceFunction)(int dst, int src);
 
+/* Cloning only takes references: nothing a state shares is ever modified,
+ * a property that changes gets a new value instead.
+ */
 void rsvg_state_clone(RsvgState* dst, const RsvgState* src) {
-    gint i;
     RsvgState* parent = dst->parent;
 
     rsvg_state_finalize(dst);
 
     *dst = *src;
     dst->parent = parent;
-    dst->filter = g_strdup(src->filter);
-    dst->mask = g_strdup(src->mask);
-    dst->clip_path = g_strdup(src->clip_path);
-    dst->font_family = g_strdup(src->font_family);
-    dst->lang = g_strdup(src->lang);
-    dst->startMarker = g_strdup(src->startMarker);
-    dst->middleMarker = g_strdup(src->middleMarker);
-    dst->endMarker = g_strdup(src->endMarker);
+    rsvg_shared_ref(dst->filter);
+    rsvg_shared_ref(dst->mask);
+    rsvg_shared_ref(dst->clip_path);
+    rsvg_shared_ref(dst->font_family);
+    rsvg_shared_ref(dst->lang);
+    rsvg_shared_ref(dst->startMarker);
+    rsvg_shared_ref(dst->middleMarker);
+    rsvg_shared_ref(dst->endMarker);
+    rsvg_shared_ref(dst->dash.dash);
+    rsvg_shared_ref(dst->important);
     rsvg_paint_server_ref(dst->fill);
     rsvg_paint_server_ref(dst->stroke);
-
-    dst->styles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)rsvg_style_value_data_free);
-    if (src->styles) {
-        GHashTableIter iter;
-        gpointer key, value;
-        g_hash_table_iter_init(&iter, src->styles);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            StyleValueData* val = (StyleValueData*)value;
-            g_hash_table_insert(dst->styles, g_strdup((char*)key),
-                                rsvg_style_value_data_new(val->value, val->important));
-        }
-    }
-
-    if (src->dash.n_dash > 0) {
-        dst->dash.dash = g_new(gdouble, src->dash.n_dash);
-        for (i = 0; i < src->dash.n_dash; i++)
-            dst->dash.dash[i] = src->dash.dash[i];
-    }
 }
 
 /*
@@ -240,8 +382,6 @@ static void rsvg_state_inherit_run(RsvgState* dst,
                                    const RsvgState* src,
                                    const InheritanceFunction function,
                                    const gboolean inherituninheritables) {
-    gint i;
-
     if (function(dst->has_baseline_shift, src->has_baseline_shift))
         dst->baseline_shift = src->baseline_shift;
     if (function(dst->has_current_color, src->has_current_color))
@@ -309,16 +449,13 @@ static void rsvg_state_inherit_run(RsvgState* dst,
     if (function(dst->has_letter_spacing, src->has_letter_spacing))
         dst->letter_spacing = src->letter_spacing;
     if (function(dst->has_startMarker, src->has_startMarker)) {
-        g_free(dst->startMarker);
-        dst->startMarker = g_strdup(src->startMarker);
+        rsvg_state_string_assign(&dst->startMarker, src->startMarker);
     }
     if (function(dst->has_middleMarker, src->has_middleMarker)) {
-        g_free(dst->middleMarker);
-        dst->middleMarker = g_strdup(src->middleMarker);
+        rsvg_state_string_assign(&dst->middleMarker, src->middleMarker);
     }
     if (function(dst->has_endMarker, src->has_endMarker)) {
-        g_free(dst->endMarker);
-        dst->endMarker = g_strdup(src->endMarker);
+        rsvg_state_string_assign(&dst->endMarker, src->endMarker);
     }
     if (function(dst->has_shape_rendering_type, src->has_shape_rendering_type))
         dst->shape_rendering_type = src->shape_rendering_type;
@@ -326,8 +463,7 @@ static void rsvg_state_inherit_run(RsvgState* dst,
         dst->text_rendering_type = src->text_rendering_type;
 
     if (function(dst->has_font_family, src->has_font_family)) {
-        g_free(dst->font_family); /* font_family is always set to something */
-        dst->font_family = g_strdup(src->font_family);
+        rsvg_state_string_assign(&dst->font_family, src->font_family);
     }
 
     if (function(dst->has_space_preserve, src->has_space_preserve))
@@ -336,20 +472,14 @@ static void rsvg_state_inherit_run(RsvgState* dst,
     if (function(dst->has_visible, src->has_visible))
         dst->visible = src->visible;
 
-    if (function(dst->has_lang, src->has_lang)) {
-        if (dst->has_lang)
-            g_free(dst->lang);
-        dst->lang = g_strdup(src->lang);
-    }
+    if (function(dst->has_lang, src->has_lang))
+        rsvg_state_string_assign(&dst->lang, src->lang);
 
     if (src->dash.n_dash > 0 && (function(dst->has_dash, src->has_dash))) {
-        if (dst->has_dash)
-            g_free(dst->dash.dash);
-
-        dst->dash.dash = g_new(gdouble, src->dash.n_dash);
+        rsvg_shared_ref(src->dash.dash);
+        rsvg_shared_unref(dst->dash.dash);
+        dst->dash.dash = src->dash.dash;
         dst->dash.n_dash = src->dash.n_dash;
-        for (i = 0; i < src->dash.n_dash; i++)
-            dst->dash.dash[i] = src->dash.dash[i];
     }
 
     if (function(dst->has_dashoffset, src->has_dashoffset)) {
@@ -357,12 +487,9 @@ static void rsvg_state_inherit_run(RsvgState* dst,
     }
 
     if (inherituninheritables) {
-        g_free(dst->clip_path);
-        dst->clip_path = g_strdup(src->clip_path);
-        g_free(dst->mask);
-        dst->mask = g_strdup(src->mask);
-        g_free(dst->filter);
-        dst->filter = g_strdup(src->filter);
+        rsvg_state_string_assign(&dst->clip_path, src->clip_path);
+        rsvg_state_string_assign(&dst->mask, src->mask);
+        rsvg_state_string_assign(&dst->filter, src->filter);
         dst->enable_background = src->enable_background;
         dst->opacity = src->opacity;
         dst->comp_op = src->comp_op;
@@ -434,517 +561,798 @@ void rsvg_state_inherit(RsvgState* dst, const RsvgState* src) {
 }
 
 void rsvg_state_finalize(RsvgState* state) {
-    g_free(state->filter);
-    g_free(state->mask);
-    g_free(state->clip_path);
-    g_free(state->font_family);
-    g_free(state->lang);
-    g_free(state->startMarker);
-    g_free(state->middleMarker);
-    g_free(state->endMarker);
+    rsvg_state_string_unref(state->filter);
+    rsvg_state_string_unref(state->mask);
+    rsvg_state_string_unref(state->clip_path);
+    rsvg_state_string_unref(state->font_family);
+    rsvg_state_string_unref(state->lang);
+    rsvg_state_string_unref(state->startMarker);
+    rsvg_state_string_unref(state->middleMarker);
+    rsvg_state_string_unref(state->endMarker);
     rsvg_paint_server_unref(state->fill);
     rsvg_paint_server_unref(state->stroke);
+    rsvg_shared_unref(state->dash.dash);
+    rsvg_shared_unref(state->important);
+    state->important = NULL;
+}
 
-    if (state->dash.n_dash != 0)
-        g_free(state->dash.dash);
+/* A state in a document cache is an RsvgFlatState, then its dash array and
+ * its important atoms, padded to 8 bytes.  The flat state holds a copy of
+ * the state with every pointer cleared, and what the pointers held: the
+ * strings as offsets in the cache's string table and the paint servers by
+ * value.
+ */
+#define RSVG_FLAT_NO_STRING G_MAXUINT32
+#define RSVG_FLAT_N_STRINGS 8
+
+enum { RSVG_FLAT_PAINT_NONE, RSVG_FLAT_PAINT_COLOR, RSVG_FLAT_PAINT_CURRENT_COLOR, RSVG_FLAT_PAINT_IRI };
+
+typedef struct {
+    guint32 kind;
+    guint32 value; /* the color, or the offset of the iri */
+} RsvgFlatPaint;
+
+typedef struct {
+    RsvgState state;
+    guint32 strings[RSVG_FLAT_N_STRINGS]; /* in the order of rsvg_flat_string_fields */
+    RsvgFlatPaint fill;
+    RsvgFlatPaint stroke;
+    guint32 n_dash;
+    guint32 n_important;
+} RsvgFlatState;
+
+static const gsize rsvg_flat_string_fields[RSVG_FLAT_N_STRINGS] = {
+    G_STRUCT_OFFSET(RsvgState, filter),    G_STRUCT_OFFSET(RsvgState, mask),
+    G_STRUCT_OFFSET(RsvgState, clip_path), G_STRUCT_OFFSET(RsvgState, font_family),
+    G_STRUCT_OFFSET(RsvgState, lang),      G_STRUCT_OFFSET(RsvgState, startMarker),
+    G_STRUCT_OFFSET(RsvgState, middleMarker), G_STRUCT_OFFSET(RsvgState, endMarker)};
+
+#define RSVG_FLAT_STRING(state, i) (*(const char**)((guint8*)(state) + rsvg_flat_string_fields[i]))
+
+static void rsvg_flat_paint_write(RsvgFlatPaint* flat,
+                                  const RsvgPaintServer* ps,
+                                  RsvgStateWriteString write_string,
+                                  gpointer user_data) {
+    if (ps == NULL) {
+        flat->kind = RSVG_FLAT_PAINT_NONE;
+    }
+    else if (ps->type == RSVG_PAINT_SERVER_IRI) {
+        flat->kind = RSVG_FLAT_PAINT_IRI;
+        flat->value = write_string(ps->core.iri, user_data);
+    }
+    else if (ps->core.color->currentcolor) {
+        flat->kind = RSVG_FLAT_PAINT_CURRENT_COLOR;
+    }
+    else {
+        flat->kind = RSVG_FLAT_PAINT_COLOR;
+        flat->value = ps->core.color->argb;
+    }
+}
 
-    if (state->styles) {
-        g_hash_table_unref(state->styles);
-        state->styles = NULL;
+/* Returns FALSE if @flat is damaged */
+static gboolean rsvg_flat_paint_read(const RsvgFlatPaint* flat,
+                                     RsvgPaintServer** ps,
+                                     RsvgStateReadString read_string,
+                                     gpointer user_data) {
+    const char* iri;
+
+    switch (flat->kind) {
+        case RSVG_FLAT_PAINT_NONE:
+            *ps = NULL;
+            return TRUE;
+        case RSVG_FLAT_PAINT_COLOR:
+            *ps = rsvg_paint_server_new_color(flat->value, FALSE);
+            return TRUE;
+        case RSVG_FLAT_PAINT_CURRENT_COLOR:
+            *ps = rsvg_paint_server_new_color(0, TRUE);
+            return TRUE;
+        case RSVG_FLAT_PAINT_IRI:
+            if ((iri = read_string(flat->value, user_data)) == NULL)
+                return FALSE;
+            *ps = rsvg_paint_server_new_iri(iri);
+            return TRUE;
+        default:
+            return FALSE;
     }
 }
 
-/* Parse a CSS2 style argument, setting the SVG context attributes. */
-void rsvg_parse_style_pair(RsvgHandle* ctx,
-                           RsvgState* state,
-                           const gchar* name,
-                           const gchar* value,
-                           gboolean important) {
-    StyleValueData* data;
+/* The enumerations are handed to cairo and pango, so a damaged cache must
+ * not get values into them that the parser would never have produced
+ */
+static gboolean rsvg_flat_state_check_values(const RsvgState* state) {
+    return (guint)state->fill_rule <= CAIRO_FILL_RULE_EVEN_ODD && (guint)state->clip_rule <= CAIRO_FILL_RULE_EVEN_ODD &&
+           (guint)state->cap <= CAIRO_LINE_CAP_SQUARE && (guint)state->join <= CAIRO_LINE_JOIN_BEVEL &&
+           (guint)state->font_style <= PANGO_STYLE_ITALIC && (guint)state->font_variant <= PANGO_VARIANT_SMALL_CAPS &&
+           state->font_weight >= 100 && state->font_weight <= 1000 &&
+           (guint)state->font_stretch <= PANGO_STRETCH_ULTRA_EXPANDED &&
+           (guint)state->text_dir <= PANGO_DIRECTION_NEUTRAL && (guint)state->text_gravity <= PANGO_GRAVITY_AUTO &&
+           (guint)state->unicode_bidi <= UNICODE_BIDI_OVERRIDE && (guint)state->text_anchor <= TEXT_ANCHOR_END &&
+           (guint)state->comp_op <= CAIRO_OPERATOR_HSL_LUMINOSITY &&
+           (guint)state->enable_background <= RSVG_ENABLE_BACKGROUND_NEW &&
+           (guint)state->shape_rendering_type <= CAIRO_ANTIALIAS_BEST &&
+           (guint)state->text_rendering_type <= CAIRO_ANTIALIAS_BEST;
+}
 
-    (void)ctx;
+void rsvg_state_write_flat(const RsvgState* state,
+                           GByteArray* out,
+                           RsvgStateWriteString write_string,
+                           gpointer user_data) {
+    static const guint8 zeros[8] = {0};
+    RsvgFlatState flat;
+    guint i;
 
-    data = g_hash_table_lookup(state->styles, name);
-    if (data && data->important && !important)
-        return;
+    memset(&flat, 0, sizeof(flat));
+    flat.state = *state;
+    flat.state.parent = NULL;
 
-    if (name == NULL || value == NULL)
-        return;
+    for (i = 0; i < RSVG_FLAT_N_STRINGS; i++) {
+        const char* str = RSVG_FLAT_STRING(state, i);
 
-    g_hash_table_insert(state->styles, (gpointer)g_strdup(name), (gpointer)rsvg_style_value_data_new(value, important));
-
-    if (g_str_equal(name, "color"))
-        state->current_color = rsvg_css_parse_color(value, &state->has_current_color);
-    else if (g_str_equal(name, "opacity"))
-        state->opacity = rsvg_css_parse_opacity(value);
-    else if (g_str_equal(name, "flood-color"))
-        state->flood_color = rsvg_css_parse_color(value, &state->has_flood_color);
-    else if (g_str_equal(name, "flood-opacity")) {
-        state->flood_opacity = rsvg_css_parse_opacity(value);
-        state->has_flood_opacity = TRUE;
-    }
-    else if (g_str_equal(name, "filter")) {
-        g_free(state->filter);
-        state->filter = rsvg_get_url_string(value);
-    }
-    else if (g_str_equal(name, "mask")) {
-        g_free(state->mask);
-        state->mask = rsvg_get_url_string(value);
+        flat.strings[i] = str != NULL ? write_string(str, user_data) : RSVG_FLAT_NO_STRING;
+        RSVG_FLAT_STRING(&flat.state, i) = NULL;
     }
-    else if (g_str_equal(name, "baseline-shift")) {
-        /* These values come from Inkscape's SP_CSS_BASELINE_SHIFT_(SUB/SUPER/BASELINE);
-         * see sp_style_merge_baseline_shift_from_parent()
-         */
-        if (g_str_equal(value, "sub")) {
-            state->has_baseline_shift = TRUE;
-            state->baseline_shift = -0.2;
-        }
-        else if (g_str_equal(value, "super")) {
-            state->has_baseline_shift = TRUE;
-            state->baseline_shift = 0.4;
-        }
-        else if (g_str_equal(value, "baseline")) {
-            state->has_baseline_shift = TRUE;
-            state->baseline_shift = 0.;
-        }
-        else {
-            g_warning(
-                "value \'%s\' for attribute \'baseline-shift\' is not supported; only 'sub', 'super', and 'baseline' "
-                "are supported\n",
-                value);
-        }
-    }
-    else if (g_str_equal(name, "clip-path")) {
-        g_free(state->clip_path);
-        state->clip_path = rsvg_get_url_string(value);
-    }
-    else if (g_str_equal(name, "overflow")) {
-        if (!g_str_equal(value, "inherit")) {
-            state->overflow = rsvg_css_parse_overflow(value, &state->has_overflow);
-        }
-    }
-    else if (g_str_equal(name, "enable-background")) {
-        if (g_str_equal(value, "new"))
-            state->enable_background = RSVG_ENABLE_BACKGROUND_NEW;
-        else
-            state->enable_background = RSVG_ENABLE_BACKGROUND_ACCUMULATE;
-    }
-    else if (g_str_equal(name, "comp-op")) {
-        if (g_str_equal(value, "clear"))
-            state->comp_op = CAIRO_OPERATOR_CLEAR;
-        else if (g_str_equal(value, "src"))
-            state->comp_op = CAIRO_OPERATOR_SOURCE;
-        else if (g_str_equal(value, "dst"))
-            state->comp_op = CAIRO_OPERATOR_DEST;
-        else if (g_str_equal(value, "src-over"))
-            state->comp_op = CAIRO_OPERATOR_OVER;
-        else if (g_str_equal(value, "dst-over"))
-            state->comp_op = CAIRO_OPERATOR_DEST_OVER;
-        else if (g_str_equal(value, "src-in"))
-            state->comp_op = CAIRO_OPERATOR_IN;
-        else if (g_str_equal(value, "dst-in"))
-            state->comp_op = CAIRO_OPERATOR_DEST_IN;
-        else if (g_str_equal(value, "src-out"))
-            state->comp_op = CAIRO_OPERATOR_OUT;
-        else if (g_str_equal(value, "dst-out"))
-            state->comp_op = CAIRO_OPERATOR_DEST_OUT;
-        else if (g_str_equal(value, "src-atop"))
-            state->comp_op = CAIRO_OPERATOR_ATOP;
-        else if (g_str_equal(value, "dst-atop"))
-            state->comp_op = CAIRO_OPERATOR_DEST_ATOP;
-        else if (g_str_equal(value, "xor"))
-            state->comp_op = CAIRO_OPERATOR_XOR;
-        else if (g_str_equal(value, "plus"))
-            state->comp_op = CAIRO_OPERATOR_ADD;
-        else if (g_str_equal(value, "multiply"))
-            state->comp_op = CAIRO_OPERATOR_MULTIPLY;
-        else if (g_str_equal(value, "screen"))
-            state->comp_op = CAIRO_OPERATOR_SCREEN;
-        else if (g_str_equal(value, "overlay"))
-            state->comp_op = CAIRO_OPERATOR_OVERLAY;
-        else if (g_str_equal(value, "darken"))
-            state->comp_op = CAIRO_OPERATOR_DARKEN;
-        else if (g_str_equal(value, "lighten"))
-            state->comp_op = CAIRO_OPERATOR_LIGHTEN;
-        else if (g_str_equal(value, "color-dodge"))
-            state->comp_op = CAIRO_OPERATOR_COLOR_DODGE;
-        else if (g_str_equal(value, "color-burn"))
-            state->comp_op = CAIRO_OPERATOR_COLOR_BURN;
-        else if (g_str_equal(value, "hard-light"))
-            state->comp_op = CAIRO_OPERATOR_HARD_LIGHT;
-        else if (g_str_equal(value, "soft-light"))
-            state->comp_op = CAIRO_OPERATOR_SOFT_LIGHT;
-        else if (g_str_equal(value, "difference"))
-            state->comp_op = CAIRO_OPERATOR_DIFFERENCE;
-        else if (g_str_equal(value, "exclusion"))
-            state->comp_op = CAIRO_OPERATOR_EXCLUSION;
-        else
-            state->comp_op = CAIRO_OPERATOR_OVER;
-    }
-    else if (g_str_equal(name, "display")) {
-        state->has_visible = TRUE;
-        if (g_str_equal(value, "none"))
-            state->visible = FALSE;
-        else if (!g_str_equal(value, "inherit") != 0)
-            state->visible = TRUE;
-        else
-            state->has_visible = FALSE;
-    }
-    else if (g_str_equal(name, "xml:space")) {
-        state->has_space_preserve = TRUE;
-        if (g_str_equal(value, "default"))
-            state->space_preserve = FALSE;
-        else if (!g_str_equal(value, "preserve") == 0)
-            state->space_preserve = TRUE;
-        else
-            state->space_preserve = FALSE;
-    }
-    else if (g_str_equal(name, "visibility")) {
-        state->has_visible = TRUE;
-        if (g_str_equal(value, "visible"))
-            state->visible = TRUE;
-        else if (!g_str_equal(value, "inherit") != 0)
-            state->visible = FALSE; /* collapse or hidden */
-        else
-            state->has_visible = FALSE;
-    }
-    else if (g_str_equal(name, "fill")) {
-        RsvgPaintServer* fill = state->fill;
-        state->fill = rsvg_paint_server_parse(&state->has_fill_server, value);
+
+    rsvg_flat_paint_write(&flat.fill, state->fill, write_string, user_data);
+    rsvg_flat_paint_write(&flat.stroke, state->stroke, write_string, user_data);
+    flat.state.fill = NULL;
+    flat.state.stroke = NULL;
+
+    flat.n_dash = state->dash.dash != NULL ? state->dash.n_dash : 0;
+    flat.state.dash.dash = NULL;
+    flat.state.dash.n_dash = 0;
+    flat.n_important = state->important != NULL ? state->important->n_atoms : 0;
+    flat.state.important = NULL;
+
+    g_byte_array_append(out, (const guint8*)&flat, sizeof(flat));
+    if (flat.n_dash > 0)
+        g_byte_array_append(out, (const guint8*)state->dash.dash, flat.n_dash * sizeof(double));
+    if (flat.n_important > 0)
+        g_byte_array_append(out, (const guint8*)state->important->atoms, flat.n_important * sizeof(guint16));
+    g_byte_array_append(out, zeros, (8 - out->len % 8) % 8);
+}
+
+gsize rsvg_state_read_flat(RsvgState* state,
+                           const guint8* data,
+                           gsize len,
+                           RsvgStateReadString read_string,
+                           gpointer user_data) {
+    RsvgFlatState flat;
+    const char* strings[RSVG_FLAT_N_STRINGS];
+    RsvgPaintServer* fill = NULL;
+    RsvgPaintServer* stroke = NULL;
+    RsvgState* parent;
+    const guint8* atoms;
+    guint16 atom, previous;
+    gsize size;
+    guint i;
+
+    if (len < sizeof(flat))
+        return 0;
+    memcpy(&flat, data, sizeof(flat));
+
+    size = sizeof(flat);
+    if (flat.n_dash > (len - size) / sizeof(double))
+        return 0;
+    size += flat.n_dash * sizeof(double);
+    if (flat.n_important > (len - size) / sizeof(guint16))
+        return 0;
+    size += flat.n_important * sizeof(guint16);
+    size += (8 - size % 8) % 8;
+    if (size > len || !rsvg_flat_state_check_values(&flat.state))
+        return 0;
+
+    atoms = data + sizeof(flat) + flat.n_dash * sizeof(double);
+    for (i = 0, previous = RSVG_ATTRIBUTE_UNKNOWN; i < flat.n_important; i++, previous = atom) {
+        /* sorted, as rsvg_important_properties_contain() bisects them */
+        memcpy(&atom, atoms + i * sizeof(guint16), sizeof(atom));
+        if (atom <= previous || atom >= RSVG_ATTRIBUTE_LAST)
+            return 0;
+    }
+
+    for (i = 0; i < RSVG_FLAT_N_STRINGS; i++) {
+        strings[i] = NULL;
+        if (flat.strings[i] != RSVG_FLAT_NO_STRING && (strings[i] = read_string(flat.strings[i], user_data)) == NULL)
+            return 0;
+    }
+
+    if (!rsvg_flat_paint_read(&flat.fill, &fill, read_string, user_data) ||
+        !rsvg_flat_paint_read(&flat.stroke, &stroke, read_string, user_data)) {
         rsvg_paint_server_unref(fill);
+        return 0;
     }
-    else if (g_str_equal(name, "fill-opacity")) {
-        state->fill_opacity = rsvg_css_parse_opacity(value);
-        state->has_fill_opacity = TRUE;
-    }
-    else if (g_str_equal(name, "fill-rule")) {
-        state->has_fill_rule = TRUE;
-        if (g_str_equal(value, "nonzero"))
-            state->fill_rule = CAIRO_FILL_RULE_WINDING;
-        else if (g_str_equal(value, "evenodd"))
-            state->fill_rule = CAIRO_FILL_RULE_EVEN_ODD;
-        else
-            state->has_fill_rule = FALSE;
-    }
-    else if (g_str_equal(name, "clip-rule")) {
-        state->has_clip_rule = TRUE;
-        if (g_str_equal(value, "nonzero"))
-            state->clip_rule = CAIRO_FILL_RULE_WINDING;
-        else if (g_str_equal(value, "evenodd"))
-            state->clip_rule = CAIRO_FILL_RULE_EVEN_ODD;
-        else
-            state->has_clip_rule = FALSE;
-    }
-    else if (g_str_equal(name, "stroke")) {
-        RsvgPaintServer* stroke = state->stroke;
 
-        state->stroke = rsvg_paint_server_parse(&state->has_stroke_server, value);
+    parent = state->parent;
+    rsvg_state_finalize(state);
+    *state = flat.state;
+    state->parent = parent;
 
-        rsvg_paint_server_unref(stroke);
-    }
-    else if (g_str_equal(name, "stroke-width")) {
-        state->stroke_width = _rsvg_css_parse_length(value);
-        state->has_stroke_width = TRUE;
-    }
-    else if (g_str_equal(name, "stroke-linecap")) {
-        state->has_cap = TRUE;
-        if (g_str_equal(value, "butt"))
-            state->cap = CAIRO_LINE_CAP_BUTT;
-        else if (g_str_equal(value, "round"))
-            state->cap = CAIRO_LINE_CAP_ROUND;
-        else if (g_str_equal(value, "square"))
-            state->cap = CAIRO_LINE_CAP_SQUARE;
-        else
-            g_warning(_("unknown line cap style %s\n"), value);
-    }
-    else if (g_str_equal(name, "stroke-opacity")) {
-        state->stroke_opacity = rsvg_css_parse_opacity(value);
-        state->has_stroke_opacity = TRUE;
-    }
-    else if (g_str_equal(name, "stroke-linejoin")) {
-        state->has_join = TRUE;
-        if (g_str_equal(value, "miter"))
-            state->join = CAIRO_LINE_JOIN_MITER;
-        else if (g_str_equal(value, "round"))
-            state->join = CAIRO_LINE_JOIN_ROUND;
-        else if (g_str_equal(value, "bevel"))
-            state->join = CAIRO_LINE_JOIN_BEVEL;
-        else
-            g_warning(_("unknown line join style %s\n"), value);
-    }
-    else if (g_str_equal(name, "font-size")) {
-        state->font_size = _rsvg_css_parse_length(value);
-        state->has_font_size = TRUE;
-    }
-    else if (g_str_equal(name, "font-family")) {
-        char* save = g_strdup(rsvg_css_parse_font_family(value, &state->has_font_family));
-        g_free(state->font_family);
-        state->font_family = save;
-    }
-    else if (g_str_equal(name, "xml:lang")) {
-        char* save = g_strdup(value);
-        g_free(state->lang);
-        state->lang = save;
-        state->has_lang = TRUE;
-    }
-    else if (g_str_equal(name, "font-style")) {
-        state->font_style = rsvg_css_parse_font_style(value, &state->has_font_style);
-    }
-    else if (g_str_equal(name, "font-variant")) {
-        state->font_variant = rsvg_css_parse_font_variant(value, &state->has_font_variant);
-    }
-    else if (g_str_equal(name, "font-weight")) {
-        state->font_weight = rsvg_css_parse_font_weight(value, &state->has_font_weight);
-    }
-    else if (g_str_equal(name, "font-stretch")) {
-        state->font_stretch = rsvg_css_parse_font_stretch(value, &state->has_font_stretch);
+    for (i = 0; i < RSVG_FLAT_N_STRINGS; i++)
+        RSVG_FLAT_STRING(state, i) = rsvg_state_string_new(strings[i]);
+    state->fill = fill;
+    state->stroke = stroke;
+
+    if (flat.n_dash > 0) {
+        double* dash = rsvg_shared_alloc(flat.n_dash * sizeof(double));
+
+        memcpy(dash, data + sizeof(flat), flat.n_dash * sizeof(double));
+        state->dash.dash = dash;
+        state->dash.n_dash = flat.n_dash;
     }
-    else if (g_str_equal(name, "text-decoration")) {
-        if (g_str_equal(value, "inherit")) {
-            state->has_font_decor = FALSE;
-            state->font_decor = TEXT_NORMAL;
-        }
-        else {
-            if (strstr(value, "underline"))
-                state->font_decor |= TEXT_UNDERLINE;
-            if (strstr(value, "overline"))
-                state->font_decor |= TEXT_OVERLINE;
-            if (strstr(value, "strike") || strstr(value, "line-through")) /* strike though or line-through */
-                state->font_decor |= TEXT_STRIKE;
-            state->has_font_decor = TRUE;
-        }
+
+    if (flat.n_important > 0) {
+        RsvgImportantProperties* important = rsvg_shared_alloc(G_STRUCT_OFFSET(RsvgImportantProperties, atoms) +
+                                                                flat.n_important * sizeof(guint16));
+
+        important->n_atoms = flat.n_important;
+        memcpy(important->atoms, atoms, flat.n_important * sizeof(guint16));
+        state->important = important;
     }
-    else if (g_str_equal(name, "direction")) {
-        state->has_text_dir = TRUE;
-        if (g_str_equal(value, "inherit")) {
-            state->text_dir = PANGO_DIRECTION_LTR;
-            state->has_text_dir = FALSE;
-        }
-        else if (g_str_equal(value, "rtl"))
-            state->text_dir = PANGO_DIRECTION_RTL;
-        else /* ltr */
-            state->text_dir = PANGO_DIRECTION_LTR;
+
+    return size;
+}
+
+/* Parse a CSS2 style argument, setting the SVG context attributes.
+ * @atom is the property's atom, or RSVG_ATTRIBUTE_UNKNOWN for a property
+ * that is not supported.  A property that was declared !important can only
+ * be overridden by another !important declaration.
+ */
+void rsvg_parse_style_property(RsvgHandle* ctx,
+                               RsvgState* state,
+                               RsvgAttributeAtom atom,
+                               const gchar* name,
+                               const gchar* value,
+                               gboolean important) {
+    gboolean has;
+
+    (void)ctx;
+
+    if (name == NULL || value == NULL || atom == RSVG_ATTRIBUTE_UNKNOWN)
+        return;
+
+    if (rsvg_important_properties_contain(state->important, atom)) {
+        if (!important)
+            return;
     }
-    else if (g_str_equal(name, "unicode-bidi")) {
-        state->has_unicode_bidi = TRUE;
-        if (g_str_equal(value, "inherit")) {
-            state->unicode_bidi = UNICODE_BIDI_NORMAL;
-            state->has_unicode_bidi = FALSE;
-        }
-        else if (g_str_equal(value, "embed"))
-            state->unicode_bidi = UNICODE_BIDI_EMBED;
-        else if (g_str_equal(value, "bidi-override"))
-            state->unicode_bidi = UNICODE_BIDI_OVERRIDE;
-        else /* normal */
-            state->unicode_bidi = UNICODE_BIDI_NORMAL;
+    else if (important) {
+        const RsvgImportantProperties* added = rsvg_important_properties_add(state->important, atom);
+
+        rsvg_shared_unref(state->important);
+        state->important = added;
     }
-    else if (g_str_equal(name, "writing-mode")) {
-        /* TODO: these aren't quite right... */
-
-        state->has_text_dir = TRUE;
-        state->has_text_gravity = TRUE;
-        if (g_str_equal(value, "inherit")) {
-            state->text_dir = PANGO_DIRECTION_LTR;
-            state->has_text_dir = FALSE;
-            state->text_gravity = PANGO_GRAVITY_SOUTH;
-            state->has_text_gravity = FALSE;
-        }
-        else if (g_str_equal(value, "lr-tb") || g_str_equal(value, "lr")) {
-            state->text_dir = PANGO_DIRECTION_LTR;
-            state->text_gravity = PANGO_GRAVITY_SOUTH;
+
+    switch (atom) {
+        case RSVG_ATTRIBUTE_COLOR:
+            state->current_color = rsvg_css_parse_color(value, &has);
+            state->has_current_color = has;
+            break;
+        case RSVG_ATTRIBUTE_OPACITY:
+            state->opacity = rsvg_css_parse_opacity(value);
+            break;
+        case RSVG_ATTRIBUTE_FLOOD_COLOR:
+            state->flood_color = rsvg_css_parse_color(value, &has);
+            state->has_flood_color = has;
+            break;
+        case RSVG_ATTRIBUTE_FLOOD_OPACITY:
+            state->flood_opacity = rsvg_css_parse_opacity(value);
+            state->has_flood_opacity = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_FILTER:
+            rsvg_state_string_unref(state->filter);
+            state->filter = rsvg_state_url_new(value);
+            break;
+        case RSVG_ATTRIBUTE_MASK:
+            rsvg_state_string_unref(state->mask);
+            state->mask = rsvg_state_url_new(value);
+            break;
+        case RSVG_ATTRIBUTE_BASELINE_SHIFT:
+            /* These values come from Inkscape's SP_CSS_BASELINE_SHIFT_(SUB/SUPER/BASELINE);
+             * see sp_style_merge_baseline_shift_from_parent()
+             */
+            if (g_str_equal(value, "sub")) {
+                state->has_baseline_shift = TRUE;
+                state->baseline_shift = -0.2;
+            }
+            else if (g_str_equal(value, "super")) {
+                state->has_baseline_shift = TRUE;
+                state->baseline_shift = 0.4;
+            }
+            else if (g_str_equal(value, "baseline")) {
+                state->has_baseline_shift = TRUE;
+                state->baseline_shift = 0.;
+            }
+            else {
+                g_warning(
+                    "value \'%s\' for attribute \'baseline-shift\' is not supported; only 'sub', 'super', and "
+                    "'baseline' are supported\n",
+                    value);
+            }
+            break;
+        case RSVG_ATTRIBUTE_CLIP_PATH:
+            rsvg_state_string_unref(state->clip_path);
+            state->clip_path = rsvg_state_url_new(value);
+            break;
+        case RSVG_ATTRIBUTE_OVERFLOW:
+            if (!g_str_equal(value, "inherit")) {
+                state->overflow = rsvg_css_parse_overflow(value, &has);
+                state->has_overflow = has;
+            }
+            break;
+        case RSVG_ATTRIBUTE_ENABLE_BACKGROUND:
+            if (g_str_equal(value, "new"))
+                state->enable_background = RSVG_ENABLE_BACKGROUND_NEW;
+            else
+                state->enable_background = RSVG_ENABLE_BACKGROUND_ACCUMULATE;
+            break;
+        case RSVG_ATTRIBUTE_COMP_OP:
+            if (g_str_equal(value, "clear"))
+                state->comp_op = CAIRO_OPERATOR_CLEAR;
+            else if (g_str_equal(value, "src"))
+                state->comp_op = CAIRO_OPERATOR_SOURCE;
+            else if (g_str_equal(value, "dst"))
+                state->comp_op = CAIRO_OPERATOR_DEST;
+            else if (g_str_equal(value, "src-over"))
+                state->comp_op = CAIRO_OPERATOR_OVER;
+            else if (g_str_equal(value, "dst-over"))
+                state->comp_op = CAIRO_OPERATOR_DEST_OVER;
+            else if (g_str_equal(value, "src-in"))
+                state->comp_op = CAIRO_OPERATOR_IN;
+            else if (g_str_equal(value, "dst-in"))
+                state->comp_op = CAIRO_OPERATOR_DEST_IN;
+            else if (g_str_equal(value, "src-out"))
+                state->comp_op = CAIRO_OPERATOR_OUT;
+            else if (g_str_equal(value, "dst-out"))
+                state->comp_op = CAIRO_OPERATOR_DEST_OUT;
+            else if (g_str_equal(value, "src-atop"))
+                state->comp_op = CAIRO_OPERATOR_ATOP;
+            else if (g_str_equal(value, "dst-atop"))
+                state->comp_op = CAIRO_OPERATOR_DEST_ATOP;
+            else if (g_str_equal(value, "xor"))
+                state->comp_op = CAIRO_OPERATOR_XOR;
+            else if (g_str_equal(value, "plus"))
+                state->comp_op = CAIRO_OPERATOR_ADD;
+            else if (g_str_equal(value, "multiply"))
+                state->comp_op = CAIRO_OPERATOR_MULTIPLY;
+            else if (g_str_equal(value, "screen"))
+                state->comp_op = CAIRO_OPERATOR_SCREEN;
+            else if (g_str_equal(value, "overlay"))
+                state->comp_op = CAIRO_OPERATOR_OVERLAY;
+            else if (g_str_equal(value, "darken"))
+                state->comp_op = CAIRO_OPERATOR_DARKEN;
+            else if (g_str_equal(value, "lighten"))
+                state->comp_op = CAIRO_OPERATOR_LIGHTEN;
+            else if (g_str_equal(value, "color-dodge"))
+                state->comp_op = CAIRO_OPERATOR_COLOR_DODGE;
+            else if (g_str_equal(value, "color-burn"))
+                state->comp_op = CAIRO_OPERATOR_COLOR_BURN;
+            else if (g_str_equal(value, "hard-light"))
+                state->comp_op = CAIRO_OPERATOR_HARD_LIGHT;
+            else if (g_str_equal(value, "soft-light"))
+                state->comp_op = CAIRO_OPERATOR_SOFT_LIGHT;
+            else if (g_str_equal(value, "difference"))
+                state->comp_op = CAIRO_OPERATOR_DIFFERENCE;
+            else if (g_str_equal(value, "exclusion"))
+                state->comp_op = CAIRO_OPERATOR_EXCLUSION;
+            else
+                state->comp_op = CAIRO_OPERATOR_OVER;
+            break;
+        case RSVG_ATTRIBUTE_DISPLAY:
+            state->has_visible = TRUE;
+            if (g_str_equal(value, "none"))
+                state->visible = FALSE;
+            else if (!g_str_equal(value, "inherit") != 0)
+                state->visible = TRUE;
+            else
+                state->has_visible = FALSE;
+            break;
+        case RSVG_ATTRIBUTE_XML_SPACE:
+            state->has_space_preserve = TRUE;
+            if (g_str_equal(value, "default"))
+                state->space_preserve = FALSE;
+            else if (!g_str_equal(value, "preserve") == 0)
+                state->space_preserve = TRUE;
+            else
+                state->space_preserve = FALSE;
+            break;
+        case RSVG_ATTRIBUTE_VISIBILITY:
+            state->has_visible = TRUE;
+            if (g_str_equal(value, "visible"))
+                state->visible = TRUE;
+            else if (!g_str_equal(value, "inherit") != 0)
+                state->visible = FALSE; /* collapse or hidden */
+            else
+                state->has_visible = FALSE;
+            break;
+        case RSVG_ATTRIBUTE_FILL: {
+            RsvgPaintServer* fill = state->fill;
+            state->fill = rsvg_paint_server_parse(&has, value);
+            state->has_fill_server = has;
+            rsvg_paint_server_unref(fill);
+            break;
         }
-        else if (g_str_equal(value, "rl-tb") || g_str_equal(value, "rl")) {
-            state->text_dir = PANGO_DIRECTION_RTL;
-            state->text_gravity = PANGO_GRAVITY_SOUTH;
+        case RSVG_ATTRIBUTE_FILL_OPACITY:
+            state->fill_opacity = rsvg_css_parse_opacity(value);
+            state->has_fill_opacity = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_FILL_RULE:
+            state->has_fill_rule = TRUE;
+            if (g_str_equal(value, "nonzero"))
+                state->fill_rule = CAIRO_FILL_RULE_WINDING;
+            else if (g_str_equal(value, "evenodd"))
+                state->fill_rule = CAIRO_FILL_RULE_EVEN_ODD;
+            else
+                state->has_fill_rule = FALSE;
+            break;
+        case RSVG_ATTRIBUTE_CLIP_RULE:
+            state->has_clip_rule = TRUE;
+            if (g_str_equal(value, "nonzero"))
+                state->clip_rule = CAIRO_FILL_RULE_WINDING;
+            else if (g_str_equal(value, "evenodd"))
+                state->clip_rule = CAIRO_FILL_RULE_EVEN_ODD;
+            else
+                state->has_clip_rule = FALSE;
+            break;
+        case RSVG_ATTRIBUTE_STROKE: {
+            RsvgPaintServer* stroke = state->stroke;
+
+            state->stroke = rsvg_paint_server_parse(&has, value);
+            state->has_stroke_server = has;
+
+            rsvg_paint_server_unref(stroke);
+            break;
         }
-        else if (g_str_equal(value, "tb-rl") || g_str_equal(value, "tb")) {
-            state->text_dir = PANGO_DIRECTION_LTR;
-            state->text_gravity = PANGO_GRAVITY_EAST;
+        case RSVG_ATTRIBUTE_STROKE_WIDTH:
+            state->stroke_width = _rsvg_css_parse_length(value);
+            state->has_stroke_width = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_STROKE_LINECAP:
+            state->has_cap = TRUE;
+            if (g_str_equal(value, "butt"))
+                state->cap = CAIRO_LINE_CAP_BUTT;
+            else if (g_str_equal(value, "round"))
+                state->cap = CAIRO_LINE_CAP_ROUND;
+            else if (g_str_equal(value, "square"))
+                state->cap = CAIRO_LINE_CAP_SQUARE;
+            else
+                g_warning(_("unknown line cap style %s\n"), value);
+            break;
+        case RSVG_ATTRIBUTE_STROKE_OPACITY:
+            state->stroke_opacity = rsvg_css_parse_opacity(value);
+            state->has_stroke_opacity = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_STROKE_LINEJOIN:
+            state->has_join = TRUE;
+            if (g_str_equal(value, "miter"))
+                state->join = CAIRO_LINE_JOIN_MITER;
+            else if (g_str_equal(value, "round"))
+                state->join = CAIRO_LINE_JOIN_ROUND;
+            else if (g_str_equal(value, "bevel"))
+                state->join = CAIRO_LINE_JOIN_BEVEL;
+            else
+                g_warning(_("unknown line join style %s\n"), value);
+            break;
+        case RSVG_ATTRIBUTE_FONT_SIZE:
+            state->font_size = _rsvg_css_parse_length(value);
+            state->has_font_size = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_FONT_FAMILY: {
+            const char* save = rsvg_state_string_new(rsvg_css_parse_font_family(value, &has));
+            rsvg_state_string_unref(state->font_family);
+            state->font_family = save;
+            state->has_font_family = has;
+            break;
         }
-    }
-    else if (g_str_equal(name, "text-anchor")) {
-        state->has_text_anchor = TRUE;
-        if (g_str_equal(value, "inherit")) {
-            state->text_anchor = TEXT_ANCHOR_START;
-            state->has_text_anchor = FALSE;
+        case RSVG_ATTRIBUTE_XML_LANG: {
+            const char* save = rsvg_state_string_new(value);
+            rsvg_state_string_unref(state->lang);
+            state->lang = save;
+            state->has_lang = TRUE;
+            break;
         }
-        else {
-            if (strstr(value, "start"))
+        case RSVG_ATTRIBUTE_FONT_STYLE:
+            state->font_style = rsvg_css_parse_font_style(value, &has);
+            state->has_font_style = has;
+            break;
+        case RSVG_ATTRIBUTE_FONT_VARIANT:
+            state->font_variant = rsvg_css_parse_font_variant(value, &has);
+            state->has_font_variant = has;
+            break;
+        case RSVG_ATTRIBUTE_FONT_WEIGHT:
+            state->font_weight = rsvg_css_parse_font_weight(value, &has);
+            state->has_font_weight = has;
+            break;
+        case RSVG_ATTRIBUTE_FONT_STRETCH:
+            state->font_stretch = rsvg_css_parse_font_stretch(value, &has);
+            state->has_font_stretch = has;
+            break;
+        case RSVG_ATTRIBUTE_TEXT_DECORATION:
+            if (g_str_equal(value, "inherit")) {
+                state->has_font_decor = FALSE;
+                state->font_decor = TEXT_NORMAL;
+            }
+            else {
+                if (strstr(value, "underline"))
+                    state->font_decor |= TEXT_UNDERLINE;
+                if (strstr(value, "overline"))
+                    state->font_decor |= TEXT_OVERLINE;
+                if (strstr(value, "strike") || strstr(value, "line-through")) /* strike though or line-through */
+                    state->font_decor |= TEXT_STRIKE;
+                state->has_font_decor = TRUE;
+            }
+            break;
+        case RSVG_ATTRIBUTE_DIRECTION:
+            state->has_text_dir = TRUE;
+            if (g_str_equal(value, "inherit")) {
+                state->text_dir = PANGO_DIRECTION_LTR;
+                state->has_text_dir = FALSE;
+            }
+            else if (g_str_equal(value, "rtl"))
+                state->text_dir = PANGO_DIRECTION_RTL;
+            else /* ltr */
+                state->text_dir = PANGO_DIRECTION_LTR;
+            break;
+        case RSVG_ATTRIBUTE_UNICODE_BIDI:
+            state->has_unicode_bidi = TRUE;
+            if (g_str_equal(value, "inherit")) {
+                state->unicode_bidi = UNICODE_BIDI_NORMAL;
+                state->has_unicode_bidi = FALSE;
+            }
+            else if (g_str_equal(value, "embed"))
+                state->unicode_bidi = UNICODE_BIDI_EMBED;
+            else if (g_str_equal(value, "bidi-override"))
+                state->unicode_bidi = UNICODE_BIDI_OVERRIDE;
+            else /* normal */
+                state->unicode_bidi = UNICODE_BIDI_NORMAL;
+            break;
+        case RSVG_ATTRIBUTE_WRITING_MODE:
+            /* TODO: these aren't quite right... */
+
+            state->has_text_dir = TRUE;
+            state->has_text_gravity = TRUE;
+            if (g_str_equal(value, "inherit")) {
+                state->text_dir = PANGO_DIRECTION_LTR;
+                state->has_text_dir = FALSE;
+                state->text_gravity = PANGO_GRAVITY_SOUTH;
+                state->has_text_gravity = FALSE;
+            }
+            else if (g_str_equal(value, "lr-tb") || g_str_equal(value, "lr")) {
+                state->text_dir = PANGO_DIRECTION_LTR;
+                state->text_gravity = PANGO_GRAVITY_SOUTH;
+            }
+            else if (g_str_equal(value, "rl-tb") || g_str_equal(value, "rl")) {
+                state->text_dir = PANGO_DIRECTION_RTL;
+                state->text_gravity = PANGO_GRAVITY_SOUTH;
+            }
+            else if (g_str_equal(value, "tb-rl") || g_str_equal(value, "tb")) {
+                state->text_dir = PANGO_DIRECTION_LTR;
+                state->text_gravity = PANGO_GRAVITY_EAST;
+            }
+            break;
+        case RSVG_ATTRIBUTE_TEXT_ANCHOR:
+            state->has_text_anchor = TRUE;
+            if (g_str_equal(value, "inherit")) {
                 state->text_anchor = TEXT_ANCHOR_START;
-            else if (strstr(value, "middle"))
-                state->text_anchor = TEXT_ANCHOR_MIDDLE;
-            else if (strstr(value, "end"))
-                state->text_anchor = TEXT_ANCHOR_END;
-        }
-    }
-    else if (g_str_equal(name, "letter-spacing")) {
-        state->has_letter_spacing = TRUE;
-        state->letter_spacing = _rsvg_css_parse_length(value);
-    }
-    else if (g_str_equal(name, "stop-color")) {
-        if (!g_str_equal(value, "inherit")) {
-            state->stop_color = rsvg_css_parse_color(value, &state->has_stop_color);
-        }
-    }
-    else if (g_str_equal(name, "stop-opacity")) {
-        if (!g_str_equal(value, "inherit")) {
-            state->has_stop_opacity = TRUE;
-            state->stop_opacity = rsvg_css_parse_opacity(value);
-        }
-    }
-    else if (g_str_equal(name, "marker-start")) {
-        g_free(state->startMarker);
-        state->startMarker = rsvg_get_url_string(value);
-        state->has_startMarker = TRUE;
-    }
-    else if (g_str_equal(name, "marker-mid")) {
-        g_free(state->middleMarker);
-        state->middleMarker = rsvg_get_url_string(value);
-        state->has_middleMarker = TRUE;
-    }
-    else if (g_str_equal(name, "marker-end")) {
-        g_free(state->endMarker);
-        state->endMarker = rsvg_get_url_string(value);
-        state->has_endMarker = TRUE;
-    }
-    else if (g_str_equal(name, "stroke-miterlimit")) {
-        state->has_miter_limit = TRUE;
-        state->miter_limit = g_ascii_strtod(value, NULL);
-    }
-    else if (g_str_equal(name, "stroke-dashoffset")) {
-        state->has_dashoffset = TRUE;
-        state->dash.offset = _rsvg_css_parse_length(value);
-        if (state->dash.offset.length < 0.)
-            state->dash.offset.length = 0.;
-    }
-    else if (g_str_equal(name, "shape-rendering")) {
-        state->has_shape_rendering_type = TRUE;
-
-        if (g_str_equal(value, "auto") || g_str_equal(value, "default"))
-            state->shape_rendering_type = SHAPE_RENDERING_AUTO;
-        else if (g_str_equal(value, "optimizeSpeed"))
-            state->shape_rendering_type = SHAPE_RENDERING_OPTIMIZE_SPEED;
-        else if (g_str_equal(value, "crispEdges"))
-            state->shape_rendering_type = SHAPE_RENDERING_CRISP_EDGES;
-        else if (g_str_equal(value, "geometricPrecision"))
-            state->shape_rendering_type = SHAPE_RENDERING_GEOMETRIC_PRECISION;
-    }
-    else if (g_str_equal(name, "text-rendering")) {
-        state->has_text_rendering_type = TRUE;
-
-        if (g_str_equal(value, "auto") || g_str_equal(value, "default"))
-            state->text_rendering_type = TEXT_RENDERING_AUTO;
-        else if (g_str_equal(value, "optimizeSpeed"))
-            state->text_rendering_type = TEXT_RENDERING_OPTIMIZE_SPEED;
-        else if (g_str_equal(value, "optimizeLegibility"))
-            state->text_rendering_type = TEXT_RENDERING_OPTIMIZE_LEGIBILITY;
-        else if (g_str_equal(value, "geometricPrecision"))
-            state->text_rendering_type = TEXT_RENDERING_GEOMETRIC_PRECISION;
-    }
-    else if (g_str_equal(name, "stroke-dasharray")) {
-        state->has_dash = TRUE;
-        if (g_str_equal(value, "none")) {
-            if (state->dash.n_dash != 0) {
-                /* free any cloned dash data */
-                g_free(state->dash.dash);
-                state->dash.dash = NULL;
-                state->dash.n_dash = 0;
+                state->has_text_anchor = FALSE;
             }
-        }
-        else {
-            gchar** dashes = g_strsplit(value, ",", -1);
-            if (NULL != dashes) {
-                gint n_dashes, i;
-                gboolean is_even = FALSE;
-                gdouble total = 0;
-
-                /* count the #dashes */
-                for (n_dashes = 0; dashes[n_dashes] != NULL; n_dashes++)
-                    ;
-
-                is_even = (n_dashes % 2 == 0);
-                state->dash.n_dash = (is_even ? n_dashes : n_dashes * 2);
-                state->dash.dash = g_new(double, state->dash.n_dash);
-
-                /* TODO: handle negative value == error case */
-
-                /* the even and base case */
-                for (i = 0; i < n_dashes; i++) {
-                    state->dash.dash[i] = g_ascii_strtod(dashes[i], NULL);
-                    total += state->dash.dash[i];
-                }
-                /* if an odd number of dashes is found, it gets repeated */
-                if (!is_even)
-                    for (; i < state->dash.n_dash; i++)
-                        state->dash.dash[i] = state->dash.dash[i - n_dashes];
-
-                g_strfreev(dashes);
-                /* If the dashes add up to 0, then it should
-                   be ignored */
-                if (total == 0) {
-                    g_free(state->dash.dash);
-                    state->dash.dash = NULL;
-                    state->dash.n_dash = 0;
+            else {
+                if (strstr(value, "start"))
+                    state->text_anchor = TEXT_ANCHOR_START;
+                else if (strstr(value, "middle"))
+                    state->text_anchor = TEXT_ANCHOR_MIDDLE;
+                else if (strstr(value, "end"))
+                    state->text_anchor = TEXT_ANCHOR_END;
+            }
+            break;
+        case RSVG_ATTRIBUTE_LETTER_SPACING:
+            state->has_letter_spacing = TRUE;
+            state->letter_spacing = _rsvg_css_parse_length(value);
+            break;
+        case RSVG_ATTRIBUTE_STOP_COLOR:
+            if (!g_str_equal(value, "inherit")) {
+                state->stop_color = rsvg_css_parse_color(value, &has);
+                state->has_stop_color = has;
+            }
+            break;
+        case RSVG_ATTRIBUTE_STOP_OPACITY:
+            if (!g_str_equal(value, "inherit")) {
+                state->has_stop_opacity = TRUE;
+                state->stop_opacity = rsvg_css_parse_opacity(value);
+            }
+            break;
+        case RSVG_ATTRIBUTE_MARKER_START:
+            rsvg_state_string_unref(state->startMarker);
+            state->startMarker = rsvg_state_url_new(value);
+            state->has_startMarker = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_MARKER_MID:
+            rsvg_state_string_unref(state->middleMarker);
+            state->middleMarker = rsvg_state_url_new(value);
+            state->has_middleMarker = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_MARKER_END:
+            rsvg_state_string_unref(state->endMarker);
+            state->endMarker = rsvg_state_url_new(value);
+            state->has_endMarker = TRUE;
+            break;
+        case RSVG_ATTRIBUTE_STROKE_MITERLIMIT:
+            state->has_miter_limit = TRUE;
+            state->miter_limit = g_ascii_strtod(value, NULL);
+            break;
+        case RSVG_ATTRIBUTE_STROKE_DASHOFFSET:
+            state->has_dashoffset = TRUE;
+            state->dash.offset = _rsvg_css_parse_length(value);
+            if (state->dash.offset.length < 0.)
+                state->dash.offset.length = 0.;
+            break;
+        case RSVG_ATTRIBUTE_SHAPE_RENDERING:
+            state->has_shape_rendering_type = TRUE;
+
+            if (g_str_equal(value, "auto") || g_str_equal(value, "default"))
+                state->shape_rendering_type = SHAPE_RENDERING_AUTO;
+            else if (g_str_equal(value, "optimizeSpeed"))
+                state->shape_rendering_type = SHAPE_RENDERING_OPTIMIZE_SPEED;
+            else if (g_str_equal(value, "crispEdges"))
+                state->shape_rendering_type = SHAPE_RENDERING_CRISP_EDGES;
+            else if (g_str_equal(value, "geometricPrecision"))
+                state->shape_rendering_type = SHAPE_RENDERING_GEOMETRIC_PRECISION;
+            break;
+        case RSVG_ATTRIBUTE_TEXT_RENDERING:
+            state->has_text_rendering_type = TRUE;
+
+            if (g_str_equal(value, "auto") || g_str_equal(value, "default"))
+                state->text_rendering_type = TEXT_RENDERING_AUTO;
+            else if (g_str_equal(value, "optimizeSpeed"))
+                state->text_rendering_type = TEXT_RENDERING_OPTIMIZE_SPEED;
+            else if (g_str_equal(value, "optimizeLegibility"))
+                state->text_rendering_type = TEXT_RENDERING_OPTIMIZE_LEGIBILITY;
+            else if (g_str_equal(value, "geometricPrecision"))
+                state->text_rendering_type = TEXT_RENDERING_GEOMETRIC_PRECISION;
+            break;
+        case RSVG_ATTRIBUTE_STROKE_DASHARRAY:
+            state->has_dash = TRUE;
+            /* drop the old dash data, which may be shared with other states */
+            rsvg_shared_unref(state->dash.dash);
+            state->dash.dash = NULL;
+            state->dash.n_dash = 0;
+
+            if (!g_str_equal(value, "none")) {
+                gchar** dashes = g_strsplit(value, ",", -1);
+                if (NULL != dashes) {
+                    gint n_dashes, n_dash, i;
+                    gboolean is_even = FALSE;
+                    gdouble total = 0;
+                    double* dash;
+
+                    /* count the #dashes */
+                    for (n_dashes = 0; dashes[n_dashes] != NULL; n_dashes++)
+                        ;
+
+                    is_even = (n_dashes % 2 == 0);
+                    n_dash = (is_even ? n_dashes : n_dashes * 2);
+                    dash = rsvg_shared_alloc(n_dash * sizeof(double));
+
+                    /* TODO: handle negative value == error case */
+
+                    /* the even and base case */
+                    for (i = 0; i < n_dashes; i++) {
+                        dash[i] = g_ascii_strtod(dashes[i], NULL);
+                        total += dash[i];
+                    }
+                    /* if an odd number of dashes is found, it gets repeated */
+                    if (!is_even)
+                        for (; i < n_dash; i++)
+                            dash[i] = dash[i - n_dashes];
+
+                    g_strfreev(dashes);
+                    /* If the dashes add up to 0, then it should
+                       be ignored */
+                    if (total == 0) {
+                        rsvg_shared_unref(dash);
+                    }
+                    else {
+                        state->dash.dash = dash;
+                        state->dash.n_dash = n_dash;
+                    }
                 }
             }
-        }
+            break;
+        default:
+            break;
     }
 }
 
-static void rsvg_lookup_parse_style_pair(RsvgHandle* ctx, RsvgState* state, const char* key, RsvgPropertyBag* atts) {
-    const char* value;
+void rsvg_parse_style_pair(RsvgHandle* ctx,
+                           RsvgState* state,
+                           const gchar* name,
+                           const gchar* value,
+                           gboolean important) {
+    if (name == NULL)
+        return;
 
-    if ((value = rsvg_property_bag_lookup(atts, key)) != NULL)
-        rsvg_parse_style_pair(ctx, state, key, value, FALSE);
-}
-
-/* take a pair of the form (fill="#ff00ff") and parse it as a style */
-void rsvg_parse_style_pairs(RsvgHandle* ctx, RsvgState* state, RsvgPropertyBag* atts) {
-    rsvg_lookup_parse_style_pair(ctx, state, "baseline-shift", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "clip-path", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "clip-rule", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "color", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "direction", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "display", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "enable-background", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "comp-op", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "fill", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "fill-opacity", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "fill-rule", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "filter", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "flood-color", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "flood-opacity", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-family", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-size", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-stretch", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-style", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-variant", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "font-weight", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "marker-end", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "mask", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "marker-mid", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "marker-start", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "opacity", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "overflow", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "shape-rendering", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stop-color", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stop-opacity", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-dasharray", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-dashoffset", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-linecap", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-linejoin", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-miterlimit", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-opacity", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "stroke-width", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "text-anchor", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "text-decoration", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "unicode-bidi", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "letter-spacing", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "visibility", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "writing-mode", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "xml:lang", atts);
-    rsvg_lookup_parse_style_pair(ctx, state, "xml:space", atts);
+    rsvg_parse_style_property(ctx, state, rsvg_attribute_atom_lookup(name), name, value, important);
+}
+
+/* Presentation attributes, indexed by atom.  The rank is the order in which
+ * they are applied, so that attributes which touch the same state field
+ * (display/visibility, direction/writing-mode) resolve the same way no
+ * matter where they appear on the element; 0 means "not a presentation
+ * attribute".
+ */
+static const guint8 presentation_attribute_rank[RSVG_ATTRIBUTE_LAST] = {
+    [RSVG_ATTRIBUTE_BASELINE_SHIFT] = 1,
+    [RSVG_ATTRIBUTE_CLIP_PATH] = 2,
+    [RSVG_ATTRIBUTE_CLIP_RULE] = 3,
+    [RSVG_ATTRIBUTE_COLOR] = 4,
+    [RSVG_ATTRIBUTE_DIRECTION] = 5,
+    [RSVG_ATTRIBUTE_DISPLAY] = 6,
+    [RSVG_ATTRIBUTE_ENABLE_BACKGROUND] = 7,
+    [RSVG_ATTRIBUTE_COMP_OP] = 8,
+    [RSVG_ATTRIBUTE_FILL] = 9,
+    [RSVG_ATTRIBUTE_FILL_OPACITY] = 10,
+    [RSVG_ATTRIBUTE_FILL_RULE] = 11,
+    [RSVG_ATTRIBUTE_FILTER] = 12,
+    [RSVG_ATTRIBUTE_FLOOD_COLOR] = 13,
+    [RSVG_ATTRIBUTE_FLOOD_OPACITY] = 14,
+    [RSVG_ATTRIBUTE_FONT_FAMILY] = 15,
+    [RSVG_ATTRIBUTE_FONT_SIZE] = 16,
+    [RSVG_ATTRIBUTE_FONT_STRETCH] = 17,
+    [RSVG_ATTRIBUTE_FONT_STYLE] = 18,
+    [RSVG_ATTRIBUTE_FONT_VARIANT] = 19,
+    [RSVG_ATTRIBUTE_FONT_WEIGHT] = 20,
+    [RSVG_ATTRIBUTE_MARKER_END] = 21,
+    [RSVG_ATTRIBUTE_MASK] = 22,
+    [RSVG_ATTRIBUTE_MARKER_MID] = 23,
+    [RSVG_ATTRIBUTE_MARKER_START] = 24,
+    [RSVG_ATTRIBUTE_OPACITY] = 25,
+    [RSVG_ATTRIBUTE_OVERFLOW] = 26,
+    [RSVG_ATTRIBUTE_SHAPE_RENDERING] = 27,
+    [RSVG_ATTRIBUTE_STOP_COLOR] = 28,
+    [RSVG_ATTRIBUTE_STOP_OPACITY] = 29,
+    [RSVG_ATTRIBUTE_STROKE] = 30,
+    [RSVG_ATTRIBUTE_STROKE_DASHARRAY] = 31,
+    [RSVG_ATTRIBUTE_STROKE_DASHOFFSET] = 32,
+    [RSVG_ATTRIBUTE_STROKE_LINECAP] = 33,
+    [RSVG_ATTRIBUTE_STROKE_LINEJOIN] = 34,
+    [RSVG_ATTRIBUTE_STROKE_MITERLIMIT] = 35,
+    [RSVG_ATTRIBUTE_STROKE_OPACITY] = 36,
+    [RSVG_ATTRIBUTE_STROKE_WIDTH] = 37,
+    [RSVG_ATTRIBUTE_TEXT_ANCHOR] = 38,
+    [RSVG_ATTRIBUTE_TEXT_DECORATION] = 39,
+    [RSVG_ATTRIBUTE_UNICODE_BIDI] = 40,
+    [RSVG_ATTRIBUTE_LETTER_SPACING] = 41,
+    [RSVG_ATTRIBUTE_VISIBILITY] = 42,
+    [RSVG_ATTRIBUTE_WRITING_MODE] = 43,
+    [RSVG_ATTRIBUTE_XML_LANG] = 44,
+    [RSVG_ATTRIBUTE_XML_SPACE] = 45,
+};
+
+#define N_PRESENTATION_ATTRIBUTES 45
+
+/* take a pair of the form (fill="#ff00ff") and parse it as a style; returns
+ * whether there were any such pairs, or conditional attributes
+ */
+gboolean rsvg_parse_style_pairs(RsvgHandle* ctx, RsvgState* state, RsvgPropertyBag* atts) {
+    const RsvgAttribute* found[N_PRESENTATION_ATTRIBUTES];
+    guint n_found = 0;
+    guint i, j;
+
+    /* One pass over the attributes that are actually present; each hit is
+     * insertion-sorted by rank, which is cheap for the handful we expect.
+     */
+    for (i = 0; i < atts->n_attributes && n_found < N_PRESENTATION_ATTRIBUTES; i++) {
+        const RsvgAttribute* attr = &atts->attributes[i];
+        guint rank = presentation_attribute_rank[attr->atom];
+
+        if (rank == 0)
+            continue;
+
+        for (j = n_found; j > 0 && presentation_attribute_rank[found[j - 1]->atom] > rank; j--)
+            found[j] = found[j - 1];
+        found[j] = attr;
+        n_found++;
+    }
+
+    for (i = 0; i < n_found; i++)
+        rsvg_parse_style_property(ctx, state, found[i]->atom, found[i]->name, found[i]->value, FALSE);
 
     {
         /* TODO: this conditional behavior isn't quite correct, and i'm not sure it should reside here */
@@ -956,76 +1364,140 @@ void rsvg_parse_style_pairs(RsvgHandle* ctx, RsvgState* state, RsvgPropertyBag*
             state->cond_true = cond_true;
             state->has_cond = TRUE;
         }
+
+        return n_found > 0 || has_cond;
     }
 }
 
-static gboolean parse_style_value(const gchar* string, gchar** value, gboolean* important) {
-    gchar** strings;
+/* One declaration of a style="" attribute.  The slices point into the
+ * attribute value and are not NUL-terminated; @value still carries any
+ * single quotes, which are dropped when it is handed to the parsers.
+ */
+typedef struct {
+    RsvgAttributeAtom atom;
+    const char* name;
+    gsize name_len;
+    const char* value;
+    gsize value_len;
+    gboolean important;
+} RsvgStyleDeclaration;
 
-    strings = g_strsplit(string, "!", 2);
+/* Does @str[0..len), ignoring single quotes and surrounding whitespace, read "important"? */
+static gboolean style_slice_is_important(const char* str, gsize len) {
+    static const char important[] = "important";
+    gsize i, matched = 0;
 
-    if (strings == NULL || strings[0] == NULL) {
-        g_strfreev(strings);
-        return FALSE;
+    for (i = 0; i < len; i++) {
+        if (str[i] == '\'')
+            continue;
+        if (matched < sizeof(important) - 1 && str[i] == important[matched])
+            matched++;
+        else if (!g_ascii_isspace(str[i]) || (matched != 0 && matched < sizeof(important) - 1))
+            return FALSE;
     }
 
-    if (strings[1] != NULL && strings[2] == NULL && g_str_equal(g_strstrip(strings[1]), "important")) {
-        *important = TRUE;
-    }
-    else {
-        *important = FALSE;
-    }
+    return matched == sizeof(important) - 1;
+}
 
-    *value = g_strdup(g_strstrip(strings[0]));
+/* Advance *@cursor past the next "name: value [!important]" declaration and
+ * describe it in @decl, without copying anything.  Declarations without a
+ * colon, or whose value is empty once quotes are removed, are skipped as
+ * they always have been.
+ */
+static gboolean rsvg_style_next_declaration(const char** cursor, RsvgStyleDeclaration* decl) {
+    const char* p = *cursor;
 
-    g_strfreev(strings);
+    while (*p) {
+        const char *start = p, *colon = NULL, *bang = NULL, *end;
+        gboolean has_value = FALSE;
 
-    return TRUE;
+        for (; *p && *p != ';'; p++) {
+            if (colon == NULL) {
+                if (*p == ':')
+                    colon = p;
+            }
+            else if (*p != '\'') {
+                has_value = TRUE;
+                if (*p == '!' && bang == NULL)
+                    bang = p;
+            }
+        }
+        end = p;
+        if (*p)
+            p++;
+
+        if (colon == NULL || !has_value)
+            continue;
+
+        decl->name = start;
+        decl->name_len = colon - start;
+        while (decl->name_len > 0 && g_ascii_isspace(decl->name[0])) {
+            decl->name++;
+            decl->name_len--;
+        }
+        while (decl->name_len > 0 && g_ascii_isspace(decl->name[decl->name_len - 1]))
+            decl->name_len--;
+        decl->atom = rsvg_attribute_atom_lookup_len(decl->name, decl->name_len);
+
+        decl->value = colon + 1;
+        decl->value_len = (bang ? bang : end) - decl->value;
+        while (decl->value_len > 0 && (g_ascii_isspace(decl->value[0]) || decl->value[0] == '\'')) {
+            decl->value++;
+            decl->value_len--;
+        }
+        while (decl->value_len > 0 &&
+               (g_ascii_isspace(decl->value[decl->value_len - 1]) || decl->value[decl->value_len - 1] == '\''))
+            decl->value_len--;
+
+        decl->important = bang != NULL && style_slice_is_important(bang + 1, end - bang - 1);
+
+        *cursor = p;
+        return TRUE;
+    }
+
+    *cursor = p;
+    return FALSE;
 }
 
+/* Big enough for the name and value of nearly every declaration seen in the wild */
+#define RSVG_STYLE_SCRATCH_SIZE 256
+
 /* Split a CSS2 style into individual style arguments, setting attributes
    in the SVG context.
 
    It's known that this is _way_ out of spec. A more complete CSS2
    implementation will happen later.
+
+   Single quotes are simply removed.  No handling for any special
+   character inside the quotes is done.  This relates especially to
+   font-family names but cases with special characters are rare.
 */
 void rsvg_parse_style(RsvgHandle* ctx, RsvgState* state, const char* str) {
-    gchar** styles;
-    guint i;
+    gchar scratch[RSVG_STYLE_SCRATCH_SIZE];
+    RsvgStyleDeclaration decl;
+    const char* cursor = str;
 
-    styles = g_strsplit(str, ";", -1);
-    for (i = 0; i < g_strv_length(styles); i++) {
-        gchar** values;
-        values = g_strsplit(styles[i], ":", 2);
-        if (!values)
-            continue;
+    while (rsvg_style_next_declaration(&cursor, &decl)) {
+        gchar *buf, *name, *value, *out;
+        gsize i, needed = decl.name_len + decl.value_len + 2;
 
-        if (g_strv_length(values) == 2) {
-            gboolean important;
-            gchar* style_value = NULL;
-            gchar* first_value = values[0];
-            gchar* second_value = values[1];
-            gchar** split_list;
-
-            /* Just remove single quotes in a trivial way.  No handling for any
-             * special character inside the quotes is done.  This relates
-             * especially to font-family names but cases with special characters
-             * are rare.
-             *
-             * We need a real CSS parser, sigh.
-             */
-            split_list = g_strsplit(second_value, "'", -1);
-            second_value = g_strjoinv(NULL, split_list);
-            g_strfreev(split_list);
-
-            if (parse_style_value(second_value, &style_value, &important))
-                rsvg_parse_style_pair(ctx, state, g_strstrip(first_value), style_value, important);
-            g_free(style_value);
-            g_free(second_value);
-        }
-        g_strfreev(values);
+        buf = needed <= sizeof(scratch) ? scratch : g_malloc(needed);
+
+        name = buf;
+        memcpy(name, decl.name, decl.name_len);
+        name[decl.name_len] = '\0';
+
+        value = out = name + decl.name_len + 1;
+        for (i = 0; i < decl.value_len; i++)
+            if (decl.value[i] != '\'')
+                *out++ = decl.value[i];
+        *out = '\0';
+
+        rsvg_parse_style_property(ctx, state, decl.atom, name, value, decl.important);
+
+        if (buf != scratch)
+            g_free(buf);
     }
-    g_strfreev(styles);
 }
 
 /* Parse an SVG transform string into an affine matrix. Reference: SVG
@@ -1077,7 +1549,7 @@ gboolean rsvg_parse_transform(cairo_matrix_t* dst, const char* src) {
 
         for (n_args = 0;; n_args++) {
             char c;
-            char* end_ptr;
+            const char* end_ptr;
 
             /* skip whitespace */
             while (g_ascii_isspace(src[idx]))
@@ -1087,7 +1559,9 @@ gboolean rsvg_parse_transform(cairo_matrix_t* dst, const char* src) {
                 if (n_args == sizeof(args) / sizeof(args[0]))
                     goto invalid;
 
-                args[n_args] = g_ascii_strtod(src + idx, &end_ptr);
+                end_ptr = src + idx;
+                if (!rsvg_scan_number(&end_ptr, &args[n_args]))
+                    goto invalid;
                 idx = end_ptr - src;
 
                 while (g_ascii_isspace(src[idx]))
@@ -1213,7 +1687,16 @@ void rsvg_parse_style_attrs(RsvgHandle* ctx,
                             const char* klazz,
                             const char* id,
                             RsvgPropertyBag* atts) {
-    rsvg_css_engine_apply_styles(ctx->priv->css_engine, NULL, state, tag, klazz, id, atts);
+    RsvgHandlePrivate* priv = ctx->priv;
+
+    /* a document loaded from a cache gets the states it had when it was cached */
+    if (priv->cache != NULL && rsvg_cache_replay_state(priv->cache, state))
+        return;
+
+    rsvg_css_engine_apply_styles(priv->css_engine, NULL, state, tag, klazz, id, atts);
+
+    if (priv->cache_writer != NULL)
+        rsvg_cache_writer_add_state(priv->cache_writer, state);
 }
 
 RsvgState* rsvg_current_state(RsvgDrawingCtx* ctx) {
@@ -1224,13 +1707,63 @@ RsvgState* rsvg_state_parent(RsvgState* state) {
     return state->parent;
 }
 
-void rsvg_state_free_all(RsvgState* state) {
-    while (state) {
-        RsvgState* parent = state->parent;
-        rsvg_state_finalize(state);
-        g_slice_free(RsvgState, state);
-        state = parent;
+void rsvg_state_free_all(RsvgDrawingCtx* ctx) {
+    while (ctx->state)
+        rsvg_state_pop(ctx);
+
+    if (ctx->state_chunks != NULL) {
+        g_ptr_array_free(ctx->state_chunks, TRUE);
+        ctx->state_chunks = NULL;
+    }
+}
+
+/**
+ * rsvg_property_bag_init:
+ * @bag: uninitialized storage, usually on the stack
+ * @atts: (array zero-terminated=1): list of alternating attributes
+ *   and values
+ *
+ * Fills @bag with a view of @atts, tagging every attribute with its atom.
+ * The bag does NOT copy the attributes and values, and it only allocates
+ * when there are more than %RSVG_PROPERTY_BAG_PREALLOC of them.  Release it
+ * with rsvg_property_bag_clear().
+ */
+void rsvg_property_bag_init(RsvgPropertyBag* bag, const char** atts) {
+    guint i, n = 0;
+
+    if (atts != NULL)
+        while (atts[n * 2] != NULL)
+            n++;
+
+    bag->n_attributes = n;
+    bag->is_heap = FALSE;
+    bag->owns_strings = FALSE;
+    bag->attributes = n > RSVG_PROPERTY_BAG_PREALLOC ? g_new(RsvgAttribute, n) : bag->prealloc;
+
+    for (i = 0; i < n; i++) {
+        RsvgAttribute* attr = &bag->attributes[i];
+
+        attr->name = atts[i * 2];
+        attr->value = atts[i * 2 + 1];
+        attr->atom = rsvg_attribute_atom_lookup(attr->name);
+    }
+}
+
+void rsvg_property_bag_clear(RsvgPropertyBag* bag) {
+    guint i;
+
+    if (bag->owns_strings) {
+        for (i = 0; i < bag->n_attributes; i++) {
+            g_free((char*)bag->attributes[i].name);
+            g_free((char*)bag->attributes[i].value);
+        }
     }
+
+    if (bag->attributes != bag->prealloc)
+        g_free(bag->attributes);
+
+    bag->attributes = bag->prealloc;
+    bag->n_attributes = 0;
 }
 
 /**
@@ -1238,6 +1771,8 @@ void rsvg_state_free_all(RsvgState* state) {
  * @atts: (array zero-terminated=1): list of alternating attributes
  *   and values
  *
+ * Heap-allocated variant of rsvg_property_bag_init().
+ *
  * The property bag will NOT copy the attributes and values. If you need
  * to store them for later, use rsvg_property_bag_dup().
  *
@@ -1245,14 +1780,10 @@ void rsvg_state_free_all(RsvgState* state) {
  */
 RsvgPropertyBag* rsvg_property_bag_new(const char** atts) {
     RsvgPropertyBag* bag;
-    int i;
 
-    bag = g_hash_table_new(g_str_hash, g_str_equal);
-
-    if (atts != NULL) {
-        for (i = 0; atts[i] != NULL; i += 2)
-            g_hash_table_insert(bag, (gpointer)atts[i], (gpointer)atts[i + 1]);
-    }
+    bag = g_new(RsvgPropertyBag, 1);
+    rsvg_property_bag_init(bag, atts);
+    bag->is_heap = TRUE;
 
     return bag;
 }
@@ -1267,56 +1798,330 @@ RsvgPropertyBag* rsvg_property_bag_new(const char** atts) {
  */
 RsvgPropertyBag* rsvg_property_bag_dup(RsvgPropertyBag* bag) {
     RsvgPropertyBag* dup;
-    GHashTableIter iter;
-    gpointer key, value;
+    guint i;
 
-    dup = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    dup = g_new(RsvgPropertyBag, 1);
+    dup->n_attributes = bag->n_attributes;
+    dup->is_heap = TRUE;
+    dup->owns_strings = TRUE;
+    dup->attributes = bag->n_attributes > RSVG_PROPERTY_BAG_PREALLOC ? g_new(RsvgAttribute, bag->n_attributes)
+                                                                     : dup->prealloc;
 
-    g_hash_table_iter_init(&iter, bag);
-    while (g_hash_table_iter_next(&iter, &key, &value))
-        g_hash_table_insert(dup, (gpointer)g_strdup((char*)key), (gpointer)g_strdup((char*)value));
+    for (i = 0; i < bag->n_attributes; i++) {
+        dup->attributes[i].atom = bag->attributes[i].atom;
+        dup->attributes[i].name = g_strdup(bag->attributes[i].name);
+        dup->attributes[i].value = g_strdup(bag->attributes[i].value);
+    }
 
     return dup;
 }
 
 void rsvg_property_bag_free(RsvgPropertyBag* bag) {
-    g_hash_table_unref(bag);
+    rsvg_property_bag_clear(bag);
+    if (bag->is_heap)
+        g_free(bag);
 }
 
 const char* rsvg_property_bag_lookup(RsvgPropertyBag* bag, const char* key) {
-    return (const char*)g_hash_table_lookup(bag, (gconstpointer)key);
+    RsvgAttributeAtom atom;
+    guint i;
+
+    atom = rsvg_attribute_atom_lookup(key);
+    if (atom != RSVG_ATTRIBUTE_UNKNOWN)
+        return rsvg_property_bag_lookup_atom(bag, atom);
+
+    for (i = 0; i < bag->n_attributes; i++)
+        if (!strcmp(bag->attributes[i].name, key))
+            return bag->attributes[i].value;
+
+    return NULL;
 }
 
 guint rsvg_property_bag_size(RsvgPropertyBag* bag) {
-    return g_hash_table_size(bag);
+    return bag->n_attributes;
 }
 
 void rsvg_property_bag_enumerate(RsvgPropertyBag* bag, RsvgPropertyBagEnumFunc func, gpointer user_data) {
-    g_hash_table_foreach(bag, (GHFunc)func, user_data);
+    guint i;
+
+    for (i = 0; i < bag->n_attributes; i++)
+        func(bag->attributes[i].name, bag->attributes[i].value, user_data);
+}
+
+/* Computed styles.
+ *
+ * What a node looks like when it is drawn depends on its own state and on
+ * the style of whatever it is drawn in, which is usually its parent but
+ * can be a <use>, a pattern or a marker.  Resolving that takes a full pass
+ * over the state, so the result is computed once for each node and base
+ * style and kept on the node.  Computed styles are immutable and shared:
+ * the state stack holds references to them, and since the base style is
+ * part of the key, a document drawn again (at another size, say) finds the
+ * same styles all the way down.
+ *
+ * Several renders may draw the same handle at once, so a node's list is
+ * only ever prepended to, with an atomic compare-and-exchange, and only
+ * emptied while nothing draws it.
+ */
+
+/* The number of styles kept for one node, which bounds what a node that is
+ * drawn in many different places (an external document that is used by
+ * many handles) holds on to; styles beyond it are computed for each use.
+ */
+#define RSVG_COMPUTED_STYLES_PER_NODE 16
+
+typedef enum {
+    RSVG_COMPUTED_REINHERIT,
+    RSVG_COMPUTED_DOMINATE,
+    RSVG_COMPUTED_OVERRIDE,
+    RSVG_COMPUTED_RECONSTRUCT
+} RsvgComputedMode;
+
+struct _RsvgComputedStyle {
+    RsvgState state; /* parent, affine and personal_affine are unused */
+    gint ref_count;
+
+    /* the key in the node's list */
+    RsvgComputedStyle* base;
+    RsvgComputedMode mode;
+    RsvgComputedStyle* next;
+
+    /* the style of a state pushed on top of one with this style */
+    RsvgComputedStyle* pushed;
+};
+
+/* A frame of the state stack.  The state is a copy of the computed style,
+ * so that it can be read like any other state, but it does not own the
+ * strings and paint servers in it; the reference to the style keeps them
+ * alive.  Only the transforms are the frame's own, along with the font
+ * size and baseline shift, which are resolved against the frames below
+ * whenever the style changes so that em and ex lengths cost nothing.
+ */
+typedef struct {
+    RsvgState state;
+    RsvgComputedStyle* style;
+    double font_size;
+    double baseline_shift;
+} RsvgStateFrame;
+
+/* Frames are allocated this many at a time, in chunks that never move,
+ * since states point at their parents
+ */
+#define RSVG_STATE_CHUNK_SIZE 32
+
+static RsvgComputedStyle* rsvg_computed_style_new(void) {
+    RsvgComputedStyle* style = g_new(RsvgComputedStyle, 1);
+
+    rsvg_state_init(&style->state);
+    style->ref_count = 1;
+    style->base = NULL;
+    style->mode = RSVG_COMPUTED_REINHERIT;
+    style->next = NULL;
+    style->pushed = NULL;
+
+    return style;
+}
+
+static RsvgComputedStyle* rsvg_computed_style_ref(RsvgComputedStyle* style) {
+    g_atomic_int_inc(&style->ref_count);
+    return style;
+}
+
+static void rsvg_computed_style_unref(RsvgComputedStyle* style) {
+    if (style == NULL || !g_atomic_int_dec_and_test(&style->ref_count))
+        return;
+
+    rsvg_state_finalize(&style->state);
+    rsvg_computed_style_unref(style->base);
+    rsvg_computed_style_unref(style->pushed);
+    g_free(style);
+}
+
+/* The style of the bottom of every state stack, which is never freed */
+static RsvgComputedStyle* rsvg_computed_style_initial(void) {
+    static gsize initial = 0;
+
+    if (g_once_init_enter(&initial))
+        g_once_init_leave(&initial, (gsize)rsvg_computed_style_new());
+
+    return rsvg_computed_style_ref((RsvgComputedStyle*)initial);
+}
+
+static RsvgComputedStyle* rsvg_computed_style_pushed(RsvgComputedStyle* base) {
+    RsvgComputedStyle* pushed = g_atomic_pointer_get(&base->pushed);
+
+    if (pushed == NULL) {
+        pushed = rsvg_computed_style_new();
+        rsvg_state_reinherit(&pushed->state, &base->state);
+
+        if (!g_atomic_pointer_compare_and_exchange(&base->pushed, NULL, pushed)) {
+            rsvg_computed_style_unref(pushed);
+            pushed = g_atomic_pointer_get(&base->pushed);
+        }
+    }
+
+    return rsvg_computed_style_ref(pushed);
+}
+
+static RsvgComputedStyle* rsvg_computed_style_compute(RsvgNode* node, RsvgComputedStyle* base, RsvgComputedMode mode) {
+    RsvgComputedStyle* style = rsvg_computed_style_new();
+
+    switch (mode) {
+        case RSVG_COMPUTED_OVERRIDE:
+            rsvg_state_clone(&style->state, &base->state);
+            rsvg_state_override(&style->state, node->state);
+            break;
+        case RSVG_COMPUTED_RECONSTRUCT:
+            rsvg_state_reconstruct(&style->state, node);
+            break;
+        case RSVG_COMPUTED_DOMINATE:
+        case RSVG_COMPUTED_REINHERIT:
+            rsvg_state_clone(&style->state, node->state);
+            if (base == NULL)
+                break;
+            if (mode == RSVG_COMPUTED_DOMINATE)
+                rsvg_state_dominate(&style->state, &base->state);
+            else
+                rsvg_state_reinherit(&style->state, &base->state);
+            break;
+    }
+
+    style->base = base != NULL ? rsvg_computed_style_ref(base) : NULL;
+    style->mode = mode;
+
+    return style;
+}
+
+/* Returns a reference to the style of @node on top of @base */
+static RsvgComputedStyle* rsvg_computed_style_get(RsvgNode* node, RsvgComputedStyle* base, RsvgComputedMode mode) {
+    RsvgComputedStyle* head = g_atomic_pointer_get(&node->computed);
+    RsvgComputedStyle* style = NULL;
+
+    for (;;) {
+        RsvgComputedStyle* entry;
+        guint n = 0;
+
+        for (entry = head; entry != NULL; entry = entry->next, n++) {
+            if (entry->base == base && entry->mode == mode) {
+                /* another thread got there first */
+                rsvg_computed_style_unref(style);
+                return rsvg_computed_style_ref(entry);
+            }
+        }
+
+        if (style == NULL)
+            style = rsvg_computed_style_compute(node, base, mode);
+        if (n >= RSVG_COMPUTED_STYLES_PER_NODE)
+            return style;
+
+        style->next = head;
+        if (g_atomic_pointer_compare_and_exchange(&node->computed, head, style))
+            return rsvg_computed_style_ref(style);
+
+        head = g_atomic_pointer_get(&node->computed);
+    }
+}
+
+void rsvg_state_clear_computed(RsvgNode* node) {
+    RsvgComputedStyle* style = node->computed;
+
+    node->computed = NULL;
+    while (style != NULL) {
+        RsvgComputedStyle* next = style->next;
+
+        rsvg_computed_style_unref(style);
+        style = next;
+    }
+}
+
+/* Resolves the font size and baseline shift of @frame from those of its
+ * parent, which are already resolved
+ */
+static void rsvg_state_frame_resolve(RsvgStateFrame* frame, RsvgDrawingCtx* ctx) {
+    RsvgStateFrame* parent = (RsvgStateFrame*)frame->state.parent;
+    const RsvgLength* size = &frame->state.font_size;
+
+    switch (size->factor) {
+        case 'p':
+        case 'm':
+        case 'x':
+            frame->font_size = parent ? size->length * parent->font_size : 12.;
+            break;
+        default:
+            frame->font_size = _rsvg_css_normalize_length(size, ctx, 'v');
+            break;
+    }
+
+    frame->baseline_shift = 0.;
+    if (parent) {
+        frame->baseline_shift = parent->baseline_shift;
+        if (frame->state.has_baseline_shift)
+            frame->baseline_shift += parent->font_size * frame->state.baseline_shift;
+    }
+}
+
+/* Makes @frame show @style, taking over the caller's reference to it; the
+ * frame's parent and transforms are kept.
+ */
+static void rsvg_state_frame_set_style(RsvgStateFrame* frame, RsvgComputedStyle* style, RsvgDrawingCtx* ctx) {
+    RsvgState* parent = frame->state.parent;
+    cairo_matrix_t affine = frame->state.affine;
+    cairo_matrix_t personal_affine = frame->state.personal_affine;
+
+    rsvg_computed_style_unref(frame->style);
+
+    frame->state = style->state;
+    frame->state.parent = parent;
+    frame->state.affine = affine;
+    frame->state.personal_affine = personal_affine;
+    frame->style = style;
+
+    rsvg_state_frame_resolve(frame, ctx);
+}
+
+double rsvg_state_font_size(RsvgState* state) {
+    return ((RsvgStateFrame*)state)->font_size;
+}
+
+double rsvg_state_baseline_shift(RsvgState* state) {
+    return ((RsvgStateFrame*)state)->baseline_shift;
 }
 
 void rsvg_state_push(RsvgDrawingCtx* ctx) {
-    RsvgState* data;
-    RsvgState* baseon;
+    RsvgState* baseon = ctx->state;
+    RsvgStateFrame* frame;
+    guint chunk = ctx->n_states / RSVG_STATE_CHUNK_SIZE;
+
+    if (ctx->state_chunks == NULL)
+        ctx->state_chunks = g_ptr_array_new_with_free_func(g_free);
+    if (chunk == ctx->state_chunks->len)
+        g_ptr_array_add(ctx->state_chunks, g_new(RsvgStateFrame, RSVG_STATE_CHUNK_SIZE));
+
+    frame = (RsvgStateFrame*)g_ptr_array_index(ctx->state_chunks, chunk) + ctx->n_states % RSVG_STATE_CHUNK_SIZE;
+    ctx->n_states++;
 
-    baseon = ctx->state;
-    data = g_slice_new(RsvgState);
-    rsvg_state_init(data);
+    frame->style = NULL;
+    frame->state.parent = baseon;
+    cairo_matrix_init_identity(&frame->state.personal_affine);
 
     if (baseon) {
-        rsvg_state_reinherit(data, baseon);
-        data->affine = baseon->affine;
-        data->parent = baseon;
+        frame->state.affine = baseon->affine;
+        rsvg_state_frame_set_style(frame, rsvg_computed_style_pushed(((RsvgStateFrame*)baseon)->style), ctx);
+    }
+    else {
+        cairo_matrix_init_identity(&frame->state.affine);
+        rsvg_state_frame_set_style(frame, rsvg_computed_style_initial(), ctx);
     }
 
-    ctx->state = data;
+    ctx->state = &frame->state;
 }
 
 void rsvg_state_pop(RsvgDrawingCtx* ctx) {
-    RsvgState* dead_state = ctx->state;
-    ctx->state = dead_state->parent;
-    rsvg_state_finalize(dead_state);
-    g_slice_free(RsvgState, dead_state);
+    RsvgStateFrame* frame = (RsvgStateFrame*)ctx->state;
+
+    ctx->state = frame->state.parent;
+    rsvg_computed_style_unref(frame->style);
+    ctx->n_states--;
 }
 
 /*
@@ -1331,30 +2136,35 @@ void rsvg_state_pop(RsvgDrawingCtx* ctx) {
   rather based wholly on their own loading context. Other things
   may want to have this totally disabled, and a value of three will
   achieve this.
+  The resulting style is computed once per node and base style; see
+  "Computed styles" above.
 */
 
-void rsvg_state_reinherit_top(RsvgDrawingCtx* ctx, RsvgState* state, int dominate) {
+void rsvg_state_reinherit_top(RsvgDrawingCtx* ctx, RsvgNode* node, int dominate) {
+    RsvgStateFrame* frame;
     RsvgState* current;
 
     if (dominate == 3)
         return;
 
     current = rsvg_current_state(ctx);
+    frame = (RsvgStateFrame*)current;
     /*This is a special domination mode for patterns, the transform
        is simply left as is, wheras the style is totally overridden */
     if (dominate == 2) {
-        rsvg_state_override(current, state);
+        rsvg_state_frame_set_style(frame, rsvg_computed_style_get(node, frame->style, RSVG_COMPUTED_OVERRIDE), ctx);
     }
     else {
         RsvgState* parent = rsvg_state_parent(current);
-        rsvg_state_clone(current, state);
-        if (parent) {
-            if (dominate)
-                rsvg_state_dominate(current, parent);
-            else
-                rsvg_state_reinherit(current, parent);
+        RsvgComputedStyle* base = parent ? ((RsvgStateFrame*)parent)->style : NULL;
+        RsvgComputedStyle* style;
+
+        style = rsvg_computed_style_get(node, base, dominate ? RSVG_COMPUTED_DOMINATE : RSVG_COMPUTED_REINHERIT);
+        rsvg_state_frame_set_style(frame, style, ctx);
+        current->affine = node->state->affine;
+        current->personal_affine = node->state->personal_affine;
+        if (parent)
             cairo_matrix_multiply(&current->affine, &current->affine, &parent->affine);
-        }
     }
 }
 
@@ -1364,3 +2174,15 @@ void rsvg_state_reconstruct(RsvgState* state, RsvgNode* current) {
     rsvg_state_reconstruct(state, current->parent);
     rsvg_state_inherit(state, current->state);
 }
+
+/* Gives the top of the stack the style @node has in the document, with
+ * identity transforms
+ */
+void rsvg_state_reconstruct_top(RsvgDrawingCtx* ctx, RsvgNode* node) {
+    RsvgState* current = rsvg_current_state(ctx);
+    RsvgComputedStyle* style = rsvg_computed_style_get(node, NULL, RSVG_COMPUTED_RECONSTRUCT);
+
+    rsvg_state_frame_set_style((RsvgStateFrame*)current, style, ctx);
+    cairo_matrix_init_identity(&current->affine);
+    cairo_matrix_init_identity(&current->personal_affine);
+}
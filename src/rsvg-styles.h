@@ -52,7 +52,7 @@ typedef struct _RsvgVpathDash RsvgVpathDash;
 struct _RsvgVpathDash {
     RsvgLength offset;
     int n_dash;
-    double* dash;
+    const double* dash; /* shared between states, see rsvg_state_clone() */
 };
 
 typedef struct _StyleValueData {
@@ -65,117 +65,114 @@ StyleValueData* rsvg_style_value_data_new(const gchar* value, gboolean important
 G_GNUC_INTERNAL
 void rsvg_style_value_data_free(StyleValueData* value);
 
+/* The properties that were declared !important, as a sorted array of atoms
+ * shared between states; NULL if there are none.
+ */
+typedef struct _RsvgImportantProperties RsvgImportantProperties;
+
+/* The strings (urls, font family and language) are shared with every other
+ * state that holds the same value and the dash array with the state it was
+ * cloned from, so they are never modified in place.
+ */
 struct _RsvgState {
     RsvgState* parent;
     cairo_matrix_t affine;
     cairo_matrix_t personal_affine;
 
-    char* filter;
-    char* mask;
-    char* clip_path;
-    guint8 opacity; /* 0..255 */
-    double baseline_shift;
-    gboolean has_baseline_shift;
+    const char* filter;
+    const char* mask;
+    const char* clip_path;
+    const char* font_family;
+    const char* lang;
+    const char* startMarker;
+    const char* middleMarker;
+    const char* endMarker;
 
     RsvgPaintServer* fill;
-    gboolean has_fill_server;
-    guint8 fill_opacity; /* 0..255 */
-    gboolean has_fill_opacity;
-    gint fill_rule;
-    gboolean has_fill_rule;
-    gint clip_rule;
-    gboolean has_clip_rule;
-
-    gboolean overflow;
-    gboolean has_overflow;
-
     RsvgPaintServer* stroke;
-    gboolean has_stroke_server;
-    guint8 stroke_opacity; /* 0..255 */
-    gboolean has_stroke_opacity;
-    RsvgLength stroke_width;
-    gboolean has_stroke_width;
+
+    double baseline_shift;
     double miter_limit;
-    gboolean has_miter_limit;
+    RsvgLength stroke_width;
+    RsvgLength font_size;
+    RsvgLength letter_spacing;
+    RsvgVpathDash dash;
 
+    gint fill_rule;
+    gint clip_rule;
     cairo_line_cap_t cap;
-    gboolean has_cap;
     cairo_line_join_t join;
-    gboolean has_join;
-
-    RsvgLength font_size;
-    gboolean has_font_size;
-    char* font_family;
-    gboolean has_font_family;
-    char* lang;
-    gboolean has_lang;
     PangoStyle font_style;
-    gboolean has_font_style;
     PangoVariant font_variant;
-    gboolean has_font_variant;
     PangoWeight font_weight;
-    gboolean has_font_weight;
     PangoStretch font_stretch;
-    gboolean has_font_stretch;
     TextDecoration font_decor;
-    gboolean has_font_decor;
     PangoDirection text_dir;
-    gboolean has_text_dir;
     PangoGravity text_gravity;
-    gboolean has_text_gravity;
     UnicodeBidi unicode_bidi;
-    gboolean has_unicode_bidi;
     TextAnchor text_anchor;
-    gboolean has_text_anchor;
-    RsvgLength letter_spacing;
-    gboolean has_letter_spacing;
-
-    guint text_offset;
-
-    guint32 stop_color; /* rgb */
-    gboolean has_stop_color;
-    gint stop_opacity; /* 0..255 */
-    gboolean has_stop_opacity;
-
-    gboolean visible;
-    gboolean has_visible;
-
-    gboolean space_preserve;
-    gboolean has_space_preserve;
-
-    gboolean has_cond;
-    gboolean cond_true;
-
-    RsvgVpathDash dash;
-    gboolean has_dash;
-    gboolean has_dashoffset;
-
-    guint32 current_color;
-    gboolean has_current_color;
-
-    guint32 flood_color;
-    gboolean has_flood_color;
-
-    guchar flood_opacity;
-    gboolean has_flood_opacity;
-
-    char* startMarker;
-    char* middleMarker;
-    char* endMarker;
-    gboolean has_startMarker;
-    gboolean has_middleMarker;
-    gboolean has_endMarker;
-
     cairo_operator_t comp_op;
     RsvgEnableBackgroundType enable_background;
-
     cairo_antialias_t shape_rendering_type;
-    gboolean has_shape_rendering_type;
-
     cairo_antialias_t text_rendering_type;
-    gboolean has_text_rendering_type;
 
-    GHashTable* styles;
+    guint32 stop_color; /* rgb */
+    guint32 current_color;
+    guint32 flood_color;
+
+    guint8 opacity;        /* 0..255 */
+    guint8 fill_opacity;   /* 0..255 */
+    guint8 stroke_opacity; /* 0..255 */
+    guint8 stop_opacity;   /* 0..255 */
+    guint8 flood_opacity;  /* 0..255 */
+
+    guint overflow : 1;
+    guint visible : 1;
+    guint space_preserve : 1;
+    guint cond_true : 1;
+
+    guint has_baseline_shift : 1;
+    guint has_fill_server : 1;
+    guint has_fill_opacity : 1;
+    guint has_fill_rule : 1;
+    guint has_clip_rule : 1;
+    guint has_overflow : 1;
+    guint has_stroke_server : 1;
+    guint has_stroke_opacity : 1;
+    guint has_stroke_width : 1;
+    guint has_miter_limit : 1;
+    guint has_cap : 1;
+    guint has_join : 1;
+    guint has_font_size : 1;
+    guint has_font_family : 1;
+    guint has_lang : 1;
+    guint has_font_style : 1;
+    guint has_font_variant : 1;
+    guint has_font_weight : 1;
+    guint has_font_stretch : 1;
+    guint has_font_decor : 1;
+    guint has_text_dir : 1;
+    guint has_text_gravity : 1;
+    guint has_unicode_bidi : 1;
+    guint has_text_anchor : 1;
+    guint has_letter_spacing : 1;
+    guint has_stop_color : 1;
+    guint has_stop_opacity : 1;
+    guint has_visible : 1;
+    guint has_space_preserve : 1;
+    guint has_cond : 1;
+    guint has_dash : 1;
+    guint has_dashoffset : 1;
+    guint has_current_color : 1;
+    guint has_flood_color : 1;
+    guint has_flood_opacity : 1;
+    guint has_startMarker : 1;
+    guint has_middleMarker : 1;
+    guint has_endMarker : 1;
+    guint has_shape_rendering_type : 1;
+    guint has_text_rendering_type : 1;
+
+    const RsvgImportantProperties* important;
 };
 
 G_GNUC_INTERNAL
@@ -184,8 +181,6 @@ RsvgState* rsvg_state_new(void);
 G_GNUC_INTERNAL
 void rsvg_state_init(RsvgState* state);
 G_GNUC_INTERNAL
-void rsvg_state_reinit(RsvgState* state);
-G_GNUC_INTERNAL
 void rsvg_state_clone(RsvgState* dst, const RsvgState* src);
 G_GNUC_INTERNAL
 void rsvg_state_inherit(RsvgState* dst, const RsvgState* src);
@@ -197,11 +192,36 @@ G_GNUC_INTERNAL
 void rsvg_state_override(RsvgState* dst, const RsvgState* src);
 G_GNUC_INTERNAL
 void rsvg_state_finalize(RsvgState* state);
+
+/* Document caches store states flat, with their strings in the cache's
+ * string table: @write_string adds a string to it and returns its offset,
+ * and @read_string returns the string at an offset, or NULL for an offset
+ * that is out of range.
+ */
+typedef guint32 (*RsvgStateWriteString)(const char* str, gpointer user_data);
+typedef const char* (*RsvgStateReadString)(guint32 offset, gpointer user_data);
+
+/* Appends @state to @out, padded to 8 bytes */
 G_GNUC_INTERNAL
-void rsvg_state_free_all(RsvgState* state);
+void rsvg_state_write_flat(const RsvgState* state,
+                           GByteArray* out,
+                           RsvgStateWriteString write_string,
+                           gpointer user_data);
+/* Replaces @state, keeping its parent, with the flat state at the start of
+ * @data.  Returns the number of bytes it took up, or 0 if it is damaged, in
+ * which case @state is left alone.
+ */
+G_GNUC_INTERNAL
+gsize rsvg_state_read_flat(RsvgState* state,
+                           const guint8* data,
+                           gsize len,
+                           RsvgStateReadString read_string,
+                           gpointer user_data);
+G_GNUC_INTERNAL
+void rsvg_state_free_all(RsvgDrawingCtx* ctx);
 
 G_GNUC_INTERNAL
-void rsvg_parse_style_pairs(RsvgHandle* ctx, RsvgState* state, RsvgPropertyBag* atts);
+gboolean rsvg_parse_style_pairs(RsvgHandle* ctx, RsvgState* state, RsvgPropertyBag* atts);
 G_GNUC_INTERNAL
 void rsvg_parse_style(RsvgHandle* ctx, RsvgState* state, const char* str);
 G_GNUC_INTERNAL
@@ -218,6 +238,13 @@ void rsvg_parse_style_pair(RsvgHandle* ctx,
                            const gchar* name,
                            const gchar* value,
                            gboolean important);
+G_GNUC_INTERNAL
+void rsvg_parse_style_property(RsvgHandle* ctx,
+                               RsvgState* state,
+                               RsvgAttributeAtom atom,
+                               const gchar* name,
+                               const gchar* value,
+                               gboolean important);
 
 G_GNUC_INTERNAL
 void rsvg_parse_transform_attr(RsvgHandle* ctx, RsvgState* state, const char* str);
@@ -240,11 +267,27 @@ void rsvg_state_push(RsvgDrawingCtx* ctx);
 G_GNUC_INTERNAL
 RsvgState* rsvg_current_state(RsvgDrawingCtx* ctx);
 
+/* The absolute font size and accumulated baseline shift of @state, which
+ * must be on a drawing context's state stack
+ */
 G_GNUC_INTERNAL
-void rsvg_state_reinherit_top(RsvgDrawingCtx* ctx, RsvgState* state, int dominate);
+double rsvg_state_font_size(RsvgState* state);
+G_GNUC_INTERNAL
+double rsvg_state_baseline_shift(RsvgState* state);
+
+G_GNUC_INTERNAL
+void rsvg_state_reinherit_top(RsvgDrawingCtx* ctx, RsvgNode* node, int dominate);
 
 G_GNUC_INTERNAL
 void rsvg_state_reconstruct(RsvgState* state, RsvgNode* current);
+G_GNUC_INTERNAL
+void rsvg_state_reconstruct_top(RsvgDrawingCtx* ctx, RsvgNode* node);
+
+/* Forgets the styles computed for drawing @node, which must be done
+ * whenever its state changes
+ */
+G_GNUC_INTERNAL
+void rsvg_state_clear_computed(RsvgNode* node);
 
 G_END_DECLS
 
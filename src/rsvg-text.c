@@ -43,40 +43,27 @@ struct _RsvgNodeText {
     RsvgLength x, y, dx, dy;
 };
 
-char* rsvg_make_valid_utf8(const char* str, int len) {
-    GString* string;
-    const char *remainder, *invalid;
-    int remaining_bytes, valid_bytes;
-
-    string = NULL;
-    remainder = str;
-
-    if (len < 0)
-        remaining_bytes = strlen(str);
-    else
-        remaining_bytes = len;
-
-    while (remaining_bytes != 0) {
-        if (g_utf8_validate(remainder, remaining_bytes, &invalid))
-            break;
-        valid_bytes = invalid - remainder;
-
-        if (string == NULL)
-            string = g_string_sized_new(remaining_bytes);
+/* Appends @len bytes of @str to @string, replacing every byte that does not
+ * start a valid UTF-8 sequence with '?'.  Each valid run is validated once
+ * and copied straight into @string.
+ */
+void rsvg_string_append_valid_utf8(GString* string, const char* str, int len) {
+    const char* invalid;
+    int valid_bytes;
+
+    while (len > 0) {
+        if (g_utf8_validate(str, len, &invalid)) {
+            g_string_append_len(string, str, len);
+            return;
+        }
+        valid_bytes = invalid - str;
 
-        g_string_append_len(string, remainder, valid_bytes);
+        g_string_append_len(string, str, valid_bytes);
         g_string_append_c(string, '?');
 
-        remaining_bytes -= valid_bytes + 1;
-        remainder = invalid + 1;
+        len -= valid_bytes + 1;
+        str = invalid + 1;
     }
-
-    if (string == NULL)
-        return len < 0 ? g_strndup(str, len) : g_strdup(str);
-
-    g_string_append(string, remainder);
-
-    return g_string_free(string, FALSE);
 }
 
 static GString* _rsvg_text_chomp(RsvgState* state, GString* in, gboolean* lastwasspace) {
@@ -117,17 +104,17 @@ static void _rsvg_node_text_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgProper
     RsvgNodeText* text = (RsvgNodeText*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             text->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             text->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DX)))
             text->dx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dy")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DY)))
             text->dy = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -203,7 +190,7 @@ static int _rsvg_node_text_length_children(RsvgNode* self,
         RsvgNodeType type = RSVG_NODE_TYPE(node);
 
         rsvg_state_push(ctx);
-        rsvg_state_reinherit_top(ctx, node->state, 0);
+        rsvg_state_reinherit_top(ctx, node, 0);
         if (type == RSVG_NODE_TYPE_CHARS) {
             RsvgNodeChars* chars = (RsvgNodeChars*)node;
             GString* str = _rsvg_text_chomp(rsvg_current_state(ctx), chars->contents, lastwasspace);
@@ -232,7 +219,7 @@ static void _rsvg_node_text_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
     double x, y, dx, dy, length = 0;
     gboolean lastwasspace = TRUE;
     RsvgNodeText* text = (RsvgNodeText*)self;
-    rsvg_state_reinherit_top(ctx, self->state, dominate);
+    rsvg_state_reinherit_top(ctx, self, dominate);
 
     x = _rsvg_css_normalize_length(&text->x, ctx, 'h');
     y = _rsvg_css_normalize_length(&text->y, ctx, 'v');
@@ -265,9 +252,9 @@ static void _rsvg_node_text_draw(RsvgNode* self, RsvgDrawingCtx* ctx, int domina
     _rsvg_node_text_type_children(self, ctx, &x, &y, &lastwasspace, FALSE);
 }
 
-RsvgNode* rsvg_new_text(void) {
+RsvgNode* rsvg_new_text(RsvgArena* arena) {
     RsvgNodeText* text;
-    text = g_new(RsvgNodeText, 1);
+    text = RSVG_ARENA_NEW(arena, RsvgNodeText);
     _rsvg_node_init(&text->super, RSVG_NODE_TYPE_TEXT);
     text->super.draw = _rsvg_node_text_draw;
     text->super.set_atts = _rsvg_node_text_set_atts;
@@ -282,7 +269,7 @@ static void _rsvg_node_text_type_tspan(RsvgNodeText* self,
                                        gboolean* lastwasspace,
                                        gboolean usetextonly) {
     double dx, dy, length = 0;
-    rsvg_state_reinherit_top(ctx, self->super.state, 0);
+    rsvg_state_reinherit_top(ctx, &self->super, 0);
 
     dx = _rsvg_css_normalize_length(&self->dx, ctx, 'h');
     dy = _rsvg_css_normalize_length(&self->dy, ctx, 'v');
@@ -341,17 +328,17 @@ static void _rsvg_node_tspan_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPrope
     RsvgNodeText* text = (RsvgNodeText*)self;
 
     if (rsvg_property_bag_size(atts)) {
-        if ((value = rsvg_property_bag_lookup(atts, "x")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_X)))
             text->x = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "y")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_Y)))
             text->y = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dx")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DX)))
             text->dx = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "dy")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_DY)))
             text->dy = _rsvg_css_parse_length(value);
-        if ((value = rsvg_property_bag_lookup(atts, "class")))
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_CLASS)))
             klazz = value;
-        if ((value = rsvg_property_bag_lookup(atts, "id"))) {
+        if ((value = rsvg_property_bag_lookup_atom(atts, RSVG_ATTRIBUTE_ID))) {
             id = value;
             rsvg_defs_register_name(ctx->priv->defs, value, self);
         }
@@ -360,9 +347,9 @@ static void _rsvg_node_tspan_set_atts(RsvgNode* self, RsvgHandle* ctx, RsvgPrope
     }
 }
 
-RsvgNode* rsvg_new_tspan(void) {
+RsvgNode* rsvg_new_tspan(RsvgArena* arena) {
     RsvgNodeText* text;
-    text = g_new(RsvgNodeText, 1);
+    text = RSVG_ARENA_NEW(arena, RsvgNodeText);
     _rsvg_node_init(&text->super, RSVG_NODE_TYPE_TSPAN);
     text->super.set_atts = _rsvg_node_tspan_set_atts;
     text->x.factor = text->y.factor = 'n';
@@ -417,8 +404,7 @@ static PangoLayout* rsvg_text_create_layout(RsvgDrawingCtx* ctx,
         if (dpi_y <= 0.0)
             dpi_y = 72.0;
 
-        pango_font_description_set_size(font_desc,
-                                        _rsvg_css_normalize_font_size(state, ctx) * PANGO_SCALE / dpi_y * 72);
+        pango_font_description_set_size(font_desc, _rsvg_css_normalize_font_size(state) * PANGO_SCALE / dpi_y * 72);
     }
 
     layout = pango_layout_new(context);
@@ -495,7 +481,7 @@ void rsvg_text_render_text(RsvgDrawingCtx* ctx, const char* text, gdouble* x, gd
     pango_layout_get_size(layout, &w, &h);
     iter = pango_layout_get_iter(layout);
     offset = pango_layout_iter_get_baseline(iter) / (double)PANGO_SCALE;
-    offset += _rsvg_css_accumulate_baseline_shift(state, ctx);
+    offset += _rsvg_css_accumulate_baseline_shift(state);
     if (PANGO_GRAVITY_IS_VERTICAL(state->text_gravity)) {
         offset_x = -offset;
         offset_y = 0;
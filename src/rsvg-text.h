@@ -33,11 +33,11 @@
 G_BEGIN_DECLS
 
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_text(void);
+RsvgNode* rsvg_new_text(RsvgArena* arena);
 G_GNUC_INTERNAL
-RsvgNode* rsvg_new_tspan(void);
+RsvgNode* rsvg_new_tspan(RsvgArena* arena);
 G_GNUC_INTERNAL
-char* rsvg_make_valid_utf8(const char* str, int len);
+void rsvg_string_append_valid_utf8(GString* string, const char* str, int len);
 
 G_END_DECLS
 
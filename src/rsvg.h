@@ -182,6 +182,9 @@ void rsvg_cleanup(void);
 void rsvg_set_default_dpi(double dpi);
 void rsvg_set_default_dpi_x_y(double dpi_x, double dpi_y);
 
+void rsvg_set_extern_cache_size(guint max_documents);
+void rsvg_get_extern_cache_stats(guint64* hits, guint64* misses);
+
 void rsvg_handle_set_dpi(RsvgHandle* handle, double dpi);
 void rsvg_handle_set_dpi_x_y(RsvgHandle* handle, double dpi_x, double dpi_y);
 
@@ -195,6 +198,8 @@ const char* rsvg_handle_get_base_uri(RsvgHandle* handle);
 void rsvg_handle_set_base_uri(RsvgHandle* handle, const char* base_uri);
 
 gboolean rsvg_handle_set_stylesheet(RsvgHandle* handle, const guint8* css, gsize css_len, GError** error);
+void rsvg_handle_set_style_threads(RsvgHandle* handle, guint n_threads);
+void rsvg_handle_get_style_share_stats(RsvgHandle* handle, guint64* hits, guint64* misses);
 
 void rsvg_handle_get_dimensions(RsvgHandle* handle, RsvgDimensionData* dimension_data);
 
@@ -237,11 +242,23 @@ gboolean rsvg_handle_has_sub(RsvgHandle* handle, const char* id);
  *  for use by cairo when painting to e.g. a PDF surface. This will make the
  *  resulting PDF file smaller and faster.
  *  Since: 2.40.3
+ * @RSVG_HANDLE_FLAG_RENDER_ONLY: Only keeps what is needed for rendering.
+ *  The contents of title, desc and metadata elements, elements from other
+ *  XML vocabularies (like Inkscape's sodipodi:namedview or RDF) and
+ *  character data outside of text elements are skipped while parsing;
+ *  rsvg_handle_get_title(), rsvg_handle_get_desc() and
+ *  rsvg_handle_get_metadata() return %NULL.
+ *  Since: 2.52
+ * @RSVG_HANDLE_FLAG_CACHEABLE: Records what rsvg_handle_save_cache() needs
+ *  while loading, at the cost of keeping a copy of the parsed document until
+ *  the handle is freed.  Since: 2.52
  */
 typedef enum /*< flags, prefix=RSVG_HANDLE_FLAG >*/ {
     RSVG_HANDLE_FLAGS_NONE = 0, /*< skip >*/
     RSVG_HANDLE_FLAG_UNLIMITED = 1 << 0,
-    RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA = 1 << 1
+    RSVG_HANDLE_FLAG_KEEP_IMAGE_DATA = 1 << 1,
+    RSVG_HANDLE_FLAG_RENDER_ONLY = 1 << 2,
+    RSVG_HANDLE_FLAG_CACHEABLE = 1 << 3
 } RsvgHandleFlags;
 
 RsvgHandle* rsvg_handle_new_with_flags(RsvgHandleFlags flags);
@@ -264,9 +281,29 @@ RsvgHandle* rsvg_handle_new_from_stream_sync(GInputStream* input_stream,
                                              GCancellable* cancellable,
                                              GError** error);
 
+void rsvg_handle_read_stream_async(RsvgHandle* handle,
+                                   GInputStream* stream,
+                                   GCancellable* cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+gboolean rsvg_handle_read_stream_finish(RsvgHandle* handle, GAsyncResult* result, GError** error);
+
+void rsvg_handle_new_from_gfile_async(GFile* file,
+                                      RsvgHandleFlags flags,
+                                      GCancellable* cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data);
+RsvgHandle* rsvg_handle_new_from_gfile_finish(GAsyncResult* result, GError** error);
+
 RsvgHandle* rsvg_handle_new_from_data(const guint8* data, gsize data_len, GError** error);
 RsvgHandle* rsvg_handle_new_from_file(const gchar* file_name, GError** error);
 
+gboolean rsvg_handle_save_cache(RsvgHandle* handle, const char* filename, GError** error);
+RsvgHandle* rsvg_handle_new_from_cache(const char* cache_filename,
+                                       const guint8* data,
+                                       gsize data_len,
+                                       GError** error);
+
 void rsvg_handle_internal_set_testing(RsvgHandle* handle, gboolean testing);
 
 #include "rsvg-deprecated.h"
@@ -4,6 +4,9 @@
 #include "config.h"
 
 #include <glib.h>
+#include <cairo.h>
+#include <string.h>
+#define RSVG_DISABLE_DEPRECATION_WARNINGS
 #include "rsvg.h"
 #include "test-utils.h"
 
@@ -118,6 +121,239 @@ static void test_handle_has_sub_invalid(void) {
     g_object_unref(handle);
 }
 
+static const char render_only_document[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' xmlns:sodipodi='http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd'"
+    "     xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#' width='100' height='50'>"
+    "  <title>Title</title>"
+    "  <desc>Description</desc>"
+    "  <metadata><rdf:RDF><rdf:Description rdf:about=''/></rdf:RDF></metadata>"
+    "  <sodipodi:namedview id='namedview'><rect id='in-namedview'/></sodipodi:namedview>"
+    "  <unknown><rect id='in-unknown'/></unknown>"
+    "  <rect id='rect' width='10' height='10'/>"
+    "  <text id='text'>Hello</text>"
+    "</svg>";
+
+static RsvgHandle* load_with_flags(const char* data, RsvgHandleFlags flags) {
+    RsvgHandle* handle = rsvg_handle_new_with_flags(flags);
+    GError* error = NULL;
+
+    g_assert_true(rsvg_handle_write(handle, (const guchar*)data, strlen(data), &error));
+    g_assert_true(rsvg_handle_close(handle, &error));
+    g_assert_no_error(error);
+
+    return handle;
+}
+
+static void test_render_only(void) {
+    RsvgHandle* handle;
+    RsvgDimensionData dim;
+
+    handle = load_with_flags(render_only_document, RSVG_HANDLE_FLAGS_NONE);
+    g_assert_cmpstr(rsvg_handle_get_title(handle), ==, "Title");
+    g_assert_cmpstr(rsvg_handle_get_desc(handle), ==, "Description");
+    g_assert_nonnull(rsvg_handle_get_metadata(handle));
+    g_assert_true(rsvg_handle_has_sub(handle, "#in-namedview"));
+    g_object_unref(handle);
+
+    handle = load_with_flags(render_only_document, RSVG_HANDLE_FLAG_RENDER_ONLY);
+    g_assert_null(rsvg_handle_get_title(handle));
+    g_assert_null(rsvg_handle_get_desc(handle));
+    g_assert_null(rsvg_handle_get_metadata(handle));
+    g_assert_false(rsvg_handle_has_sub(handle, "#namedview"));
+    g_assert_false(rsvg_handle_has_sub(handle, "#in-namedview"));
+    /* unprefixed unknown elements are kept */
+    g_assert_true(rsvg_handle_has_sub(handle, "#in-unknown"));
+    g_assert_true(rsvg_handle_has_sub(handle, "#rect"));
+    g_assert_true(rsvg_handle_has_sub(handle, "#text"));
+
+    rsvg_handle_get_dimensions(handle, &dim);
+    g_assert_cmpint(dim.width, ==, 100);
+    g_assert_cmpint(dim.height, ==, 50);
+    g_object_unref(handle);
+}
+
+/* clip paths and masks in objectBoundingBox units, which used to adjust
+ * their own nodes while being drawn
+ */
+static const char concurrent_document[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' width='64' height='64'>"
+    "<clipPath id='clip' clipPathUnits='objectBoundingBox'><circle cx='0.5' cy='0.5' r='0.5'/></clipPath>"
+    "<mask id='mask' maskContentUnits='objectBoundingBox'>"
+    "<rect width='0.5' height='1' fill='white'/></mask>"
+    "<rect x='0' y='0' width='32' height='32' fill='red' clip-path='url(#clip)'/>"
+    "<rect x='32' y='0' width='32' height='32' fill='lime' mask='url(#mask)'/>"
+    "<g clip-path='url(#clip)' mask='url(#mask)'><rect x='0' y='32' width='64' height='32' fill='blue'/></g>"
+    "</svg>";
+
+#define CONCURRENT_THREADS 8
+#define CONCURRENT_RENDERS 25
+
+typedef struct {
+    RsvgHandle* handle;
+    cairo_surface_t* reference;
+} ConcurrentRender;
+
+static cairo_surface_t* render_to_surface(RsvgHandle* handle) {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 64, 64);
+    cairo_t* cr = cairo_create(surface);
+
+    g_assert_true(rsvg_handle_render_cairo(handle, cr));
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    return surface;
+}
+
+static gboolean surfaces_equal(cairo_surface_t* a, cairo_surface_t* b) {
+    int stride = cairo_image_surface_get_stride(a);
+
+    return memcmp(cairo_image_surface_get_data(a), cairo_image_surface_get_data(b), (gsize)stride * 64) == 0;
+}
+
+static gpointer render_concurrently_thread(gpointer data) {
+    ConcurrentRender* job = data;
+    guint n_mismatches = 0;
+    guint i;
+
+    for (i = 0; i < CONCURRENT_RENDERS; i++) {
+        cairo_surface_t* surface = render_to_surface(job->handle);
+        RsvgDimensionData dim;
+
+        if (!surfaces_equal(surface, job->reference))
+            n_mismatches++;
+        cairo_surface_destroy(surface);
+
+        rsvg_handle_get_dimensions(job->handle, &dim);
+        if (dim.width != 64 || dim.height != 64)
+            n_mismatches++;
+    }
+
+    return GUINT_TO_POINTER(n_mismatches);
+}
+
+static guint32 get_pixel(cairo_surface_t* surface, int x, int y) {
+    guint8* data = cairo_image_surface_get_data(surface);
+
+    return ((guint32*)(data + y * cairo_image_surface_get_stride(surface)))[x];
+}
+
+static void test_render_concurrently(void) {
+    ConcurrentRender job;
+    GThread* threads[CONCURRENT_THREADS];
+    cairo_surface_t* surface;
+    GError* error = NULL;
+    guint i;
+
+    job.handle = rsvg_handle_new_from_data((const guint8*)concurrent_document, strlen(concurrent_document), &error);
+    g_assert_no_error(error);
+    job.reference = render_to_surface(job.handle);
+
+    /* clipped to the circle, and masked to the left half of the box */
+    g_assert_cmphex(get_pixel(job.reference, 16, 16), ==, 0xffff0000);
+    g_assert_cmphex(get_pixel(job.reference, 1, 1), ==, 0);
+    g_assert_cmphex(get_pixel(job.reference, 40, 16), ==, 0xff00ff00);
+    g_assert_cmphex(get_pixel(job.reference, 56, 16), ==, 0);
+
+    for (i = 0; i < CONCURRENT_THREADS; i++)
+        threads[i] = g_thread_new("render", render_concurrently_thread, &job);
+    for (i = 0; i < CONCURRENT_THREADS; i++)
+        g_assert_cmpuint(GPOINTER_TO_UINT(g_thread_join(threads[i])), ==, 0);
+
+    /* and the document itself is no different afterwards */
+    surface = render_to_surface(job.handle);
+    g_assert_true(surfaces_equal(surface, job.reference));
+    cairo_surface_destroy(surface);
+
+    cairo_surface_destroy(job.reference);
+    g_object_unref(job.handle);
+}
+
+/* styles reached through a group, a <use>, a pattern and a marker */
+static const char sizes_document[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='64' height='64'>"
+    "<defs><rect id='tile' width='16' height='16'/>"
+    "<pattern id='pat' width='8' height='8' patternUnits='userSpaceOnUse'>"
+    "<rect width='8' height='8' fill='blue'/></pattern>"
+    "<marker id='dot' markerWidth='8' markerHeight='8' refX='4' refY='4' markerUnits='userSpaceOnUse'>"
+    "<rect width='8' height='8' fill='lime'/></marker></defs>"
+    "<g fill='red'><rect width='16' height='16'/></g>"
+    "<use xlink:href='#tile' x='32' fill='lime'/>"
+    "<rect y='32' width='16' height='16' fill='url(#pat)'/>"
+    "<path d='M44 44 L60 44' marker-start='url(#dot)'/>"
+    "</svg>";
+
+static cairo_surface_t* render_scaled(RsvgHandle* handle, int scale) {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 64 * scale, 64 * scale);
+    cairo_t* cr = cairo_create(surface);
+
+    cairo_scale(cr, scale, scale);
+    g_assert_true(rsvg_handle_render_cairo(handle, cr));
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    g_assert_cmphex(get_pixel(surface, 8 * scale, 8 * scale), ==, 0xffff0000);
+    g_assert_cmphex(get_pixel(surface, 40 * scale, 8 * scale), ==, 0xff00ff00);
+    g_assert_cmphex(get_pixel(surface, 8 * scale, 40 * scale), ==, 0xff0000ff);
+    g_assert_cmphex(get_pixel(surface, 44 * scale, 44 * scale), ==, 0xff00ff00);
+
+    return surface;
+}
+
+/* later renders reuse the styles computed by the first one */
+static void test_render_sizes(void) {
+    RsvgHandle* handle;
+    cairo_surface_t* first;
+    cairo_surface_t* again;
+    GError* error = NULL;
+    int scale;
+
+    handle = rsvg_handle_new_from_data((const guint8*)sizes_document, strlen(sizes_document), &error);
+    g_assert_no_error(error);
+
+    first = render_scaled(handle, 1);
+    for (scale = 2; scale <= 4; scale++)
+        cairo_surface_destroy(render_scaled(handle, scale));
+
+    again = render_scaled(handle, 1);
+    g_assert_true(surfaces_equal(first, again));
+
+    cairo_surface_destroy(again);
+    cairo_surface_destroy(first);
+    g_object_unref(handle);
+}
+
+/* em lengths against font sizes set in ems and percentages further up */
+static const char em_document[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' width='64' height='64' font-size='4px'>"
+    "<g font-size='200%'><g font-size='2em'>"
+    "<rect font-size='1em' width='2em' height='1em' fill='lime'/>"
+    "<g font-size='50%'><rect font-size='100%' y='32' width='1em' height='1ex' fill='blue'/></g>"
+    "</g></g>"
+    "</svg>";
+
+static void test_em_lengths(void) {
+    RsvgHandle* handle;
+    cairo_surface_t* surface;
+    GError* error = NULL;
+
+    handle = rsvg_handle_new_from_data((const guint8*)em_document, strlen(em_document), &error);
+    g_assert_no_error(error);
+
+    /* 16px, so 32x16 */
+    surface = render_to_surface(handle);
+    g_assert_cmphex(get_pixel(surface, 31, 15), ==, 0xff00ff00);
+    g_assert_cmphex(get_pixel(surface, 33, 8), ==, 0);
+    g_assert_cmphex(get_pixel(surface, 8, 17), ==, 0);
+
+    /* 8px, so 8x4 */
+    g_assert_cmphex(get_pixel(surface, 7, 35), ==, 0xff0000ff);
+    g_assert_cmphex(get_pixel(surface, 9, 33), ==, 0);
+    g_assert_cmphex(get_pixel(surface, 4, 37), ==, 0);
+
+    cairo_surface_destroy(surface);
+    g_object_unref(handle);
+}
+
 int main(int argc, char** argv) {
     g_test_init(&argc, &argv, NULL);
 
@@ -128,6 +364,10 @@ int main(int argc, char** argv) {
     g_test_add_func("/api/double_close", test_double_close);
     g_test_add_func("/api/handle_get_dimensions_no_base_uri", test_handle_get_dimensions_no_base_uri);
     g_test_add_func("/api/handle_has_sub_invalid", test_handle_has_sub_invalid);
+    g_test_add_func("/api/render_only", test_render_only);
+    g_test_add_func("/api/render_concurrently", test_render_concurrently);
+    g_test_add_func("/api/render_sizes", test_render_sizes);
+    g_test_add_func("/api/em_lengths", test_em_lengths);
 
     return g_test_run();
 }
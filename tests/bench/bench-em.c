@@ -0,0 +1,93 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Relative length benchmark.
+ *
+ * Renders a drawing whose elements sit 50 groups deep, every group with a
+ * font size relative to its parent's, and whose shapes and text are all
+ * measured in em and ex, so that each length depends on the font size of
+ * every level above it.
+ *
+ * Usage: bench-em [depth] [elements] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+
+static char* make_document(guint depth, guint n_elements) {
+    GString* str = g_string_new("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\" "
+                                "font-size=\"10px\">\n");
+    guint i;
+
+    for (i = 0; i < depth; i++)
+        g_string_append_printf(str, "<g font-size=\"%s\">\n", i % 2 ? "101%" : "0.99em");
+
+    for (i = 0; i < n_elements; i++) {
+        if (i % 10 == 9)
+            g_string_append_printf(str,
+                                   "<text font-size=\"1em\" x=\"%uem\" y=\"%uem\">a"
+                                   "<tspan baseline-shift=\"0.5\" font-size=\"0.8em\">b</tspan></text>\n",
+                                   i % 100, i / 100 % 100);
+        else
+            g_string_append_printf(str,
+                                   "<rect font-size=\"1em\" x=\"%uem\" y=\"%uex\" width=\"0.5em\" height=\"1ex\" "
+                                   "stroke=\"black\" stroke-width=\"0.1em\"/>\n",
+                                   i % 100, i / 100 % 200);
+    }
+
+    for (i = 0; i < depth; i++)
+        g_string_append(str, "</g>\n");
+    g_string_append(str, "</svg>\n");
+
+    return g_string_free(str, FALSE);
+}
+
+int main(int argc, char** argv) {
+    guint depth = 50;
+    guint n_elements = 10000;
+    guint iterations = 5;
+    guint i;
+    char* document;
+    RsvgHandle* handle;
+    GError* error = NULL;
+    gint64 start, render_us = 0;
+
+    if (argc > 1)
+        depth = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        n_elements = MAX(1, atoi(argv[2]));
+    if (argc > 3)
+        iterations = MAX(1, atoi(argv[3]));
+
+    document = make_document(depth, n_elements);
+    handle = rsvg_handle_new_from_data((const guint8*)document, strlen(document), &error);
+    if (!handle) {
+        g_printerr("%s\n", error->message);
+        return 1;
+    }
+
+    for (i = 0; i < iterations; i++) {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1000, 1000);
+        cairo_t* cr = cairo_create(surface);
+
+        start = g_get_monotonic_time();
+        rsvg_handle_render_cairo(handle, cr);
+        render_us += g_get_monotonic_time() - start;
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+
+    g_print("%u levels, %u elements, %u iterations\n", depth, n_elements, iterations);
+    g_print("render: %8.2f ms/iteration\n", render_us / 1000.0 / iterations);
+
+    g_object_unref(handle);
+    g_free(document);
+
+    return 0;
+}
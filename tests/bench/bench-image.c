@@ -0,0 +1,116 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Embedded image benchmark.
+ *
+ * Loads a document with one <image> whose PNG, of about 20 MB, is embedded
+ * as a base64 data: URI, and compares it with what loading used to cost:
+ * decoding the whole payload into a buffer with g_base64_decode() and only
+ * then handing it to a GdkPixbufLoader.
+ *
+ * Usage: bench-image [megabytes] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+
+static char* make_png_base64(gsize target_len) {
+    GdkPixbuf* pixbuf;
+    guint8* pixels;
+    GRand* rand = g_rand_new_with_seed(42);
+    int side = 1;
+    gsize n;
+    gchar* png;
+    gsize png_len;
+    char* base64;
+    gsize i;
+
+    /* random pixels, so that the PNG is about as big as the pixel data */
+    while ((gsize)(side + 1) * (side + 1) * 3 <= target_len)
+        side++;
+
+    pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, side, side);
+    pixels = gdk_pixbuf_get_pixels(pixbuf);
+    n = (gsize)gdk_pixbuf_get_rowstride(pixbuf) * side;
+
+    for (i = 0; i < n; i++)
+        pixels[i] = g_rand_int(rand);
+
+    if (!gdk_pixbuf_save_to_buffer(pixbuf, &png, &png_len, "png", NULL, "compression", "1", NULL))
+        g_error("could not encode the image");
+
+    base64 = g_base64_encode((const guchar*)png, png_len);
+
+    g_free(png);
+    g_rand_free(rand);
+    g_object_unref(pixbuf);
+
+    return base64;
+}
+
+static void load_the_old_way(const char* base64) {
+    GdkPixbufLoader* loader = gdk_pixbuf_loader_new_with_mime_type("image/png", NULL);
+    guchar* data;
+    gsize len;
+
+    data = g_base64_decode(base64, &len);
+    if (!gdk_pixbuf_loader_write(loader, data, len, NULL) || !gdk_pixbuf_loader_close(loader, NULL))
+        g_error("could not decode the image");
+
+    g_free(data);
+    g_object_unref(loader);
+}
+
+int main(int argc, char** argv) {
+    gsize megabytes = 20;
+    guint iterations = 5;
+    guint i;
+    char* base64;
+    char* document;
+    gsize len;
+    gint64 start, load_us = 0, old_us = 0;
+
+    if (argc > 1)
+        megabytes = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    base64 = make_png_base64(megabytes * 1024 * 1024);
+    document = g_strdup_printf("<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                               "xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"100\" height=\"100\">"
+                               "<image width=\"100\" height=\"100\" xlink:href=\"data:image/png;base64,%s\"/></svg>",
+                               base64);
+    len = strlen(document);
+
+    for (i = 0; i < iterations; i++) {
+        RsvgHandle* handle;
+        GError* error = NULL;
+
+        start = g_get_monotonic_time();
+        handle = rsvg_handle_new_with_flags(RSVG_HANDLE_FLAG_UNLIMITED);
+        if (!rsvg_handle_write(handle, (const guchar*)document, len, &error) || !rsvg_handle_close(handle, &error)) {
+            g_printerr("%s\n", error->message);
+            return 1;
+        }
+        load_us += g_get_monotonic_time() - start;
+        g_object_unref(handle);
+
+        start = g_get_monotonic_time();
+        load_the_old_way(base64);
+        old_us += g_get_monotonic_time() - start;
+    }
+
+    g_print("%" G_GSIZE_FORMAT " bytes of base64, %u iterations\n", strlen(base64), iterations);
+    g_print("document load:            %8.2f ms/iteration\n", load_us / 1000.0 / iterations);
+    g_print("decode, then pixbuf load: %8.2f ms/iteration\n", old_us / 1000.0 / iterations);
+
+    g_free(document);
+    g_free(base64);
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* File loading benchmark.
+ *
+ * Writes a large document of long paths to a temporary file and loads it
+ * in a fresh process, once by reading the whole file into memory and
+ * handing it to rsvg_handle_new_from_data(), the way
+ * rsvg_handle_new_from_file() used to, and once through
+ * rsvg_handle_new_from_file(), which maps the file.  Each run reports the
+ * load time and the peak resident set size of its process.
+ *
+ * Usage: bench-load [megabytes]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "rsvg.h"
+
+static glong get_peak_rss_kb(void) {
+#ifdef G_OS_UNIX
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+static gboolean write_document(const char* path, gsize target_len) {
+    GString* chunk = g_string_new(NULL);
+    gsize written = 0;
+    guint i = 0;
+    FILE* file;
+
+    file = g_fopen(path, "wb");
+    if (file == NULL)
+        return FALSE;
+
+    fputs("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10000\" height=\"10000\">\n", file);
+    while (written < target_len) {
+        guint j;
+
+        g_string_printf(chunk, "<path id=\"p%u\" fill=\"none\" stroke=\"black\" d=\"M%u %u", i, i % 10000, i / 100);
+        for (j = 0; j < 500; j++)
+            g_string_append_printf(chunk, " L%u.%u %u.%u", (i + j) % 10000, j % 10, (i * 7 + j) % 10000, i % 10);
+        g_string_append(chunk, "\"/>\n");
+
+        fwrite(chunk->str, 1, chunk->len, file);
+        written += chunk->len;
+        i++;
+    }
+    fputs("</svg>\n", file);
+
+    g_string_free(chunk, TRUE);
+    return fclose(file) == 0;
+}
+
+static int run_child(const char* mode, const char* path) {
+    RsvgHandle* handle;
+    GError* error = NULL;
+    gint64 start;
+    double ms;
+
+    start = g_get_monotonic_time();
+    if (strcmp(mode, "read") == 0) {
+        char* data;
+        gsize len;
+
+        if (!g_file_get_contents(path, &data, &len, &error)) {
+            g_printerr("%s\n", error->message);
+            return 1;
+        }
+        handle = rsvg_handle_new_from_data((const guint8*)data, len, &error);
+        g_free(data);
+    }
+    else {
+        handle = rsvg_handle_new_from_file(path, &error);
+    }
+    ms = (g_get_monotonic_time() - start) / 1000.0;
+
+    if (handle == NULL) {
+        g_printerr("%s\n", error->message);
+        return 1;
+    }
+
+    g_print("%-5s %10.2f ms  peak RSS %8.2f MB\n", mode, ms, get_peak_rss_kb() / 1024.0);
+    g_object_unref(handle);
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    static const char* const modes[] = {"read", "map"};
+    gsize megabytes = 100;
+    char* path;
+    GStatBuf st;
+    guint i;
+    int fd;
+
+    if (argc > 3 && strcmp(argv[1], "--child") == 0)
+        return run_child(argv[2], argv[3]);
+
+    if (argc > 1)
+        megabytes = MAX(1, atoi(argv[1]));
+
+    fd = g_file_open_tmp("bench-load-XXXXXX.svg", &path, NULL);
+    if (fd < 0) {
+        g_printerr("could not create a temporary file\n");
+        return 1;
+    }
+    g_close(fd, NULL);
+
+    if (!write_document(path, megabytes * 1024 * 1024) || g_stat(path, &st) != 0) {
+        g_printerr("could not write %s\n", path);
+        g_unlink(path);
+        return 1;
+    }
+    g_print("%" G_GINT64_FORMAT " bytes\n", (gint64)st.st_size);
+
+    /* a process per run, since the peak RSS only ever goes up */
+    for (i = 0; i < G_N_ELEMENTS(modes); i++) {
+        char* child_argv[] = {argv[0], "--child", (char*)modes[i], path, NULL};
+        GError* error = NULL;
+
+        if (!g_spawn_sync(NULL, child_argv, NULL, G_SPAWN_DEFAULT, NULL, NULL, NULL, NULL, NULL, &error)) {
+            g_printerr("%s\n", error->message);
+            g_error_free(error);
+        }
+    }
+
+    g_unlink(path);
+    g_free(path);
+
+    return 0;
+}
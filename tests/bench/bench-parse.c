@@ -0,0 +1,179 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Parse benchmark over tests/samples.
+ *
+ * Reports the cost of mapping element names to node constructors with the
+ * strcmp() chain the loader used to have and with the perfect-hash atom
+ * table, followed by the time spent loading every sample through the public
+ * API.
+ *
+ * Usage: bench-parse [samples-dir] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <string.h>
+#include <stdlib.h>
+#include <libxml/parser.h>
+
+#include "rsvg.h"
+#include "rsvg-atoms.h"
+
+/* In the order rsvg_standard_element_start() used to test them */
+static const char* const legacy_element_names[] = {
+    "g", "a", "switch", "defs", "use", "path", "line", "rect", "ellipse", "circle", "polygon", "polyline",
+    "symbol", "svg", "mask", "clipPath", "image", "marker", "stop", "pattern", "linearGradient",
+    "radialGradient", "conicalGradient", "filter", "feBlend", "feColorMatrix", "feComponentTransfer",
+    "feComposite", "feConvolveMatrix", "feDiffuseLighting", "feDisplacementMap", "feFlood", "feGaussianBlur",
+    "feImage", "feMerge", "feMorphology", "feOffset", "feSpecularLighting", "feTile", "feTurbulence",
+    "feMergeNode", "feFuncR", "feFuncG", "feFuncB", "feFuncA", "feDistantLight", "feSpotLight",
+    "fePointLight", "multiImage", "subImageRef", "subImage", "text", "tspan",
+};
+
+static guint legacy_dispatch(const char* name) {
+    guint i;
+
+    /* rsvg_start_element() checked these before falling through to the chain */
+    if (!strcmp(name, "style"))
+        return 1;
+    else if (!strcmp(name, "title"))
+        return 2;
+    else if (!strcmp(name, "desc"))
+        return 3;
+    else if (!strcmp(name, "metadata"))
+        return 4;
+
+    for (i = 0; i < G_N_ELEMENTS(legacy_element_names); i++)
+        if (!strcmp(name, legacy_element_names[i]))
+            return i + 5;
+
+    return 0;
+}
+
+static void collect_start_element(void* data, const xmlChar* name, const xmlChar** atts) {
+    GPtrArray* names = data;
+    const char* local = strrchr((const char*)name, ':');
+
+    (void)atts;
+
+    g_ptr_array_add(names, g_strdup(local ? local + 1 : (const char*)name));
+}
+
+static void collect_element_names(const char* contents, gsize length, GPtrArray* names) {
+    xmlSAXHandler sax;
+
+    memset(&sax, 0, sizeof(sax));
+    sax.startElement = collect_start_element;
+
+    xmlSAXUserParseMemory(&sax, names, contents, (int)length);
+}
+
+typedef struct {
+    char* contents;
+    gsize length;
+} Sample;
+
+static GArray* load_samples(const char* dir_path) {
+    GArray* samples = g_array_new(FALSE, FALSE, sizeof(Sample));
+    GDir* dir;
+    const char* entry;
+    GError* error = NULL;
+
+    dir = g_dir_open(dir_path, 0, &error);
+    if (!dir) {
+        g_printerr("%s\n", error->message);
+        exit(1);
+    }
+
+    while ((entry = g_dir_read_name(dir)) != NULL) {
+        Sample sample;
+        char* path;
+
+        if (!g_str_has_suffix(entry, ".svg"))
+            continue;
+
+        path = g_build_filename(dir_path, entry, NULL);
+        if (g_file_get_contents(path, &sample.contents, &sample.length, NULL))
+            g_array_append_val(samples, sample);
+        g_free(path);
+    }
+
+    g_dir_close(dir);
+    return samples;
+}
+
+int main(int argc, char** argv) {
+    const char* srcdir = g_getenv("G_TEST_SRCDIR");
+    char* samples_dir;
+    GArray* samples;
+    GPtrArray* names;
+    guint iterations = 20;
+    guint i, j, n, loaded;
+    guint64 checksum;
+    gint64 start, legacy_us, atom_us, load_us;
+
+    if (argc > 1)
+        samples_dir = g_strdup(argv[1]);
+    else
+        samples_dir = g_build_filename(srcdir ? srcdir : ".", "samples", NULL);
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    samples = load_samples(samples_dir);
+    names = g_ptr_array_new_with_free_func(g_free);
+    for (i = 0; i < samples->len; i++) {
+        Sample* sample = &g_array_index(samples, Sample, i);
+        collect_element_names(sample->contents, sample->length, names);
+    }
+
+    g_print("%u samples, %u elements, %u iterations\n", samples->len, names->len, iterations);
+
+    /* Repeat the name stream enough times that the timings are measurable */
+    n = iterations * 50;
+
+    checksum = 0;
+    start = g_get_monotonic_time();
+    for (j = 0; j < n; j++)
+        for (i = 0; i < names->len; i++)
+            checksum += legacy_dispatch(g_ptr_array_index(names, i));
+    legacy_us = g_get_monotonic_time() - start;
+    g_print("dispatch, strcmp chain:   %8.2f ns/element (checksum %" G_GUINT64_FORMAT ")\n",
+            legacy_us * 1000.0 / ((double)n * MAX(names->len, 1)), checksum);
+
+    checksum = 0;
+    start = g_get_monotonic_time();
+    for (j = 0; j < n; j++)
+        for (i = 0; i < names->len; i++)
+            checksum += rsvg_element_atom_lookup(g_ptr_array_index(names, i));
+    atom_us = g_get_monotonic_time() - start;
+    g_print("dispatch, atom table:     %8.2f ns/element (checksum %" G_GUINT64_FORMAT ")\n",
+            atom_us * 1000.0 / ((double)n * MAX(names->len, 1)), checksum);
+
+    loaded = 0;
+    start = g_get_monotonic_time();
+    for (j = 0; j < iterations; j++) {
+        for (i = 0; i < samples->len; i++) {
+            Sample* sample = &g_array_index(samples, Sample, i);
+            RsvgHandle* handle;
+
+            handle = rsvg_handle_new_from_data((const guint8*)sample->contents, sample->length, NULL);
+            if (handle) {
+                loaded++;
+                g_object_unref(handle);
+            }
+        }
+    }
+    load_us = g_get_monotonic_time() - start;
+    g_print("load, all samples:        %8.2f ms/iteration (%u handles)\n", load_us / 1000.0 / iterations,
+            loaded);
+
+    for (i = 0; i < samples->len; i++)
+        g_free(g_array_index(samples, Sample, i).contents);
+    g_array_free(samples, TRUE);
+    g_ptr_array_free(names, TRUE);
+    g_free(samples_dir);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Path data benchmark.
+ *
+ * Builds a long "d" attribute in the style of cartographic exports (an
+ * absolute move-to followed by relative curve-tos and line-tos with three
+ * decimals) and reports how fast rsvg_parse_path() gets through it.
+ *
+ * Usage: bench-path [megabytes] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg-path.h"
+
+static char* make_path_data(gsize target_len) {
+    GString* str = g_string_sized_new(target_len + 64);
+    GRand* rand = g_rand_new_with_seed(42);
+
+    g_string_append(str, "M 1024.5,768.25");
+    while (str->len < target_len) {
+        if (g_rand_int_range(rand, 0, 4) == 0) {
+            g_string_append_printf(str, " l%.3f,%.3f", g_rand_double_range(rand, -50, 50),
+                                   g_rand_double_range(rand, -50, 50));
+        }
+        else {
+            g_string_append_printf(str, " c%.3f,%.3f %.3f,%.3f %.3f,%.3f", g_rand_double_range(rand, -50, 50),
+                                   g_rand_double_range(rand, -50, 50), g_rand_double_range(rand, -50, 50),
+                                   g_rand_double_range(rand, -50, 50), g_rand_double_range(rand, -50, 50),
+                                   g_rand_double_range(rand, -50, 50));
+        }
+        if (g_rand_int_range(rand, 0, 200) == 0)
+            g_string_append(str, " z m3.5e1,-1.25E+1");
+    }
+
+    g_rand_free(rand);
+    return g_string_free(str, FALSE);
+}
+
+int main(int argc, char** argv) {
+    gsize megabytes = 8;
+    guint iterations = 10;
+    guint i;
+    char* data;
+    gsize len;
+    int num_data = 0;
+    gint64 start, elapsed_us;
+
+    if (argc > 1)
+        megabytes = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    data = make_path_data(megabytes * 1024 * 1024);
+    len = strlen(data);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < iterations; i++) {
+        cairo_path_t* path = rsvg_parse_path(data);
+
+        num_data = path->num_data;
+        rsvg_cairo_path_destroy(path);
+    }
+    elapsed_us = g_get_monotonic_time() - start;
+
+    g_print("%" G_GSIZE_FORMAT " bytes, %d path elements, %u iterations\n", len, num_data, iterations);
+    g_print("parse:  %8.2f ms/iteration, %8.2f MB/s, %6.2f ns/element\n", elapsed_us / 1000.0 / iterations,
+            (double)len * iterations / elapsed_us, elapsed_us * 1000.0 / ((double)iterations * MAX(num_data, 1)));
+
+    g_free(data);
+
+    return 0;
+}
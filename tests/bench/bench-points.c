@@ -0,0 +1,87 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Number list benchmark.
+ *
+ * Builds a polyline "points" attribute with many coordinate pairs and
+ * reports how fast rsvg_css_parse_number_list() gets through it, followed
+ * by the time to load a document holding that polyline through the public
+ * API.
+ *
+ * Usage: bench-points [points] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+#include "rsvg-css.h"
+
+static char* make_points(guint n_points) {
+    GString* str = g_string_sized_new(n_points * 20);
+    GRand* rand = g_rand_new_with_seed(42);
+    guint i;
+
+    for (i = 0; i < n_points; i++) {
+        /* Mix the separators that show up in the wild */
+        g_string_append_printf(str, i % 3 == 0 ? "%.3f,%.3f\n" : "%.3f, %.3f ", g_rand_double_range(rand, 0, 2000),
+                               g_rand_double_range(rand, 0, 2000));
+    }
+
+    g_rand_free(rand);
+    return g_string_free(str, FALSE);
+}
+
+int main(int argc, char** argv) {
+    guint n_points = 50000;
+    guint iterations = 20;
+    guint i, list_len = 0, loaded = 0;
+    char* points;
+    char* document;
+    gsize len;
+    gint64 start, elapsed_us;
+
+    if (argc > 1)
+        n_points = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    points = make_points(n_points);
+    len = strlen(points);
+    document = g_strdup_printf("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"2000\" height=\"2000\">"
+                               "<polyline points=\"%s\"/></svg>",
+                               points);
+
+    g_print("%u points, %" G_GSIZE_FORMAT " bytes, %u iterations\n", n_points, len, iterations);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < iterations; i++) {
+        double* list = rsvg_css_parse_number_list(points, &list_len);
+
+        g_free(list);
+    }
+    elapsed_us = g_get_monotonic_time() - start;
+    g_print("number list:  %8.2f ms/iteration, %8.2f MB/s (%u numbers)\n", elapsed_us / 1000.0 / iterations,
+            (double)len * iterations / MAX(elapsed_us, 1), list_len);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < iterations; i++) {
+        RsvgHandle* handle;
+
+        handle = rsvg_handle_new_from_data((const guint8*)document, strlen(document), NULL);
+        if (handle) {
+            loaded++;
+            g_object_unref(handle);
+        }
+    }
+    elapsed_us = g_get_monotonic_time() - start;
+    g_print("load:         %8.2f ms/iteration (%u handles)\n", elapsed_us / 1000.0 / iterations, loaded);
+
+    g_free(document);
+    g_free(points);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Repeated rendering benchmark.
+ *
+ * Loads a drawing of nested, styled groups and renders it at ten different
+ * sizes, the way a thumbnailer or an icon theme would.  It reports how long
+ * the first render took, the average of the others, which find each
+ * element's computed style already cached, and a last render at the first
+ * size, for a comparison that does not depend on the number of pixels.
+ *
+ * Usage: bench-render [elements] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+
+#define N_SIZES 10
+
+static char* make_document(guint n_elements) {
+    GString* str = g_string_new("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    guint i;
+
+    for (i = 0; i < n_elements; i++) {
+        if (i % 10 == 0) {
+            if (i > 0)
+                g_string_append(str, "</g></g>\n");
+            g_string_append_printf(str,
+                                   "<g style=\"fill:#%06x;stroke:black;stroke-width:%u;opacity:0.9\">"
+                                   "<g font-size=\"%upx\" stroke-dasharray=\"2 1\" transform=\"translate(%u %u)\">\n",
+                                   (i * 2654435761u) & 0xffffff, 1 + i % 3, 8 + i % 5, i % 100 * 10, i / 1000);
+        }
+        g_string_append_printf(str, "<rect x=\"%u\" y=\"%u\" width=\"8\" height=\"8\" stroke-opacity=\"0.5\"/>\n",
+                               i % 10 * 10, i / 100 % 10 * 10);
+    }
+    if (n_elements > 0)
+        g_string_append(str, "</g></g>\n");
+    g_string_append(str, "</svg>\n");
+
+    return g_string_free(str, FALSE);
+}
+
+static gint64 render_at(RsvgHandle* handle, int size) {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    cairo_t* cr = cairo_create(surface);
+    gint64 start;
+
+    cairo_scale(cr, size / 1000.0, size / 1000.0);
+
+    start = g_get_monotonic_time();
+    rsvg_handle_render_cairo(handle, cr);
+    start = g_get_monotonic_time() - start;
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    return start;
+}
+
+int main(int argc, char** argv) {
+    guint n_elements = 20000;
+    guint iterations = 5;
+    guint i, j;
+    char* document;
+    gsize len;
+    gint64 first_us = 0, later_us = 0, again_us = 0;
+
+    if (argc > 1)
+        n_elements = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    document = make_document(n_elements);
+    len = strlen(document);
+
+    for (i = 0; i < iterations; i++) {
+        RsvgHandle* handle;
+        GError* error = NULL;
+
+        handle = rsvg_handle_new_from_data((const guint8*)document, len, &error);
+        if (!handle) {
+            g_printerr("%s\n", error->message);
+            return 1;
+        }
+
+        first_us += render_at(handle, 64);
+        for (j = 1; j < N_SIZES; j++)
+            later_us += render_at(handle, 64 + 48 * j);
+        again_us += render_at(handle, 64);
+
+        g_object_unref(handle);
+    }
+
+    g_print("%u elements, %u sizes, %u iterations\n", n_elements, N_SIZES, iterations);
+    g_print("first render: %8.2f ms\n", first_us / 1000.0 / iterations);
+    g_print("other sizes:  %8.2f ms/render\n", later_us / 1000.0 / iterations / (N_SIZES - 1));
+    g_print("first again:  %8.2f ms\n", again_us / 1000.0 / iterations);
+
+    g_free(document);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Restyling benchmark.
+ *
+ * Loads a drawing with many classed elements and sets a stylesheet with a
+ * rule for every class on it, once restyling on the calling thread alone
+ * and once on as many threads as rsvg_handle_set_style_threads() picks by
+ * default.
+ *
+ * Usage: bench-restyle [elements] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+
+#define N_CLASSES 200
+
+static char* make_document(guint n_elements) {
+    GString* str = g_string_new("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    guint i;
+
+    for (i = 0; i < n_elements; i++)
+        g_string_append_printf(str, "<rect id=\"r%u\" class=\"c%u layer%u\" x=\"%u\" y=\"%u\" width=\"5\" height=\"5\" "
+                               "style=\"opacity:0.5\"/>\n",
+                               i, i % N_CLASSES, i % 7, i % 1000, i / 1000);
+    g_string_append(str, "</svg>\n");
+
+    return g_string_free(str, FALSE);
+}
+
+static char* make_stylesheet(void) {
+    GString* str = g_string_new("* { stroke-width: 1; }\n");
+    guint i;
+
+    for (i = 0; i < N_CLASSES; i++)
+        g_string_append_printf(str,
+                               ".c%u { fill: #%06x; stroke: #%06x; stroke-dasharray: %u %u; }\n"
+                               "rect.c%u { stroke-linejoin: round; font-size: %upx; }\n",
+                               i, (i * 0x010305) & 0xffffff, (i * 0x030501) & 0xffffff, i % 5 + 1, i % 3 + 1, i, i % 20 + 8);
+    for (i = 0; i < 7; i++)
+        g_string_append_printf(str, ".layer%u { fill-opacity: 0.%u; }\n", i, i + 1);
+
+    return g_string_free(str, FALSE);
+}
+
+static double time_restyle(RsvgHandle* handle, const char* css, guint n_threads, guint iterations) {
+    gint64 start;
+    guint i;
+
+    rsvg_handle_set_style_threads(handle, n_threads);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < iterations; i++)
+        rsvg_handle_set_stylesheet(handle, (const guint8*)css, strlen(css), NULL);
+
+    return (g_get_monotonic_time() - start) / 1000.0 / iterations;
+}
+
+int main(int argc, char** argv) {
+    guint n_elements = 100000;
+    guint iterations = 5;
+    char* document;
+    char* css;
+    RsvgHandle* handle;
+    GError* error = NULL;
+    double sequential_ms, parallel_ms;
+
+    if (argc > 1)
+        n_elements = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    document = make_document(n_elements);
+    css = make_stylesheet();
+
+    handle = rsvg_handle_new_from_data((const guint8*)document, strlen(document), &error);
+    if (!handle) {
+        g_printerr("%s\n", error->message);
+        return 1;
+    }
+
+    /* the first restyle also snapshots every node's state; keep it out */
+    time_restyle(handle, css, 1, 1);
+
+    sequential_ms = time_restyle(handle, css, 1, iterations);
+    parallel_ms = time_restyle(handle, css, 0, iterations);
+
+    g_print("%u elements, %u processors, %u iterations\n", n_elements, g_get_num_processors(), iterations);
+    g_print("restyle, 1 thread:   %8.2f ms/iteration\n", sequential_ms);
+    g_print("restyle, automatic:  %8.2f ms/iteration\n", parallel_ms);
+
+    g_object_unref(handle);
+    g_free(document);
+    g_free(css);
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Text loading benchmark.
+ *
+ * Loads a document with one <text> element holding a large block of
+ * character data, which libxml2 hands to the loader in many small chunks,
+ * and a document with one <text> element holding many <tspan> children.
+ * Both used to take time quadratic in the number of chunks or tspans.
+ *
+ * Usage: bench-text [megabytes] [tspans] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rsvg.h"
+
+#define DOCUMENT_START "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\"><text x=\"0\" y=\"10\">"
+#define DOCUMENT_END "</text></svg>"
+
+static char* make_text_document(gsize target_len) {
+    static const char* const words[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "&amp;", "caf\xc3\xa9", "na\xc3\xafve", "\xe2\x80\x94", "&#x263A;",
+    };
+    GString* str = g_string_sized_new(target_len + 64);
+    guint i = 0;
+
+    g_string_append(str, DOCUMENT_START);
+    /* Entity references make libxml2 deliver the text in many chunks */
+    while (str->len < target_len) {
+        g_string_append(str, words[i++ % G_N_ELEMENTS(words)]);
+        g_string_append_c(str, i % 13 == 0 ? '\n' : ' ');
+    }
+    g_string_append(str, DOCUMENT_END);
+
+    return g_string_free(str, FALSE);
+}
+
+static char* make_tspan_document(guint n_tspans) {
+    GString* str = g_string_new(DOCUMENT_START);
+    guint i;
+
+    for (i = 0; i < n_tspans; i++)
+        g_string_append_printf(str, "word %u <tspan>span %u</tspan> ", i, i);
+    g_string_append(str, DOCUMENT_END);
+
+    return g_string_free(str, FALSE);
+}
+
+static double time_load(const char* document, guint iterations) {
+    gsize len = strlen(document);
+    gint64 start;
+    guint i;
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < iterations; i++) {
+        RsvgHandle* handle = rsvg_handle_new_with_flags(RSVG_HANDLE_FLAG_UNLIMITED);
+        GError* error = NULL;
+
+        if (!rsvg_handle_write(handle, (const guchar*)document, len, &error) || !rsvg_handle_close(handle, &error)) {
+            g_printerr("%s\n", error->message);
+            exit(1);
+        }
+        g_object_unref(handle);
+    }
+
+    return (g_get_monotonic_time() - start) / 1000.0 / iterations;
+}
+
+int main(int argc, char** argv) {
+    gsize megabytes = 10;
+    guint n_tspans = 50000;
+    guint iterations = 5;
+    char* document;
+    double ms;
+
+    if (argc > 1)
+        megabytes = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        n_tspans = MAX(1, atoi(argv[2]));
+    if (argc > 3)
+        iterations = MAX(1, atoi(argv[3]));
+
+    document = make_text_document(megabytes * 1024 * 1024);
+    ms = time_load(document, iterations);
+    g_print("text block, %" G_GSIZE_FORMAT " bytes: %8.2f ms/iteration, %8.2f MB/s\n", strlen(document), ms,
+            strlen(document) / 1000.0 / MAX(ms, 0.001));
+    g_free(document);
+
+    document = make_tspan_document(n_tspans);
+    ms = time_load(document, iterations);
+    g_print("%u tspans:                  %8.2f ms/iteration\n", n_tspans, ms);
+    g_free(document);
+
+    return 0;
+}
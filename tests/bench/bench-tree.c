@@ -0,0 +1,108 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Document tree benchmark.
+ *
+ * Loads a flat document with many small elements, each with an id, a class
+ * and a bit of path data, and reports the time spent building the tree,
+ * the time spent tearing it down, the size of the handle's arena, the size
+ * of the style state every element carries and the peak resident set size.
+ *
+ * Usage: bench-tree [elements] [iterations]
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "rsvg-private.h"
+#include "rsvg-styles.h"
+
+static glong get_peak_rss_kb(void) {
+#ifdef G_OS_UNIX
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+static char* make_document(guint n_elements) {
+    GString* str = g_string_new("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    guint i;
+
+    for (i = 0; i < n_elements; i++) {
+        switch (i % 3) {
+            case 0:
+                g_string_append_printf(str, "<path id=\"p%u\" class=\"c%u\" d=\"M%u %u l10 0 0 10z\"/>\n", i, i % 16,
+                                       i % 1000, i / 1000);
+                break;
+            case 1:
+                g_string_append_printf(str,
+                                       "<rect id=\"r%u\" class=\"c%u\" x=\"%u\" y=\"%u\" "
+                                       "width=\"5\" height=\"5\"/>\n",
+                                       i, i % 16, i % 1000, i / 1000);
+                break;
+            default:
+                g_string_append_printf(str, "<polyline id=\"l%u\" style=\"fill:none\" points=\"%u,%u %u,%u\"/>\n", i,
+                                       i % 1000, i / 1000, i % 1000 + 5, i / 1000 + 5);
+                break;
+        }
+    }
+    g_string_append(str, "</svg>\n");
+
+    return g_string_free(str, FALSE);
+}
+
+int main(int argc, char** argv) {
+    guint n_elements = 150000;
+    guint iterations = 5;
+    guint i;
+    char* document;
+    gsize len, arena_size = 0;
+    gint64 start, load_us = 0, free_us = 0;
+
+    if (argc > 1)
+        n_elements = MAX(1, atoi(argv[1]));
+    if (argc > 2)
+        iterations = MAX(1, atoi(argv[2]));
+
+    document = make_document(n_elements);
+    len = strlen(document);
+
+    for (i = 0; i < iterations; i++) {
+        RsvgHandle* handle;
+        GError* error = NULL;
+
+        start = g_get_monotonic_time();
+        handle = rsvg_handle_new_from_data((const guint8*)document, len, &error);
+        load_us += g_get_monotonic_time() - start;
+
+        if (!handle) {
+            g_printerr("%s\n", error->message);
+            return 1;
+        }
+        arena_size = _rsvg_handle_get_arena_size(handle);
+
+        start = g_get_monotonic_time();
+        g_object_unref(handle);
+        free_us += g_get_monotonic_time() - start;
+    }
+
+    g_print("%u elements, %" G_GSIZE_FORMAT " bytes, %u iterations\n", n_elements, len, iterations);
+    g_print("load:     %8.2f ms/iteration\n", load_us / 1000.0 / iterations);
+    g_print("teardown: %8.2f ms/iteration\n", free_us / 1000.0 / iterations);
+    g_print("arena:    %8.2f MB\n", arena_size / (1024.0 * 1024.0));
+    g_print("state:    %8" G_GSIZE_FORMAT " bytes/element\n", sizeof(RsvgState));
+    g_print("peak RSS: %8.2f MB\n", get_peak_rss_kb() / 1024.0);
+
+    g_free(document);
+
+    return 0;
+}
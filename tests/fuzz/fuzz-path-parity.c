@@ -0,0 +1,504 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/* vim: set sw=4 sts=4 ts=4 expandtab: */
+
+/* Checks rsvg_parse_path() against a copy of the original path parser.
+ *
+ * The reference below is the parser as it was before the number scanner
+ * and the path builder were rewritten, with one change: numbers are
+ * converted with g_ascii_strtod() instead of being accumulated digit by
+ * digit, so both sides should agree on every element bit for bit.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include <cairo.h>
+#include "rsvg-path.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+typedef struct _ReferencePathCtx ReferencePathCtx;
+
+struct _ReferencePathCtx {
+    RsvgPathBuilder builder;
+
+    cairo_path_data_t cp; /* current point */
+    cairo_path_data_t rp; /* reflection point (for 's' and 't' commands) */
+    char cmd;             /* current command (lowercase) */
+    int param;            /* parameter number */
+    gboolean rel;         /* true if relative coords */
+    double params[7];     /* parameters that have been parsed */
+};
+
+/* supply defaults for missing parameters, assuming relative coordinates
+   are to be interpreted as x,y */
+static void reference_default_xy(ReferencePathCtx* ctx, int n_params) {
+    unsigned int i;
+
+    if (ctx->rel) {
+        for (i = (unsigned int)ctx->param; i < (unsigned int)n_params; i++) {
+            /* we shouldn't get 0 here (usually ctx->param > 0 as
+               precondition) */
+            if (i == 0)
+                ctx->params[i] = ctx->cp.point.x;
+            else if (i == 1)
+                ctx->params[i] = ctx->cp.point.y;
+            else
+                ctx->params[i] = ctx->params[i - 2];
+        }
+    }
+    else {
+        for (i = (unsigned int)ctx->param; i < (unsigned int)n_params; i++)
+            ctx->params[i] = 0.0;
+    }
+}
+
+static void reference_do_cmd(ReferencePathCtx* ctx, gboolean final) {
+    double x1, y1, x2, y2, x3, y3;
+
+    switch (ctx->cmd) {
+        case 'm':
+            /* moveto */
+            if (ctx->param == 2 || final) {
+                reference_default_xy(ctx, 2);
+                rsvg_path_builder_move_to(&ctx->builder, ctx->params[0], ctx->params[1]);
+                ctx->cp.point.x = ctx->rp.point.x = ctx->params[0];
+                ctx->cp.point.y = ctx->rp.point.y = ctx->params[1];
+                ctx->param = 0;
+                ctx->cmd = 'l'; /* implicit linetos after a moveto */
+            }
+            break;
+        case 'l':
+            /* lineto */
+            if (ctx->param == 2 || final) {
+                reference_default_xy(ctx, 2);
+                rsvg_path_builder_line_to(&ctx->builder, ctx->params[0], ctx->params[1]);
+                ctx->cp.point.x = ctx->rp.point.x = ctx->params[0];
+                ctx->cp.point.y = ctx->rp.point.y = ctx->params[1];
+                ctx->param = 0;
+            }
+            break;
+        case 'c':
+            /* curveto */
+            if (ctx->param == 6 || final) {
+                reference_default_xy(ctx, 6);
+                x1 = ctx->params[0];
+                y1 = ctx->params[1];
+                x2 = ctx->params[2];
+                y2 = ctx->params[3];
+                x3 = ctx->params[4];
+                y3 = ctx->params[5];
+                rsvg_path_builder_curve_to(&ctx->builder, x1, y1, x2, y2, x3, y3);
+                ctx->rp.point.x = x2;
+                ctx->rp.point.y = y2;
+                ctx->cp.point.x = x3;
+                ctx->cp.point.y = y3;
+                ctx->param = 0;
+            }
+            break;
+        case 's':
+            /* smooth curveto */
+            if (ctx->param == 4 || final) {
+                reference_default_xy(ctx, 4);
+                x1 = 2 * ctx->cp.point.x - ctx->rp.point.x;
+                y1 = 2 * ctx->cp.point.y - ctx->rp.point.y;
+                x2 = ctx->params[0];
+                y2 = ctx->params[1];
+                x3 = ctx->params[2];
+                y3 = ctx->params[3];
+                rsvg_path_builder_curve_to(&ctx->builder, x1, y1, x2, y2, x3, y3);
+                ctx->rp.point.x = x2;
+                ctx->rp.point.y = y2;
+                ctx->cp.point.x = x3;
+                ctx->cp.point.y = y3;
+                ctx->param = 0;
+            }
+            break;
+        case 'h':
+            /* horizontal lineto */
+            if (ctx->param == 1) {
+                rsvg_path_builder_line_to(&ctx->builder, ctx->params[0], ctx->cp.point.y);
+                ctx->cp.point.x = ctx->rp.point.x = ctx->params[0];
+                ctx->rp.point.y = ctx->cp.point.y;
+                ctx->param = 0;
+            }
+            break;
+        case 'v':
+            /* vertical lineto */
+            if (ctx->param == 1) {
+                rsvg_path_builder_line_to(&ctx->builder, ctx->cp.point.x, ctx->params[0]);
+                ctx->rp.point.x = ctx->cp.point.x;
+                ctx->cp.point.y = ctx->rp.point.y = ctx->params[0];
+                ctx->param = 0;
+            }
+            break;
+        case 'q':
+            /* quadratic bezier curveto */
+
+            /* non-normative reference:
+               http://www.icce.rug.nl/erikjan/bluefuzz/beziers/beziers/beziers.html
+             */
+            if (ctx->param == 4 || final) {
+                reference_default_xy(ctx, 4);
+                /* raise quadratic bezier to cubic */
+                x1 = (ctx->cp.point.x + 2 * ctx->params[0]) * (1.0 / 3.0);
+                y1 = (ctx->cp.point.y + 2 * ctx->params[1]) * (1.0 / 3.0);
+                x3 = ctx->params[2];
+                y3 = ctx->params[3];
+                x2 = (x3 + 2 * ctx->params[0]) * (1.0 / 3.0);
+                y2 = (y3 + 2 * ctx->params[1]) * (1.0 / 3.0);
+                rsvg_path_builder_curve_to(&ctx->builder, x1, y1, x2, y2, x3, y3);
+                ctx->rp.point.x = ctx->params[0];
+                ctx->rp.point.y = ctx->params[1];
+                ctx->cp.point.x = x3;
+                ctx->cp.point.y = y3;
+                ctx->param = 0;
+            }
+            break;
+        case 't':
+            /* Truetype quadratic bezier curveto */
+            if (ctx->param == 2 || final) {
+                double xc, yc; /* quadratic control point */
+
+                xc = 2 * ctx->cp.point.x - ctx->rp.point.x;
+                yc = 2 * ctx->cp.point.y - ctx->rp.point.y;
+                /* generate a quadratic bezier with control point = xc, yc */
+                x1 = (ctx->cp.point.x + 2 * xc) * (1.0 / 3.0);
+                y1 = (ctx->cp.point.y + 2 * yc) * (1.0 / 3.0);
+                x3 = ctx->params[0];
+                y3 = ctx->params[1];
+                x2 = (x3 + 2 * xc) * (1.0 / 3.0);
+                y2 = (y3 + 2 * yc) * (1.0 / 3.0);
+                rsvg_path_builder_curve_to(&ctx->builder, x1, y1, x2, y2, x3, y3);
+                ctx->rp.point.x = xc;
+                ctx->rp.point.y = yc;
+                ctx->cp.point.x = x3;
+                ctx->cp.point.y = y3;
+                ctx->param = 0;
+            }
+            else if (final) {
+                if (ctx->param > 2) {
+                    reference_default_xy(ctx, 4);
+                    /* raise quadratic bezier to cubic */
+                    x1 = (ctx->cp.point.x + 2 * ctx->params[0]) * (1.0 / 3.0);
+                    y1 = (ctx->cp.point.y + 2 * ctx->params[1]) * (1.0 / 3.0);
+                    x3 = ctx->params[2];
+                    y3 = ctx->params[3];
+                    x2 = (x3 + 2 * ctx->params[0]) * (1.0 / 3.0);
+                    y2 = (y3 + 2 * ctx->params[1]) * (1.0 / 3.0);
+                    rsvg_path_builder_curve_to(&ctx->builder, x1, y1, x2, y2, x3, y3);
+                    ctx->rp.point.x = ctx->params[0];
+                    ctx->rp.point.y = ctx->params[1];
+                    ctx->cp.point.x = x3;
+                    ctx->cp.point.y = y3;
+                }
+                else {
+                    reference_default_xy(ctx, 2);
+                    rsvg_path_builder_line_to(&ctx->builder, ctx->params[0], ctx->params[1]);
+                    ctx->cp.point.x = ctx->rp.point.x = ctx->params[0];
+                    ctx->cp.point.y = ctx->rp.point.y = ctx->params[1];
+                }
+                ctx->param = 0;
+            }
+            break;
+        case 'a':
+            if (ctx->param == 7 || final) {
+                double x1, y1;
+                double rx, ry;
+                double x_axis_rotation;
+                gboolean large_arc_flag;
+                gboolean sweep_flag;
+                double x2, y2;
+
+                x1 = ctx->cp.point.x;
+                y1 = ctx->cp.point.y;
+
+                rx = ctx->params[0];
+                ry = ctx->params[1];
+
+                x_axis_rotation = ctx->params[2];
+
+                large_arc_flag = (ctx->params[3] == 0 ? FALSE : TRUE);
+                sweep_flag = (ctx->params[4] == 0 ? FALSE : TRUE);
+
+                x2 = ctx->params[5];
+                y2 = ctx->params[6];
+
+                rsvg_path_builder_arc(&ctx->builder, x1, y1, rx, ry, x_axis_rotation, large_arc_flag, sweep_flag, x2,
+                                      y2);
+
+                ctx->rp.point.x = ctx->cp.point.x = x2;
+                ctx->rp.point.y = ctx->cp.point.y = y2;
+
+                ctx->param = 0;
+            }
+            break;
+        default:
+            ctx->param = 0;
+    }
+}
+
+static void reference_end_of_number(ReferencePathCtx* ctx, double val) {
+    if (ctx->rel) {
+        /* Handle relative coordinates. This switch statement attempts
+           to determine _what_ the coords are relative to. This is
+           underspecified in the 12 Apr working draft. */
+        switch (ctx->cmd) {
+            case 'l':
+            case 'm':
+            case 'c':
+            case 's':
+            case 'q':
+            case 't':
+                /* rule: even-numbered params are x-relative, odd-numbered
+                   are y-relative */
+                if ((ctx->param & 1) == 0)
+                    val += ctx->cp.point.x;
+                else if ((ctx->param & 1) == 1)
+                    val += ctx->cp.point.y;
+                break;
+            case 'a':
+                /* rule: sixth and seventh are x and y, rest are not
+                   relative */
+                if (ctx->param == 5)
+                    val += ctx->cp.point.x;
+                else if (ctx->param == 6)
+                    val += ctx->cp.point.y;
+                break;
+            case 'h':
+                /* rule: x-relative */
+                val += ctx->cp.point.x;
+                break;
+            case 'v':
+                /* rule: y-relative */
+                val += ctx->cp.point.y;
+                break;
+        }
+    }
+    ctx->params[ctx->param++] = val;
+    reference_do_cmd(ctx, FALSE);
+}
+
+#define RSVGN_IN_PREINTEGER 0
+#define RSVGN_IN_INTEGER 1
+#define RSVGN_IN_FRACTION 2
+#define RSVGN_IN_PREEXPONENT 3
+#define RSVGN_IN_EXPONENT 4
+
+#define RSVGN_GOT_SIGN 0x1
+#define RSVGN_GOT_EXPONENT_SIGN 0x2
+
+/* The original character-at-a-time scanner, except that instead of
+ * accumulating the value digit by digit it collects the literal and leaves
+ * the conversion to g_ascii_strtod(), which rounds correctly.
+ */
+static int reference_parse_number(ReferencePathCtx* ctx, const char* data) {
+    int length = 0;
+    int in = RSVGN_IN_PREINTEGER; /* Current location within the number */
+    int got = 0x0;                /* [bitfield] Having 2 of each of these is an error */
+    gboolean end = FALSE;         /* Set to true if the number should end after a char */
+    gboolean error = FALSE;       /* Set to true if the number ended due to an error */
+
+    GString* literal = g_string_new(NULL);
+    double value;
+    int sign = +1; /* Presume the INTEGER is positive if it has no sign */
+
+    while (data[length] != '\0' && !end && !error) {
+        char c = data[length];
+        switch (in) {
+            case RSVGN_IN_PREINTEGER: /* No numbers yet, we're just starting out */
+                /* LEGAL: + - .->FRACTION DIGIT->INTEGER */
+                if (c == '+' || c == '-') {
+                    if (got & RSVGN_GOT_SIGN) {
+                        error = TRUE; /* Two signs: not allowed */
+                    }
+                    else {
+                        sign = c == '+' ? +1 : -1;
+                        got |= RSVGN_GOT_SIGN;
+                    }
+                }
+                else if (c == '.') {
+                    g_string_append_c(literal, c);
+                    in = RSVGN_IN_FRACTION;
+                }
+                else if (c >= '0' && c <= '9') {
+                    g_string_append_c(literal, c);
+                    in = RSVGN_IN_INTEGER;
+                }
+                break;
+            case RSVGN_IN_INTEGER: /* Previous character(s) was/were digit(s) */
+                /* LEGAL: DIGIT .->FRACTION E->PREEXPONENT */
+                if (c >= '0' && c <= '9') {
+                    g_string_append_c(literal, c);
+                }
+                else if (c == '.') {
+                    g_string_append_c(literal, c);
+                    in = RSVGN_IN_FRACTION;
+                }
+                else if (c == 'e' || c == 'E') {
+                    g_string_append_c(literal, 'e');
+                    in = RSVGN_IN_PREEXPONENT;
+                }
+                else {
+                    end = TRUE;
+                }
+                break;
+            case RSVGN_IN_FRACTION: /* Previously, digit(s) in the fractional part */
+                /* LEGAL: DIGIT E->PREEXPONENT */
+                if (c >= '0' && c <= '9') {
+                    g_string_append_c(literal, c);
+                }
+                else if (c == 'e' || c == 'E') {
+                    g_string_append_c(literal, 'e');
+                    in = RSVGN_IN_PREEXPONENT;
+                }
+                else {
+                    end = TRUE;
+                }
+                break;
+            case RSVGN_IN_PREEXPONENT: /* Right after E */
+                /* LEGAL: + - DIGIT->EXPONENT */
+                if (c == '+' || c == '-') {
+                    if (got & RSVGN_GOT_EXPONENT_SIGN) {
+                        error = TRUE; /* Two signs: not allowed */
+                    }
+                    else {
+                        g_string_append_c(literal, c);
+                        got |= RSVGN_GOT_EXPONENT_SIGN;
+                    }
+                }
+                else if (c >= '0' && c <= '9') {
+                    g_string_append_c(literal, c);
+                    in = RSVGN_IN_EXPONENT;
+                }
+                break;
+            case RSVGN_IN_EXPONENT: /* After E and the sign, if applicable */
+                /* LEGAL: DIGIT */
+                if (c >= '0' && c <= '9') {
+                    g_string_append_c(literal, c);
+                }
+                else {
+                    end = TRUE;
+                }
+                break;
+        }
+        length++;
+    }
+
+    value = g_ascii_strtod(literal->str, NULL);
+    g_string_free(literal, TRUE);
+
+    reference_end_of_number(ctx, sign < 0 ? -value : value);
+    return end /* && !error */ ? length - 1 : length;
+}
+
+static void reference_parse_path_data(ReferencePathCtx* ctx, const char* data) {
+    int i = 0;
+    char c = 0;
+
+    for (i = 0; data[i] != '\0'; i++) {
+        c = data[i];
+        if ((c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.') {
+            /* digit */
+            i += reference_parse_number(ctx, data + i) - 1;
+        }
+        else if (c == 'z' || c == 'Z') {
+            if (ctx->param)
+                reference_do_cmd(ctx, TRUE);
+            rsvg_path_builder_close_path(&ctx->builder);
+
+            ctx->cp = ctx->rp = ctx->builder.data[ctx->builder.n_data - 1];
+        }
+        else if (c >= 'A' && c < 'Z' && c != 'E') {
+            if (ctx->param)
+                reference_do_cmd(ctx, TRUE);
+            ctx->cmd = c + 'a' - 'A';
+            ctx->rel = FALSE;
+        }
+        else if (c >= 'a' && c < 'z' && c != 'e') {
+            if (ctx->param)
+                reference_do_cmd(ctx, TRUE);
+            ctx->cmd = c;
+            ctx->rel = TRUE;
+        }
+        /* else c _should_ be whitespace or , */
+    }
+}
+
+static cairo_path_t* reference_parse_path(const char* path_str) {
+    ReferencePathCtx ctx;
+
+    rsvg_path_builder_init(&ctx.builder, 32);
+
+    ctx.cp.point.x = 0.0;
+    ctx.cp.point.y = 0.0;
+    ctx.rp.point.x = 0.0;
+    ctx.rp.point.y = 0.0;
+    ctx.cmd = 0;
+    ctx.param = 0;
+    /* An arc cut short reads all seven parameters */
+    memset(ctx.params, 0, sizeof(ctx.params));
+
+    reference_parse_path_data(&ctx, path_str);
+
+    if (ctx.param)
+        reference_do_cmd(&ctx, TRUE);
+
+    return rsvg_path_builder_finish(&ctx.builder);
+}
+
+
+static gboolean same_double(double a, double b) {
+    return a == b || (isnan(a) && isnan(b));
+}
+
+static void assert_same_path(const cairo_path_t* expected, const cairo_path_t* actual) {
+    int i, j;
+
+    if (expected->num_data != actual->num_data)
+        abort();
+
+    for (i = 0; i < expected->num_data; i += expected->data[i].header.length) {
+        const cairo_path_data_t* e = &expected->data[i];
+        const cairo_path_data_t* a = &actual->data[i];
+
+        if (e->header.type != a->header.type || e->header.length != a->header.length)
+            abort();
+
+        for (j = 1; j < e->header.length; j++)
+            if (!same_double(e[j].point.x, a[j].point.x) || !same_double(e[j].point.y, a[j].point.y))
+                abort();
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    g_autofree char* path_str = g_strndup((const char*)data, size);
+    cairo_path_t* expected;
+    cairo_path_t* actual;
+
+    expected = reference_parse_path(path_str);
+    actual = rsvg_parse_path(path_str);
+
+    assert_same_path(expected, actual);
+
+    rsvg_cairo_path_destroy(expected);
+    rsvg_cairo_path_destroy(actual);
+
+    return 0;
+}
+
+#ifndef RSVG_FUZZING_ENGINE
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        g_autofree gchar* contents = NULL;
+        gsize length = 0;
+        if (g_file_get_contents(argv[i], &contents, &length, NULL)) {
+            LLVMFuzzerTestOneInput((const uint8_t*)contents, length);
+        }
+    }
+    return 0;
+}
+#endif
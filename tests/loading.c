@@ -4,7 +4,9 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include "rsvg.h"
 #include "rsvg-compat.h"
 #include "test-utils.h"
@@ -56,6 +58,745 @@ static void load_n_bytes_at_a_time(gconstpointer data) {
     g_free(filename);
 }
 
+static void load_compressed_stream(void) {
+    char* filename = g_build_filename(test_utils_get_test_data_path(), "loading/gnome-cool.svgz", NULL);
+    GFile* file = g_file_new_for_path(filename);
+    GError* error = NULL;
+    RsvgHandle* handle;
+
+    handle = rsvg_handle_new_from_gfile_sync(file, RSVG_HANDLE_FLAGS_NONE, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(handle != NULL);
+
+    g_object_unref(handle);
+    g_object_unref(file);
+    g_free(filename);
+}
+
+/* A document whose compressed form is too big to be inflated in one go
+ * when it is read from a stream; a rejected one stops the parser right at
+ * its start, with a reference to an external entity
+ */
+static GBytes* make_large_compressed_document(gboolean rejected) {
+    GString* str = g_string_new(NULL);
+    GRand* rand = g_rand_new_with_seed(42);
+    GConverter* compressor;
+    GInputStream* plain;
+    GInputStream* compressed;
+    GOutputStream* out;
+    GBytes* bytes;
+    guint i, j;
+
+    if (rejected)
+        g_string_append(str, "<!DOCTYPE svg [<!ENTITY ext SYSTEM \"secret.txt\">]>\n");
+    g_string_append(str, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    if (rejected)
+        g_string_append(str, "<text>&ext;</text>\n");
+
+    for (i = 0; i < 2000; i++) {
+        g_string_append_printf(str, "<path id=\"p%u\" d=\"M0 0", i);
+        for (j = 0; j < 40; j++)
+            g_string_append_printf(str, " L%.3f %.3f", g_rand_double_range(rand, 0, 1000),
+                                   g_rand_double_range(rand, 0, 1000));
+        g_string_append(str, "\"/>\n");
+    }
+    g_string_append(str, "</svg>\n");
+
+    compressor = G_CONVERTER(g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+    plain = g_memory_input_stream_new_from_data(str->str, str->len, NULL);
+    compressed = g_converter_input_stream_new(plain, compressor);
+    out = g_memory_output_stream_new_resizable();
+    g_assert(g_output_stream_splice(out, compressed,
+                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, NULL,
+                                    NULL) > 0);
+    bytes = g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(out));
+
+    g_object_unref(out);
+    g_object_unref(compressed);
+    g_object_unref(plain);
+    g_object_unref(compressor);
+    g_rand_free(rand);
+    g_string_free(str, TRUE);
+
+    return bytes;
+}
+
+static void load_large_compressed_document(void) {
+    GBytes* bytes = make_large_compressed_document(FALSE);
+    GInputStream* stream;
+    GError* error = NULL;
+    RsvgHandle* handle;
+
+    g_assert_cmpuint(g_bytes_get_size(bytes), >, 64 * 1024);
+
+    /* decompressed on a helper thread */
+    stream = g_memory_input_stream_new_from_bytes(bytes);
+    handle = rsvg_handle_new_from_stream_sync(stream, NULL, RSVG_HANDLE_FLAGS_NONE, NULL, &error);
+    g_assert_no_error(error);
+    g_assert(handle != NULL);
+    g_assert(rsvg_handle_has_sub(handle, "#p1999"));
+    g_object_unref(handle);
+    g_object_unref(stream);
+
+    /* inflated in one go */
+    handle = rsvg_handle_new_from_data(g_bytes_get_data(bytes, NULL), g_bytes_get_size(bytes), &error);
+    g_assert_no_error(error);
+    g_assert(handle != NULL);
+    g_assert(rsvg_handle_has_sub(handle, "#p1999"));
+    g_object_unref(handle);
+
+    g_bytes_unref(bytes);
+}
+
+static void load_truncated_compressed_document(void) {
+    GBytes* bytes = make_large_compressed_document(FALSE);
+    gsize len = g_bytes_get_size(bytes) / 2;
+    GInputStream* stream;
+    GError* error = NULL;
+    RsvgHandle* handle;
+
+    stream = g_memory_input_stream_new_from_data(g_bytes_get_data(bytes, NULL), len, NULL);
+    handle = rsvg_handle_new_from_stream_sync(stream, NULL, RSVG_HANDLE_FLAGS_NONE, NULL, &error);
+    g_assert(handle == NULL);
+    g_assert(error != NULL);
+    g_clear_error(&error);
+    g_object_unref(stream);
+
+    handle = rsvg_handle_new_from_data(g_bytes_get_data(bytes, NULL), len, &error);
+    g_assert(handle == NULL);
+    g_assert(error != NULL);
+    g_clear_error(&error);
+
+    g_bytes_unref(bytes);
+}
+
+/* A stream that hands out its data, then waits for more that never comes,
+ * until it is cancelled
+ */
+typedef struct {
+    GInputStream parent;
+    GBytes* bytes;
+    gsize pos;
+} StalledStream;
+
+typedef struct {
+    GInputStreamClass parent_class;
+} StalledStreamClass;
+
+static GType stalled_stream_get_type(void);
+
+G_DEFINE_TYPE(StalledStream, stalled_stream, G_TYPE_INPUT_STREAM)
+
+static gssize stalled_stream_read(GInputStream* stream,
+                                  void* buffer,
+                                  gsize count,
+                                  GCancellable* cancellable,
+                                  GError** error) {
+    StalledStream* self = (StalledStream*)stream;
+    gsize len = g_bytes_get_size(self->bytes);
+
+    if (self->pos < len) {
+        count = MIN(count, len - self->pos);
+        memcpy(buffer, (const guint8*)g_bytes_get_data(self->bytes, NULL) + self->pos, count);
+        self->pos += count;
+        return count;
+    }
+
+    while (!g_cancellable_is_cancelled(cancellable))
+        g_usleep(1000);
+
+    g_cancellable_set_error_if_cancelled(cancellable, error);
+    return -1;
+}
+
+static void stalled_stream_finalize(GObject* object) {
+    g_bytes_unref(((StalledStream*)object)->bytes);
+
+    G_OBJECT_CLASS(stalled_stream_parent_class)->finalize(object);
+}
+
+static void stalled_stream_init(StalledStream* self) {
+    (void)self;
+}
+
+static void stalled_stream_class_init(StalledStreamClass* klass) {
+    G_OBJECT_CLASS(klass)->finalize = stalled_stream_finalize;
+    G_INPUT_STREAM_CLASS(klass)->read_fn = stalled_stream_read;
+}
+
+static void load_stalled_compressed_document(void) {
+    GBytes* bytes = make_large_compressed_document(TRUE);
+    StalledStream* stream;
+    GError* error = NULL;
+    RsvgHandle* handle;
+
+    /* just enough not to be inflated in one go, and too little to fill the
+     * helper thread's buffer: the parser gives up while the thread still
+     * waits for the rest
+     */
+    g_assert_cmpuint(g_bytes_get_size(bytes), >, 64 * 1024);
+    stream = g_object_new(stalled_stream_get_type(), NULL);
+    stream->bytes = g_bytes_new_from_bytes(bytes, 0, 64 * 1024);
+
+    handle = rsvg_handle_new_from_stream_sync(G_INPUT_STREAM(stream), NULL, RSVG_HANDLE_FLAGS_NONE, NULL, &error);
+    g_assert(handle == NULL);
+    g_assert_error(error, RSVG_ERROR, RSVG_ERROR_FAILED);
+    g_clear_error(&error);
+
+    g_object_unref(stream);
+    g_bytes_unref(bytes);
+}
+
+/* Enough path data for it to be compiled on several threads */
+static void load_large_geometry(void) {
+    GString* str = g_string_new("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    RsvgDimensionData dim;
+    RsvgHandle* handle;
+    GError* error = NULL;
+    guint i, j;
+
+    /* zigzags of 75 by 10 units, as paths and polygons */
+    for (i = 0; i < 3000; i++) {
+        guint x = i % 500, y = i % 700;
+
+        if (i % 2 == 0) {
+            g_string_append_printf(str, "<path id=\"e%u\" d=\"M%u %u", i, x, y);
+            for (j = 0; j < 50; j++)
+                g_string_append(str, j % 2 == 0 ? " l1.5 10" : " l1.5 -10");
+        }
+        else {
+            g_string_append_printf(str, "<polygon id=\"e%u\" points=\"%u,%u", i, x, y);
+            for (j = 0; j < 50; j++)
+                g_string_append_printf(str, " %u.%u,%u", x + 3 * (j + 1) / 2, 3 * (j + 1) % 2 * 5,
+                                       j % 2 == 0 ? y + 10 : y);
+        }
+        g_string_append(str, "\"/>\n");
+    }
+    g_string_append(str, "</svg>\n");
+
+    handle = rsvg_handle_new_from_data((const guint8*)str->str, str->len, &error);
+    g_assert_no_error(error);
+    g_assert(handle != NULL);
+
+    for (i = 0; i < 3000; i += 333) {
+        char* id = g_strdup_printf("#e%u", i);
+
+        g_assert(rsvg_handle_get_dimensions_sub(handle, &dim, id));
+        g_assert_cmpint(dim.width, ==, 75);
+        g_assert_cmpint(dim.height, ==, 10);
+        g_free(id);
+    }
+
+    g_object_unref(handle);
+    g_string_free(str, TRUE);
+}
+
+/* A 2x2 red PNG */
+#define RED_PNG_BASE64 \
+    "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAIAAAD91JpzAAAAEElEQVR42mP4z8AARAwQCgAf7gP9Y167WwAAAABJRU5ErkJggg=="
+
+static void load_data_uri_image(gconstpointer data) {
+    const char* uri = data;
+    char* document;
+    RsvgHandle* handle;
+    GError* error = NULL;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+    guint32 pixel;
+
+    document = g_strdup_printf("<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                               "xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"4\" height=\"4\">"
+                               "<image width=\"4\" height=\"4\" xlink:href=\"%s\"/></svg>",
+                               uri);
+    handle = rsvg_handle_new_from_data((const guint8*)document, strlen(document), &error);
+    g_assert_no_error(error);
+    g_assert(handle != NULL);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 4, 4);
+    cr = cairo_create(surface);
+    g_assert(rsvg_handle_render_cairo(handle, cr));
+    cairo_surface_flush(surface);
+
+    pixel = *(guint32*)(cairo_image_surface_get_data(surface) + 2 * cairo_image_surface_get_stride(surface) + 2 * 4);
+    g_assert_cmphex(pixel, ==, 0xffff0000);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    g_object_unref(handle);
+    g_free(document);
+}
+
+static cairo_surface_t* render_handle(RsvgHandle* handle) {
+    RsvgDimensionData dim;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    rsvg_handle_get_dimensions(handle, &dim);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dim.width, dim.height);
+    cr = cairo_create(surface);
+    g_assert(rsvg_handle_render_cairo(handle, cr));
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    return surface;
+}
+
+/* Where the words changed below sit in a cache file's header */
+#define CACHE_FLAGS_OFFSET 20
+#define CACHE_EVENTS_OFFSET 80
+#define CACHE_PATHS_OFFSET 112
+
+static RsvgHandle* load_from_edited_cache(const char* cache, gsize cache_len, const char* data, gsize len,
+                                          GError** error) {
+    char* filename;
+    RsvgHandle* handle;
+    int fd;
+
+    fd = g_file_open_tmp("loading-XXXXXX.rsvgcache", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+    g_assert(g_file_set_contents(filename, cache, cache_len, NULL));
+
+    handle = rsvg_handle_new_from_cache(filename, (const guint8*)data, len, error);
+
+    g_unlink(filename);
+    g_free(filename);
+
+    return handle;
+}
+
+static void check_damaged_cache(const char* cache, gsize cache_len, const char* data, gsize len) {
+    GError* error = NULL;
+
+    g_assert(load_from_edited_cache(cache, cache_len, data, len, &error) == NULL);
+    g_assert_error(error, RSVG_ERROR, RSVG_ERROR_FAILED);
+    g_assert_cmpstr(error->message, ==, "The cache file is damaged");
+    g_error_free(error);
+}
+
+static void load_from_damaged_cache(const char* cache_filename, const char* data, gsize len) {
+    char* cache;
+    char* edited;
+    gsize cache_len, i;
+    guint64 word;
+    guint32 flags;
+    RsvgHandle* handle;
+    RsvgHandleFlags handle_flags;
+    GError* error = NULL;
+
+    g_assert(g_file_get_contents(cache_filename, &cache, &cache_len, NULL));
+    edited = g_malloc(cache_len);
+
+    /* cut off, past the header */
+    check_damaged_cache(cache, cache_len - 16, data, len);
+
+    /* the events pointed past the end of the file */
+    memcpy(edited, cache, cache_len);
+    word = cache_len + 8;
+    memcpy(edited + CACHE_EVENTS_OFFSET, &word, sizeof(word));
+    check_damaged_cache(edited, cache_len, data, len);
+
+    /* a path element that is not one */
+    memcpy(edited, cache, cache_len);
+    memcpy(&word, edited + CACHE_PATHS_OFFSET, sizeof(word));
+    for (i = word; i < cache_len; i += 2 * sizeof(guint64)) {
+        gint64 num_data;
+
+        memcpy(&num_data, edited + i + sizeof(guint64), sizeof(num_data));
+        if (num_data > 0)
+            break;
+    }
+    g_assert_cmpuint(i, <, cache_len);
+    memcpy(&word, edited + i, sizeof(word));
+    ((cairo_path_data_t*)(edited + word))->header.type = (cairo_path_data_type_t)42;
+    check_damaged_cache(edited, cache_len, data, len);
+
+    /* the loading limits stay, whatever flags the cache claims */
+    memcpy(edited, cache, cache_len);
+    memcpy(&flags, edited + CACHE_FLAGS_OFFSET, sizeof(flags));
+    flags |= RSVG_HANDLE_FLAG_UNLIMITED;
+    memcpy(edited + CACHE_FLAGS_OFFSET, &flags, sizeof(flags));
+    handle = load_from_edited_cache(edited, cache_len, data, len, &error);
+    g_assert_no_error(error);
+    g_object_get(handle, "flags", &handle_flags, NULL);
+    g_assert_cmpuint(handle_flags & RSVG_HANDLE_FLAG_UNLIMITED, ==, 0);
+    g_object_unref(handle);
+
+    g_free(edited);
+    g_free(cache);
+}
+
+static void load_from_cache(void) {
+    char* filename = g_build_filename(test_utils_get_test_data_path(), "loading/gnome-cool.svg", NULL);
+    char* cache_filename;
+    char* data;
+    gsize len;
+    RsvgHandle* handle;
+    RsvgHandle* cached;
+    GError* error = NULL;
+    cairo_surface_t* expected;
+    cairo_surface_t* actual;
+    int fd;
+
+    g_assert(g_file_get_contents(filename, &data, &len, NULL));
+    fd = g_file_open_tmp("loading-XXXXXX.rsvgcache", &cache_filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+
+    /* only a cacheable handle records enough to be cached */
+    handle = rsvg_handle_new_from_data((const guint8*)data, len, &error);
+    g_assert_no_error(error);
+    g_assert(!rsvg_handle_save_cache(handle, cache_filename, &error));
+    g_assert_error(error, RSVG_ERROR, RSVG_ERROR_FAILED);
+    g_clear_error(&error);
+    g_object_unref(handle);
+
+    handle = rsvg_handle_new_with_flags(RSVG_HANDLE_FLAG_CACHEABLE);
+    rsvg_handle_set_base_uri(handle, filename);
+    g_assert(rsvg_handle_write(handle, (const guchar*)data, len, &error));
+    g_assert(rsvg_handle_close(handle, &error));
+    g_assert_no_error(error);
+    g_assert(rsvg_handle_save_cache(handle, cache_filename, &error));
+    g_assert_no_error(error);
+
+    cached = rsvg_handle_new_from_cache(cache_filename, (const guint8*)data, len, &error);
+    g_assert_no_error(error);
+    g_assert(cached != NULL);
+    g_assert_cmpstr(rsvg_handle_get_base_uri(cached), ==, rsvg_handle_get_base_uri(handle));
+
+    expected = render_handle(handle);
+    actual = render_handle(cached);
+    g_assert_cmpint(cairo_image_surface_get_height(actual), ==, cairo_image_surface_get_height(expected));
+    g_assert(memcmp(cairo_image_surface_get_data(actual), cairo_image_surface_get_data(expected),
+                    cairo_image_surface_get_stride(expected) * cairo_image_surface_get_height(expected)) == 0);
+
+    cairo_surface_destroy(expected);
+    cairo_surface_destroy(actual);
+    g_object_unref(cached);
+    g_object_unref(handle);
+
+    load_from_damaged_cache(cache_filename, data, len);
+
+    /* a cache of another document is rejected */
+    data[len / 2] ^= 1;
+    g_assert(rsvg_handle_new_from_cache(cache_filename, (const guint8*)data, len, &error) == NULL);
+    g_assert_error(error, RSVG_ERROR, RSVG_ERROR_FAILED);
+    g_clear_error(&error);
+
+    g_unlink(cache_filename);
+    g_free(cache_filename);
+    g_free(data);
+    g_free(filename);
+}
+
+static guint32 render_center_pixel(const char* filename) {
+    RsvgHandle* handle;
+    GError* error = NULL;
+    cairo_surface_t* surface;
+    guint32 pixel;
+
+    handle = rsvg_handle_new_from_file(filename, &error);
+    g_assert_no_error(error);
+
+    surface = render_handle(handle);
+    pixel = *(guint32*)(cairo_image_surface_get_data(surface) + 5 * cairo_image_surface_get_stride(surface) + 5 * 4);
+
+    cairo_surface_destroy(surface);
+    g_object_unref(handle);
+
+    return pixel;
+}
+
+static void load_extern_from_cache(void) {
+    static const char icon[] = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' "
+                               "width='10' height='10'><use xlink:href='sprites.svg#icon'/></svg>";
+    char* dir;
+    char* sprites;
+    char* icons[2];
+    guint64 hits, misses, hits_before, misses_before;
+    GError* error = NULL;
+    guint i;
+
+    dir = g_dir_make_tmp("rsvg-extern-XXXXXX", &error);
+    g_assert_no_error(error);
+
+    sprites = g_build_filename(dir, "sprites.svg", NULL);
+    g_assert(g_file_set_contents(sprites,
+                                 "<svg xmlns='http://www.w3.org/2000/svg'>"
+                                 "<rect id='icon' width='10' height='10' fill='red'/></svg>",
+                                 -1, NULL));
+    for (i = 0; i < G_N_ELEMENTS(icons); i++) {
+        char* name = g_strdup_printf("icon%u.svg", i);
+
+        icons[i] = g_build_filename(dir, name, NULL);
+        g_assert(g_file_set_contents(icons[i], icon, -1, NULL));
+        g_free(name);
+    }
+
+    rsvg_set_extern_cache_size(4);
+    rsvg_get_extern_cache_stats(&hits_before, &misses_before);
+
+    /* the first icon parses the sprites, the second shares them */
+    g_assert_cmphex(render_center_pixel(icons[0]), ==, 0xffff0000);
+    g_assert_cmphex(render_center_pixel(icons[1]), ==, 0xffff0000);
+    rsvg_get_extern_cache_stats(&hits, &misses);
+    g_assert_cmpuint(hits - hits_before, ==, 1);
+    g_assert_cmpuint(misses - misses_before, ==, 1);
+
+    /* a file that changed size is a different document */
+    g_assert(g_file_set_contents(sprites,
+                                 "<svg xmlns='http://www.w3.org/2000/svg'>"
+                                 "<rect id='icon' width='10' height='10' fill='lime'/></svg>",
+                                 -1, NULL));
+    g_assert_cmphex(render_center_pixel(icons[0]), ==, 0xff00ff00);
+    rsvg_get_extern_cache_stats(&hits, &misses);
+    g_assert_cmpuint(hits - hits_before, ==, 1);
+    g_assert_cmpuint(misses - misses_before, ==, 2);
+
+    /* with the cache disabled, nothing is counted */
+    rsvg_set_extern_cache_size(0);
+    g_assert_cmphex(render_center_pixel(icons[1]), ==, 0xff00ff00);
+    rsvg_get_extern_cache_stats(&hits, &misses);
+    g_assert_cmpuint(misses - misses_before, ==, 2);
+
+    for (i = 0; i < G_N_ELEMENTS(icons); i++) {
+        g_unlink(icons[i]);
+        g_free(icons[i]);
+    }
+    g_unlink(sprites);
+    g_free(sprites);
+    g_rmdir(dir);
+    g_free(dir);
+}
+
+static void check_prefetched(RsvgHandle* handle) {
+    cairo_surface_t* surface = render_handle(handle);
+    guint8* data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    int i;
+
+    for (i = 0; i < 8; i++)
+        g_assert_cmphex(*(guint32*)(data + 5 * stride + (i * 4 + 1) * 4), ==, 0xffff0000);
+    g_assert_cmphex(*(guint32*)(data + 5 * stride + 35 * 4), ==, 0xff00ff00);
+
+    cairo_surface_destroy(surface);
+}
+
+static void load_prefetched_resources(void) {
+    GString* document = g_string_new("<svg xmlns='http://www.w3.org/2000/svg' "
+                                     "xmlns:xlink='http://www.w3.org/1999/xlink' width='40' height='10'>");
+    char *dir, *png, *sprites, *filename;
+    guchar* png_data;
+    gsize png_len;
+    RsvgHandle* handle;
+    GError* error = NULL;
+    int i;
+
+    dir = g_dir_make_tmp("rsvg-prefetch-XXXXXX", &error);
+    g_assert_no_error(error);
+
+    png = g_build_filename(dir, "red.png", NULL);
+    png_data = g_base64_decode(RED_PNG_BASE64, &png_len);
+    g_assert(g_file_set_contents(png, (const char*)png_data, png_len, NULL));
+    g_free(png_data);
+
+    sprites = g_build_filename(dir, "sprites.svg", NULL);
+    g_assert(g_file_set_contents(sprites,
+                                 "<svg xmlns='http://www.w3.org/2000/svg'>"
+                                 "<rect id='icon' width='10' height='10' fill='lime'/></svg>",
+                                 -1, NULL));
+
+    /* every image is fetched on its own, while the rest of the document loads */
+    for (i = 0; i < 8; i++)
+        g_string_append_printf(document, "<image x='%d' width='4' height='10' preserveAspectRatio='none' "
+                                         "xlink:href='red.png'/>", i * 4);
+    g_string_append(document, "<use x='30' xlink:href='sprites.svg#icon'/></svg>");
+
+    filename = g_build_filename(dir, "document.svg", NULL);
+    g_assert(g_file_set_contents(filename, document->str, document->len, NULL));
+
+    /* loaded from a stream */
+    handle = rsvg_handle_new_from_file(filename, &error);
+    g_assert_no_error(error);
+    check_prefetched(handle);
+    g_object_unref(handle);
+
+    /* written a byte at a time, then closed */
+    handle = rsvg_handle_new();
+    rsvg_handle_set_base_uri(handle, filename);
+    for (i = 0; i < (int)document->len; i++)
+        g_assert(rsvg_handle_write(handle, (const guchar*)document->str + i, 1, &error));
+    g_assert(rsvg_handle_close(handle, &error));
+    g_assert_no_error(error);
+    check_prefetched(handle);
+    g_object_unref(handle);
+
+    /* given up on halfway, with fetches still running */
+    handle = rsvg_handle_new();
+    rsvg_handle_set_base_uri(handle, filename);
+    g_assert(rsvg_handle_write(handle, (const guchar*)document->str, document->len / 2, &error));
+    g_object_unref(handle);
+
+    g_unlink(filename);
+    g_unlink(sprites);
+    g_unlink(png);
+    g_rmdir(dir);
+    g_free(filename);
+    g_free(sprites);
+    g_free(png);
+    g_free(dir);
+    g_string_free(document, TRUE);
+}
+
+typedef struct {
+    GAsyncResult* result;
+    GThread* thread;
+} AsyncLoad;
+
+static void async_load_ready(GObject* source, GAsyncResult* result, gpointer user_data) {
+    AsyncLoad* load = user_data;
+
+    (void)source;
+    load->result = g_object_ref(result);
+    load->thread = g_thread_self();
+}
+
+static GAsyncResult* wait_for_async_load(AsyncLoad* load) {
+    while (load->result == NULL)
+        g_main_context_iteration(NULL, TRUE);
+
+    /* completion is reported in the caller's main context */
+    g_assert(load->thread == g_thread_self());
+
+    return load->result;
+}
+
+static void assert_same_rendering(RsvgHandle* a, RsvgHandle* b) {
+    cairo_surface_t* expected = render_handle(a);
+    cairo_surface_t* actual = render_handle(b);
+
+    g_assert_cmpint(cairo_image_surface_get_height(actual), ==, cairo_image_surface_get_height(expected));
+    g_assert(memcmp(cairo_image_surface_get_data(actual), cairo_image_surface_get_data(expected),
+                    cairo_image_surface_get_stride(expected) * cairo_image_surface_get_height(expected)) == 0);
+
+    cairo_surface_destroy(expected);
+    cairo_surface_destroy(actual);
+}
+
+static void load_async(void) {
+    char* filename = g_build_filename(test_utils_get_test_data_path(), "loading/gnome-cool.svgz", NULL);
+    GFile* file = g_file_new_for_path(filename);
+    GCancellable* cancellable;
+    GInputStream* stream;
+    RsvgHandle* expected;
+    RsvgHandle* handle;
+    AsyncLoad load = {NULL, NULL};
+    GError* error = NULL;
+
+    expected = rsvg_handle_new_from_gfile_sync(file, RSVG_HANDLE_FLAGS_NONE, NULL, &error);
+    g_assert_no_error(error);
+
+    rsvg_handle_new_from_gfile_async(file, RSVG_HANDLE_FLAGS_NONE, NULL, async_load_ready, &load);
+    handle = rsvg_handle_new_from_gfile_finish(wait_for_async_load(&load), &error);
+    g_assert_no_error(error);
+    assert_same_rendering(expected, handle);
+    g_object_unref(handle);
+    g_clear_object(&load.result);
+
+    stream = G_INPUT_STREAM(g_file_read(file, NULL, &error));
+    g_assert_no_error(error);
+    handle = rsvg_handle_new();
+    rsvg_handle_set_base_gfile(handle, file);
+    rsvg_handle_read_stream_async(handle, stream, NULL, async_load_ready, &load);
+    g_assert(rsvg_handle_read_stream_finish(handle, wait_for_async_load(&load), &error));
+    g_assert_no_error(error);
+    assert_same_rendering(expected, handle);
+    g_object_unref(handle);
+    g_object_unref(stream);
+    g_clear_object(&load.result);
+
+    cancellable = g_cancellable_new();
+    g_cancellable_cancel(cancellable);
+    rsvg_handle_new_from_gfile_async(file, RSVG_HANDLE_FLAGS_NONE, cancellable, async_load_ready, &load);
+    g_assert_null(rsvg_handle_new_from_gfile_finish(wait_for_async_load(&load), &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error(&error);
+    g_clear_object(&load.result);
+
+    g_object_unref(cancellable);
+    g_object_unref(expected);
+    g_object_unref(file);
+    g_free(filename);
+}
+
+static guint32 pixel_at(cairo_surface_t* surface, int x, int y) {
+    guint8* data = cairo_image_surface_get_data(surface);
+
+    return *(guint32*)(data + y * cairo_image_surface_get_stride(surface) + x * 4);
+}
+
+static void check_cycle(const char* filename, guint32 left, guint32 right) {
+    RsvgHandle* handle;
+    cairo_surface_t* surface;
+    GError* error = NULL;
+
+    handle = rsvg_handle_new_from_file(filename, &error);
+    g_assert_no_error(error);
+
+    surface = render_handle(handle);
+    g_assert_cmphex(pixel_at(surface, 5, 5), ==, left);
+    g_assert_cmphex(pixel_at(surface, 15, 5), ==, right);
+
+    cairo_surface_destroy(surface);
+    g_object_unref(handle);
+}
+
+static void load_extern_cycles(void) {
+    char *dir, *self, *a, *b;
+    GError* error = NULL;
+
+    dir = g_dir_make_tmp("rsvg-cycle-XXXXXX", &error);
+    g_assert_no_error(error);
+
+    /* a document that refers to itself by name */
+    self = g_build_filename(dir, "self.svg", NULL);
+    g_assert(g_file_set_contents(self,
+                                 "<svg xmlns='http://www.w3.org/2000/svg' "
+                                 "xmlns:xlink='http://www.w3.org/1999/xlink' width='20' height='10'>"
+                                 "<rect id='x' width='10' height='10' fill='lime'/>"
+                                 "<use x='10' xlink:href='self.svg#x'/></svg>",
+                                 -1, NULL));
+
+    /* two documents that refer to each other */
+    a = g_build_filename(dir, "a.svg", NULL);
+    b = g_build_filename(dir, "b.svg", NULL);
+    g_assert(g_file_set_contents(a,
+                                 "<svg xmlns='http://www.w3.org/2000/svg' "
+                                 "xmlns:xlink='http://www.w3.org/1999/xlink' width='20' height='10'>"
+                                 "<rect id='a' width='10' height='10' fill='lime'/>"
+                                 "<use x='10' xlink:href='b.svg#b'/></svg>",
+                                 -1, NULL));
+    g_assert(g_file_set_contents(b,
+                                 "<svg xmlns='http://www.w3.org/2000/svg' "
+                                 "xmlns:xlink='http://www.w3.org/1999/xlink' width='20' height='10'>"
+                                 "<rect id='b' width='10' height='10' fill='blue'/>"
+                                 "<use x='10' xlink:href='a.svg#a'/></svg>",
+                                 -1, NULL));
+
+    check_cycle(self, 0xff00ff00, 0xff00ff00);
+    check_cycle(a, 0xff00ff00, 0xff0000ff);
+    check_cycle(b, 0xff0000ff, 0xff00ff00);
+
+    g_unlink(self);
+    g_unlink(a);
+    g_unlink(b);
+    g_rmdir(dir);
+    g_free(self);
+    g_free(a);
+    g_free(b);
+    g_free(dir);
+}
+
 static TestData tests[] = {
     {"/loading/one-byte-at-a-time", "loading/gnome-cool.svg", 1},
     {"/loading/compressed-one-byte-at-a-time", "loading/gnome-cool.svgz", 1},
@@ -74,6 +815,37 @@ int main(int argc, char** argv) {
         g_test_add_data_func(tests[i].test_name, &tests[i], load_n_bytes_at_a_time);
     }
 
+    g_test_add_func("/loading/compressed-stream", load_compressed_stream);
+    g_test_add_func("/loading/compressed-large-document", load_large_compressed_document);
+    g_test_add_func("/loading/compressed-truncated-document", load_truncated_compressed_document);
+    g_test_add_func("/loading/compressed-stalled-document", load_stalled_compressed_document);
+    g_test_add_func("/loading/large-geometry", load_large_geometry);
+    g_test_add_func("/loading/cache", load_from_cache);
+    g_test_add_func("/loading/extern-cache", load_extern_from_cache);
+    g_test_add_func("/loading/prefetch", load_prefetched_resources);
+    g_test_add_func("/loading/extern-cycles", load_extern_cycles);
+    g_test_add_func("/loading/async", load_async);
+
+    g_test_add_data_func("/loading/data-uri/base64", "data:image/png;base64," RED_PNG_BASE64,
+                         load_data_uri_image);
+    g_test_add_data_func("/loading/data-uri/base64-line-breaks",
+                         "data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAA\n"
+                         "AAIAAAACCAIAAAD91JpzAAAAEElEQVR42mP4z8AARAwQCgAf7gP9\n"
+                         "Y167WwAAAABJRU5ErkJggg==",
+                         load_data_uri_image);
+    g_test_add_data_func("/loading/data-uri/percent-escaped",
+                         "data:image%2Fpng;base64,%69VBORw0KGgoAAAANSUhEUgAA%0A"
+                         "AAIAAAACCAIAAAD91JpzAAAAEElEQVR42mP4z8AARAwQCgAf7gP9Y167WwAAAABJRU5ErkJggg%3D%3D",
+                         load_data_uri_image);
+    /* as with g_base64_decode(), an unpadded partial quad at the end is dropped */
+    g_test_add_data_func("/loading/data-uri/unpadded-tail", "data:image/png;base64," RED_PNG_BASE64 "QU",
+                         load_data_uri_image);
+    /* and decoding carries on after padding */
+    g_test_add_data_func("/loading/data-uri/padding-mid-string",
+                         "data:image/png;base64,iVBORw=="
+                         "DQoaCgAAAA1JSERSAAAAAgAAAAIIAgAAAP3UmnMAAAAQSURBVHjaY/jPwABEDBAKAB/uA/1jXrtbAAAAAElFTkSuQmCC",
+                         load_data_uri_image);
+
     result = g_test_run();
 
     rsvg_cleanup();
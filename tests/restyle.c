@@ -181,6 +181,58 @@ static void test_restyle_accumulation(void) {
     g_object_unref(handle);
 }
 
+/* Enough nodes to be restyled on several threads */
+#define GRID_WIDTH 100
+#define GRID_HEIGHT 60
+
+static void test_restyle_threads(guint n_threads) {
+    static const guint32 colors[] = {0xffff0000, 0xff00ff00, 0xff0000ff, 0xffffffff};
+    const char* css_data = ".c0 { fill: #ff0000; } .c1 { fill: #00ff00; } rect.c2 { fill: #0000ff; } "
+                           ".c3 { fill: #000000; } #r3 { fill: #ffffff; }";
+    GString* svg = g_string_new(NULL);
+    RsvgHandle* handle;
+    GError* error = NULL;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+    guint i;
+
+    g_string_printf(svg, "<svg xmlns='http://www.w3.org/2000/svg' width='%d' height='%d'>", GRID_WIDTH, GRID_HEIGHT);
+    for (i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++) {
+        /* every fourth rect is c3, but only r3 is restyled to white */
+        g_string_append_printf(svg, "<rect id='r%u' class='c%u other' x='%u' y='%u' width='1' height='1'/>",
+                               i % 4 == 3 ? 3 : i, i % 4, i % GRID_WIDTH, i / GRID_WIDTH);
+    }
+    g_string_append(svg, "</svg>");
+
+    handle = rsvg_handle_new_from_data((const guint8*)svg->str, svg->len, &error);
+    g_assert_no_error(error);
+    rsvg_handle_set_style_threads(handle, n_threads);
+
+    rsvg_handle_set_stylesheet(handle, (const guint8*)css_data, strlen(css_data), &error);
+    g_assert_no_error(error);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, GRID_WIDTH, GRID_HEIGHT);
+    cr = cairo_create(surface);
+    rsvg_handle_render_cairo(handle, cr);
+    cairo_surface_flush(surface);
+
+    for (i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++)
+        g_assert_cmphex(get_pixel(surface, i % GRID_WIDTH, i / GRID_WIDTH), ==, colors[i % 4]);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    g_object_unref(handle);
+    g_string_free(svg, TRUE);
+}
+
+static void test_restyle_sequential(void) {
+    test_restyle_threads(1);
+}
+
+static void test_restyle_parallel(void) {
+    test_restyle_threads(4);
+}
+
 int main(int argc, char** argv) {
     g_test_init(&argc, &argv, NULL);
 
@@ -189,6 +241,8 @@ int main(int argc, char** argv) {
     g_test_add_func("/restyle/id", test_restyle_id);
     g_test_add_func("/restyle/inline_precedence", test_restyle_inline_precedence);
     g_test_add_func("/restyle/accumulation", test_restyle_accumulation);
+    g_test_add_func("/restyle/sequential", test_restyle_sequential);
+    g_test_add_func("/restyle/parallel", test_restyle_parallel);
 
     return g_test_run();
 }
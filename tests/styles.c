@@ -1,6 +1,7 @@
 /* vim: set ts=4 nowrap ai expandtab sw=4: */
 
 #include <glib.h>
+#include <string.h>
 #include "rsvg.h"
 #include "rsvg-compat.h"
 #include "rsvg-private.h"
@@ -95,6 +96,19 @@ static const FixtureData fixtures[] = {
      .expected.color = 0xffff0000},
     {"/styles/selectors/2 or more selectors (stroke)", "592207", "styles/bug592207.svg", "#target", "stroke",
      .expected.color = 0xff0000ff},
+    {"/styles/selectors/class list", NULL, "styles/class-list.svg", "#multi", "fill", .expected.color = 0xffff0000},
+    {"/styles/selectors/type.class in class list", NULL, "styles/class-list.svg", "#multi", "stroke",
+     .expected.color = 0xff00ff00},
+    {"/styles/selectors/repeated class list", NULL, "styles/class-list.svg", "#repeat", "stroke",
+     .expected.color = 0xff00ff00},
+    {"/styles/selectors/class list without type.class", NULL, "styles/class-list.svg", "#circle", "stroke",
+     .expected.color = 0xff0000ff},
+    {"/styles/selectors/*.class", NULL, "styles/selector-parts.svg", "#universal-class", "fill",
+     .expected.color = 0xff00ff00},
+    {"/styles/selectors/#id.class prior than class", NULL, "styles/selector-parts.svg", "#swapped", "fill",
+     .expected.color = 0xff0000ff},
+    {"/styles/selectors/unsupported selectors are ignored", NULL, "styles/selector-parts.svg", "#descendant", "fill",
+     .expected.color = 0xff000000},
     {"/styles/svg-element-style", "615701", "styles/svg-class.svg", "#svg", "fill", .expected.color = 0xff0000ff},
     {"/styles/presentation attribute in svg element", "620693", "styles/bug620693.svg", "#svg", "stroke",
      .expected.color = 0xffff0000},
@@ -113,11 +127,64 @@ static const FixtureData fixtures[] = {
      .expected.color = 0xffffffff},
     {"/styles/!important/style prior than class", NULL, "styles/important.svg", "#pink", "fill",
      .expected.color = 0xffffc0cb},
+    {"/styles/inline/quotes and whitespace", NULL, "styles/inline-style.svg", "#quoted", "stroke",
+     .expected.color = 0xff0000ff},
+    {"/styles/inline/!important", NULL, "styles/inline-style.svg", "#quoted", "fill", .expected.color = 0xff00ff00},
+    {"/styles/inline/later declaration wins", NULL, "styles/inline-style.svg", "#not-important", "fill",
+     .expected.color = 0xff00ff00},
     /* {"/styles/selectors/descendant", "338160", "styles/bug338160.svg", "#base_shadow", "stroke-width",
        .expected.length = {2., '\0'}}, */
 };
 static const gint n_fixtures = G_N_ELEMENTS(fixtures);
 
+/* siblings that can take their styles from one another */
+static const char share_document[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>"
+    "<style type='text/css'>.a { fill: blue; } #special { fill: lime; }</style>"
+    "<rect id='r0' class='a' width='10' height='10'/>"
+    "<rect id='r1' class='a' width='10' height='10'/>"
+    "<rect id='r2' class='a' width='10' height='10'/>"
+    "<rect id='r3' class='a' width='10' height='10'/>"
+    "<rect id='special' class='a' width='10' height='10'/>"
+    "<rect id='attr' class='a' stroke='red' width='10' height='10'/>"
+    "<rect id='styled' class='a' style='stroke: red' width='10' height='10'/>"
+    "<rect id='styled2' class='a' style='stroke: red' width='10' height='10'/>"
+    "</svg>";
+
+static RsvgNode* lookup_node(RsvgHandle* handle, const char* id) {
+    RsvgNode* node = rsvg_defs_lookup(handle->priv->defs, id);
+
+    g_assert(node);
+    g_assert(node->state);
+    return node;
+}
+
+static void test_style_sharing(void) {
+    RsvgHandle* handle;
+    GError* error = NULL;
+    guint64 hits, misses;
+
+    handle = rsvg_handle_new_from_data((const guint8*)share_document, strlen(share_document), &error);
+    g_assert_no_error(error);
+
+    assert_equal_color(0xff0000ff, lookup_node(handle, "#r0")->state->fill->core.color->argb);
+    assert_equal_color(0xff0000ff, lookup_node(handle, "#r3")->state->fill->core.color->argb);
+    assert_equal_color(0xff00ff00, lookup_node(handle, "#special")->state->fill->core.color->argb);
+    assert_equal_color(0xff0000ff, lookup_node(handle, "#attr")->state->fill->core.color->argb);
+    assert_equal_color(0xffff0000, lookup_node(handle, "#attr")->state->stroke->core.color->argb);
+    assert_equal_color(0xffff0000, lookup_node(handle, "#styled2")->state->stroke->core.color->argb);
+    g_assert_false(lookup_node(handle, "#r1")->state->has_stroke_server);
+
+    /* r1 to r3 from r0, and styled2 from styled; computed for the <svg>,
+     * r0, special and styled
+     */
+    rsvg_handle_get_style_share_stats(handle, &hits, &misses);
+    g_assert_cmpuint(hits, ==, 4);
+    g_assert_cmpuint(misses, ==, 4);
+
+    g_object_unref(handle);
+}
+
 int main(int argc, char* argv[]) {
     gint i;
     int result;
@@ -128,6 +195,7 @@ int main(int argc, char* argv[]) {
 
     for (i = 0; i < n_fixtures; i++)
         g_test_add_data_func(fixtures[i].test_name, &fixtures[i], (GTestDataFunc)test_value);
+    g_test_add_func("/styles/sharing", test_style_sharing);
 
     result = g_test_run();
 